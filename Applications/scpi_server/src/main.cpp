@@ -55,7 +55,7 @@ void UpdateSignals(void) {
 }
 
 void UpdateParams(void) {
-    isRunning.Value() = IsRunning();
+    isRunning.SendValue(IsRunning());
 }
 
 int IsRunning(void) {
@@ -75,11 +75,11 @@ void OnNewParams(void) {
     if(IsRunning() && inRun.NewValue() == false)
     {
     	system("killall scpi-server");
-    	inRun.Value() = false;
+    	inRun.SendValue(false);
     }
     else if(!IsRunning() && inRun.NewValue() == true)
     {
     	system("export LD_LIBRARY_PATH=/opt/redpitaya/lib/ && /opt/redpitaya/bin/scpi-server &");
-    	inRun.Value() = true;
+    	inRun.SendValue(true);
     }
 }
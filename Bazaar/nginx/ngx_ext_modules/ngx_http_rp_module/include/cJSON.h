@@ -40,6 +40,7 @@ extern "C"
 #define cJSON_Object 6
 #define cJSON_2dFloatArray 7
 #define cJSON_VerFloat 8
+#define cJSON_Raw 9
 
 #define cJSON_IsReference 256
 
@@ -105,6 +106,9 @@ extern cJSON *cJSON_CreateIntArray(const int *numbers,int count, ngx_pool_t *poo
 extern cJSON *cJSON_CreateFloatArray(const float *numbers,int count, ngx_pool_t *pool);
 extern cJSON *cJSON_CreateDoubleArray(const double *numbers,int count, ngx_pool_t *pool);
 extern cJSON *cJSON_CreateStringArray(const char **strings,int count, ngx_pool_t *pool);
+/* Already rendered JSON text, printed as is. The text is referenced, not copied,
+   and must stay valid until the item is printed. */
+extern cJSON *cJSON_CreateRaw(const char *raw, ngx_pool_t *pool);
 extern cJSON *cJSON_Create2dFloatArray(const float *num1, const float *num2, 
                                        int count, ngx_pool_t *pool);
 
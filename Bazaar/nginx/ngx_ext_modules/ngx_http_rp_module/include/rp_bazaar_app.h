@@ -42,6 +42,20 @@ typedef struct rp_app_params_s {
     float  max_val;
 } rp_app_params_t;
 
+/** Same as rp_app_params_t with double precision values. Applications that
+ * provide rp_set_params_hd() and rp_get_params_hd() get and return their
+ * parameters this way, so frequencies and phase increments reach them without
+ * being squeezed into a float.
+ **/
+typedef struct rp_app_params_hd_s {
+    char   *name;
+    double  value;
+    int     fpga_update;
+    int     read_only;
+    double  min_val;
+    double  max_val;
+} rp_app_params_hd_t;
+
 /* Functions & Structure which defines the application interface.
  * In application function with the same name and the same declaration must
  * be provided. For example: int rp_app_init(void);
@@ -53,6 +67,9 @@ typedef const char  *(*rp_app_desc_func)(void);
 typedef int          (*rp_set_params_func)(rp_app_params_t *p, int len);
 typedef int          (*rp_get_params_func)(rp_app_params_t **p);
 typedef int          (*rp_get_signals_func)(float ***s, int *sig_num, int *sig_len);
+/* Optional functions: */
+typedef int          (*rp_set_params_hd_func)(rp_app_params_hd_t *p, int len);
+typedef int          (*rp_get_params_hd_func)(rp_app_params_hd_t **p);
 
 /*WebSocket Server part*/
 typedef void		(*rp_ws_set_params_interval_func)(int);
@@ -64,6 +81,8 @@ typedef const char     *(*rp_ws_get_signals_func)(void);
 typedef int		(*rp_ws_set_params_func)(const char *_params);
 typedef int		(*rp_ws_set_signals_func)(const char *_signals);
 typedef void	(*rp_ws_gzip_func)(const char *_in, void* _data, size_t* _size);
+typedef const void *(*rp_ws_get_signals_binary_func)(int _key_frame, int _update, size_t* _size);
+typedef unsigned int	(*rp_ws_get_signals_generation_func)(void);
 
 typedef struct rp_bazaar_app_s {
     /* Initialization function - called when app. is loaded */
@@ -83,6 +102,9 @@ typedef struct rp_bazaar_app_s {
     rp_get_params_func       get_params_func;
     /* Retrieves last good signals from the application */
     rp_get_signals_func      get_signals_func;
+    /* Optional double precision variants of set_params_func and get_params_func */
+    rp_set_params_hd_func    set_params_hd_func;
+    rp_get_params_hd_func    get_params_hd_func;
 
 	/*WebSocket Server part*/
 
@@ -98,6 +120,8 @@ typedef struct rp_bazaar_app_s {
 	rp_ws_set_params_interval_func ws_set_params_demo_func;
 	rp_ws_set_params_func verify_app_license_func;
 	rp_ws_gzip_func ws_gzip_func;
+	rp_ws_get_signals_binary_func ws_get_signals_binary_func;
+	rp_ws_get_signals_generation_func ws_get_signals_generation_func;
 
     /* Dynamic library handle */
     void            *handle;
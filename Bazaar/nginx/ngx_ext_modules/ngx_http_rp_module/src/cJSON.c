@@ -379,6 +379,7 @@ static char *print_value(cJSON *item,int depth,int fmt, ngx_pool_t *pool)
         case cJSON_Array:	out=print_array(item,depth,fmt, pool);break;
         case cJSON_Object:	out=print_object(item,depth,fmt, pool);break;
         case cJSON_2dFloatArray: out=print_2dfloat_array(item, fmt, pool);break;
+        case cJSON_Raw:         out=cJSON_strdup(item->valuestring, pool);break;
 	}
 	return out;
 }
@@ -700,6 +701,7 @@ cJSON *cJSON_CreateBool(int b, ngx_pool_t *pool)					{cJSON *item=cJSON_New_Item
 cJSON *cJSON_CreateNumber(double num, ngx_pool_t *pool)			{cJSON *item=cJSON_New_Item(pool);if(item){item->type=cJSON_Number;item->valuedouble=num;item->valueint=(int)num;}return item;}
 cJSON *cJSON_CreateVerFloat(double num, ngx_pool_t *pool)			{cJSON *item=cJSON_New_Item(pool);if(item){item->type=cJSON_VerFloat;item->valuedouble=num;item->valueint=(int)num;}return item;}
 cJSON *cJSON_CreateString(const char *string, ngx_pool_t *pool)	{cJSON *item=cJSON_New_Item(pool);if(item){item->type=cJSON_String;item->valuestring=cJSON_strdup(string, pool);}return item;}
+cJSON *cJSON_CreateRaw(const char *raw, ngx_pool_t *pool)			{cJSON *item=cJSON_New_Item(pool);if(item){item->type=cJSON_Raw|cJSON_IsReference;item->valuestring=(char*)raw;}return item;}
 cJSON *cJSON_CreateArray(ngx_pool_t *pool)					{cJSON *item=cJSON_New_Item(pool);if(item)item->type=cJSON_Array;return item;}
 cJSON *cJSON_CreateObject(ngx_pool_t *pool)					{cJSON *item=cJSON_New_Item(pool);if(item)item->type=cJSON_Object;return item;}
 
@@ -36,6 +36,8 @@ const char *c_rp_set_params_str   = "rp_set_params";
 const char *c_rp_get_params_str   = "rp_get_params";
 const char *c_rp_set_signals_str  = "rp_set_signals";
 const char *c_rp_get_signals_str  = "rp_get_signals";
+const char *c_rp_set_params_hd_str = "rp_set_params_hd";
+const char *c_rp_get_params_hd_str = "rp_get_params_hd";
 
 //start web socket function str
 
@@ -50,6 +52,8 @@ const char *c_ws_get_signals_str  = "ws_get_signals";
 const char *c_ws_set_demo_mode_str  = "ws_set_demo_mode";
 const char *c_verify_app_license_str  = "verify_app_license";
 const char* c_ws_gzip_str = "ws_gzip";
+const char* c_ws_get_signals_binary_str = "ws_get_signals_binary";
+const char* c_ws_get_signals_generation_str = "ws_get_signals_generation";
 // end web socket function str
 
 /** Get MAC address of a specific NIC via sysfs */
@@ -507,6 +511,10 @@ int rp_bazaar_app_load_module(const char *app_file, rp_bazaar_app_t *app)
     if(!app->get_signals_func)
         return -7;
 
+    /* Optional, applications without them get and return float parameters */
+    app->set_params_hd_func = dlsym(app->handle, c_rp_set_params_hd_str);
+    app->get_params_hd_func = dlsym(app->handle, c_rp_get_params_hd_str);
+
     // start web socket functionality
     app->ws_api_supported = 1;
     app->ws_set_params_interval_func = dlsym(app->handle, c_ws_set_params_interval_str);
@@ -586,6 +594,11 @@ int rp_bazaar_app_load_module(const char *app_file, rp_bazaar_app_t *app)
         fprintf(stderr, "Cannot resolve '%s' function.\n", c_ws_gzip_str);
     }
 
+    /* Optional, applications built against an older SDK only send JSON */
+    app->ws_get_signals_binary_func = dlsym(app->handle, c_ws_get_signals_binary_str);
+    /* Optional, without it every tick is encoded and sent as new */
+    app->ws_get_signals_generation_func = dlsym(app->handle, c_ws_get_signals_generation_str);
+
     // end web socket functionality
 
     app->file_name = (char *)malloc(strlen(app_file)+1);
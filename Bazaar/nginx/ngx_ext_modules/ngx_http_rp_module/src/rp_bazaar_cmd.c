@@ -523,6 +523,8 @@ int rp_bazaar_start(ngx_http_request_t *r,
         params.get_signals_func = rp_module_ctx.app.ws_get_signals_func;
         params.set_signals_func = rp_module_ctx.app.ws_set_signals_func;
         params.gzip_func = rp_module_ctx.app.ws_gzip_func;
+        params.get_signals_binary_func = rp_module_ctx.app.ws_get_signals_binary_func;
+        params.get_signals_generation_func = rp_module_ctx.app.ws_get_signals_generation_func;
         fprintf(stderr, "Starting WS-server\n");
 
         if (rp_module_ctx.app.verify_app_license_func)
@@ -25,6 +25,13 @@
 static float **rp_signals = NULL;
 static int     rp_signals_dirty = 0;
 
+/* rendered JSON of the last good result, shared by all requests until new
+ * signals arrive
+ */
+static unsigned int rp_signals_generation = 0;
+static unsigned int rp_signals_json_generation = 0;
+static char        *rp_signals_json = NULL;
+
 #define TRACE(args...) fprintf(stderr, args)
 
 
@@ -317,12 +324,36 @@ int rp_data_parse_and_set_params(cJSON *params_root)
         return -1;
 
     /* count the number of specified parameters to be set */
-    j_params = params_root->child;
-    while(j_params != NULL) {
-        if(j_params->type != cJSON_Number)
-            continue;
-        j_params = j_params->next;
-        rp_params_cnt++;
+    for(j_params = params_root->child; j_params != NULL; j_params = j_params->next) {
+        if((j_params->string != NULL) && (j_params->type == cJSON_Number))
+            rp_params_cnt++;
+    }
+
+    /* applications taking doubles get the values as parsed, names are
+     * only borrowed from the JSON tree for the time of the call */
+    if(rp_module_ctx.app.set_params_hd_func) {
+        rp_app_params_hd_t *rp_params_hd;
+
+        rp_params_hd = (rp_app_params_hd_t *)malloc((rp_params_cnt+1) * sizeof(rp_app_params_hd_t));
+        if(rp_params_hd == NULL)
+            return -1;
+
+        i = 0;
+        for(j_params = params_root->child; j_params != NULL; j_params = j_params->next) {
+            if((j_params->string == NULL) || (j_params->type != cJSON_Number))
+                continue;
+            rp_params_hd[i].name = j_params->string;
+            rp_params_hd[i].value = j_params->valuedouble;
+            i++;
+        }
+        rp_params_hd[rp_params_cnt].name = NULL;
+
+        ret_val = 0;
+        if(rp_module_ctx.app.set_params_hd_func(rp_params_hd, rp_params_cnt) < 0) {
+            ret_val = -1;
+        }
+        free(rp_params_hd);
+        return ret_val;
     }
 
     /* allocate temporary storage as an array of sequential parameters */
@@ -331,20 +362,17 @@ int rp_data_parse_and_set_params(cJSON *params_root)
         return -1;
 
     /* scan the specified JSON object and copy request parameters in our temporary storage */
-    j_params = params_root->child;
-    for(i = 0; i < rp_params_cnt || j_params != NULL; i++) {
-        if((j_params->string == NULL) || (j_params->type != cJSON_Number)) {
-            j_params = j_params->next;
+    i = 0;
+    for(j_params = params_root->child; j_params != NULL; j_params = j_params->next) {
+        if((j_params->string == NULL) || (j_params->type != cJSON_Number))
             continue;
-        }
 
         rp_params[i].name = (char *)malloc(strlen(j_params->string)+1);
         strncpy(&rp_params[i].name[0], &j_params->string[0],
                 strlen(j_params->string));
         rp_params[i].name[strlen(j_params->string)] = '\0';
         rp_params[i].value = (float)j_params->valuedouble;
-
-        j_params = j_params->next;
+        i++;
     }
     rp_params[rp_params_cnt].name = NULL;
 
@@ -383,6 +411,33 @@ int rp_data_get_params(ngx_http_request_t *r, cJSON **json_root)
     }
 
     /* Now prepare the answer with set parameters */
+    if(rp_module_ctx.app.get_params_hd_func) {
+        rp_app_params_hd_t *rp_params_hd = NULL;
+
+        rp_params_cnt = rp_module_ctx.app.get_params_hd_func(&rp_params_hd);
+        if(rp_params_hd == NULL) {
+            return rp_module_cmd_error(json_root, "Can not retrieve parameters.",
+                                       NULL, r->pool);
+        }
+
+        cJSON_AddItemToObject(data_root, "params",
+                              j_params=cJSON_CreateObject(r->pool), r->pool);
+
+        for(i = 0; i < rp_params_cnt; i++) {
+            cJSON_AddItemToObject(j_params, rp_params_hd[i].name,
+                                  cJSON_CreateNumber(rp_params_hd[i].value, r->pool),
+                                  r->pool);
+        }
+
+        for(i = 0; i < rp_params_cnt; i++) {
+            if(rp_params_hd[i].name)
+                free((char *)rp_params_hd[i].name);
+        }
+        free(rp_params_hd);
+
+        return 0;
+    }
+
     rp_params_cnt = rp_module_ctx.app.get_params_func(&rp_params);
     if(rp_params == NULL) {
         return rp_module_cmd_error(json_root, "Can not retrieve parameters.",
@@ -410,10 +465,61 @@ int rp_data_get_params(ngx_http_request_t *r, cJSON **json_root)
 
 
 /*----------------------------------------------------------------------------*/
+/**
+ * @brief Render the signal datasets of the last good result.
+ *
+ * The text is kept in rp_signals_json and only rebuilt when the application
+ * delivered new signals, so polling clients share one rendering per update.
+ *
+ * @retval     0          rp_signals_json is up to date
+ * @retval     -1         failure while allocating or printing
+ */
+static int rp_data_render_signals(ngx_http_request_t *r, int rp_sig_len)
+{
+    cJSON *sig_root, *g1;
+    char *out;
+
+    if((rp_signals_json != NULL) &&
+       (rp_signals_json_generation == rp_signals_generation))
+        return 0;
+
+    g1 = cJSON_CreateArray(r->pool);
+    if(g1 == NULL)
+        return -1;
+
+    cJSON_AddItemToObject(g1, "g1", 
+                          sig_root=cJSON_CreateObject(r->pool), r->pool);
+    cJSON_AddItemToObject(sig_root, "data",
+                   cJSON_Create2dFloatArray(&rp_signals[0][0], &rp_signals[1][0],
+                                            rp_sig_len, r->pool),
+                          r->pool);
+    cJSON_AddItemToObject(g1, "g1", 
+                          sig_root=cJSON_CreateObject(r->pool), r->pool);
+    cJSON_AddItemToObject(sig_root, "data",
+                   cJSON_Create2dFloatArray(&rp_signals[0][0], &rp_signals[2][0],
+                                            rp_sig_len, r->pool),
+                          r->pool);
+
+    out = cJSON_PrintUnformatted(g1, r->pool);
+    cJSON_Delete(g1, r->pool);
+    if(out == NULL)
+        return -1;
+
+    if(rp_signals_json)
+        free(rp_signals_json);
+    rp_signals_json = strdup(out);
+    ngx_pfree(r->pool, out);
+    if(rp_signals_json == NULL)
+        return -1;
+
+    rp_signals_json_generation = rp_signals_generation;
+    return 0;
+}
+
 int rp_data_get_signals(ngx_http_request_t *r, cJSON **json_root)
 {
     int rp_sig_num, rp_sig_len, ret_val;
-    cJSON *data_root, *sig_root, *d1, *d2, *g1;
+    cJSON *data_root;
     /* TODO: Make it configurable */
     int retries = 200; /* Approx in [ms] */
 
@@ -435,11 +541,15 @@ int rp_data_get_signals(ngx_http_request_t *r, cJSON **json_root)
     ret_val =
         rp_module_ctx.app.get_signals_func((float ***)&rp_signals, &rp_sig_num, 
                                            &rp_sig_len);
+    if(ret_val == 0)
+        rp_signals_generation++;
 
     while(ret_val == -1) {
         ret_val =
             rp_module_ctx.app.get_signals_func((float ***)&rp_signals, 
                                                &rp_sig_num, &rp_sig_len);
+        if(ret_val == 0)
+            rp_signals_generation++;
 
         if(ret_val == -2) 
             break;
@@ -456,21 +566,13 @@ int rp_data_get_signals(ngx_http_request_t *r, cJSON **json_root)
         ret_val = 0;
     rp_signals_dirty = 1;
 
+    if(rp_data_render_signals(r, rp_sig_len) < 0) {
+        return rp_module_cmd_error(json_root, 
+                                   "Can not render signals", NULL, 
+                                   r->pool);
+    }
     cJSON_AddItemToObject(data_root, "g1",
-                          g1=cJSON_CreateArray(r->pool), r->pool);
-
-    cJSON_AddItemToObject(g1, "g1", 
-                          sig_root=cJSON_CreateObject(r->pool), r->pool);
-    cJSON_AddItemToObject(sig_root, "data",
-                   d1=cJSON_Create2dFloatArray(&rp_signals[0][0], &rp_signals[1][0],
-                                               rp_sig_len, r->pool),
-                          r->pool);
-    cJSON_AddItemToObject(g1, "g1", 
-                          sig_root=cJSON_CreateObject(r->pool), r->pool);
-    cJSON_AddItemToObject(sig_root, "data",
-                   d2=cJSON_Create2dFloatArray(&rp_signals[0][0], &rp_signals[2][0],
-                                               rp_sig_len, r->pool),
-                          r->pool);
+                          cJSON_CreateRaw(rp_signals_json, r->pool), r->pool);
 
     return ret_val;
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <stdint.h>
+#include <vector>
 #include <libjson.h>
 
 class CBaseParameter  //base class for parameter and signal
@@ -17,6 +19,7 @@ public:
 		AccessModes
 	};
 
+	CBaseParameter() : m_Dirty(false), m_Generation(0) {};
 	virtual ~CBaseParameter(){}; 
 	virtual const char* GetName() const = 0;
 	virtual void Update() = 0;		//apply change of value
@@ -26,4 +29,18 @@ public:
 	virtual bool IsValueChanged() const = 0;
 	virtual bool IsNewValue() const = 0;
 	virtual void ClearNewValue() = 0;
+
+	// raw little-endian samples for binary signal frames, false if not supported
+	virtual bool GetBinaryValue(std::vector<uint8_t>& _raw, uint8_t& _type, uint32_t& _size) { return false; }
+
+	// changes whenever the value may have been written, see CDataManager::GetSignalsGeneration()
+	uint32_t GetGeneration() const { return m_Generation; }
+
+protected:
+	void Touch() { m_Generation++; }
+
+private:
+	friend class CDataManager;
+	bool m_Dirty;	// queued on the CDataManager dirty list
+	uint32_t m_Generation;
 };
@@ -1,8 +1,11 @@
 #pragma once
 
 #include <stdio.h>
+#include <limits>
+#include <cstring>
 
 #include "Parameter.h"
+#include "SignalFrame.h"
 
 //template for params
 template <typename Type> class CCustomParameter : public CParameter<Type, Type>
@@ -57,6 +60,15 @@ public:
 	void Set(const Type& _value)
 	{
 		this->m_Value.value = CheckMinMax(_value);
+		MarkDirty();
+	}
+
+	// reports a value the application measured, queued for the next send;
+	// writes through Value() are not sent, use Set() or SendValue()
+	void SendValue(const Type& _value)
+	{
+		this->m_Value.value = _value;
+		MarkDirty();
 	}
 
 	bool IsValueChanged() const
@@ -67,6 +79,13 @@ public:
 	}
 
 protected:
+	void MarkDirty()
+	{
+		CDataManager * man = CDataManager::GetInstance();
+		if(man)
+			man->MarkParamDirty(this);
+	}
+
 	mutable Type m_SentValue;
 
 };
@@ -105,24 +124,79 @@ public:
 		return n;
 	}
 
+	bool GetBinaryValue(std::vector<uint8_t>& _raw, uint8_t& _type, uint32_t& _size)
+	{
+		const std::vector<Type>& value = this->m_Value.value;
+		_size = value.size();
+
+		if(std::numeric_limits<Type>::is_integer)
+		{
+			bool fits16 = true;
+			for(size_t i = 0; i < value.size() && fits16; i++)
+				fits16 = value[i] >= std::numeric_limits<int16_t>::min() && value[i] <= std::numeric_limits<int16_t>::max();
+
+			_type = fits16 ? SF_TYPE_INT16 : SF_TYPE_INT32;
+			_raw.resize(value.size() * (fits16 ? sizeof(int16_t) : sizeof(int32_t)));
+			for(size_t i = 0; i < value.size(); i++)
+			{
+				if(fits16)
+				{
+					int16_t v = value[i];
+					memcpy(&_raw[i * sizeof(v)], &v, sizeof(v));
+				}
+				else
+				{
+					int32_t v = value[i];
+					memcpy(&_raw[i * sizeof(v)], &v, sizeof(v));
+				}
+			}
+		}
+		else
+		{
+			_type = SF_TYPE_FLOAT32;
+			_raw.resize(value.size() * sizeof(float));
+			for(size_t i = 0; i < value.size(); i++)
+			{
+				float v = value[i];
+				memcpy(&_raw[i * sizeof(v)], &v, sizeof(v));
+			}
+		}
+		return true;
+	}
+
 	const Type& operator [](int _index) const
 	{
 		return this->m_Value.value.at(_index);
 	}
 
+	// every writable access moves the generation on, unchanged signals are not encoded again
 	Type& operator [](int _index)
 	{
+		this->Touch();
 		return this->m_Value.value.at(_index);
 	}
 
+	std::vector<Type>& Value()
+	{
+		this->Touch();
+		return this->m_Value.value;
+	}
+
+	const std::vector<Type>& Value() const
+	{
+		return this->m_Value.value;
+	}
+
 	void Set(const std::vector<Type>& _value)
 	{
 		this->m_Value.value = _value;
+		this->Touch();
 	}
 
 	void Resize(int _new_size)
 	{
 		this->m_Value.value.resize(_new_size);
+		this->Touch();
 	}
 
 	int GetSize()
@@ -173,6 +247,7 @@ public:
 	void Set(const std::string& _value)
 	{
 		this->m_Value.value = _value;
+		MarkDirty();
 	}
 };
 
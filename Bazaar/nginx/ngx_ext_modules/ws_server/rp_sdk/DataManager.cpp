@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <cstring>
+#include <algorithm>
 #include "DataManager.h"
 #include "CustomParameters.h"
 #include "misc.h"
@@ -14,6 +15,17 @@ CBooleanParameter IsDemoParam("is_demo", CBaseParameter::RO, false, 1);
 CStringParameter InCommandParam("in_command", CBaseParameter::WO, "", 1);
 CStringParameter OutCommandParam("out_command", CBaseParameter::RO, "", 1);
 
+static inline bool IsAlwaysSent(const CBaseParameter& param)
+{
+	CBaseParameter::AccessMode mode = param.GetAccessMode();
+	return (mode == CBaseParameter::AccessMode::ROSA) || (mode == CBaseParameter::AccessMode::RWSA);
+}
+
+static void Erase(std::vector<CBaseParameter*>& _list, CBaseParameter* _param)
+{
+	_list.erase(std::remove(_list.begin(), _list.end(), _param), _list.end());
+}
+
 int dbg_printf(const char * format, ...)
 {
 	static FILE* log = fopen("/var/log/nginx/rp_sdk.log", "wt");
@@ -43,6 +55,17 @@ CDataManager::CDataManager()
 	, m_param_interval(20)
 	, m_signal_interval(20)
 	, m_send_all_params(true)
+	, m_signal_frame()
+	, m_signal_raw()
+	, m_signal_generation(0)
+	, m_signal_touched(0)
+	, m_signal_list_changed(true)
+	, m_signals_json()
+	, m_json_generation(0)
+	, m_json_valid(false)
+	, m_binary_generation(0)
+	, m_binary_valid(false)
+	, m_binary_key(false)
 {
 }
 
@@ -56,6 +79,9 @@ void CDataManager::RegisterParam(CBaseParameter * _param)
 {
 	dbg_printf("RegisterParam: %s\n", _param->GetName());
 	m_params.push_back(_param);
+	m_param_index.insert(ParamIndex::value_type(_param->GetName(), _param));
+	if(IsAlwaysSent(*_param))
+		m_always_params.push_back(_param);
 	dbg_printf("Registered params: %d\n", m_params.size());
 }
 
@@ -63,47 +89,72 @@ void CDataManager::RegisterSignal(CBaseParameter * _signal)
 {
 	dbg_printf("RegisterSignal: %s\n", _signal->GetName());
 	m_signals.push_back(_signal);
+	m_signal_index.insert(ParamIndex::value_type(_signal->GetName(), _signal));
+	m_signal_list_changed = true;
 	dbg_printf("Registered signals: %d\n", m_signals.size());
 }
 
 void CDataManager::UnRegisterParam(const char * _name)
 {
-	for (std::vector<CBaseParameter *>::iterator it =  m_params.begin() ; it !=  m_params.end(); ++it)
+	ParamIndex::iterator it = m_param_index.find(_name);
+	if(it == m_param_index.end())
+		return;
+
+	CBaseParameter * param = it->second;
+	m_param_index.erase(it);
+	Erase(m_params, param);
+	Erase(m_always_params, param);
+	Erase(m_new_params, param);
 	{
-		if(strcmp((*it)->GetName(),_name)==0)
-		{
-			m_params.erase(it);
-			dbg_printf("UnRegisterParam: %s\n", _name);
-			return;
-		}
+		std::lock_guard<std::mutex> lock(m_dirty_mutex);
+		Erase(m_dirty_params, param);
 	}
+	dbg_printf("UnRegisterParam: %s\n", _name);
 }
 
 void CDataManager::UnRegisterSignal(const char * _name)
 {
-	for (std::vector<CBaseParameter *>::iterator it =  m_signals.begin() ; it !=  m_params.end(); ++it)
+	ParamIndex::iterator it = m_signal_index.find(_name);
+	if(it == m_signal_index.end())
+		return;
+
+	CBaseParameter * signal = it->second;
+	m_signal_index.erase(it);
+	Erase(m_signals, signal);
+	Erase(m_new_signals, signal);
+	m_signal_list_changed = true;
+	dbg_printf("UnRegisterSignal: %s\n", _name);
+}
+
+inline bool CDataManager::IsRegisteredParam(CBaseParameter * _param) const
+{
+	ParamIndex::const_iterator it = m_param_index.find(_param->GetName());
+	return it != m_param_index.end() && it->second == _param;
+}
+
+void CDataManager::MarkParamDirty(CBaseParameter * _param)
+{
+	std::lock_guard<std::mutex> lock(m_dirty_mutex);
+	if(!_param->m_Dirty)
 	{
-		if(strcmp((*it)->GetName(),_name)==0)
-		{
-			m_signals.erase(it);
-			dbg_printf("UnRegisterSignal: %s\n", _name);
-			return;
-		}
+		_param->m_Dirty = true;
+		m_dirty_params.push_back(_param);
 	}
 }
 
+// only parameters received in the last message can hold a new value
 void CDataManager::UpdateAllParams()
 {
-	for(size_t i=0; i < m_params.size(); i++) {
-		m_params[i]->Update();
-       }
+	for(size_t i=0; i < m_new_params.size(); i++) {
+		m_new_params[i]->Update();
+	}
 }
 
 void CDataManager::UpdateAllSignals()
 {
-	for(size_t i=0; i < m_signals.size(); i++) {
-		m_signals[i]->Update();
-        }
+	for(size_t i=0; i < m_new_signals.size(); i++) {
+		m_new_signals[i]->Update();
+	}
 }
 
 std::string CDataManager::GetParamsJson()
@@ -111,11 +162,29 @@ std::string CDataManager::GetParamsJson()
 	UpdateParams();
 	JSONNode params(JSON_NODE);
 	params.set_name("parameters");
-	for(size_t i=0; i < m_params.size(); i++) {
-		if(NeedSend(*m_params[i])) {
-			JSONNode n(JSON_NODE);
-			n = m_params[i]->GetJSONObject();
-			params.push_back(n);
+
+	{
+		std::lock_guard<std::mutex> lock(m_dirty_mutex);
+		m_send_params.swap(m_dirty_params);
+		m_dirty_params.clear();
+		for(size_t i=0; i < m_send_params.size(); i++)
+			m_send_params[i]->m_Dirty = false;
+	}
+
+	if(m_send_all_params) {
+		for(size_t i=0; i < m_params.size(); i++) {
+			if(NeedSend(*m_params[i]))
+				params.push_back(m_params[i]->GetJSONObject());
+		}
+	} else {
+		// written parameters which really changed, plus the always sent ones
+		for(size_t i=0; i < m_send_params.size(); i++) {
+			CBaseParameter * param = m_send_params[i];
+			if(!IsAlwaysSent(*param) && NeedSend(*param) && IsRegisteredParam(param))
+				params.push_back(param->GetJSONObject());
+		}
+		for(size_t i=0; i < m_always_params.size(); i++) {
+			params.push_back(m_always_params[i]->GetJSONObject());
 		}
 	}
 
@@ -126,9 +195,36 @@ std::string CDataManager::GetParamsJson()
 	return data_node.write();
 }
 
-std::string CDataManager::GetSignalsJson()
+/*
+ * Signals only move their generation on writable access, so the sum over all
+ * of them changes as soon as any one may have been written. Then the common
+ * generation is bumped and the cached JSON and binary encodings are stale.
+ */
+void CDataManager::UpdateSignalsGeneration()
+{
+	uint32_t touched = 0;
+	for(size_t i=0; i < m_signals.size(); i++)
+		touched += m_signals[i]->GetGeneration();
+
+	if(touched != m_signal_touched || m_signal_list_changed) {
+		m_signal_touched = touched;
+		m_signal_list_changed = false;
+		m_signal_generation++;
+	}
+}
+
+uint32_t CDataManager::GetSignalsGeneration()
+{
+	return m_signal_generation;
+}
+
+const std::string& CDataManager::GetSignalsJson()
 {
 	UpdateSignals();
+	UpdateSignalsGeneration();
+	if(m_json_valid && m_json_generation == m_signal_generation)
+		return m_signals_json;
+
 	JSONNode signals(JSON_NODE);
 	signals.set_name("signals");
 	for(size_t i=0; i < m_signals.size(); i++) {
@@ -142,31 +238,60 @@ std::string CDataManager::GetSignalsJson()
 	JSONNode data_node(JSON_NODE);
 	data_node.set_name("data");
 	data_node.push_back(signals);
-	return data_node.write();
+	m_signals_json = data_node.write();
+	m_json_generation = m_signal_generation;
+	m_json_valid = true;
+	return m_signals_json;
 }
 
-void CDataManager::OnNewParams(std::string _params)
+const std::vector<uint8_t>& CDataManager::GetSignalsBinary(bool _key_frame, bool _update)
 {
+	if(_update) {
+		UpdateSignals();
+		UpdateSignalsGeneration();
+	}
+
+	// a key frame serves everybody, a delta frame only those who had the previous one
+	if(m_binary_valid && m_binary_generation == m_signal_generation && (m_binary_key || !_key_frame))
+		return m_signal_frame.Get();
+
+	m_binary_generation = m_signal_generation;
+	m_binary_key = _key_frame;
+	m_binary_valid = true;
+	m_signal_frame.Begin(_key_frame);
+	for(size_t i=0; i < m_signals.size(); i++) {
+		uint8_t type;
+		uint32_t size;
+		if(NeedSend(*m_signals[i]) && m_signals[i]->GetBinaryValue(m_signal_raw, type, size))
+			m_signal_frame.AddSignal(m_signals[i]->GetName(), type, size, m_signal_raw);
+	}
+	return m_signal_frame.End();
+}
+
+void CDataManager::SetValuesFromJSON(const std::string& _json, const ParamIndex& _index, std::vector<CBaseParameter*>& _new)
+{
+	for(size_t i=0; i < _new.size(); i++)
+		_new[i]->ClearNewValue();
+	_new.clear();
+
 	JSONNode n(JSON_NODE);
-	n = libjson::parse(_params);
+	n = libjson::parse(_json);
 	JSONNode m(JSON_NODE);
 
-	for(size_t i=0; i < m_params.size(); i++)
-		m_params[i]->ClearNewValue();
-
 	for(size_t i=0; i < n.size(); i++) {
 		m = n.at(i);
-		const char* name = m.name().c_str();
-
-		for(size_t j=0; j < m_params.size(); j++) {
-			if(m_params[j]->GetAccessMode() != CBaseParameter::AccessMode::RO)
-			{
-				const char* param_name = m_params[j]->GetName();
-				if(!strcmp(param_name, name))
-					m_params[j]->SetValueFromJSON(m);
-			}
+
+		ParamIndex::const_iterator it = _index.find(m.name());
+		if(it != _index.end() && it->second->GetAccessMode() != CBaseParameter::AccessMode::RO) {
+			it->second->SetValueFromJSON(m);
+			_new.push_back(it->second);
 		}
 	}
+}
+
+void CDataManager::OnNewParams(std::string _params)
+{
+	SetValuesFromJSON(_params, m_param_index, m_new_params);
 
 	if(InCommandParam.IsNewValue())
 		m_send_all_params |= InCommandParam.NewValue() == "send_all_params";
@@ -177,26 +302,7 @@ void CDataManager::OnNewParams(std::string _params)
 void CDataManager::OnNewSignals(std::string _signals)
 {
 	dbg_printf("OnNewSignals\n");
-	JSONNode n(JSON_NODE);
-	n = libjson::parse(_signals);
-	JSONNode m(JSON_NODE);
-
-	for(size_t i=0; i < m_signals.size(); i++)
-		m_signals[i]->ClearNewValue();
-
-	for(size_t i=0; i < n.size(); i++) {
-		m = n.at(i);
-		const char* name = m.name().c_str();
-
-		for(size_t j=0; j < m_signals.size(); j++) {
-			if(m_signals[j]->GetAccessMode() != CBaseParameter::AccessMode::RO)
-			{
-				const char* param_name = m_signals[j]->GetName();
-				if(!strcmp(param_name, name))
-					m_signals[j]->SetValueFromJSON(m);
-			}
-		}
-	}
+	SetValuesFromJSON(_signals, m_signal_index, m_new_signals);
 
 	::OnNewSignals();
 }
@@ -268,13 +374,30 @@ extern "C" int ws_set_signals(const char *_signals)
 extern "C" const char* ws_get_signals(void)
 {
 	CDataManager * man = CDataManager::GetInstance();
-	static std::string res = "";
+	if(man)
+		return man->GetSignalsJson().c_str();
+	return "";
+}
+
+extern "C" const void * ws_get_signals_binary(int _key_frame, int _update, size_t* _size)
+{
+	CDataManager * man = CDataManager::GetInstance();
+	*_size = 0;
 	if(man)
 	{
-		res = man->GetSignalsJson();
-		return res.c_str();
+		const std::vector<uint8_t>& res = man->GetSignalsBinary(_key_frame, _update);
+		*_size = res.size();
+		return res.data();
 	}
-	return res.c_str();
+	return NULL;
+}
+
+extern "C" unsigned int ws_get_signals_generation(void)
+{
+	CDataManager * man = CDataManager::GetInstance();
+	if(man)
+		return man->GetSignalsGeneration();
+	return 0;
 }
 
 extern "C" void ws_set_params_interval(int _interval)
@@ -1,7 +1,11 @@
 #pragma once
 
 #include <vector>
+#include <string>
+#include <unordered_map>
+#include <mutex>
 #include "BaseParameter.h"
+#include "SignalFrame.h"
 
 struct Data {
 	char* data;
@@ -17,11 +21,38 @@ private:
 
 	inline bool NeedSend(const CBaseParameter& param) const;
 
+	typedef std::unordered_map<std::string, CBaseParameter*> ParamIndex;
+
+	inline bool IsRegisteredParam(CBaseParameter * _param) const;
+	void SetValuesFromJSON(const std::string& _json, const ParamIndex& _index, std::vector<CBaseParameter*>& _new);
+	void UpdateSignalsGeneration();
+
 	std::vector<CBaseParameter*> m_params;
 	std::vector<CBaseParameter*> m_signals;
+	ParamIndex m_param_index; //name lookup for incoming values
+	ParamIndex m_signal_index;
+	std::vector<CBaseParameter*> m_new_params; //params holding a value received in the last message
+	std::vector<CBaseParameter*> m_new_signals;
+	std::vector<CBaseParameter*> m_always_params; //RWSA and ROSA params, sent on every tick
+	std::vector<CBaseParameter*> m_dirty_params; //params written since the last send
+	std::vector<CBaseParameter*> m_send_params; //dirty params taken by the current send
+	std::mutex m_dirty_mutex;
 	int m_param_interval; //parameters send time interval in milliseconds
 	int m_signal_interval; //signals send time interval in milliseconds
 	bool m_send_all_params;
+	CSignalFrame m_signal_frame;
+	std::vector<uint8_t> m_signal_raw;
+
+	// encoded signals are kept until a signal changes, see GetSignalsGeneration()
+	uint32_t m_signal_generation;
+	uint32_t m_signal_touched; //sum of the signal generations at the last check
+	bool m_signal_list_changed;
+	std::string m_signals_json;
+	uint32_t m_json_generation;
+	bool m_json_valid;
+	uint32_t m_binary_generation;
+	bool m_binary_valid;
+	bool m_binary_key;
 
 public:
 	static CDataManager* GetInstance();
@@ -33,8 +64,12 @@ public:
 	void UnRegisterParam(const char * _name);
 	void UnRegisterSignal(const char * _name);
 
+	void MarkParamDirty(CBaseParameter * _param); //queue a written parameter for the next send
+
 	std::string GetParamsJson(); //get all parameters in JSON-formatted string
-	std::string GetSignalsJson(); //get all signals in JSON-formatted string
+	const std::string& GetSignalsJson(); //get all signals in JSON-formatted string
+	const std::vector<uint8_t>& GetSignalsBinary(bool _key_frame, bool _update); //get all signals as binary frame, see SignalFrame.h
+	uint32_t GetSignalsGeneration(); //changes whenever the signals returned by the two above change
 
 	void OnNewParams(std::string _params); //is involved when new data received from server, data is JSON-formatted string
 	void OnNewSignals(std::string _signals); //is involved when new data received from server, data is JSON-formatted string
@@ -65,5 +100,7 @@ extern "C" const char * ws_get_params(void);
 extern "C" const char * ws_get_signals(void);
 extern "C" int ws_set_params(const char *_params);
 extern "C" int ws_set_signals(const char *_signals);
+extern "C" const void * ws_get_signals_binary(int _key_frame, int _update, size_t* _size);
+extern "C" unsigned int ws_get_signals_generation(void);
 extern "C" int ws_set_demo_mode(int a);
 extern "C" void ws_gzip(const char* _in, void* _out, size_t* size_);
@@ -0,0 +1,122 @@
+#include <cstring>
+#include "SignalFrame.h"
+
+#define SF_COUNT_OFFSET		6
+
+CSignalFrame::CSignalFrame()
+	: m_frame()
+	, m_delta()
+	, m_zrle()
+	, m_prev()
+	, m_sequence(0)
+	, m_count(0)
+	, m_key(true)
+{
+}
+
+inline void CSignalFrame::Put8(uint8_t _value)
+{
+	m_frame.push_back(_value);
+}
+
+inline void CSignalFrame::Put32(uint32_t _value)
+{
+	m_frame.push_back(_value);
+	m_frame.push_back(_value >> 8);
+	m_frame.push_back(_value >> 16);
+	m_frame.push_back(_value >> 24);
+}
+
+void CSignalFrame::Begin(bool _key)
+{
+	m_key = _key;
+	m_count = 0;
+
+	// capacity is kept between frames, so steady state does not allocate
+	m_frame.clear();
+	Put32(SF_MAGIC);
+	Put8(SF_VERSION);
+	Put8(_key ? SF_FLAG_KEY : 0);
+	Put8(0);
+	Put8(0);
+	Put32(m_sequence);
+}
+
+void CSignalFrame::Compress(const std::vector<uint8_t>& _in, std::vector<uint8_t>& _out)
+{
+	_out.clear();
+
+	size_t i = 0;
+	const size_t len = _in.size();
+	while(i < len)
+	{
+		size_t run = 0;
+		while(i + run < len && run < 128 && _in[i + run] == 0)
+			run++;
+
+		// short zero runs are cheaper as part of a literal
+		if(run >= 2 || (run == 1 && i + 1 == len))
+		{
+			_out.push_back(0x80 | (run - 1));
+			i += run;
+			continue;
+		}
+
+		size_t start = i;
+		size_t lit = 0;
+		while(i < len && lit < 128 && !(i + 1 < len && _in[i] == 0 && _in[i + 1] == 0))
+		{
+			i++;
+			lit++;
+		}
+		_out.push_back(lit - 1);
+		_out.insert(_out.end(), _in.begin() + start, _in.begin() + start + lit);
+	}
+}
+
+void CSignalFrame::AddSignal(const char* _name, uint8_t _type, uint32_t _size, const std::vector<uint8_t>& _raw)
+{
+	TPrevious& prev = m_prev[_name];
+	bool delta = !m_key && prev.type == _type && prev.size == _size && prev.raw.size() == _raw.size();
+
+	const std::vector<uint8_t>* payload = &_raw;
+	uint8_t encoding = SF_ENC_RAW;
+	if(delta)
+	{
+		m_delta.resize(_raw.size());
+		for(size_t i = 0; i < _raw.size(); i++)
+			m_delta[i] = _raw[i] ^ prev.raw[i];
+		payload = &m_delta;
+		encoding = SF_ENC_DELTA;
+	}
+
+	Compress(*payload, m_zrle);
+	if(m_zrle.size() < payload->size())
+	{
+		payload = &m_zrle;
+		encoding |= SF_ENC_ZRLE;
+	}
+
+	size_t name_len = strnlen(_name, 255);
+	Put8(name_len);
+	Put8(_type);
+	Put8(encoding);
+	Put8(0);
+	Put32(_size);
+	Put32(payload->size());
+	m_frame.insert(m_frame.end(), _name, _name + name_len);
+	m_frame.insert(m_frame.end(), payload->begin(), payload->end());
+
+	prev.type = _type;
+	prev.size = _size;
+	prev.raw = _raw;
+	m_count++;
+}
+
+const std::vector<uint8_t>& CSignalFrame::End()
+{
+	m_frame[SF_COUNT_OFFSET] = m_count;
+	m_frame[SF_COUNT_OFFSET + 1] = m_count >> 8;
+	m_sequence++;
+	return m_frame;
+}
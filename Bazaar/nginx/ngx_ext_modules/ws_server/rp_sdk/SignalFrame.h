@@ -0,0 +1,78 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <map>
+
+/*
+ * Binary signal frame, sent instead of gzipped JSON to websocket clients that
+ * asked for it with {"signal_format":"binary"}. A client tells the two apart by
+ * the first bytes: 'RPSF' here, 0x1f 0x8b for gzip. All fields are little-endian.
+ *
+ * frame header
+ *	uint32	magic		SF_MAGIC
+ *	uint8	version		SF_VERSION
+ *	uint8	flags		SF_FLAG_*
+ *	uint16	count		number of signal blocks
+ *	uint32	sequence	frame counter
+ *
+ * signal block
+ *	uint8	name_len
+ *	uint8	type		SF_TYPE_*
+ *	uint8	encoding	SF_ENC_RAW or SF_ENC_DELTA, optionally | SF_ENC_ZRLE
+ *	uint8	reserved
+ *	uint32	size		number of samples
+ *	uint32	payload_len
+ *	char	name[name_len]
+ *	uint8	payload[payload_len]
+ *
+ * SF_ENC_DELTA payloads are the sample bytes XORed with the bytes of the same
+ * signal in the previous frame, which is lossless for floats too. Unchanged
+ * samples become zeros, which SF_ENC_ZRLE then squeezes: a token byte t with
+ * the high bit set stands for (t & 0x7f) + 1 zero bytes, otherwise t + 1
+ * literal bytes follow.
+ */
+
+#define SF_MAGIC	0x46535052	// "RPSF"
+#define SF_VERSION	1
+
+#define SF_FLAG_KEY	0x01		// no block is delta encoded
+
+#define SF_TYPE_FLOAT32	0
+#define SF_TYPE_INT16	1
+#define SF_TYPE_INT32	2
+
+#define SF_ENC_RAW	0x00
+#define SF_ENC_DELTA	0x01
+#define SF_ENC_ZRLE	0x80
+
+class CSignalFrame
+{
+public:
+	CSignalFrame();
+
+	void Begin(bool _key);
+	void AddSignal(const char* _name, uint8_t _type, uint32_t _size, const std::vector<uint8_t>& _raw);
+	const std::vector<uint8_t>& End();
+	const std::vector<uint8_t>& Get() const { return m_frame; }	// last finished frame
+
+private:
+	void Put8(uint8_t _value);
+	void Put32(uint32_t _value);
+	static void Compress(const std::vector<uint8_t>& _in, std::vector<uint8_t>& _out);
+
+	struct TPrevious {
+		uint8_t type;
+		uint32_t size;
+		std::vector<uint8_t> raw;
+	};
+
+	std::vector<uint8_t> m_frame;
+	std::vector<uint8_t> m_delta;
+	std::vector<uint8_t> m_zrle;
+	std::map<std::string, TPrevious> m_prev;	// last sent samples per signal
+	uint32_t m_sequence;
+	uint16_t m_count;
+	bool m_key;
+};
@@ -5,6 +5,7 @@
 #include "libjson/libjson.h"
 #include "libjson/_internal/Source/JSONGlobals.h"
 #include "libjson/JSONOptions.h"
+#include "rp_sdk/SignalFrame.h"
 
 #include <fstream>
 #include <iostream>
@@ -13,17 +14,26 @@
 #include <future>
 
 #include <math.h>
+#include <algorithm>
 
 using websocketpp::lib::thread;
 
+#define STATS_INTERVAL 10 // s
+
 rp_websocket_server::rp_websocket_server()
     : m_params(NULL)
+    , m_json_frame()
+    , m_binary_frame()
+    , m_tick(0)
     , m_OnClosed(false)
 {
 }
 
 rp_websocket_server::rp_websocket_server(struct server_parameters* params)
     : m_params(params)
+    , m_json_frame()
+    , m_binary_frame()
+    , m_tick(0)
 {
     // set up access channels to only log interesting things
     m_endpoint.clear_access_channels(websocketpp::log::alevel::all);
@@ -44,6 +54,8 @@ rp_websocket_server::rp_websocket_server(struct server_parameters* params)
     m_endpoint.get_alog().set_ostream(&m_out);
     m_endpoint.get_alog().write(websocketpp::log::alevel::app, "ws_server constructor");
 
+    m_stats_time = clock::now();
+
     std::stringstream ss;
     ss << "default params: signal_interval = "<< params->signal_interval <<", param_interval =" << params->param_interval;
     m_endpoint.get_alog().write(websocketpp::log::alevel::app,ss.str());
@@ -117,10 +129,175 @@ void rp_websocket_server::on_signal_timer(websocketpp::lib::error_code const & e
 		return;
 	}
 
-	con_list::iterator it;
-	const char* signals = m_params->get_signals_func();
+	clock::time_point now = clock::now();
+	bool json_needed = false;
+	bool binary_needed = false;
+	bool key_frame = false;
+	for (con_list::iterator it = m_connections.begin(); it != m_connections.end(); ++it) {
+		connection_data& data = it->second;
+		data.ready = schedule_signals(it->first, data, now);
+		if (!data.ready)
+			continue;
+
+		if (data.binary_signals) {
+			binary_needed = true;
+			key_frame |= !data.synced
+				|| (data.generation != m_binary_frame.generation && data.generation != m_binary_frame.base);
+		} else {
+			json_needed = true;
+		}
+	}
+
+	// the application only encodes again if a signal changed
+	const char* signals = NULL;
+	const void* frame = NULL;
+	size_t frame_size = 0;
+	if (json_needed)
+		signals = m_params->get_signals_func();
+	if (binary_needed)
+		frame = m_params->get_signals_binary_func(key_frame, signals == NULL, &frame_size);
+
+	// no client takes a frame, keep the application's signal processing running
+	if (!json_needed && !binary_needed) {
+		if (m_params->get_signals_binary_func)
+			frame = m_params->get_signals_binary_func(false, true, &frame_size);
+		else
+			m_params->get_signals_func();
+	}
+
+	uint32_t generation = signals_generation();
+	if (signals) {
+		update_json_frame(signals, generation);
+		send_signals_json(now);
+	}
+	if (frame) {
+		update_binary_frame(frame, frame_size, generation);
+		send_signals_binary(now);
+	}
+
+	for (con_list::iterator it = m_connections.begin(); it != m_connections.end(); ++it)
+		if (!it->second.ready)
+			signals_held(it->second, generation);
+
+	if (now - m_stats_time >= std::chrono::seconds(STATS_INTERVAL))
+		log_stats(now);
+
+	// set timer for next check
+	set_signal_timer();
+}
+
+/*
+ * A client gets a new signal frame only once less than one frame is still
+ * queued on its connection, so a slow client is served the latest frame
+ * instead of a growing backlog, and a fast one gets every frame without
+ * waiting for an estimated drain time.
+ */
+bool rp_websocket_server::schedule_signals(connection_hdl hdl, connection_data& data, clock::time_point now) {
+
+	websocketpp::lib::error_code ec;
+	server::connection_ptr con = m_endpoint.get_con_from_hdl(hdl, ec);
+	if (ec)
+		return false;
+
+	size_t buffered = con->get_buffered_amount();
+	data.max_buffered = std::max(data.max_buffered, buffered);
+
+	return buffered <= data.budget;
+}
+
+void rp_websocket_server::signals_sent(connection_data& data, size_t size, clock::time_point now) {
+
+	// the next frame goes out once this one has mostly left the socket buffer
+	data.budget = size > 0 ? size - 1 : 0;
+	data.pending = false;
+
+	data.frames++;
+	data.bytes += size;
+	data.window_bytes += size;
+}
+
+// counts a frame as dropped only when a newer one replaces it before it was sent
+void rp_websocket_server::signals_held(connection_data& data, uint32_t generation) {
+
+	if (data.synced && data.generation == generation)
+		return;
+	if (data.pending && data.pending_generation != generation)
+		data.dropped++;
+	data.pending = true;
+	data.pending_generation = generation;
+}
+
+void rp_websocket_server::log_stats(clock::time_point now) {
+
+	double elapsed = std::chrono::duration<double>(now - m_stats_time).count();
+	m_stats_time = now;
+
+	for (con_list::iterator it = m_connections.begin(); it != m_connections.end(); ++it) {
+		websocketpp::lib::error_code ec;
+		server::connection_ptr con = m_endpoint.get_con_from_hdl(it->first, ec);
+		if (ec)
+			continue;
+
+		connection_data& data = it->second;
+		size_t buffered = con->get_buffered_amount();
+		// bytes which really left the socket buffer within the window
+		double drained = (double)data.window_bytes + data.window_buffered - buffered;
+		std::stringstream ss;
+		ss << "client " << con->get_remote_endpoint()
+		   << ": frames " << data.frames
+		   << ", dropped " << data.dropped
+		   << ", queued " << buffered << " B (max " << data.max_buffered << " B)"
+		   << ", " << (elapsed > 0 ? data.window_bytes / elapsed / 1024 : 0) << " KB/s"
+		   << ", drain " << (elapsed > 0 ? drained / elapsed / 1024 : 0) << " KB/s";
+		m_endpoint.get_alog().write(websocketpp::log::alevel::app, ss.str());
+
+		data.window_bytes = 0;
+		data.window_buffered = buffered;
+		data.max_buffered = 0;
+	}
+}
+
+uint32_t rp_websocket_server::signals_generation() {
+
+	// without a generation every tick counts as a change, as before
+	if (m_params->get_signals_generation_func)
+		return m_params->get_signals_generation_func();
+	return ++m_tick;
+}
+
+/*
+ * Frames go out to every client unchanged, so the websocket header is built
+ * here once and the message marked as prepared. websocketpp then queues the
+ * same reference counted buffer on each connection instead of copying and
+ * framing the payload per client.
+ */
+rp_websocket_server::server::message_ptr rp_websocket_server::prepare_message(const void* payload, size_t size) {
+
+	if (!size)
+		return server::message_ptr();
+
+	for (con_list::iterator it = m_connections.begin(); it != m_connections.end(); ++it) {
+		websocketpp::lib::error_code ec;
+		server::connection_ptr con = m_endpoint.get_con_from_hdl(it->first, ec);
+		if (ec)
+			continue;
+
+		server::message_ptr msg = con->get_message(websocketpp::frame::opcode::binary, size);
+		websocketpp::frame::basic_header header(websocketpp::frame::opcode::binary, size, true, false);
+		websocketpp::frame::extended_header extended(size);
+		msg->set_header(websocketpp::frame::prepare_header(header, extended));
+		msg->set_payload(payload, size);
+		msg->set_prepared(true);
+		return msg;
+	}
+	return server::message_ptr();
+}
+
+void rp_websocket_server::update_json_frame(const char* signals, uint32_t generation) {
+
+	if (m_json_frame.valid && m_json_frame.generation == generation)
+		return;
 
-//	m_endpoint.get_alog().write(websocketpp::log::alevel::app, "on_signal_timer");
 	static int once = 1;
 	if(once)
 	{
@@ -128,18 +305,86 @@ void rp_websocket_server::on_signal_timer(websocketpp::lib::error_code const & e
 		m_endpoint.get_alog().write(websocketpp::log::alevel::app, signals);
 	}
 
-	std::string js(signals);
 	static char buf[1000000];
 	size_t size;
-	m_params->gzip_func(js.c_str(), buf, &size);
+	m_params->gzip_func(signals, buf, &size);
 
-	if (size) {
-		for (it = m_connections.begin(); it != m_connections.end(); ++it) {
-			m_endpoint.send(*it, buf, size, websocketpp::frame::opcode::binary);
+	m_json_frame.valid = true;
+	m_json_frame.generation = generation;
+	m_json_frame.msg = prepare_message(buf, size);
+}
+
+void rp_websocket_server::update_binary_frame(const void* frame, size_t size, uint32_t generation) {
+
+	if (size < 12)
+		return;
+
+	// the application hands out its cached frame again if no signal changed
+	const uint8_t* header = static_cast<const uint8_t*>(frame);
+	uint32_t sequence = header[8] | header[9] << 8 | header[10] << 16 | header[11] << 24;
+	if (m_binary_frame.valid && m_binary_frame.sequence == sequence)
+		return;
+
+	m_binary_frame.base = m_binary_frame.generation;
+	m_binary_frame.generation = generation;
+	m_binary_frame.sequence = sequence;
+	m_binary_frame.key = header[5] & SF_FLAG_KEY;
+	m_binary_frame.valid = true;
+	m_binary_frame.msg = prepare_message(frame, size);
+}
+
+void rp_websocket_server::send_signals_json(clock::time_point now) {
+
+	if (!m_json_frame.msg)
+		return;
+
+	size_t size = m_json_frame.msg->get_payload().size();
+	for (con_list::iterator it = m_connections.begin(); it != m_connections.end(); ++it) {
+		connection_data& data = it->second;
+		if (data.binary_signals || !data.ready)
+			continue;
+		if (data.synced && data.generation == m_json_frame.generation)
+			continue;
+
+		websocketpp::lib::error_code ec;
+		m_endpoint.send(it->first, m_json_frame.msg, ec);
+		if (ec)
+			continue;
+		signals_sent(data, size, now);
+		data.synced = true;
+		data.generation = m_json_frame.generation;
+	}
+}
+
+void rp_websocket_server::send_signals_binary(clock::time_point now) {
+
+	if (!m_binary_frame.msg)
+		return;
+
+	size_t size = m_binary_frame.msg->get_payload().size();
+	for (con_list::iterator it = m_connections.begin(); it != m_connections.end(); ++it) {
+		connection_data& data = it->second;
+		if (!data.binary_signals || !data.ready)
+			continue;
+		if (data.synced && data.generation == m_binary_frame.generation)
+			continue;
+
+		// a delta frame only applies on top of the frame before it
+		if (!m_binary_frame.key && !(data.synced && data.generation == m_binary_frame.base)) {
+			data.synced = false;
+			continue;
+		}
+
+		websocketpp::lib::error_code ec;
+		m_endpoint.send(it->first, m_binary_frame.msg, ec);
+		if (ec) {
+			data.synced = false;
+			continue;
 		}
+		signals_sent(data, size, now);
+		data.synced = true;
+		data.generation = m_binary_frame.generation;
 	}
-	// set timer for next check
-	set_signal_timer();
 }
 
 void rp_websocket_server::on_param_timer(websocketpp::lib::error_code const & ec) {
@@ -160,14 +405,19 @@ void rp_websocket_server::on_param_timer(websocketpp::lib::error_code const & ec
 		m_endpoint.get_alog().write(websocketpp::log::alevel::app, params);
 	}
 
-	std::string js(params);
-	static char buf[1000000];
-	size_t size;
-	m_params->gzip_func(js.c_str(), buf, &size);
+	// unchanged parameters are not compressed again
+	if (!m_params_msg || m_params_json != params) {
+		static char buf[1000000];
+		size_t size;
+		m_params->gzip_func(params, buf, &size);
+		m_params_json = params;
+		m_params_msg = prepare_message(buf, size);
+	}
 
-	if (size) {
+	if (m_params_msg) {
 		for (it = m_connections.begin(); it != m_connections.end(); ++it) {
-			m_endpoint.send(*it, buf, size, websocketpp::frame::opcode::binary);
+			websocketpp::lib::error_code send_ec;
+			m_endpoint.send(it->first, m_params_msg, send_ec);
 		}
 	}
 	// set timer for next check
@@ -225,7 +475,10 @@ void rp_websocket_server::on_http(connection_hdl hdl) {
 void rp_websocket_server::on_open(connection_hdl hdl)
 {
 	m_endpoint.get_alog().write(websocketpp::log::alevel::app, "ws server on connection");
-	m_connections.insert(hdl);
+	connection_data data = connection_data();
+	data.binary_signals = false;
+	data.synced = false;
+	m_connections[hdl] = data;
 }
 
 void rp_websocket_server::on_close(connection_hdl hdl) {
@@ -260,6 +513,15 @@ void rp_websocket_server::on_message(connection_hdl hdl, server::message_ptr msg
 		set_signal_timer();
 		m_params->set_signals_func(data_str);
 	}
+	else if(name == "signal_format")
+	{
+		// binary frames only if the application provides them, otherwise stay on JSON
+		con_list::iterator it = m_connections.find(hdl);
+		if (it != m_connections.end()) {
+			it->second.binary_signals = m_params->get_signals_binary_func && child.as_string() == "binary";
+			it->second.synced = false;
+		}
+	}
 
 }
 
@@ -295,7 +557,7 @@ void rp_websocket_server::stop()
 	con_list::iterator it;
 
 	for (it = m_connections.begin(); it != m_connections.end(); ++it) {
-		connection_hdl hdl = *it;
+		connection_hdl hdl = it->first;
 
 		try{
               		m_endpoint.close(hdl, websocketpp::close::status::normal, "shutdown");
@@ -3,7 +3,9 @@
 #include <websocketpp/server.hpp>
 #include <websocketpp/common/thread.hpp>
 //#include <websocketpp/extensions/permessage_deflate/enabled.hpp>
-#include <set>
+#include <map>
+#include <chrono>
+#include <vector>
 #include <fstream>
 
 #include "libjson/_internal/Source/JSONNode.h"
@@ -42,7 +44,51 @@ public:
     void on_message(connection_hdl hdl, server::message_ptr msg);
 
 private:
-    typedef std::set<connection_hdl,std::owner_less<connection_hdl>> con_list;
+    typedef std::chrono::steady_clock clock;
+
+    // per connection state
+    struct connection_data {
+        bool binary_signals;    // client asked for binary signal frames
+        bool synced;            // client holds the signals of 'generation'
+        uint32_t generation;
+
+        // signal send scheduling: at most one frame queued, stale ones are dropped
+        bool ready;             // may take a signal frame on this tick
+        size_t budget;          // bytes that may still be queued when the next frame goes out
+        bool pending;           // a frame newer than 'generation' was held back
+        uint32_t pending_generation;
+
+        // statistics, logged every STATS_INTERVAL
+        uint64_t frames;
+        uint64_t dropped;
+        uint64_t bytes;
+        uint64_t window_bytes;
+        size_t window_buffered; // bytes queued when the window started
+        size_t max_buffered;
+    };
+    typedef std::map<connection_hdl,connection_data,std::owner_less<connection_hdl>> con_list;
+
+    // latest encoded signals of one format, shared by all connections
+    struct frame_cache {
+        bool valid;
+        uint32_t generation;    // signal generation the frame was encoded from
+        uint32_t base;          // generation a binary delta frame applies to
+        uint32_t sequence;      // binary frame sequence number
+        bool key;
+        server::message_ptr msg;
+    };
+
+    bool schedule_signals(connection_hdl hdl, connection_data& data, clock::time_point now);
+    void signals_sent(connection_data& data, size_t size, clock::time_point now);
+    void signals_held(connection_data& data, uint32_t generation);
+    void log_stats(clock::time_point now);
+
+    uint32_t signals_generation();
+    server::message_ptr prepare_message(const void* payload, size_t size);
+    void update_json_frame(const char* signals, uint32_t generation);
+    void update_binary_frame(const void* frame, size_t size, uint32_t generation);
+    void send_signals_json(clock::time_point now);
+    void send_signals_binary(clock::time_point now);
 
     struct server_parameters* m_params;
     server m_endpoint;
@@ -50,6 +96,12 @@ private:
     server::timer_ptr m_signal_timer;
     server::timer_ptr m_param_timer;
     websocketpp::lib::thread m_thread;
+    clock::time_point m_stats_time;
+    frame_cache m_json_frame;
+    frame_cache m_binary_frame;
+    uint32_t m_tick;                // signal generation if the application has none
+    std::string m_params_json;
+    server::message_ptr m_params_msg;
     std::string m_docroot;
 	std::ofstream m_out;
 	volatile bool m_OnClosed;
@@ -28,6 +28,8 @@ void start_ws_server(const struct server_parameters * _params)
 		loaded_params->get_signals_func = _params->get_signals_func;
 		loaded_params->set_signals_func = _params->set_signals_func;
 		loaded_params->gzip_func = _params->gzip_func;
+		loaded_params->get_signals_binary_func = _params->get_signals_binary_func;
+		loaded_params->get_signals_generation_func = _params->get_signals_generation_func;
 	}
 	if(_params != 0 && _params->port != 0)
 		loaded_params->port = _params->port;
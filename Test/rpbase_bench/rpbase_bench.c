@@ -0,0 +1,201 @@
+/**
+ * $Id: $
+ *
+ * @brief Red Pitaya library throughput benchmark
+ *
+ * Measures samples/s and ns/sample of the rp_AcqGetData* readout paths and
+ * of rp_GenArbWaveform. By default it runs on the simulated register backend,
+ * so it can be used on a build host; -d runs it against the FPGA on the board.
+ *
+ * (c) Red Pitaya  http://www.redpitaya.com
+ *
+ * This part of code is written in C programming language.
+ * Please visit http://en.wikipedia.org/wiki/C_(programming_language)
+ * for more details on the language used herein.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "redpitaya/rp.h"
+
+typedef int (*bench_fn_t)(uint32_t size);
+
+typedef struct bench_s {
+    const char *name;
+    bench_fn_t  fn;
+    uint32_t    channels;
+} bench_t;
+
+static int16_t  raw1[ADC_BUFFER_SIZE], raw2[ADC_BUFFER_SIZE];
+static float    volt1[ADC_BUFFER_SIZE], volt2[ADC_BUFFER_SIZE];
+static float    arb[ADC_BUFFER_SIZE];
+static uint32_t start_pos = 1234;
+
+
+static int bench_GetDataRaw(uint32_t size)
+{
+    return rp_AcqGetDataRaw(RP_CH_1, start_pos, &size, raw1);
+}
+
+static int bench_GetDataRawV2(uint32_t size)
+{
+    return rp_AcqGetDataRawV2(start_pos, &size, (uint16_t*)raw1, (uint16_t*)raw2);
+}
+
+static int bench_GetDataPosRaw(uint32_t size)
+{
+    uint32_t buf_size = ADC_BUFFER_SIZE;
+    return rp_AcqGetDataPosRaw(RP_CH_1, start_pos, start_pos + size - 1, raw1, &buf_size);
+}
+
+static int bench_GetOldestDataRaw(uint32_t size)
+{
+    return rp_AcqGetOldestDataRaw(RP_CH_1, &size, raw1);
+}
+
+static int bench_GetLatestDataRaw(uint32_t size)
+{
+    return rp_AcqGetLatestDataRaw(RP_CH_1, &size, raw1);
+}
+
+static int bench_GetDataV(uint32_t size)
+{
+    return rp_AcqGetDataV(RP_CH_1, start_pos, &size, volt1);
+}
+
+static int bench_GetDataV2(uint32_t size)
+{
+    return rp_AcqGetDataV2(start_pos, &size, volt1, volt2);
+}
+
+static int bench_GetDataPosV(uint32_t size)
+{
+    uint32_t buf_size = ADC_BUFFER_SIZE;
+    return rp_AcqGetDataPosV(RP_CH_1, start_pos, start_pos + size - 1, volt1, &buf_size);
+}
+
+static int bench_GetOldestDataV(uint32_t size)
+{
+    return rp_AcqGetOldestDataV(RP_CH_1, &size, volt1);
+}
+
+static int bench_GetLatestDataV(uint32_t size)
+{
+    return rp_AcqGetLatestDataV(RP_CH_1, &size, volt1);
+}
+
+static int bench_GenArbWaveform(uint32_t size)
+{
+    return rp_GenArbWaveform(RP_CH_1, arb, size);
+}
+
+static const bench_t benches[] = {
+    { "rp_AcqGetDataRaw",       bench_GetDataRaw,       1 },
+    { "rp_AcqGetDataRawV2",     bench_GetDataRawV2,     2 },
+    { "rp_AcqGetDataPosRaw",    bench_GetDataPosRaw,    1 },
+    { "rp_AcqGetOldestDataRaw", bench_GetOldestDataRaw, 1 },
+    { "rp_AcqGetLatestDataRaw", bench_GetLatestDataRaw, 1 },
+    { "rp_AcqGetDataV",         bench_GetDataV,         1 },
+    { "rp_AcqGetDataV2",        bench_GetDataV2,        2 },
+    { "rp_AcqGetDataPosV",      bench_GetDataPosV,      1 },
+    { "rp_AcqGetOldestDataV",   bench_GetOldestDataV,   1 },
+    { "rp_AcqGetLatestDataV",   bench_GetLatestDataV,   1 },
+    { "rp_GenArbWaveform",      bench_GenArbWaveform,   1 },
+};
+
+static double now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "Usage: %s [-d] [-n iterations] [-s size]\n"
+                    "  -d  run on the FPGA (/dev/mem) instead of the simulated backend\n"
+                    "  -n  iterations per path (default 200)\n"
+                    "  -s  samples per call, 1..%d (default %d)\n",
+                    prog, ADC_BUFFER_SIZE, ADC_BUFFER_SIZE);
+}
+
+int main(int argc, char **argv)
+{
+    bool on_board = false;
+    uint32_t iterations = 200;
+    uint32_t size = ADC_BUFFER_SIZE;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "dn:s:")) != -1) {
+        switch (opt) {
+        case 'd':
+            on_board = true;
+            break;
+        case 'n':
+            iterations = strtoul(optarg, NULL, 0);
+            break;
+        case 's':
+            size = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if ((iterations == 0) || (size == 0) || (size > ADC_BUFFER_SIZE)) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (!on_board && (rp_SetBackend(RP_BACKEND_SIM) != RP_OK)) {
+        fprintf(stderr, "Unable to select simulated backend\n");
+        return 1;
+    }
+    int ret = rp_Init();
+    if (ret != RP_OK) {
+        fprintf(stderr, "rp_Init failed: %s\n", rp_GetError(ret));
+        return 1;
+    }
+
+    /* Fill the ring once with a known stimulus, then freeze it */
+    if (!on_board) {
+        rp_SimRun(false);
+        rp_SimSetStimulus(RP_CH_1, RP_WAVEFORM_SINE, 10e3, 0.9f);
+        rp_SimSetStimulus(RP_CH_2, RP_WAVEFORM_TRIANGLE, 5e3, 0.5f);
+        rp_AcqSetDecimation(RP_DEC_8);
+        rp_AcqStart();
+        rp_SimAdvance(ADC_BUFFER_SIZE);
+        rp_AcqStop();
+    }
+
+    for (uint32_t i = 0; i < ADC_BUFFER_SIZE; ++i) {
+        arb[i] = (i & 0x100) ? 0.5f : -0.5f;
+    }
+
+    printf("%-24s %12s %12s\n", "path", "Msamples/s", "ns/sample");
+    for (size_t b = 0; b < sizeof(benches) / sizeof(benches[0]); ++b) {
+        const bench_t *bench = &benches[b];
+
+        /* warm up caches and lazy initialization */
+        if ((ret = bench->fn(size)) != RP_OK) {
+            printf("%-24s failed: %s\n", bench->name, rp_GetError(ret));
+            continue;
+        }
+
+        double t0 = now_ns();
+        for (uint32_t n = 0; n < iterations; ++n) {
+            bench->fn(size);
+        }
+        double dt = now_ns() - t0;
+
+        double samples = (double)iterations * size * bench->channels;
+        printf("%-24s %12.3f %12.3f\n", bench->name, samples / dt * 1e3, dt / samples);
+    }
+
+    rp_Release();
+    return 0;
+}
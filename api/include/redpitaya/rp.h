@@ -227,6 +227,15 @@ typedef enum {
 } rp_acq_trig_state_t;
 
 
+/**
+ * Type representing the backend the FPGA register and buffer windows are mapped from.
+ */
+typedef enum {
+    RP_BACKEND_DEVMEM, //!< Physical FPGA windows mapped through /dev/mem (default)
+    RP_BACKEND_SIM     //!< Windows backed by shared-memory files and driven by the ADC stimulus model
+} rp_backend_t;
+
+
 /**
  * Calibration parameters, stored in the EEPROM device
  */
@@ -298,6 +307,23 @@ const char* rp_GetVersion();
  */
 const char* rp_GetError(int errorCode);
 
+/**
+ * Selects the backend register and buffer windows are mapped from. It must be called before rp_Init().
+ * Setting the environment variable RP_SIM_DIR to a directory (e.g. /dev/shm) selects RP_BACKEND_SIM as well.
+ * @param backend RP_BACKEND_DEVMEM for the board, RP_BACKEND_SIM for a hardware-free simulation.
+ * @return If the function is successful, the return value is RP_OK.
+ * If the function is unsuccessful, the return value is any of RP_E* values that indicate an error.
+ */
+int rp_SetBackend(rp_backend_t backend);
+
+/**
+ * Returns the backend currently in use.
+ * @param backend Pointer where value will be returned.
+ * @return If the function is successful, the return value is RP_OK.
+ * If the function is unsuccessful, the return value is any of RP_E* values that indicate an error.
+ */
+int rp_GetBackend(rp_backend_t* backend);
+
 
 ///@}
 /** @name Digital loop
@@ -1280,6 +1306,44 @@ int rp_GenGetTriggerSource(rp_channel_t channel, rp_trig_src_t *src);
 */
 int rp_GenTrigger(uint32_t channel);
 
+/** @name Simulation
+ * Only available with RP_BACKEND_SIM. The ADC stimulus model plays the role of the FPGA
+ * acquisition core: while armed it writes synthetic samples into the 16k ring buffers,
+ * advances the write pointer and evaluates the trigger.
+ */
+///@{
+
+/**
+* Sets the synthetic waveform fed into an acquisition channel.
+* @param channel Channel A or B.
+* @param type Waveform type (SINE, SQUARE, TRIANGLE, RAMP_UP, RAMP_DOWN, DC).
+* @param frequency Signal frequency in Hz, relative to the currently set decimated sample rate.
+* @param amplitude Amplitude as a fraction of ADC full scale [0..1].
+* @return If the function is successful, the return value is RP_OK.
+* If the function is unsuccessful, the return value is any of RP_E* values that indicate an error.
+*/
+int rp_SimSetStimulus(rp_channel_t channel, rp_waveform_t type, float frequency, float amplitude);
+
+/**
+* Advances the simulated acquisition by a number of (decimated) samples.
+* Deterministic alternative to the free running stimulus thread, useful for benchmarks.
+* @param samples Number of samples to produce.
+* @return If the function is successful, the return value is RP_OK.
+* If the function is unsuccessful, the return value is any of RP_E* values that indicate an error.
+*/
+int rp_SimAdvance(uint32_t samples);
+
+/**
+* Starts or stops the free running stimulus thread, which advances the acquisition in real time.
+* It is started by rp_Init() when RP_BACKEND_SIM is selected.
+* @param enable True to start, false to stop the thread.
+* @return If the function is successful, the return value is RP_OK.
+* If the function is unsuccessful, the return value is any of RP_E* values that indicate an error.
+*/
+int rp_SimRun(bool enable);
+
+///@}
+
 float rp_CmnCnvCntToV(uint32_t field_len, uint32_t cnts, float adc_max_v, uint32_t calibScale, int calib_dc_off, float user_dc_off);
 
 #ifdef __cplusplus
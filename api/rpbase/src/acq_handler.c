@@ -697,13 +697,20 @@ uint32_t acq_GetNormalizedDataPos(uint32_t pos)
     return (pos % ADC_BUFFER_SIZE);
 }
 
+/**
+ * Returns the length of the first linear segment of a ring buffer read.
+ * The remainder, if any, starts at the beginning of the buffer.
+ */
+static uint32_t getFirstSegmentSize(uint32_t pos, uint32_t size)
+{
+    return MIN(size, ADC_BUFFER_SIZE - pos);
+}
+
 int acq_GetDataRaw(rp_channel_t channel, uint32_t pos, uint32_t* size, int16_t* buffer)
 {
 
     *size = MIN(*size, ADC_BUFFER_SIZE);
 
-    uint32_t cnts;
-
     const volatile uint32_t* raw_buffer = getRawBuffer(channel);
 
     rp_pinState_t gain;
@@ -712,11 +719,11 @@ int acq_GetDataRaw(rp_channel_t channel, uint32_t pos, uint32_t* size, int16_t*
     rp_calib_params_t calib = calib_GetParams();
     int32_t dc_offs = GET_OFFSET(channel, gain, calib);
 
-    for (uint32_t i = 0; i < (*size); ++i) {
-        cnts = (raw_buffer[(pos + i) % ADC_BUFFER_SIZE]) & ADC_BITS_MAK;
+    pos = acq_GetNormalizedDataPos(pos);
+    uint32_t first = getFirstSegmentSize(pos, *size);
 
-        buffer[i] = cmn_CalibCnts(ADC_BITS, cnts, dc_offs);
-    }
+    cmn_CalibCntsBulk(ADC_BITS, raw_buffer + pos, first, dc_offs, buffer);
+    cmn_CalibCntsBulk(ADC_BITS, raw_buffer, *size - first, dc_offs, buffer + first);
 
     return RP_OK;
 }
@@ -729,10 +736,13 @@ int acq_GetDataRawV2(uint32_t pos, uint32_t* size, uint16_t* buffer, uint16_t* b
     const volatile uint32_t* raw_buffer = getRawBuffer(RP_CH_1);
     const volatile uint32_t* raw_buffer2 = getRawBuffer(RP_CH_2);
 
-    for (uint32_t i = 0; i < (*size); ++i) {
-        buffer[i] = (raw_buffer[(pos + i) % ADC_BUFFER_SIZE]) & ADC_BITS_MAK;
-        buffer2[i] = (raw_buffer2[(pos + i) % ADC_BUFFER_SIZE]) & ADC_BITS_MAK;
-    }
+    pos = acq_GetNormalizedDataPos(pos);
+    uint32_t first = getFirstSegmentSize(pos, *size);
+
+    cmn_CopyCntsBulk(raw_buffer + pos, first, ADC_BITS_MAK, buffer);
+    cmn_CopyCntsBulk(raw_buffer, *size - first, ADC_BITS_MAK, buffer + first);
+    cmn_CopyCntsBulk(raw_buffer2 + pos, first, ADC_BITS_MAK, buffer2);
+    cmn_CopyCntsBulk(raw_buffer2, *size - first, ADC_BITS_MAK, buffer2 + first);
 
     return RP_OK;
 }
@@ -792,13 +802,16 @@ int acq_GetDataV(rp_channel_t channel,  uint32_t pos, uint32_t* size, float* buf
     int32_t dc_offs = GET_OFFSET(channel, gain, calib);
     uint32_t calibScale = calib_GetFrontEndScale(channel, gain);
 
+    float scale, offset;
+    cmn_CnvCntToVParams(ADC_BITS, gainV, calibScale, 0.0, &scale, &offset);
+
     const volatile uint32_t* raw_buffer = getRawBuffer(channel);
 
-    uint32_t cnts;
-    for (uint32_t i = 0; i < (*size); ++i) {
-        cnts = raw_buffer[(pos + i) % ADC_BUFFER_SIZE];
-        buffer[i] = cmn_CnvCntToV(ADC_BITS, cnts, gainV, calibScale, dc_offs, 0.0);
-    }
+    pos = acq_GetNormalizedDataPos(pos);
+    uint32_t first = getFirstSegmentSize(pos, *size);
+
+    cmn_CnvCntToVBulk(ADC_BITS, raw_buffer + pos, first, dc_offs, scale, offset, buffer);
+    cmn_CnvCntToVBulk(ADC_BITS, raw_buffer, *size - first, dc_offs, scale, offset, buffer + first);
 
     return RP_OK;
 }
@@ -821,27 +834,20 @@ int acq_GetDataV2(uint32_t pos, uint32_t* size, float* buffer1, float* buffer2)
     int32_t dc_offs2 = gain2 == RP_HIGH ? calib.fe_ch2_hi_offs : calib.fe_ch2_lo_offs;
     uint32_t calibScale2 = calib_GetFrontEndScale(RP_CH_2, gain2);
 
+    float scale1, offset1, scale2, offset2;
+    cmn_CnvCntToVParams(ADC_BITS, gainV1, calibScale1, 0.0, &scale1, &offset1);
+    cmn_CnvCntToVParams(ADC_BITS, gainV2, calibScale2, 0.0, &scale2, &offset2);
+
     const volatile uint32_t* raw_buffer1 = getRawBuffer(RP_CH_1);
     const volatile uint32_t* raw_buffer2 = getRawBuffer(RP_CH_2);
 
-    uint32_t cnts1[*size];
-    uint32_t cnts2[*size];
-    uint32_t* ptr1 = cnts1;
-    uint32_t* ptr2 = cnts2;
+    pos = acq_GetNormalizedDataPos(pos);
+    uint32_t first = getFirstSegmentSize(pos, *size);
 
-    for (uint32_t i = 0; i < (*size); ++i) {
-        *ptr1++ = raw_buffer1[pos];
-        *ptr2++ = raw_buffer2[pos];
-        pos = (pos + 1) % ADC_BUFFER_SIZE;
-    }
-
-    ptr1 = cnts1;
-    ptr2 = cnts2;
-
-    for (uint32_t i = 0; i < (*size); ++i) {
-        *buffer1++ = cmn_CnvCntToV(ADC_BITS, *ptr1++, gainV1, calibScale1, dc_offs1, 0.0);
-        *buffer2++ = cmn_CnvCntToV(ADC_BITS, *ptr2++, gainV2, calibScale2, dc_offs2, 0.0);
-    }
+    cmn_CnvCntToVBulk(ADC_BITS, raw_buffer1 + pos, first, dc_offs1, scale1, offset1, buffer1);
+    cmn_CnvCntToVBulk(ADC_BITS, raw_buffer1, *size - first, dc_offs1, scale1, offset1, buffer1 + first);
+    cmn_CnvCntToVBulk(ADC_BITS, raw_buffer2 + pos, first, dc_offs2, scale2, offset2, buffer2);
+    cmn_CnvCntToVBulk(ADC_BITS, raw_buffer2, *size - first, dc_offs2, scale2, offset2, buffer2 + first);
 
     return RP_OK;
 }
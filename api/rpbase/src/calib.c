@@ -31,6 +31,11 @@ static rp_calib_params_t calib, failsafa_params;
 
 int calib_Init()
 {
+    /* No EEPROM off the board - start from neutral parameters */
+    if (cmn_GetBackend() == RP_BACKEND_SIM) {
+        calib_SetToZero();
+        return RP_OK;
+    }
     ECHECK(calib_ReadParams(&calib));
     return RP_OK;
 }
@@ -14,44 +14,147 @@
 
 #include <fcntl.h>
 #include <unistd.h>
+#include <stdlib.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
 #include <stdio.h>
 #include <math.h>
 
+#if defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
 #include "common.h"
 
-static int fd = NULL;
+/* Default directory for simulated register/buffer windows */
+#define SIM_DEFAULT_DIR "/dev/shm"
+
+/* /dev/mem descriptor, or simulation directory descriptor for RP_BACKEND_SIM */
+static int fd = -1;
+
+static rp_backend_t backend = RP_BACKEND_DEVMEM;
+
+/* Simulated windows this process created, removed again by cmn_Release() */
+#define SIM_MAX_WINDOWS 8
+static size_t sim_created[SIM_MAX_WINDOWS];
+static int sim_created_num = 0;
+
+/**
+ * @brief Selects the register backend used by cmn_Init() and cmn_Map()
+ *
+ * Must be called before cmn_Init(). Setting the environment variable
+ * RP_SIM_DIR selects RP_BACKEND_SIM as well, so existing applications can be
+ * run off the board without modification.
+ */
+int cmn_SetBackend(rp_backend_t new_backend)
+{
+    if (fd != -1) {
+        return RP_EUF;
+    }
+    if ((new_backend != RP_BACKEND_DEVMEM) && (new_backend != RP_BACKEND_SIM)) {
+        return RP_EOOR;
+    }
+    backend = new_backend;
+    return RP_OK;
+}
+
+rp_backend_t cmn_GetBackend()
+{
+    return backend;
+}
 
 int cmn_Init()
 {
-    if (!fd) {
-        if((fd = open("/dev/mem", O_RDWR | O_SYNC)) == -1) {
+    if (fd == -1) {
+        const char *sim_dir = getenv("RP_SIM_DIR");
+        if (sim_dir && *sim_dir) {
+            backend = RP_BACKEND_SIM;
+        }
+
+        if (backend == RP_BACKEND_SIM) {
+            if ((fd = open(sim_dir && *sim_dir ? sim_dir : SIM_DEFAULT_DIR, O_RDONLY | O_DIRECTORY)) == -1) {
+                return RP_EOMD;
+            }
+        } else if((fd = open("/dev/mem", O_RDWR | O_SYNC)) == -1) {
             return RP_EOMD;
         }
     }
     return RP_OK;
 }
 
+static void cmn_SimName(char *name, size_t len, size_t offset)
+{
+    snprintf(name, len, "rp_sim_%08zx", offset);
+}
+
 int cmn_Release()
 {
-    if (fd) {
+    if (fd != -1) {
+        /* Processes still mapping the windows keep their pages, the names
+         * are gone so the files do not pile up in the directory */
+        while (sim_created_num > 0) {
+            char name[32];
+            cmn_SimName(name, sizeof(name), sim_created[--sim_created_num]);
+            unlinkat(fd, name, 0);
+        }
         if(close(fd) < 0) {
             return RP_ECMD;
         }
+        fd = -1;
     }
 
     return RP_OK;
 }
 
+/**
+ * @brief Opens the shared-memory file standing in for the physical window at offset
+ *
+ * Each window is a separate file named after its physical base address, grown to
+ * the requested size, so other processes (stimulus models, inspectors) can map the
+ * very same registers and buffers. Files created here are unlinked on
+ * cmn_Release(), windows of another process are only shared.
+ */
+static int cmn_SimOpen(size_t size, size_t offset)
+{
+    char name[32];
+    int sim_fd;
+
+    cmn_SimName(name, sizeof(name), offset);
+    if ((sim_fd = openat(fd, name, O_RDWR | O_CREAT | O_EXCL, 0666)) != -1) {
+        if (sim_created_num < SIM_MAX_WINDOWS) {
+            sim_created[sim_created_num++] = offset;
+        }
+    } else if ((sim_fd = openat(fd, name, O_RDWR)) == -1) {
+        return -1;
+    }
+
+    struct stat st;
+    if ((fstat(sim_fd, &st) < 0) || ((st.st_size < (off_t) size) && (ftruncate(sim_fd, size) < 0))) {
+        close(sim_fd);
+        return -1;
+    }
+    return sim_fd;
+}
+
 int cmn_Map(size_t size, size_t offset, void** mapped)
 {
     if(fd == -1) {
         return RP_EMMD;
     }
 
-    *mapped = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, offset);
+    if (backend == RP_BACKEND_SIM) {
+        int sim_fd = cmn_SimOpen(size, offset);
+        if (sim_fd == -1) {
+            return RP_EMMD;
+        }
+        *mapped = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, sim_fd, 0);
+        close(sim_fd);
+    } else {
+        *mapped = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, offset);
+    }
 
-    if(mapped == (void *) -1) {
+    if(*mapped == MAP_FAILED) {
+        *mapped = NULL;
         return RP_EMMD;
     }
 
@@ -273,6 +376,120 @@ float cmn_CnvCntToV(uint32_t field_len, uint32_t cnts, float adc_max_v, uint32_t
 float rp_cmn_CnvCntToV(uint32_t field_len, uint32_t cnts, float adc_max_v, uint32_t calibScale, int calib_dc_off, float user_dc_off) {
 	return cmn_CnvCntToV(field_len, cnts, adc_max_v, calibScale, calib_dc_off, user_dc_off);
 }
+
+/*----------------------------------------------------------------------------*/
+/**
+ * @brief Precomputes the linear part of cmn_CnvCntToV()
+ *
+ * cmn_CnvCntToV() is equivalent to (calibrated counts) * scale + offset, so
+ * for bulk conversion the calibration arithmetic is done once per block
+ * instead of once per sample.
+ *
+ * @param[in] field_len Number of field (ADC/DAC/Buffer) bits
+ * @param[in] adc_max_v Maximal ADC/DAC voltage, specified in [V]
+ * @param[in] calibScale Calibration scale factor, specified in [full scale]
+ * @param[in] user_dc_off User specified DC offset, specified in [V]
+ * @param[out] scale Volts per calibrated count
+ * @param[out] offset Volts added after scaling
+ */
+void cmn_CnvCntToVParams(uint32_t field_len, float adc_max_v, uint32_t calibScale, float user_dc_off, float* scale, float* offset)
+{
+    double calib = (double)cmn_CalibFullScaleToVoltage(calibScale) / ((double)FULL_SCALE_NORM/(double)adc_max_v);
+
+    *scale  = (float)((double)adc_max_v / (double)(1 << (field_len - 1)) * calib);
+    *offset = (float)((double)user_dc_off * calib);
+}
+
+/**
+ * @brief Bulk version of cmn_CalibCnts()
+ *
+ * Reads size words of a linear (non wrapping) FPGA buffer segment and writes
+ * calibrated counts. On NEON targets the FPGA window is read in 128 bit bursts.
+ */
+void cmn_CalibCntsBulk(uint32_t field_len, const volatile uint32_t* src, uint32_t size, int calib_dc_off, int16_t* dst)
+{
+    const int32_t sh  = 32 - field_len;
+    const int32_t lim = 1 << (field_len - 1);
+    const uint32_t* in = (const uint32_t*)src;
+    uint32_t i = 0;
+
+#if defined(__ARM_NEON__)
+    const int32x4_t vsh_l = vdupq_n_s32(sh);
+    const int32x4_t vsh_r = vdupq_n_s32(-sh);
+    const int32x4_t voff  = vdupq_n_s32(calib_dc_off);
+    const int32x4_t vmin  = vdupq_n_s32(-lim);
+    const int32x4_t vmax  = vdupq_n_s32(lim);
+
+    for (; i + 4 <= size; i += 4) {
+        int32x4_t m = vreinterpretq_s32_u32(vld1q_u32(in + i));
+        m = vshlq_s32(vshlq_s32(m, vsh_l), vsh_r);
+        m = vminq_s32(vmaxq_s32(vsubq_s32(m, voff), vmin), vmax);
+        vst1_s16(dst + i, vmovn_s32(m));
+    }
+#endif
+
+    for (; i < size; ++i) {
+        int32_t m = ((int32_t)(in[i] << sh) >> sh) - calib_dc_off;
+        dst[i] = (int16_t)MIN(MAX(m, -lim), lim);
+    }
+}
+
+/**
+ * @brief Bulk version of cmn_CnvCntToV()
+ *
+ * Converts a linear (non wrapping) FPGA buffer segment to volts, using scale
+ * and offset from cmn_CnvCntToVParams().
+ */
+void cmn_CnvCntToVBulk(uint32_t field_len, const volatile uint32_t* src, uint32_t size, int calib_dc_off, float scale, float offset, float* dst)
+{
+    const int32_t sh  = 32 - field_len;
+    const int32_t lim = 1 << (field_len - 1);
+    const uint32_t* in = (const uint32_t*)src;
+    uint32_t i = 0;
+
+#if defined(__ARM_NEON__)
+    const int32x4_t vsh_l  = vdupq_n_s32(sh);
+    const int32x4_t vsh_r  = vdupq_n_s32(-sh);
+    const int32x4_t voff   = vdupq_n_s32(calib_dc_off);
+    const int32x4_t vmin   = vdupq_n_s32(-lim);
+    const int32x4_t vmax   = vdupq_n_s32(lim);
+    const float32x4_t vscale = vdupq_n_f32(scale);
+    const float32x4_t voffset = vdupq_n_f32(offset);
+
+    for (; i + 4 <= size; i += 4) {
+        int32x4_t m = vreinterpretq_s32_u32(vld1q_u32(in + i));
+        m = vshlq_s32(vshlq_s32(m, vsh_l), vsh_r);
+        m = vminq_s32(vmaxq_s32(vsubq_s32(m, voff), vmin), vmax);
+        vst1q_f32(dst + i, vmlaq_f32(voffset, vcvtq_f32_s32(m), vscale));
+    }
+#endif
+
+    for (; i < size; ++i) {
+        int32_t m = ((int32_t)(in[i] << sh) >> sh) - calib_dc_off;
+        dst[i] = (float)MIN(MAX(m, -lim), lim) * scale + offset;
+    }
+}
+
+/**
+ * @brief Bulk masked copy of a linear (non wrapping) FPGA buffer segment
+ */
+void cmn_CopyCntsBulk(const volatile uint32_t* src, uint32_t size, uint32_t mask, uint16_t* dst)
+{
+    const uint32_t* in = (const uint32_t*)src;
+    uint32_t i = 0;
+
+#if defined(__ARM_NEON__)
+    const uint32x4_t vmask = vdupq_n_u32(mask);
+
+    for (; i + 4 <= size; i += 4) {
+        vst1_u16(dst + i, vmovn_u32(vandq_u32(vld1q_u32(in + i), vmask)));
+    }
+#endif
+
+    for (; i < size; ++i) {
+        dst[i] = in[i] & mask;
+    }
+}
 /**
  * @brief Converts voltage in [V] to ADC/DAC/Buffer counts
  *
@@ -60,6 +60,9 @@ else { \
 
 #define FULL_SCALE_NORM     20.0    // V
 
+int cmn_SetBackend(rp_backend_t backend);
+rp_backend_t cmn_GetBackend();
+
 int cmn_Init();
 int cmn_Release();
 
@@ -86,6 +89,11 @@ float cmn_CnvCalibCntToV(uint32_t field_len, int32_t calib_cnts, float adc_max_v
 float cmn_CnvCntToV(uint32_t field_len, uint32_t cnts, float adc_max_v, uint32_t calibScale, int calib_dc_off, float user_dc_off);
 uint32_t cmn_CnvVToCnt(uint32_t field_len, float voltage, float adc_max_v, bool calibFS_LO, uint32_t calib_scale, int calib_dc_off, float user_dc_off);
 
+void cmn_CnvCntToVParams(uint32_t field_len, float adc_max_v, uint32_t calibScale, float user_dc_off, float* scale, float* offset);
+void cmn_CalibCntsBulk(uint32_t field_len, const volatile uint32_t* src, uint32_t size, int calib_dc_off, int16_t* dst);
+void cmn_CnvCntToVBulk(uint32_t field_len, const volatile uint32_t* src, uint32_t size, int calib_dc_off, float scale, float offset, float* dst);
+void cmn_CopyCntsBulk(const volatile uint32_t* src, uint32_t size, uint32_t mask, uint16_t* dst);
+
 float rp_cmn_CalibFullScaleToVoltage(uint32_t fullScaleGain);
 uint32_t rp_cmn_CalibFullScaleFromVoltage(float voltageScale);
 float rp_cmn_CnvCntToV(uint32_t field_len, uint32_t cnts, float adc_max_v, uint32_t calibScale, int calib_dc_off, float user_dc_off);
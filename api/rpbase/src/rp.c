@@ -24,6 +24,7 @@
 #include "calib.h"
 #include "generate.h"
 #include "gen_handler.h"
+#include "sim.h"
 
 static char version[50];
 
@@ -40,6 +41,10 @@ int rp_Init()
     ECHECK(ams_Init());
     ECHECK(generate_Init());
     ECHECK(osc_Init());
+    if (cmn_GetBackend() == RP_BACKEND_SIM) {
+        ECHECK(sim_Init());
+        ECHECK(sim_Run(true));
+    }
     // TODO: Place other module initializations here
 
     // Set default configuration per handler
@@ -57,6 +62,9 @@ int rp_CalibInit()
 
 int rp_Release()
 {
+    if (cmn_GetBackend() == RP_BACKEND_SIM) {
+        ECHECK(sim_Release());
+    }
     ECHECK(osc_Release())
     ECHECK(generate_Release());
     ECHECK(ams_Release());
@@ -136,6 +144,17 @@ const char* rp_GetError(int errorCode) {
     }
 }
 
+int rp_SetBackend(rp_backend_t backend)
+{
+    return cmn_SetBackend(backend);
+}
+
+int rp_GetBackend(rp_backend_t* backend)
+{
+    *backend = cmn_GetBackend();
+    return RP_OK;
+}
+
 /**
  * Calibrate methods
  */
@@ -823,6 +842,22 @@ int rp_GenTrigger(uint32_t channel) {
     return gen_Trigger(channel);
 }
 
+/**
+ * Simulation methods
+ */
+
+int rp_SimSetStimulus(rp_channel_t channel, rp_waveform_t type, float frequency, float amplitude) {
+    return sim_SetStimulus(channel, type, frequency, amplitude);
+}
+
+int rp_SimAdvance(uint32_t samples) {
+    return sim_Advance(samples);
+}
+
+int rp_SimRun(bool enable) {
+    return sim_Run(enable);
+}
+
 float rp_CmnCnvCntToV(uint32_t field_len, uint32_t cnts, float adc_max_v, uint32_t calibScale, int calib_dc_off, float user_dc_off)
 {
 	return cmn_CnvCntToV(field_len, cnts, adc_max_v, calibScale, calib_dc_off, user_dc_off);
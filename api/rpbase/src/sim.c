@@ -0,0 +1,315 @@
+/**
+ * $Id: $
+ *
+ * @brief Red Pitaya library simulated acquisition (ADC stimulus model) implementation
+ *
+ * Stands in for the FPGA acquisition core when the library runs on
+ * RP_BACKEND_SIM. The oscilloscope window is mapped a second time (the shared-memory
+ * file is MAP_SHARED, so both mappings see the same registers) and, while armed,
+ * synthetic samples are written into the channel ring buffers, the write pointer
+ * is advanced and the trigger is evaluated the way the FPGA does it.
+ *
+ * @Author Red Pitaya
+ *
+ * (c) Red Pitaya  http://www.redpitaya.com
+ *
+ * This part of code is written in C programming language.
+ * Please visit http://en.wikipedia.org/wiki/C_(programming_language)
+ * for more details on the language used herein.
+ */
+
+#include <math.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "common.h"
+#include "oscilloscope.h"
+#include "sim.h"
+
+/* @brief Non-decimated ADC sampling rate [Hz]. */
+static const double SIM_ADC_RATE = 125e6;
+
+/* @brief Largest positive 14 bit ADC count. */
+static const int32_t SIM_ADC_MAX = 0x1FFF;
+
+/* @brief ADC acquisition bits mask. */
+static const uint32_t SIM_ADC_MASK = 0x3FFF;
+
+/* Configuration register bits, see osc_control_t */
+#define SIM_CONF_ARM            0x1
+#define SIM_CONF_RST            0x2
+#define SIM_CONF_TRIGGERED      0x4
+#define SIM_CONF_KEEP           0x8
+
+typedef struct sim_stimulus_s {
+    rp_waveform_t type;
+    float         frequency;        // [Hz]
+    float         amplitude;        // fraction of full scale
+    double        phase;            // [0..1)
+} sim_stimulus_t;
+
+typedef enum {
+    SIM_IDLE,
+    SIM_ARMED,
+    SIM_TRIGGERED
+} sim_state_t;
+
+static volatile osc_control_t *sim_osc = NULL;
+static volatile uint32_t *sim_buf[2] = { NULL, NULL };
+
+static sim_stimulus_t sim_stim[2] = {
+    { RP_WAVEFORM_SINE,   1000.0f, 0.8f, 0.0 },
+    { RP_WAVEFORM_SQUARE, 1000.0f, 0.5f, 0.0 }
+};
+
+static sim_state_t sim_state = SIM_IDLE;
+static uint32_t    sim_delay_left = 0;
+static int32_t     sim_prev[2] = { 0, 0 };
+
+static pthread_mutex_t sim_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_t       sim_thread;
+static volatile bool   sim_running = false;
+
+
+static int32_t sim_SignExtend(uint32_t cnts)
+{
+    return (cnts & 0x2000) ? (int32_t)(cnts | ~SIM_ADC_MASK) : (int32_t)cnts;
+}
+
+static int32_t sim_NextSample(sim_stimulus_t *stim, double phase_inc)
+{
+    double p = stim->phase;
+    double v;
+
+    switch (stim->type) {
+    case RP_WAVEFORM_SINE:
+        v = sin(2.0 * M_PI * p);
+        break;
+    case RP_WAVEFORM_SQUARE:
+        v = (p < 0.5) ? 1.0 : -1.0;
+        break;
+    case RP_WAVEFORM_TRIANGLE:
+        v = (p < 0.5) ? (4.0 * p - 1.0) : (3.0 - 4.0 * p);
+        break;
+    case RP_WAVEFORM_RAMP_UP:
+        v = 2.0 * p - 1.0;
+        break;
+    case RP_WAVEFORM_RAMP_DOWN:
+        v = 1.0 - 2.0 * p;
+        break;
+    case RP_WAVEFORM_DC:
+        v = 1.0;
+        break;
+    default:
+        v = 0.0;
+        break;
+    }
+
+    p += phase_inc;
+    stim->phase = p - floor(p);
+
+    return (int32_t)lround(v * stim->amplitude * SIM_ADC_MAX);
+}
+
+static bool sim_TriggerFired(uint32_t source, int32_t cha, int32_t chb)
+{
+    int32_t thr;
+
+    switch (source) {
+    case RP_TRIG_SRC_DISABLED:
+        return false;
+    case RP_TRIG_SRC_CHA_PE:
+        thr = sim_SignExtend(sim_osc->cha_thr & THRESHOLD_MASK);
+        return (sim_prev[0] < thr) && (cha >= thr);
+    case RP_TRIG_SRC_CHA_NE:
+        thr = sim_SignExtend(sim_osc->cha_thr & THRESHOLD_MASK);
+        return (sim_prev[0] > thr) && (cha <= thr);
+    case RP_TRIG_SRC_CHB_PE:
+        thr = sim_SignExtend(sim_osc->chb_thr & THRESHOLD_MASK);
+        return (sim_prev[1] < thr) && (chb >= thr);
+    case RP_TRIG_SRC_CHB_NE:
+        thr = sim_SignExtend(sim_osc->chb_thr & THRESHOLD_MASK);
+        return (sim_prev[1] > thr) && (chb <= thr);
+    default:
+        /* NOW, external and AWG sources have no model - fire immediately */
+        return true;
+    }
+}
+
+static void* sim_Worker(void *arg)
+{
+    double pending = 0.0;
+
+    while (sim_running) {
+        usleep(SIM_TICK_US);
+
+        uint32_t dec = sim_osc->data_dec & DATA_DEC_MASK;
+        if (dec == 0) {
+            dec = 1;
+        }
+
+        pending += SIM_TICK_US * 1e-6 * SIM_ADC_RATE / dec;
+        if (pending >= 1.0) {
+            uint32_t samples = (uint32_t)MIN(pending, (double)ADC_BUFFER_SIZE);
+            sim_Advance(samples);
+            pending -= floor(pending);
+        }
+    }
+    return NULL;
+}
+
+
+int sim_Init()
+{
+    ECHECK(cmn_Map(OSC_BASE_SIZE, OSC_BASE_ADDR, (void**)&sim_osc));
+    sim_buf[0] = (uint32_t*)((char*)sim_osc + OSC_CHA_OFFSET);
+    sim_buf[1] = (uint32_t*)((char*)sim_osc + OSC_CHB_OFFSET);
+
+    sim_state = SIM_IDLE;
+    sim_prev[0] = sim_prev[1] = 0;
+    return RP_OK;
+}
+
+int sim_Release()
+{
+    ECHECK(sim_Run(false));
+    ECHECK(cmn_Unmap(OSC_BASE_SIZE, (void**)&sim_osc));
+    sim_buf[0] = sim_buf[1] = NULL;
+    return RP_OK;
+}
+
+int sim_SetStimulus(rp_channel_t channel, rp_waveform_t type, float frequency, float amplitude)
+{
+    if ((type > RP_WAVEFORM_DC) || (frequency < 0.0f) || (amplitude < 0.0f) || (amplitude > 1.0f)) {
+        return RP_EOOR;
+    }
+
+    sim_stimulus_t *stim;
+    CHANNEL_ACTION(channel,
+            stim = &sim_stim[0],
+            stim = &sim_stim[1])
+
+    pthread_mutex_lock(&sim_mutex);
+    stim->type      = type;
+    stim->frequency = frequency;
+    stim->amplitude = amplitude;
+    pthread_mutex_unlock(&sim_mutex);
+    return RP_OK;
+}
+
+/**
+ * @brief Produces the given number of decimated samples on both channels
+ *
+ * Nothing is written while the acquisition is not armed, as with the FPGA.
+ * After the trigger fired, trigger_delay more samples are stored and the
+ * acquisition stops unless arm_keep is set.
+ */
+int sim_Advance(uint32_t samples)
+{
+    if (sim_osc == NULL) {
+        return RP_EUF;
+    }
+
+    pthread_mutex_lock(&sim_mutex);
+
+    const uint32_t conf_in = sim_osc->conf;
+    uint32_t conf = conf_in;
+
+    /* Register writes are pulses on the FPGA; a reset still pending when the
+     * acquisition gets armed happened before the arm, so the arm survives it. */
+    if (conf & SIM_CONF_RST) {
+        conf &= ~(SIM_CONF_RST | SIM_CONF_TRIGGERED);
+        sim_osc->pre_trigger_counter = 0;
+        sim_state = SIM_IDLE;
+    }
+
+    if (!(conf & SIM_CONF_ARM)) {
+        if (conf != conf_in) {
+            sim_osc->conf = conf;
+        }
+        sim_state = SIM_IDLE;
+        pthread_mutex_unlock(&sim_mutex);
+        return RP_OK;
+    }
+
+    if (sim_state == SIM_IDLE) {
+        conf &= ~SIM_CONF_TRIGGERED;
+        sim_osc->pre_trigger_counter = 0;
+        sim_state = SIM_ARMED;
+    }
+
+    uint32_t dec = sim_osc->data_dec & DATA_DEC_MASK;
+    if (dec == 0) {
+        dec = 1;
+    }
+    double rate = SIM_ADC_RATE / dec;
+    double inc_a = sim_stim[0].frequency / rate;
+    double inc_b = sim_stim[1].frequency / rate;
+
+    uint32_t wp = sim_osc->wr_ptr_cur & WRITE_POINTER_MASK;
+    uint32_t pre_trigger = sim_osc->pre_trigger_counter;
+
+    for (uint32_t i = 0; i < samples; ++i) {
+        wp = (wp + 1) % ADC_BUFFER_SIZE;
+
+        int32_t cha = sim_NextSample(&sim_stim[0], inc_a);
+        int32_t chb = sim_NextSample(&sim_stim[1], inc_b);
+        sim_buf[0][wp] = (uint32_t)cha & SIM_ADC_MASK;
+        sim_buf[1][wp] = (uint32_t)chb & SIM_ADC_MASK;
+
+        if (sim_state == SIM_ARMED) {
+            pre_trigger++;
+            if (sim_TriggerFired(sim_osc->trig_source & TRIG_SRC_MASK, cha, chb)) {
+                sim_osc->wr_ptr_trigger = wp;
+                sim_osc->trig_source = RP_TRIG_SRC_DISABLED;
+                sim_delay_left = sim_osc->trigger_delay;
+                conf |= SIM_CONF_TRIGGERED;
+                sim_state = SIM_TRIGGERED;
+            }
+        }
+        else if (sim_delay_left > 0) {
+            sim_delay_left--;
+        }
+
+        sim_prev[0] = cha;
+        sim_prev[1] = chb;
+
+        if ((sim_state == SIM_TRIGGERED) && (sim_delay_left == 0) && !(conf & SIM_CONF_KEEP)) {
+            conf &= ~SIM_CONF_ARM;
+            sim_state = SIM_IDLE;
+            break;
+        }
+    }
+
+    sim_osc->wr_ptr_cur = wp;
+    sim_osc->pre_trigger_counter = pre_trigger;
+    if (conf != conf_in) {
+        sim_osc->conf = conf;
+    }
+
+    pthread_mutex_unlock(&sim_mutex);
+    return RP_OK;
+}
+
+int sim_Run(bool enable)
+{
+    if (enable == sim_running) {
+        return RP_OK;
+    }
+
+    if (enable) {
+        if (sim_osc == NULL) {
+            return RP_EUF;
+        }
+        sim_running = true;
+        if (pthread_create(&sim_thread, NULL, sim_Worker, NULL) != 0) {
+            sim_running = false;
+            return RP_EUF;
+        }
+    }
+    else {
+        sim_running = false;
+        pthread_join(sim_thread, NULL);
+    }
+    return RP_OK;
+}
@@ -0,0 +1,33 @@
+/**
+ * $Id: $
+ *
+ * @brief Red Pitaya library simulated acquisition (ADC stimulus model) interface
+ *
+ * @Author Red Pitaya
+ *
+ * (c) Red Pitaya  http://www.redpitaya.com
+ *
+ * This part of code is written in C programming language.
+ * Please visit http://en.wikipedia.org/wiki/C_(programming_language)
+ * for more details on the language used herein.
+ */
+
+#ifndef __SIM_H
+#define __SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "redpitaya/rp.h"
+
+/* Period of the free running stimulus thread */
+#define SIM_TICK_US             1000
+
+int sim_Init();
+int sim_Release();
+
+int sim_SetStimulus(rp_channel_t channel, rp_waveform_t type, float frequency, float amplitude);
+int sim_Advance(uint32_t samples);
+int sim_Run(bool enable);
+
+#endif //__SIM_H
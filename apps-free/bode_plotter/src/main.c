@@ -336,6 +336,11 @@ static rp_app_params_t rp_main_params[PARAMS_NUM+1] = {
     { /* pid_NN_kd - PID NN derivative gain   Kd in [ADC] counts. */
         "pid_22_kd",  0, 1, 0, -8192, 8191 },
 
+    /* meas_rms_chN [V] - RMS value of the signal, DC part included, measured
+     * like the values above */
+    {  "meas_rms_ch1", 0, 0, 1, 0, +1000 },
+    {  "meas_rms_ch2", 0, 0, 1, 0, +1000 },
+
     { /* Must be last! */
         NULL, 0.0, -1, -1, 0.0, 0.0 }     
 };
@@ -1161,6 +1166,7 @@ int rp_update_meas_data(rp_osc_meas_res_t ch1_meas, rp_osc_meas_res_t ch2_meas)
     rp_main_params[MEAS_AVG_CH1].value = ch1_meas.avg;
     rp_main_params[MEAS_FREQ_CH1].value = ch1_meas.freq;
     rp_main_params[MEAS_PER_CH1].value = ch1_meas.period;
+    rp_main_params[MEAS_RMS_CH1].value = ch1_meas.rms;
 
     rp_main_params[MEAS_MIN_CH2].value = ch2_meas.min;
     rp_main_params[MEAS_MAX_CH2].value = ch2_meas.max;
@@ -1168,6 +1174,7 @@ int rp_update_meas_data(rp_osc_meas_res_t ch1_meas, rp_osc_meas_res_t ch2_meas)
     rp_main_params[MEAS_AVG_CH2].value = ch2_meas.avg;
     rp_main_params[MEAS_FREQ_CH2].value = ch2_meas.freq;
     rp_main_params[MEAS_PER_CH2].value = ch2_meas.period;
+    rp_main_params[MEAS_RMS_CH2].value = ch2_meas.rms;
 
     pthread_mutex_unlock(&rp_main_params_mutex);
     return 0;
@@ -39,13 +39,20 @@ typedef struct rp_osc_meas_res_s {
     float max;
     float amp;
     float avg;
+    float rms;
     float freq;
     float period;
+
+    /* sums of the samples and their squares in ADC counts, accumulated in
+     * double to stay exact over a whole acquisition, rp_osc_meas_avg_amp()
+     * turns them into avg and rms */
+    double sum;
+    double sum_sq;
 } rp_osc_meas_res_t;
 
 /* Parameters indexes - these defines should be in the same order as 
  * rp_app_params_t structure defined in main.c */
-#define PARAMS_NUM        91
+#define PARAMS_NUM        93
 #define MIN_GUI_PARAM     0
 #define MAX_GUI_PARAM     1
 #define TRIG_MODE_PARAM   2
@@ -141,6 +148,10 @@ typedef struct rp_osc_meas_res_s {
 #define PID_22_KI         89
 #define PID_22_KD         90
 
+/* RMS measurements, appended to leave the indices above as they are */
+#define MEAS_RMS_CH1      91
+#define MEAS_RMS_CH2      92
+
 /* Defines from which parameters on are AWG parameters (used in set_param() to
  * trigger update only on needed part - either Oscilloscope, AWG or PID */
 #define PARAMS_AWG_PARAMS 52
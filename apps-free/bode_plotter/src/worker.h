@@ -91,6 +91,10 @@ int rp_osc_get_time_unit_factor(int time_unit);
 int rp_osc_meas_clear(rp_osc_meas_res_t *ch_meas);
 /* helper function - calculates min, max and accumulates average value */
 int rp_osc_meas_min_max(rp_osc_meas_res_t *ch_meas, int sig_data);
+/* helper function - min, max and accumulated average and mean square of the
+ * whole buffer of both channels, one pass of the measurement kernel */
+int rp_osc_meas_stats(rp_osc_meas_res_t *ch1_meas, int *in_cha_signal,
+                      rp_osc_meas_res_t *ch2_meas, int *in_chb_signal);
 /* helper function - calculates average and amplitude */
 int rp_osc_meas_avg_amp(rp_osc_meas_res_t *ch_meas, int avg_len);
 /* helper function - calculates period and frequency */
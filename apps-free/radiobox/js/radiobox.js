@@ -41,7 +41,8 @@
     app_started: false,
     socket_opened: false,
     pktIdx: 0,
-    pktIdxMax: 4,  // XXX set count of transport frames
+    pktIdxMax: 7,  // XXX set count of transport frames
+    doubleParams: false,  // set when the server returned plain double frequencies, quad encoding is not needed then
     mouseWheelLim: 20,
     doUpdate: false,
     blocking: false,
@@ -105,7 +106,15 @@
     ovrdrv_s:               0,  // Current overdrive flags of the FPGA signals
 
     ac97_lil_s:            80,  // connect to RX_AUDIO_OUT (RX: audio signal)
-    ac97_lir_s:            80   // connect to RX_AUDIO_OUT (RX: audio signal)
+    ac97_lir_s:            80,  // connect to RX_AUDIO_OUT (RX: audio signal)
+
+    sweep_start_f:    7000000,  // 7000 kHz sweep start frequency
+    sweep_stop_f:     7200000,  // 7200 kHz sweep stop frequency
+    sweep_step_f:           0,  // 0: spread over the maximum count of sweep points
+    sweep_dwell_s:        100,  // 100 us settling time at each sweep step
+
+    tlm_rate_s:             0,  // RX telemetry sampling rate in Hz, 0: off
+    tlm_sink_s:             0   // RX telemetry file sink off
   //ac97_lil_s:            60,  // connect to RX_MOD_48K_I (RX: audio signal)
   //ac97_lir_s:            61   // connect to RX_MOD_48K_Q (RX: audio signal)
   };
@@ -1463,6 +1472,21 @@ function cast_1xdouble_to_4xfloat(d)
   return quad;
 }
 
+function cast_double2transport(transport, name, value)
+{
+  if (RB.state.doubleParams) {
+    transport[name] = value;
+    return;
+  }
+
+  // legacy servers pass floats only
+  var quad = cast_1xdouble_to_4xfloat(value);
+  transport['SE_' + name] = quad.se;
+  transport['HI_' + name] = quad.hi;
+  transport['MI_' + name] = quad.mi;
+  transport['LO_' + name] = quad.lo;
+}
+
 function cast_params2transport(params, pktIdx)
 {  // XXX params --> transport
   var transport = { };
@@ -1511,29 +1535,17 @@ function cast_params2transport(params, pktIdx)
 
   case 2:
     if (params['tx_car_osc_qrg_f'] !== undefined) {
-      var quad = cast_1xdouble_to_4xfloat(params['tx_car_osc_qrg_f']);
-      transport['SE_tx_car_osc_qrg_f'] = quad.se;
-      transport['HI_tx_car_osc_qrg_f'] = quad.hi;
-      transport['MI_tx_car_osc_qrg_f'] = quad.mi;
-      transport['LO_tx_car_osc_qrg_f'] = quad.lo;
+      cast_double2transport(transport, 'tx_car_osc_qrg_f', params['tx_car_osc_qrg_f']);
     }
 
     if (params['rx_car_osc_qrg_f'] !== undefined) {
-      var quad = cast_1xdouble_to_4xfloat(params['rx_car_osc_qrg_f']);
-      transport['SE_rx_car_osc_qrg_f'] = quad.se;
-      transport['HI_rx_car_osc_qrg_f'] = quad.hi;
-      transport['MI_rx_car_osc_qrg_f'] = quad.mi;
-      transport['LO_rx_car_osc_qrg_f'] = quad.lo;
+      cast_double2transport(transport, 'rx_car_osc_qrg_f', params['rx_car_osc_qrg_f']);
     }
     break;
 
   case 3:
     if (params['tx_mod_osc_qrg_f'] !== undefined) {
-      var quad = cast_1xdouble_to_4xfloat(params['tx_mod_osc_qrg_f']);
-      transport['SE_tx_mod_osc_qrg_f'] = quad.se;
-      transport['HI_tx_mod_osc_qrg_f'] = quad.hi;
-      transport['MI_tx_mod_osc_qrg_f'] = quad.mi;
-      transport['LO_tx_mod_osc_qrg_f'] = quad.lo;
+      cast_double2transport(transport, 'tx_mod_osc_qrg_f', params['tx_mod_osc_qrg_f']);
     }
 
     if (params['tx_muxin_gain_s'] !== undefined) {
@@ -1595,6 +1607,40 @@ function cast_params2transport(params, pktIdx)
     }
     break;
 
+  case 5:
+    if (params['sweep_start_f'] !== undefined) {
+      cast_double2transport(transport, 'sweep_start_f', params['sweep_start_f']);
+    }
+
+    if (params['sweep_stop_f'] !== undefined) {
+      cast_double2transport(transport, 'sweep_stop_f', params['sweep_stop_f']);
+    }
+    break;
+
+  case 6:
+    if (params['sweep_step_f'] !== undefined) {
+      cast_double2transport(transport, 'sweep_step_f', params['sweep_step_f']);
+    }
+
+    if (params['sweep_dwell_s'] !== undefined) {
+      transport['sweep_dwell_s'] = params['sweep_dwell_s'];
+    }
+
+    if (params['sweep_run'] !== undefined) {  // last one, the sweep starts with all its parameters received
+      transport['sweep_run'] = params['sweep_run'];
+    }
+    break;
+
+  case 7:
+    if (params['tlm_rate_s'] !== undefined) {
+      transport['tlm_rate_s'] = params['tlm_rate_s'];
+    }
+
+    if (params['tlm_sink_s'] !== undefined) {
+      transport['tlm_sink_s'] = params['tlm_sink_s'];
+    }
+    break;
+
   default:
     // no limitation of output data
     break;
@@ -1640,7 +1686,11 @@ function cast_transport2params(transport)
     params['rx_muxin_src_s'] = transport['rx_muxin_src_s'];
   }
 
-  if (transport['LO_tx_car_osc_qrg_f'] !== undefined) {
+  if (transport['tx_car_osc_qrg_f'] !== undefined) {
+    params['tx_car_osc_qrg_f'] = transport['tx_car_osc_qrg_f'];
+    RB.state.doubleParams = true;
+  }
+  else if (transport['LO_tx_car_osc_qrg_f'] !== undefined) {
     var quad = { };
     quad.se = transport['SE_tx_car_osc_qrg_f'];
     quad.hi = transport['HI_tx_car_osc_qrg_f'];
@@ -1649,7 +1699,11 @@ function cast_transport2params(transport)
     params['tx_car_osc_qrg_f'] = cast_4xfloat_to_1xdouble(quad);
   }
 
-  if (transport['LO_rx_car_osc_qrg_f'] !== undefined) {
+  if (transport['rx_car_osc_qrg_f'] !== undefined) {
+    params['rx_car_osc_qrg_f'] = transport['rx_car_osc_qrg_f'];
+    RB.state.doubleParams = true;
+  }
+  else if (transport['LO_rx_car_osc_qrg_f'] !== undefined) {
     var quad = { };
     quad.se = transport['SE_rx_car_osc_qrg_f'];
     quad.hi = transport['HI_rx_car_osc_qrg_f'];
@@ -1658,7 +1712,11 @@ function cast_transport2params(transport)
     params['rx_car_osc_qrg_f'] = cast_4xfloat_to_1xdouble(quad);
   }
 
-  if (transport['LO_tx_mod_osc_qrg_f'] !== undefined) {
+  if (transport['tx_mod_osc_qrg_f'] !== undefined) {
+    params['tx_mod_osc_qrg_f'] = transport['tx_mod_osc_qrg_f'];
+    RB.state.doubleParams = true;
+  }
+  else if (transport['LO_tx_mod_osc_qrg_f'] !== undefined) {
     var quad = { };
     quad.se = transport['SE_tx_mod_osc_qrg_f'];
     quad.hi = transport['HI_tx_mod_osc_qrg_f'];
@@ -1715,6 +1773,78 @@ function cast_transport2params(transport)
     params['ac97_lir_s'] = transport['ac97_lir_s'];
   }
 
+  if (transport['sweep_start_f'] !== undefined) {
+    params['sweep_start_f'] = transport['sweep_start_f'];
+    RB.state.doubleParams = true;
+  }
+  else if (transport['LO_sweep_start_f'] !== undefined) {
+    var quad = { };
+    quad.se = transport['SE_sweep_start_f'];
+    quad.hi = transport['HI_sweep_start_f'];
+    quad.mi = transport['MI_sweep_start_f'];
+    quad.lo = transport['LO_sweep_start_f'];
+    params['sweep_start_f'] = cast_4xfloat_to_1xdouble(quad);
+  }
+
+  if (transport['sweep_stop_f'] !== undefined) {
+    params['sweep_stop_f'] = transport['sweep_stop_f'];
+    RB.state.doubleParams = true;
+  }
+  else if (transport['LO_sweep_stop_f'] !== undefined) {
+    var quad = { };
+    quad.se = transport['SE_sweep_stop_f'];
+    quad.hi = transport['HI_sweep_stop_f'];
+    quad.mi = transport['MI_sweep_stop_f'];
+    quad.lo = transport['LO_sweep_stop_f'];
+    params['sweep_stop_f'] = cast_4xfloat_to_1xdouble(quad);
+  }
+
+  if (transport['sweep_step_f'] !== undefined) {
+    params['sweep_step_f'] = transport['sweep_step_f'];
+    RB.state.doubleParams = true;
+  }
+  else if (transport['LO_sweep_step_f'] !== undefined) {
+    var quad = { };
+    quad.se = transport['SE_sweep_step_f'];
+    quad.hi = transport['HI_sweep_step_f'];
+    quad.mi = transport['MI_sweep_step_f'];
+    quad.lo = transport['LO_sweep_step_f'];
+    params['sweep_step_f'] = cast_4xfloat_to_1xdouble(quad);
+  }
+
+  if (transport['sweep_dwell_s'] !== undefined) {
+    params['sweep_dwell_s'] = transport['sweep_dwell_s'];
+  }
+
+  if (transport['tlm_rate_s'] !== undefined) {
+    params['tlm_rate_s'] = transport['tlm_rate_s'];
+  }
+
+  if (transport['tlm_sink_s'] !== undefined) {
+    params['tlm_sink_s'] = transport['tlm_sink_s'];
+  }
+
+  if (transport['tlm_strength_s'] !== undefined) {
+    params['tlm_strength_s'] = transport['tlm_strength_s'];
+  }
+
+  if (transport['tlm_mag_s'] !== undefined) {
+    params['tlm_mag_s'] = transport['tlm_mag_s'];
+  }
+
+  if (transport['tlm_afc_qrg_f'] !== undefined) {
+    params['tlm_afc_qrg_f'] = transport['tlm_afc_qrg_f'];
+    RB.state.doubleParams = true;
+  }
+  else if (transport['LO_tlm_afc_qrg_f'] !== undefined) {
+    var quad = { };
+    quad.se = transport['SE_tlm_afc_qrg_f'];
+    quad.hi = transport['HI_tlm_afc_qrg_f'];
+    quad.mi = transport['MI_tlm_afc_qrg_f'];
+    quad.lo = transport['LO_tlm_afc_qrg_f'];
+    params['tlm_afc_qrg_f'] = cast_4xfloat_to_1xdouble(quad);
+  }
+
   //console.log('INFO cast_transport2params: out(params=', params, ') <-- in(transport=', transport, ')\n');
   return params;
 }
@@ -6,9 +6,76 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <stdint.h>
+#include <time.h>
 #include <sys/mman.h>
 
 
+/* emulated FIFO register block to benchmark the FIFO copy loops of the ALSA driver */
+typedef struct emu_ac97_s {
+  int levels;     // 1: status reports the FIFO levels as newer FPGA bitstreams do
+  int play_ctr;
+  int play_odd;
+  int rec_ctr;
+  int rec_odd;
+  unsigned long reads;
+  unsigned long writes;
+} emu_ac97_t;
+
+static uint32_t emu_rd(emu_ac97_t* emu, int reg)
+{
+  emu->reads++;
+  if (reg == 0x08) {
+    return (emu->levels ?  (1U << 31) : 0) | (emu->rec_odd << 17) | (emu->play_odd << 16) | (emu->rec_ctr << 12) | (emu->play_ctr << 8) |
+           (!emu->rec_ctr << 3) | ((emu->rec_ctr == 15) << 2) | ((emu->play_ctr >= 8) << 1) | (emu->play_ctr == 15);
+  }
+  if ((reg == 0x04) && emu->rec_ctr) {
+    if (emu->rec_odd) {
+      emu->rec_ctr--;
+    }
+    emu->rec_odd = !emu->rec_odd;
+    return 0x1234;
+  }
+  return 0;
+}
+
+static void emu_wr(emu_ac97_t* emu, int reg, uint32_t val)
+{
+  emu->writes++;
+  if ((reg == 0x00) && (emu->play_ctr < 15)) {
+    if (emu->play_odd) {
+      emu->play_ctr++;
+    }
+    emu->play_odd = !emu->play_odd;
+  }
+}
+
+#define CTRL_FIFO_RD(port, reg)     emu_rd((emu_ac97_t*) (port), (reg))
+#define CTRL_FIFO_WR(port, reg, v)  emu_wr((emu_ac97_t*) (port), (reg), (v))
+#include "../../../patches/redpitaya-ac97/redpitaya-ac97-fifo.h"
+
+static void emu_bench(int levels)
+{
+  static uint16_t buf[48000 * 2];
+  emu_ac97_t emu = { levels, 0, 0, 0, 0, 0, 0 };
+  struct timespec t0, t1;
+  size_t words = 0;
+  int hw_ready;
+  int irq;
+
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  for (irq = 0; irq < 6000; irq++) {  // one second of 48 kHz stereo, an IRQ each 8 frames
+    emu.play_ctr = (emu.play_ctr > 8) ?  emu.play_ctr - 8 : 0;
+    emu.rec_ctr += 8;
+    words += ctrl_fifo_play_copy(&emu, buf + (words % 48000), 16, &hw_ready);
+    words += ctrl_fifo_rec_copy(&emu, buf + (words % 48000), 16, &hw_ready);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+
+  printf("%s status: %zu words, %.2f register accesses per word, %.1f us\n", levels ?  "level" : "flag ",
+         words, (double) (emu.reads + emu.writes) / words, (t1.tv_sec - t0.tv_sec) * 1e6 + (t1.tv_nsec - t0.tv_nsec) / 1e3);
+}
+
+
 int fpga_mmap_area(int* fd, void** mem, long base_addr, long base_size)
 {
   const long page_size = sysconf(_SC_PAGESIZE);
@@ -55,7 +122,7 @@ int fpga_munmap_area(int* fd, void** mem, long base_addr, long base_size)
 }
 
 
-int main() 
+int main(int argc, char** argv)
 {
   void *mem = NULL;
   int fd = 0;
@@ -65,6 +132,12 @@ int main()
   void *addr;
   uint32_t data;
 
+  if ((argc > 1) && !strcmp(argv[1], "bench")) {
+    emu_bench(0);
+    emu_bench(1);
+    return 0;
+  }
+
   printf("001\n");
   fpga_mmap_area(&fd, &mem, base_addr, base_size);
   printf("002: mem = 0x%p\n", mem);
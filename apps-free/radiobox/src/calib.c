@@ -14,12 +14,18 @@
 #include <stdlib.h>
 #include <errno.h>
 #include <string.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
 
 #include "calib.h"
 
 const char eeprom_device[]="/sys/bus/i2c/devices/0-0050/eeprom";
 const int  eeprom_calib_off=0x0008;
 
+const char adc_ofs_cache_tmp_file[]=CALIB_ADC_OFS_CACHE_FILE ".new";
+
 
 /*----------------------------------------------------------------------------*/
 int rp_read_calib_params(rp_calib_params_t *calib_params)
@@ -212,6 +218,104 @@ int16_t calib_get_ADC_offset(rp_calib_params_t *calib_params, int adcChannel)
     }
 }
 
+/*----------------------------------------------------------------------------*/
+static int calib_ADC_offset_cache_dir(void)
+{
+    struct stat st;
+
+    if (mkdir(CALIB_ADC_OFS_CACHE_DIR, 0700) && (errno != EEXIST)) {
+        fprintf(stderr, "WARNING calib_write_ADC_offset_cache: can not create %s: %s\n", CALIB_ADC_OFS_CACHE_DIR, strerror(errno));
+        return -1;
+    }
+
+    /* an existing entry has to be our own directory nobody else can write to */
+    if (lstat(CALIB_ADC_OFS_CACHE_DIR, &st) || !S_ISDIR(st.st_mode) || (st.st_uid != geteuid()) || (st.st_mode & (S_IWGRP | S_IWOTH))) {
+        fprintf(stderr, "WARNING calib_write_ADC_offset_cache: %s is not a private directory\n", CALIB_ADC_OFS_CACHE_DIR);
+        return -1;
+    }
+    return 0;
+}
+
+/*----------------------------------------------------------------------------*/
+int calib_write_ADC_offset_cache(const int adcChannels[], const int16_t adcOfs[], int count, float temp)
+{
+    FILE *fp;
+    int   fd;
+    int   i;
+    int   err;
+
+    if (calib_ADC_offset_cache_dir()) {
+        return -1;
+    }
+
+    /* a left-over of an interrupted write is removed once, the new file is never one that existed before */
+    fd=open(adc_ofs_cache_tmp_file, O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW, 0600);
+    if((fd < 0) && (errno == EEXIST) && !unlink(adc_ofs_cache_tmp_file)) {
+        fd=open(adc_ofs_cache_tmp_file, O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW, 0600);
+    }
+    if(fd < 0) {
+        fprintf(stderr, "WARNING calib_write_ADC_offset_cache: can not write %s: %s\n", adc_ofs_cache_tmp_file, strerror(errno));
+        return -1;
+    }
+    fp=fdopen(fd, "w");
+    if(fp == NULL) {
+        close(fd);
+        unlink(adc_ofs_cache_tmp_file);
+        return -1;
+    }
+
+    fprintf(fp, "# RadioBox ADC offsets - XADC die temperature, then ADC channel and offset value\n");
+    fprintf(fp, "temp %.2f\n", temp);
+    for (i = 0; i < count; i++) {
+        fprintf(fp, "ofs 0x%02x %d\n", adcChannels[i], adcOfs[i]);
+    }
+    err = (fflush(fp) || fsync(fd));
+    if(fclose(fp) || err || rename(adc_ofs_cache_tmp_file, CALIB_ADC_OFS_CACHE_FILE)) {
+        fprintf(stderr, "WARNING calib_write_ADC_offset_cache: can not write %s: %s\n", CALIB_ADC_OFS_CACHE_FILE, strerror(errno));
+        unlink(adc_ofs_cache_tmp_file);
+        return -1;
+    }
+
+    return 0;
+}
+
+/*----------------------------------------------------------------------------*/
+int calib_read_ADC_offset_cache(rp_calib_params_t *calib_params, float temp)
+{
+    FILE  *fp;
+    char   line[128];
+    float  cacheTemp = NAN;
+    int    adcChannel, adcOfs;
+    int    count = 0;
+    int    fd;
+
+    fd=open(CALIB_ADC_OFS_CACHE_FILE, O_RDONLY | O_NOFOLLOW);
+    if(fd < 0) {
+        return -1;
+    }
+    fp=fdopen(fd, "r");
+    if(fp == NULL) {
+        close(fd);
+        return -1;
+    }
+
+    /* the temperature comes first, the offsets are only taken when it matches */
+    while (fgets(line, sizeof(line), fp)) {
+        if (sscanf(line, "temp %f", &cacheTemp) == 1) {
+            if (isnan(temp) || (fabsf(cacheTemp - temp) > CALIB_ADC_OFS_CACHE_TEMP_DEV)) {
+                break;
+            }
+
+        } else if (!isnan(cacheTemp) && (sscanf(line, "ofs %i %i", &adcChannel, &adcOfs) == 2)) {
+            calib_set_ADC_offset(calib_params, adcChannel, (int16_t) adcOfs);
+            count++;
+        }
+    }
+    fclose(fp);
+
+    return count ?  count : -1;
+}
+
 /*----------------------------------------------------------------------------*/
 void calib_set_DAC_offset(rp_calib_params_t *calib_params, int dacChannel, int16_t dacOfs)
 {
@@ -20,6 +20,15 @@
  * @{
  */
 
+/** @brief Directory of the ADC offset cache: persistent over reboots, created private to the app as the app partition is read-only */
+#define CALIB_ADC_OFS_CACHE_DIR         "/var/lib/radiobox"
+
+/** @brief ADC offset cache file, replaced as a whole by each new measurement */
+#define CALIB_ADC_OFS_CACHE_FILE        CALIB_ADC_OFS_CACHE_DIR "/adc_offsets.cache"
+
+/** @brief Maximum difference of the die temperature in degrees Celsius to take over cached ADC offsets */
+#define CALIB_ADC_OFS_CACHE_TEMP_DEV    5.0f
+
 /** @brief  Calibration parameters stored in the EEPROM device
  */
 typedef struct rp_calib_params_s {
@@ -173,6 +182,31 @@ void calib_set_ADC_offset(rp_calib_params_t *calib_params, int adcChannel, int16
  */
 int16_t calib_get_ADC_offset(rp_calib_params_t *calib_params, int adcChannel);
 
+/**
+ * Stores measured ADC offsets together with the die temperature they were measured at.
+ *
+ * The offsets go to a new file in CALIB_ADC_OFS_CACHE_DIR which is then renamed to
+ * CALIB_ADC_OFS_CACHE_FILE, so a reader never sees a partly written cache.
+ *
+ * @param[in]  adcChannels   ADC channels measured, @see calib_set_ADC_offset().
+ * @param[in]  adcOfs        offset value of each channel as passed to calib_set_ADC_offset().
+ * @param[in]  count         count of entries of adcChannels and adcOfs.
+ * @param[in]  temp          XADC die temperature in degrees Celsius during the measurement.
+ * @retval     0             Success
+ * @retval    -1             Failure, the cache file could not be written
+ */
+int calib_write_ADC_offset_cache(const int adcChannels[], const int16_t adcOfs[], int count, float temp);
+
+/**
+ * Takes over cached ADC offsets when they were measured at about the current die temperature.
+ *
+ * @param[out] calib_params  Pointer to target buffer to be updated.
+ * @param[in]  temp          current XADC die temperature in degrees Celsius.
+ * @retval     int           count of ADC channels taken over.
+ * @retval    -1             no cache available or measured more than CALIB_ADC_OFS_CACHE_TEMP_DEV away.
+ */
+int calib_read_ADC_offset_cache(rp_calib_params_t *calib_params, float temp);
+
 /**
  * Initialize calibration parameters to default values.
  *
@@ -12,11 +12,14 @@
 #include <unistd.h>
 #include <string.h>
 #include <pthread.h>
+#include <time.h>
 
 #include "main.h"
 #include "worker.h"
 #include "calib.h"
 #include "fpga.h"
+#include "telemetry.h"
+#include "xadc_mon.h"
 
 #include "cb_http.h"
 
@@ -30,15 +33,21 @@ extern rp_calib_params_t    g_rp_main_calib_params;
 /** @brief Describes app. parameters with some info/limitations */
 extern rb_app_params_t      g_rb_default_params[];
 
-/** @brief CallBack copy of params to inform the worker */
-extern rp_app_params_t*     g_rp_cb_in_params;
+/** @brief CallBack copy of params to inform the worker, pending while its count is not zero */
+extern rb_params_block_t    g_rb_cb_in_params;
 /** @brief Holds mutex to access on parameters from outside to the worker thread */
 extern pthread_mutex_t      g_rp_cb_in_params_mutex;
-
-/** @brief Current copy of params of the worker thread */
-extern rb_app_params_t*     g_rb_info_worker_params;
-/** @brief Holds mutex to access parameters from the worker thread to any other context */
+/** @brief Signaled when new params are queued, taken or the worker finished them */
+extern pthread_cond_t       g_rp_cb_in_params_cond;
+/** @brief Time the oldest params still waiting in g_rb_cb_in_params were queued */
+extern struct timespec      g_rp_cb_in_params_queued;
+/** @brief Count of parameter packets merged into g_rb_cb_in_params */
+extern int                  g_rp_cb_in_params_sets;
+
+/** @brief Holds mutex to wait for the first params the worker thread exports */
 extern pthread_mutex_t      g_rb_info_worker_params_mutex;
+/** @brief Signaled when the worker exported new params */
+extern pthread_cond_t       g_rb_info_worker_params_cond;
 
 /** @brief params initialized */
 extern int                  g_params_init_done;
@@ -55,6 +64,11 @@ int rp_app_init(void)
 
     fpga_init();
 
+    /* start-up the XADC monitor, other processes read its readings from the shared-memory segment */
+    if (xadc_mon_init(XADC_MON_RATE_DEFAULT) < 0) {
+        fprintf(stderr, "ERROR rp_app_init - failed to start xadc_mon_init.\n");
+    }
+
     rp_ac97_module_load();
 
     //fprintf(stderr, "INFO rp_app_init: sizeof(double)=%d, sizeof(float)=%d, sizeof(long long)=%d, sizeof(long)=%d, sizeof(int)=%d, sizeof(short)=%d\n",
@@ -79,10 +93,21 @@ int rp_app_init(void)
     }
     //fprintf(stderr, "INFO rp_app_init: osc125mhz = %lf\n", rp_main_calib_params.base_osc125mhz_realhz);
 
-#if 0  // disabled due to new FPGA automatic offset compensation
-    // adjust ADC offset values to current environment
-    rp_measure_calib_params(&g_rp_main_calib_params);
-#endif
+    // no ADC offset measurement at start-up, due to new FPGA automatic offset compensation -
+    // only offsets measured on request with rb_calib are taken over again while the die temperature fits
+    rp_calib_adc_offsets(&g_rp_main_calib_params, 0);
+
+    /* name to parameter ID translation for the transport layer */
+    if (rb_params_init_ids() < 0) {
+        fprintf(stderr, "ERROR rp_app_init - failed to build the parameter ID table.\n");
+        return -1;
+    }
+
+    /* start-up RX telemetry sampler before the worker, which sets its rate with its first pass */
+    if (telemetry_init() < 0) {
+        fprintf(stderr, "ERROR rp_app_init - failed to start telemetry_init.\n");
+        return -1;
+    }
 
     /* start-up worker thread */
     if (worker_init(g_rb_default_params, RB_PARAMS_NUM) < 0) {
@@ -105,13 +130,17 @@ int rp_app_exit(void)
     /* turn off all LEDs */
     fpga_hk_setLeds(0, 0xff, 0x00);
 
-    //fprintf(stderr, "rp_app_exit: calling fpga_exit()\n");
-    fpga_exit();
-
     //fprintf(stderr, "rp_app_exit: calling worker_exit()\n");
-    /* shut-down worker thread */
+    /* shut-down worker thread first, it would start the telemetry sink again */
     worker_exit();
 
+    /* the samplers read the FPGA registers until they are stopped */
+    telemetry_exit();
+    xadc_mon_exit();
+
+    //fprintf(stderr, "rp_app_exit: calling fpga_exit()\n");
+    fpga_exit();
+
     //fprintf(stderr, "rp_app_exit: END.\n");
     //fprintf(stderr, "RadioBox unloaded\n\n");
     return 0;
@@ -119,10 +148,63 @@ int rp_app_exit(void)
 
 
 /*----------------------------------------------------------------------------*/
-int rp_set_params(rp_app_params_t* p, int len)
+static void rp_set_params_begin(void)
 {
-    rp_app_params_t* p_copy = NULL;
+    /* create a local copy to release the caller. While the worker has not taken the previous
+     * packet yet, e.g. during a knob drag, the new values are merged into it and reach the FPGA
+     * with one update pass. The block is of fixed size, no memory is allocated here.
+     */
+    pthread_mutex_lock(&g_rp_cb_in_params_mutex);
+    if (!g_rb_cb_in_params.count) {
+        clock_gettime(CLOCK_MONOTONIC, &g_rp_cb_in_params_queued);
+        g_rp_cb_in_params_sets = 0;
+    }
+}
+
+/*----------------------------------------------------------------------------*/
+static void rp_set_params_end(double pktIdx)
+{
+    g_rp_cb_in_params_sets++;
+
+    /* set current pktIdx */
+    if (pktIdx >= 0.0) {
+        g_transport_pktIdx = (int) pktIdx | 0x80;                                                       // 0x80 flag: processing changed data
+    }
+
+    /* wake up the worker */
+    pthread_cond_broadcast(&g_rp_cb_in_params_cond);
+    pthread_mutex_unlock(&g_rp_cb_in_params_mutex);
+}
+
+/*----------------------------------------------------------------------------*/
+static void rp_get_params_wait(rb_app_params_t params[RB_PARAMS_NUM + 1])
+{
+    /* wait until the worker has processed the input data */
+    //fprintf(stderr, "?.. rp_get_params: waiting for worker has processed the input data - waiting ...\n");
+    pthread_mutex_lock(&g_rp_cb_in_params_mutex);
+    while (g_transport_pktIdx & 0x80) {
+        /* wait for the worker to process previous job */
+        pthread_cond_wait(&g_rp_cb_in_params_cond, &g_rp_cb_in_params_mutex);
+    }
+    pthread_mutex_unlock(&g_rp_cb_in_params_mutex);
+    //fprintf(stderr, "?.. rp_get_params: waiting for worker has processed data - done.\n");
+
+    //fprintf(stderr, "?.. rp_get_params: waiting for worker has exported the current params data - waiting ...\n");
+    if (worker_get_params(params) < 0) {
+        pthread_mutex_lock(&g_rb_info_worker_params_mutex);
+        while (worker_get_params(params) < 0) {
+            /* wait for the worker to export its first params data */
+            pthread_cond_wait(&g_rb_info_worker_params_cond, &g_rb_info_worker_params_mutex);
+        }
+        pthread_mutex_unlock(&g_rb_info_worker_params_mutex);
+    }
+    //fprintf(stderr, "?.. rp_get_params: waiting for worker has exported the current params data - done.\n");
+}
+
 
+/*----------------------------------------------------------------------------*/
+int rp_set_params(rp_app_params_t* p, int len)
+{
     //fprintf(stderr, "!!! rp_set_params: BEGIN\n");
 
     if (!p || (len < 0)) {
@@ -133,71 +215,57 @@ int rp_set_params(rp_app_params_t* p, int len)
         return 0;
     }
 
-    /* create a local copy to release the caller */
-    pthread_mutex_lock(&g_rp_cb_in_params_mutex);
-    do {
-        p_copy = g_rp_cb_in_params;
-        if (!p_copy) {
-            //fprintf(stderr, "DEBUG rp_set_params: g_rp_cb_in_params - rp_copy_params(&g_rp_cb_in_params, p, ) ...\n");
-            rp_copy_params(&g_rp_cb_in_params, p, len, !g_params_init_done);                            // piping to the worker thread
-            break;
-
-        } else {
-            pthread_mutex_unlock(&g_rp_cb_in_params_mutex);
-            /* wait for the worker to process previous job */
-            usleep(10000);
-            pthread_mutex_lock(&g_rp_cb_in_params_mutex);
-        }
-    } while (1);
-    pthread_mutex_unlock(&g_rp_cb_in_params_mutex);
-
-    /* set current pktIdx */
     int idx = rp_find_parms_index(p, TRANSPORT_pktIdx);
-    g_transport_pktIdx = (int) (p[idx].value) | 0x80;                                                   // 0x80 flag: processing changed data
+
+    rp_set_params_begin();
+    //fprintf(stderr, "DEBUG rp_set_params: g_rb_cb_in_params - rb_params_block_merge(&g_rb_cb_in_params, p, ) ...\n");
+    rb_params_block_merge(&g_rb_cb_in_params, p, len);                                                  // piping to the worker thread
+    rp_set_params_end((idx >= 0) ?  p[idx].value : -1.0);
 
     //fprintf(stderr, "!!! rp_set_params: END - pktIdx = %s = %lf\n", p[0].name, p[0].value);
     return 0;
 }
 
+/*----------------------------------------------------------------------------*/
+int rp_set_params_hd(rp_app_params_hd_t* p, int len)
+{
+    if (!p || (len < 0)) {
+        fprintf(stderr, "ERROR rp_set_params_hd - non-valid parameter\n");
+        return -1;
+
+    } else if (!len) {                                                                                  // short-cut
+        return 0;
+    }
+
+    double pktIdx = -1.0;
+    int i;
+    for (i = 0; (i < len) && p[i].name; i++) {
+        if (!strcmp(TRANSPORT_pktIdx, p[i].name)) {
+            pktIdx = p[i].value;
+            break;
+        }
+    }
+
+    rp_set_params_begin();
+    rb_params_block_merge_hd(&g_rb_cb_in_params, p, len);                                               // piping to the worker thread
+    rp_set_params_end(pktIdx);
+    return 0;
+}
+
 /*----------------------------------------------------------------------------*/
 int rp_get_params(rp_app_params_t** p)
 {
+    rb_app_params_t  l_params[RB_PARAMS_NUM + 1];
     rp_app_params_t* p_copy = NULL;
     int count = 0;
 
     //fprintf(stderr, "??? rp_get_params: BEGIN\n");
 
-    /* wait until the worker has processed the input data */
-    //fprintf(stderr, "?.. rp_get_params: waiting for worker has processed the input data - waiting ...\n");
-    do {
-        if (!(g_transport_pktIdx & 0x80)) {
-            break;
-
-        } else {
-            /* wait for the worker to process previous job */
-            usleep(1000);
-        }
-    } while (1);
-    //fprintf(stderr, "?.. rp_get_params: waiting for worker has processed data - done.\n");
+    rp_get_params_wait(l_params);
+    telemetry_get_params(l_params);
 
-    //fprintf(stderr, "?.. rp_get_params: waiting for worker has exported the current params data - waiting ...\n");
-    pthread_mutex_lock(&g_rb_info_worker_params_mutex);
-    do {
-        if (g_rb_info_worker_params) {
-            /* get the memory - free() is called by the caller */
-            count = rp_copy_params_rb2rp(&p_copy, g_rb_info_worker_params);
-            break;
-
-        } else {
-            pthread_mutex_unlock(&g_rb_info_worker_params_mutex);
-            /* wait for the worker to export its current params data */
-            //pthread_yield();
-            usleep(1000);
-            pthread_mutex_lock(&g_rb_info_worker_params_mutex);
-        }
-    } while (1);
-    pthread_mutex_unlock(&g_rb_info_worker_params_mutex);
-    //fprintf(stderr, "?.. rp_get_params: waiting for worker has exported the current params data - done.\n");
+    /* get the memory - free() is called by the caller */
+    count = rp_copy_params_rb2rp(&p_copy, l_params);
 
     //fprintf(stderr, "?-> rp_get_params - having list with count = %d\n", count);
     *p = p_copy;
@@ -206,6 +274,21 @@ int rp_get_params(rp_app_params_t** p)
     return count;
 }
 
+/*----------------------------------------------------------------------------*/
+int rp_get_params_hd(rp_app_params_hd_t** p)
+{
+    rb_app_params_t     l_params[RB_PARAMS_NUM + 1];
+    rp_app_params_hd_t* p_copy = NULL;
+
+    rp_get_params_wait(l_params);
+    telemetry_get_params(l_params);
+
+    /* get the memory - free() is called by the caller */
+    int count = rp_copy_params_rb2hd(&p_copy, l_params);
+    *p = p_copy;
+    return count;
+}
+
 /*----------------------------------------------------------------------------*/
 int rp_get_signals(float*** s, int* trc_num, int* trc_len)
 {
@@ -217,8 +300,9 @@ int rp_get_signals(float*** s, int* trc_num, int* trc_len)
         return -1;
     }
 
+    /* the worker fills the traces with each sweep: frequency, RX signal strength, RX_AFC_CORDIC magnitude */
+    ret_val = worker_get_signals(s, trc_len);
     *trc_num = TRACE_NUM;
-    *trc_len = TRACE_LENGTH;
 
     //fprintf(stderr, "rp_get_signals: END\n");
     return ret_val;
@@ -52,6 +52,27 @@ int rp_set_params(rp_app_params_t* p, int len);
  */
 int rp_get_params(rp_app_params_t** p);
 
+/** @brief Same as rp_set_params() with double precision values, used by web-servers that know about it
+ *
+ * Frequencies are received as plain doubles, quad encoded values are still accepted.
+ *
+ * @param[in]    p    Parameter list of data received from the web front-end.
+ * @param[in]    len  The count of parameters in the list p.
+ * @retval       0    Success.
+ * @retval       -1   Failed due to bad parameter.
+ */
+int rp_set_params_hd(rp_app_params_hd_t* p, int len);
+
+/** @brief Same as rp_get_params() with double precision values, used by web-servers that know about it
+ *
+ * Frequencies are returned as plain doubles instead of four quad encoded floats each.
+ * The returned parameter vector has to be free'd by the caller!
+ *
+ * @param[inout] p    The parameter vector is returned. Do free the resources before dropping.
+ * @retval       int  Number of parameters in the vector.
+ */
+int rp_get_params_hd(rp_app_params_hd_t** p);
+
 int rp_get_signals(float*** s, int* sig_num, int* sig_len);
 
 /** @} */
@@ -12,6 +12,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include <string.h>
 #include <math.h>
 #include <time.h>
@@ -33,11 +34,6 @@
 /** @brief calibration data layout within the EEPROM device */
 extern rp_calib_params_t    g_rp_main_calib_params;
 
-/** @brief CallBack copy of params from the worker when requested */
-extern rb_app_params_t*     g_rb_info_worker_params;
-/** @brief Holds mutex to access on parameters from the worker thread to any other context */
-extern pthread_mutex_t      g_rb_info_worker_params_mutex;
-
 /** @brief The RadioBox memory file descriptor used to mmap() the FPGA space. */
 extern int                  g_fpga_rb_mem_fd;
 /** @brief The RadioBox memory layout of the FPGA registers. */
@@ -54,6 +50,158 @@ const char fn_bit_orig[]  = "/opt/redpitaya/fpga/fpga.bit_orig";
 const char fn_bit_fresh[] = "/opt/redpitaya/www/apps/radiobox/fpga.bit";
 
 
+/** @brief Result period of the RX_AFC_CORDIC engine, running at 200 kHz. */
+#define FPGA_RB_CALIB_PERIOD_NS     5000L
+
+/** @brief Settling time of the RX path after the ADC offset value is changed. */
+#define FPGA_RB_CALIB_SETTLE_NS     (4 * FPGA_RB_CALIB_PERIOD_NS)
+
+
+/** @brief Word index of a register within the RadioBox register file. */
+#define FPGA_RB_IDX(reg)            (offsetof(fpga_rb_reg_mem_t, reg) >> 2)
+
+/** @brief Stages a register value in the shadow register file, see fpga_rb_shadow_commit(). */
+#define FPGA_RB_WR(reg, value)      fpga_rb_shadow_write(FPGA_RB_IDX(reg), (uint32_t) (value))
+
+/** @brief Writes a register value to the shadow register file and to the FPGA at once. */
+#define FPGA_RB_WR_THRU(reg, value) fpga_rb_shadow_write_thru(FPGA_RB_IDX(reg), (uint32_t) (value))
+
+/** @brief Reads a register value from the shadow register file, fetched from the FPGA when not known. */
+#define FPGA_RB_RD(reg)             fpga_rb_shadow_read(FPGA_RB_IDX(reg))
+
+/** @brief Writes two values to a register in direct succession, the shadow keeps the second one. */
+#define FPGA_RB_PULSE(reg, v1, v2)  fpga_rb_shadow_pulse(FPGA_RB_IDX(reg), (uint32_t) (v1), (uint32_t) (v2))
+
+
+/** @brief Shadow register file: last value written to or read from each register of the FPGA. */
+static uint32_t s_fpga_rb_shadow[FPGA_RB_REG_WORDS];
+
+/** @brief Bitmap of shadow words holding the current content of the FPGA register. */
+static uint32_t s_fpga_rb_shadow_valid[(FPGA_RB_REG_WORDS + 31) >> 5];
+
+/** @brief Bitmap of shadow words waiting to be written to the FPGA. */
+static uint32_t s_fpga_rb_shadow_dirty[(FPGA_RB_REG_WORDS + 31) >> 5];
+
+/** @brief LO word indexes of all 48 bit register pairs, the HI word follows directly. */
+static const uint16_t s_fpga_rb_shadow_pairs[] = {
+    FPGA_RB_IDX(tx_car_osc_inc_lo),
+    FPGA_RB_IDX(tx_car_osc_ofs_lo),
+    FPGA_RB_IDX(tx_car_osc_inc_scnr_lo),
+    FPGA_RB_IDX(tx_mod_osc_inc_lo),
+    FPGA_RB_IDX(tx_mod_osc_ofs_lo),
+    FPGA_RB_IDX(tx_mod_qmix_ofs_lo),
+    FPGA_RB_IDX(rx_car_calc_weaver_inc_lo),
+    FPGA_RB_IDX(rx_car_osc_inc_lo),
+    FPGA_RB_IDX(rx_car_osc_ofs_lo),
+    FPGA_RB_IDX(rx_car_osc_inc_scnr_lo),
+    FPGA_RB_IDX(rx_mod_osc_inc_lo),
+    FPGA_RB_IDX(rx_mod_osc_ofs_lo)
+};
+
+
+/*----------------------------------------------------------------------------*/
+static void fpga_rb_shadow_write(unsigned int idx, uint32_t value)
+{
+    const uint32_t bit = 1UL << (idx & 0x1f);
+
+    if ((s_fpga_rb_shadow_valid[idx >> 5] & bit) && (s_fpga_rb_shadow[idx] == value)) {
+        return;  // FPGA already holds that value
+    }
+
+    s_fpga_rb_shadow[idx]              = value;
+    s_fpga_rb_shadow_valid[idx >> 5]  |= bit;
+    s_fpga_rb_shadow_dirty[idx >> 5]  |= bit;
+}
+
+/*----------------------------------------------------------------------------*/
+static uint32_t fpga_rb_shadow_read(unsigned int idx)
+{
+    const uint32_t bit = 1UL << (idx & 0x1f);
+
+    if (!(s_fpga_rb_shadow_valid[idx >> 5] & bit) && g_fpga_rb_reg_mem) {
+        s_fpga_rb_shadow[idx]              = ((volatile uint32_t*) g_fpga_rb_reg_mem)[idx];
+        s_fpga_rb_shadow_valid[idx >> 5]  |= bit;
+    }
+    return s_fpga_rb_shadow[idx];
+}
+
+/*----------------------------------------------------------------------------*/
+static void fpga_rb_shadow_invalidate(unsigned int idx)
+{
+    const uint32_t bit = 1UL << (idx & 0x1f);
+
+    if (!(s_fpga_rb_shadow_dirty[idx >> 5] & bit)) {  // a pending write wins
+        s_fpga_rb_shadow_valid[idx >> 5] &= ~bit;
+    }
+}
+
+/*----------------------------------------------------------------------------*/
+static void fpga_rb_shadow_write_thru(unsigned int idx, uint32_t value)
+{
+    const uint32_t bit = 1UL << (idx & 0x1f);
+
+    fpga_rb_shadow_commit();  // keep the order of the writes
+
+    s_fpga_rb_shadow[idx]              = value;
+    s_fpga_rb_shadow_valid[idx >> 5]  |= bit;
+    if (g_fpga_rb_reg_mem) {
+        ((volatile uint32_t*) g_fpga_rb_reg_mem)[idx] = value;
+    }
+}
+
+/*----------------------------------------------------------------------------*/
+static void fpga_rb_shadow_pulse(unsigned int idx, uint32_t value1, uint32_t value2)
+{
+    fpga_rb_shadow_write_thru(idx, value1);
+    fpga_rb_shadow_write_thru(idx, value2);
+}
+
+/*----------------------------------------------------------------------------*/
+void fpga_rb_shadow_reset(void)
+{
+    memset(s_fpga_rb_shadow_valid, 0, sizeof(s_fpga_rb_shadow_valid));
+    memset(s_fpga_rb_shadow_dirty, 0, sizeof(s_fpga_rb_shadow_dirty));
+}
+
+/*----------------------------------------------------------------------------*/
+void fpga_rb_shadow_commit(void)
+{
+    volatile uint32_t* regs = (volatile uint32_t*) g_fpga_rb_reg_mem;
+    unsigned int w;
+
+    if (!regs) {
+        return;
+    }
+
+    /* a 48 bit value is always written as a whole */
+    for (w = 0; w < sizeof(s_fpga_rb_shadow_pairs) / sizeof(s_fpga_rb_shadow_pairs[0]); w++) {
+        const unsigned int lo = s_fpga_rb_shadow_pairs[w];
+        const unsigned int hi = lo + 1;
+
+        if (((s_fpga_rb_shadow_dirty[lo >> 5] >> (lo & 0x1f)) | (s_fpga_rb_shadow_dirty[hi >> 5] >> (hi & 0x1f))) & 1) {
+            fpga_rb_shadow_read(lo);  // a pair half never written so far is taken from the FPGA
+            fpga_rb_shadow_read(hi);
+            s_fpga_rb_shadow_dirty[lo >> 5] |= 1UL << (lo & 0x1f);
+            s_fpga_rb_shadow_dirty[hi >> 5] |= 1UL << (hi & 0x1f);
+        }
+    }
+
+    /* ascending address order, LO before HI */
+    for (w = 0; w < sizeof(s_fpga_rb_shadow_dirty) / sizeof(s_fpga_rb_shadow_dirty[0]); w++) {
+        uint32_t dirty = s_fpga_rb_shadow_dirty[w];
+
+        s_fpga_rb_shadow_dirty[w] = 0;
+        while (dirty) {
+            const unsigned int bitpos = __builtin_ctz(dirty);
+            const unsigned int idx    = (w << 5) + bitpos;
+
+            regs[idx] = s_fpga_rb_shadow[idx];
+            dirty &= dirty - 1;
+        }
+    }
+}
+
+
 /*----------------------------------------------------------------------------*/
 int fpga_rb_init(void)
 {
@@ -92,6 +240,9 @@ int fpga_rb_init(void)
         }
     }
 
+    // output gain compensation tables
+    compensation_init();
+
     // enable RadioBox sub-module
     fpga_rb_reset();
     fpga_rb_enable(1);
@@ -113,6 +264,9 @@ int fpga_rb_exit(void)
         fprintf(stderr, "ERROR - fpga_rb_exit: g_fpga_rb_reg_mem - munmap() failed: %s\n", strerror(errno));
     }
 
+    /* a mapping made later on may see a different FPGA content */
+    fpga_rb_shadow_reset();
+
     //fprintf(stderr, "fpga_rb_exit: END\n");
     return 0;
 }
@@ -128,26 +282,26 @@ void fpga_rb_enable(int enable)
 
     if (enable) {
         // enable RadioBox
-        g_fpga_rb_reg_mem->ctrl           = 0x00000001;    // enable RB sub-module
+        FPGA_RB_WR_THRU(ctrl, 0x00000001);                 // enable RB sub-module
 
-        g_fpga_rb_reg_mem->src_con_pnt    = 0x301C0000;    // disable RB LEDs, set RFOUT1 to AMP_RF output and RFOUT2 to RX_MOD_ADD output
-        g_fpga_rb_reg_mem->tx_muxin_gain  = 0x00007FFF;    // open Mic gain 1:1 (FS = 2Vpp) = 80 % Mic gain setting
+        FPGA_RB_WR_THRU(src_con_pnt, 0x301C0000);          // disable RB LEDs, set RFOUT1 to AMP_RF output and RFOUT2 to RX_MOD_ADD output
+        FPGA_RB_WR_THRU(tx_muxin_gain, 0x00007FFF);        // open Mic gain 1:1 (FS = 2Vpp) = 80 % Mic gain setting
 
-        g_fpga_rb_reg_mem->tx_amp_rf_gain = 0x00000C80;    // open RF output at -10 dBm (= 200 mVpp @ 50 Ohm)
-        g_fpga_rb_reg_mem->tx_amp_rf_ofs  = 0;             // no corrections done
+        FPGA_RB_WR_THRU(tx_amp_rf_gain, 0x00000C80);       // open RF output at -10 dBm (= 200 mVpp @ 50 Ohm)
+        FPGA_RB_WR_THRU(tx_amp_rf_ofs, 0);                 // no corrections done
 
     } else {
         //fprintf(stderr, "fpga_rb_enable: turning off RB LEDs\n");
-        g_fpga_rb_reg_mem->src_con_pnt    = 0x00000000;    // disable RB LEDs, RFOUT1 and RFOUT2
-        g_fpga_rb_reg_mem->tx_muxin_gain  = 0x00000000;    // shut Mic input
+        FPGA_RB_WR_THRU(src_con_pnt, 0x00000000);          // disable RB LEDs, RFOUT1 and RFOUT2
+        FPGA_RB_WR_THRU(tx_muxin_gain, 0x00000000);        // shut Mic input
 
-        g_fpga_rb_reg_mem->tx_amp_rf_gain = 0;             // no output
+        FPGA_RB_WR_THRU(tx_amp_rf_gain, 0);                // no output
 
-        g_fpga_rb_reg_mem->rx_muxin_src   = 0x00000000;    // disable receiver input MUX
+        FPGA_RB_WR_THRU(rx_muxin_src, 0x00000000);         // disable receiver input MUX
 
         // disable RadioBox
         //fprintf(stderr, "fpga_rb_enable: disabling RB sub-module\n");
-        g_fpga_rb_reg_mem->ctrl           = 0x00000000;    // disable RB sub-module
+        FPGA_RB_WR_THRU(ctrl, 0x00000000);                 // disable RB sub-module
     }
 
     //fprintf(stderr, "DEBUG - fpga_rb_enable(%d): END\n", enable);
@@ -163,40 +317,40 @@ void fpga_rb_reset(void)
     //fprintf(stderr, "INFO - fpga_rb_reset\n");
 
     /* reset all registers of the TX_MOD_OSC to get fixed phase of 0 deg */
-    g_fpga_rb_reg_mem->tx_mod_osc_inc_lo = 0;
-    g_fpga_rb_reg_mem->tx_mod_osc_inc_hi = 0;
-    g_fpga_rb_reg_mem->tx_mod_osc_ofs_lo = 0;
-    g_fpga_rb_reg_mem->tx_mod_osc_ofs_hi = 0;
+    FPGA_RB_WR_THRU(tx_mod_osc_inc_lo, 0);
+    FPGA_RB_WR_THRU(tx_mod_osc_inc_hi, 0);
+    FPGA_RB_WR_THRU(tx_mod_osc_ofs_lo, 0);
+    FPGA_RB_WR_THRU(tx_mod_osc_ofs_hi, 0);
 
     /* reset all registers of the TX_CAR_OSC to get fixed phase of 0 deg */
-    g_fpga_rb_reg_mem->tx_car_osc_inc_lo = 0;
-    g_fpga_rb_reg_mem->tx_car_osc_inc_hi = 0;
-    g_fpga_rb_reg_mem->tx_car_osc_ofs_lo = 0;
-    g_fpga_rb_reg_mem->tx_car_osc_ofs_hi = 0;
+    FPGA_RB_WR_THRU(tx_car_osc_inc_lo, 0);
+    FPGA_RB_WR_THRU(tx_car_osc_inc_hi, 0);
+    FPGA_RB_WR_THRU(tx_car_osc_ofs_lo, 0);
+    FPGA_RB_WR_THRU(tx_car_osc_ofs_hi, 0);
 
     /* reset all registers of the RX_MOD_OSC to get fixed phase of 0 deg */
-    g_fpga_rb_reg_mem->rx_mod_osc_inc_lo = 0;
-    g_fpga_rb_reg_mem->rx_mod_osc_inc_hi = 0;
-    g_fpga_rb_reg_mem->rx_mod_osc_ofs_lo = 0;
-    g_fpga_rb_reg_mem->rx_mod_osc_ofs_hi = 0;
+    FPGA_RB_WR_THRU(rx_mod_osc_inc_lo, 0);
+    FPGA_RB_WR_THRU(rx_mod_osc_inc_hi, 0);
+    FPGA_RB_WR_THRU(rx_mod_osc_ofs_lo, 0);
+    FPGA_RB_WR_THRU(rx_mod_osc_ofs_hi, 0);
 
     /* reset all registers of the RX_CAR_OSC to get fixed phase of 0 deg */
-    g_fpga_rb_reg_mem->rx_car_osc_inc_lo = 0;
-    g_fpga_rb_reg_mem->rx_car_osc_inc_hi = 0;
-    g_fpga_rb_reg_mem->rx_car_osc_ofs_lo = 0;
-    g_fpga_rb_reg_mem->rx_car_osc_ofs_hi = 0;
+    FPGA_RB_WR_THRU(rx_car_osc_inc_lo, 0);
+    FPGA_RB_WR_THRU(rx_car_osc_inc_hi, 0);
+    FPGA_RB_WR_THRU(rx_car_osc_ofs_lo, 0);
+    FPGA_RB_WR_THRU(rx_car_osc_ofs_hi, 0);
 
     /* send resync to all oscillators to zero phase registers, all streams are turned off */
-    g_fpga_rb_reg_mem->ctrl = 0x10101011;
+    FPGA_RB_WR_THRU(ctrl, 0x10101011);
 
     /* send resync and reset to all oscillators */
-    g_fpga_rb_reg_mem->ctrl = 0x10161017;
+    FPGA_RB_WR_THRU(ctrl, 0x10161017);
 
     /* send resync to all oscillators to zero phase registers */
-    g_fpga_rb_reg_mem->ctrl = 0x10101011;
+    FPGA_RB_WR_THRU(ctrl, 0x10101011);
 
     /* run mode of both oscillators */
-    g_fpga_rb_reg_mem->ctrl = 0x00000001;
+    FPGA_RB_WR_THRU(ctrl, 0x00000001);
 }
 
 /*----------------------------------------------------------------------------*/
@@ -275,7 +429,7 @@ void fpga_rb_reload_fpga()
 void fpga_rb_calib(int calib, int enabled)
 {
     if (calib > 0) {
-        rp_measure_calib_params(&g_rp_main_calib_params);
+        rp_calib_adc_offsets(&g_rp_main_calib_params, 1);
     }
 
     fpga_rb_enable(enabled);
@@ -284,29 +438,7 @@ void fpga_rb_calib(int calib, int enabled)
 /*----------------------------------------------------------------------------*/
 int fpga_rb_update_all_params(rb_app_params_t* pb, rb_app_params_t** p_pn)  // pb: base data of complete data set, pn: new overwriting data sets
 {
-    int    loc_rb_run         = 0;
-    int    loc_rb_calib       = 0;
-    int    loc_tx_modsrc      = 0;
-    int    loc_tx_modtyp      = 0;
-    int    loc_rx_modtyp      = 0;
-    int    loc_led_csp        = 0;
-    int    loc_rfout1_csp     = 0;
-    int    loc_rfout2_csp     = 0;
-    int    loc_rx_muxin_src   = 0;
-    double loc_tx_car_osc_qrg = 0.0;
-    double loc_rx_car_osc_qrg = 0.0;
-    double loc_tx_mod_osc_qrg = 0.0;
-    int    loc_tx_amp_rf_gain = 0;
-    int    loc_tx_mod_osc_mag = 0;
-    int    loc_tx_muxin_gain  = 0;
-    int    loc_rx_muxin_gain  = 0;
-    int    loc_tx_qrg_sel     = 0;
-    int    loc_rx_qrg_sel     = 0;
-    int    loc_rfout1_term    = 0;
-    int    loc_rfout2_term    = 0;
-    int    loc_qrg_inc        = 0;
-    int    loc_ac97_lil       = 0;
-    int    loc_ac97_lir       = 0;
+    double loc[RB_PARAMS_NUM];  // values indexed by parameter ID
 
     //fprintf(stderr, "DEBUG - fpga_rb_update_all_params: BEGIN\n");
 
@@ -324,40 +456,17 @@ int fpga_rb_update_all_params(rb_app_params_t* pb, rb_app_params_t** p_pn)  // p
     {
         //fprintf(stderr, "DEBUG - fpga_rb_update_all_params: getting local data: ...\n");
         //print_rb_params(pb);
-        loc_rb_run         = (int) pb[RB_RUN].value;
-        loc_rb_calib       = 0;
-        loc_tx_modsrc      = (int) pb[RB_TX_MODSRC].value;
-        loc_tx_modtyp      = (int) pb[RB_TX_MODTYP].value;
-        loc_rx_modtyp      = (int) pb[RB_RX_MODTYP].value;
-        loc_led_csp        = (int) pb[RB_LED_CON_SRC_PNT].value;
-        loc_rfout1_csp     = (int) pb[RB_RFOUT1_CON_SRC_PNT].value;
-        loc_rfout2_csp     = (int) pb[RB_RFOUT2_CON_SRC_PNT].value;
-        loc_rx_muxin_src   = (int) pb[RB_RX_MUXIN_SRC].value;
-
-        loc_tx_car_osc_qrg = pb[RB_TX_CAR_OSC_QRG].value;
-        loc_rx_car_osc_qrg = pb[RB_RX_CAR_OSC_QRG].value;
-
-        loc_tx_mod_osc_qrg = pb[RB_TX_MOD_OSC_QRG].value;
-        loc_tx_muxin_gain  = (int) pb[RB_TX_MUXIN_GAIN].value;
-        loc_rx_muxin_gain  = (int) pb[RB_RX_MUXIN_GAIN].value;
-        loc_tx_qrg_sel     = (int) pb[RB_TX_QRG_SEL].value;
-        loc_rx_qrg_sel     = (int) pb[RB_RX_QRG_SEL].value;
-
-        loc_tx_amp_rf_gain = (int) pb[RB_TX_AMP_RF_GAIN].value;
-        loc_tx_mod_osc_mag = (int) pb[RB_TX_MOD_OSC_MAG].value;
-        loc_rfout1_term    = (int) pb[RB_RFOUT1_TERM].value;
-        loc_rfout2_term    = (int) pb[RB_RFOUT2_TERM].value;
-        loc_qrg_inc        = (int) pb[RB_QRG_INC].value;
-        loc_ac97_lil       = (int) pb[RB_AC97_LOL].value;
-        loc_ac97_lir       = (int) pb[RB_AC97_LOR].value;
+        int id;
+        for (id = 0; id < RB_PARAMS_NUM; id++) {
+            loc[id] = pb[id].value;
+        }
+        loc[RB_CALIB] = 0.0;
         //fprintf(stderr, "DEBUG - fpga_rb_update_all_params: ... done.\n");
     }
 
     int idx;
     for (idx = 0; pn[idx].name; idx++) {
-        if (!(pn[idx].name)) {
-            break;  // end of list
-        }
+        const int id = pn[idx].id;
 
         if (!(pn[idx].fpga_update & 0x80)) {  // MARKer set?
             //fprintf(stderr, "DEBUG - fpga_rb_update_all_params: skipped not modified parameter (name=%s)\n", pn[idx].name);
@@ -368,118 +477,40 @@ int fpga_rb_update_all_params(rb_app_params_t* pb, rb_app_params_t** p_pn)  // p
         /* Remove the marker */
         pn[idx].fpga_update &= ~0x80;
 
-        /* Since here process on each known parameter accordingly */
-        if (!strcmp("rb_run", pn[idx].name)) {
-            //fprintf(stderr, "INFO - fpga_rb_update_all_params: #got rb_run = %d\n", (int) (pn[idx].value));
-            loc_rb_run = ((int) (pn[idx].value));
-            fpga_rb_enable(loc_rb_run);
-
-        } else if (!strcmp("rb_calib", pn[idx].name)) {
-            //fprintf(stderr, "INFO - fpga_rb_update_all_params: #got rb_calib = %d\n", (int) (pn[idx].value));
-            loc_rb_calib = ((int) (pn[idx].value));
-            fpga_rb_calib(loc_rb_calib, loc_rb_run);
-            pn[idx].value = 0.0;  // remove single-shot tag
-
-        } else if (!strcmp("tx_modsrc_s", pn[idx].name)) {
-            //fprintf(stderr, "INFO - fpga_rb_update_all_params: #got tx_modsrc_s = %d\n", (int) (pn[idx].value));
-            loc_tx_modsrc = ((int) (pn[idx].value));
-
-        } else if (!strcmp("tx_modtyp_s", pn[idx].name)) {
-            //fprintf(stderr, "INFO - fpga_rb_update_all_params: #got tx_modtyp_s = %d\n", (int) (pn[idx].value));
-            loc_tx_modtyp = ((int) (pn[idx].value));
-
-        } else if (!strcmp("rx_modtyp_s", pn[idx].name)) {
-            //fprintf(stderr, "INFO - fpga_rb_update_all_params: #got rx_modtyp_s = %d\n", (int) (pn[idx].value));
-            loc_rx_modtyp = ((int) (pn[idx].value));
-
-        } else if (!strcmp("rbled_csp_s", pn[idx].name)) {
-            //fprintf(stderr, "INFO - fpga_rb_update_all_params: #got rbled_csp_s = %d\n", (int) (pn[idx].value));
-            loc_led_csp = ((int) (pn[idx].value));
-
-        } else if (!strcmp("rfout1_csp_s", pn[idx].name)) {
-            //fprintf(stderr, "INFO - fpga_rb_update_all_params: #got rfout1_csp_s = %d\n", (int) (pn[idx].value));
-            loc_rfout1_csp = ((int) (pn[idx].value));
-
-        } else if (!strcmp("rfout2_csp_s", pn[idx].name)) {
-            //fprintf(stderr, "INFO - fpga_rb_update_all_params: #got rfout2_csp_s = %d\n", (int) (pn[idx].value));
-            loc_rfout2_csp = ((int) (pn[idx].value));
-
-        } else if (!strcmp("rx_muxin_src_s", pn[idx].name)) {
-            //fprintf(stderr, "INFO - fpga_rb_update_all_params: #got rx_muxin_src_s = %d\n", (int) (pn[idx].value));
-            loc_rx_muxin_src = ((int) (pn[idx].value));
-
-
-        } else if (!strcmp("tx_car_osc_qrg_f", pn[idx].name)) {
-            //fprintf(stderr, "INFO - fpga_rb_update_all_params: #got tx_car_osc_qrg_f = %lf\n", pn[idx].value);
-            loc_tx_car_osc_qrg = pn[idx].value;
-
-        } else if (!strcmp("rx_car_osc_qrg_f", pn[idx].name)) {
-            //fprintf(stderr, "INFO - fpga_rb_update_all_params: #got rx_car_osc_qrg_f = %lf\n", pn[idx].value);
-            loc_rx_car_osc_qrg = pn[idx].value;
-
-
-        } else if (!strcmp("tx_mod_osc_qrg_f", pn[idx].name)) {
-            //fprintf(stderr, "INFO - fpga_rb_update_all_params: #got tx_mod_osc_qrg_f = %lf\n", pn[idx].value);
-            loc_tx_mod_osc_qrg = pn[idx].value;
-
-        } else if (!strcmp("tx_amp_rf_gain_s", pn[idx].name)) {
-            //fprintf(stderr, "INFO - fpga_rb_update_all_params: #got tx_amp_rf_gain_f = %lf\n", pn[idx].value);
-            loc_tx_amp_rf_gain = ((int) pn[idx].value);
-
-        } else if (!strcmp("tx_mod_osc_mag_s", pn[idx].name)) {
-            //fprintf(stderr, "INFO - fpga_rb_update_all_params: #got tx_mod_osc_mag_f = %lf\n", pn[idx].value);
-            loc_tx_mod_osc_mag = ((int) pn[idx].value);
-
-        } else if (!strcmp("tx_muxin_gain_s", pn[idx].name)) {
-            //fprintf(stderr, "INFO - fpga_rb_update_all_params: #got tx_muxin_gain_s = %d\n", pn[idx].value);
-            loc_tx_muxin_gain = ((int) pn[idx].value);
-
-        } else if (!strcmp("rx_muxin_gain_s", pn[idx].name)) {
-            //fprintf(stderr, "INFO - fpga_rb_update_all_params: #got rx_muxin_gain_s = %d\n", pn[idx].value);
-            loc_rx_muxin_gain = ((int) pn[idx].value);
-
-
-        } else if (!strcmp("tx_qrg_sel_s", pn[idx].name)) {
-            //fprintf(stderr, "INFO - fpga_rb_update_all_params: #got tx_qrg_sel_s = %d\n", (int) (pn[idx].value));
-            loc_tx_qrg_sel = ((int) (pn[idx].value));
-
-        } else if (!strcmp("rx_qrg_sel_s", pn[idx].name)) {
-            //fprintf(stderr, "INFO - fpga_rb_update_all_params: #got rx_qrg_sel_s = %d\n", (int) (pn[idx].value));
-            loc_rx_qrg_sel = ((int) (pn[idx].value));
-
-        } else if (!strcmp("rfout1_term_s", pn[idx].name)) {
-            //fprintf(stderr, "INFO - fpga_rb_update_all_params: #got rfout1_term_s = %d\n", (int) (pn[idx].value));
-            loc_rfout1_term = ((int) (pn[idx].value));
-
-        } else if (!strcmp("rfout2_term_s", pn[idx].name)) {
-            //fprintf(stderr, "INFO - fpga_rb_update_all_params: #got rfout2_term_s = %d\n", (int) (pn[idx].value));
-            loc_rfout2_term = ((int) (pn[idx].value));
+        if (id < 0 || id >= RB_PARAMS_NUM) {
+            continue;  // unknown parameter
+        }
 
-        } else if (!strcmp("qrg_inc_s", pn[idx].name)) {
-            //fprintf(stderr, "INFO - fpga_rb_update_all_params: #got qrg_inc_s = %d\n", (int) (pn[idx].value));
-            loc_qrg_inc = ((int) (pn[idx].value));
+        /* Since here process on each known parameter accordingly */
+        //fprintf(stderr, "INFO - fpga_rb_update_all_params: #got %s = %lf\n", pn[idx].name, pn[idx].value);
+        loc[id] = pn[idx].value;
 
-        } else if (!strcmp("ac97_lil_s", pn[idx].name)) {
-            //fprintf(stderr, "INFO - fpga_rb_update_all_params: #got ac97_lil_s = %d\n", (int) (pn[idx].value));
-            loc_ac97_lil = ((int) (pn[idx].value));
+        switch (id) {
+        case RB_RUN:
+            fpga_rb_enable((int) loc[RB_RUN]);
+            break;
 
-        } else if (!strcmp("ac97_lir_s", pn[idx].name)) {
-            //fprintf(stderr, "INFO - fpga_rb_update_all_params: #got ac97_lir_s = %d\n", (int) (pn[idx].value));
-            loc_ac97_lir = ((int) (pn[idx].value));
+        case RB_CALIB:
+            fpga_rb_calib((int) loc[RB_CALIB], (int) loc[RB_RUN]);
+            pn[idx].value = 0.0;  // remove single-shot tag
+            break;
 
-        }  // else if ()
+        default:
+            /* register values are written below, all at once */
+            break;
+        }  // switch ()
     }  // for ()
 
     /* set the new values */
     {
-        if (loc_rb_run) {
-            fpga_rb_set_ctrl(loc_rb_run, loc_tx_modsrc, loc_tx_modtyp, loc_rx_modtyp,
-                    ((loc_rfout2_csp  & 0xff) << 0x18) | ((loc_rfout1_csp  & 0xff) << 0x10) | (loc_led_csp & 0xff),
-                    ((loc_ac97_lir    & 0xff) << 0x08) | ((loc_ac97_lil    & 0xff) << 0x00),
-                    loc_rx_muxin_src,
-                    loc_tx_car_osc_qrg, loc_rx_car_osc_qrg,
-                    loc_tx_mod_osc_qrg, loc_tx_muxin_gain, loc_rx_muxin_gain, loc_tx_qrg_sel, loc_rx_qrg_sel,
-                    loc_tx_amp_rf_gain, loc_tx_mod_osc_mag, loc_rfout1_term, loc_rfout2_term, loc_qrg_inc);
+        if ((int) loc[RB_RUN]) {
+            fpga_rb_set_ctrl((int) loc[RB_RUN], (int) loc[RB_TX_MODSRC], (int) loc[RB_TX_MODTYP], (int) loc[RB_RX_MODTYP],
+                    ((((int) loc[RB_RFOUT2_CON_SRC_PNT]) & 0xff) << 0x18) | ((((int) loc[RB_RFOUT1_CON_SRC_PNT]) & 0xff) << 0x10) | (((int) loc[RB_LED_CON_SRC_PNT]) & 0xff),
+                    ((((int) loc[RB_AC97_LOR])           & 0xff) << 0x08) | ((((int) loc[RB_AC97_LOL])           & 0xff) << 0x00),
+                    (int) loc[RB_RX_MUXIN_SRC],
+                    loc[RB_TX_CAR_OSC_QRG], loc[RB_RX_CAR_OSC_QRG],
+                    loc[RB_TX_MOD_OSC_QRG], (int) loc[RB_TX_MUXIN_GAIN], (int) loc[RB_RX_MUXIN_GAIN], (int) loc[RB_TX_QRG_SEL], (int) loc[RB_RX_QRG_SEL],
+                    (int) loc[RB_TX_AMP_RF_GAIN], (int) loc[RB_TX_MOD_OSC_MAG], (int) loc[RB_RFOUT1_TERM], (int) loc[RB_RFOUT2_TERM], (int) loc[RB_QRG_INC]);
         }
     }
 
@@ -520,21 +551,25 @@ int fpga_rb_get_fpga_params(rb_app_params_t* pb, rb_app_params_t** p_pn)  // pb:
   {
     int idx;
     for (idx = 0; pn[idx].name; idx++) {
-      if (!(pn[idx].name)) {
-        break;  // end of list
-
-      } else if (!strcmp("tx_modtyp_s", pn[idx].name)) {
+      switch (pn[idx].id) {
+      case RB_TX_MODTYP:
         //fprintf(stderr, "INFO - fpga_rb_get_fpga_params: #got tx_modtyp_s = %d, was = %d\n", (int) (pn[idx].value), loc_tx_modtyp);
         loc_tx_modtyp = ((int) (pn[idx].value));
+        break;
 
-      } else if (!strcmp("rx_modtyp_s", pn[idx].name)) {
+      case RB_RX_MODTYP:
         //fprintf(stderr, "INFO - fpga_rb_get_fpga_params: #got rx_modtyp_s = %d, was = %d\n", (int) (pn[idx].value), loc_rx_modtyp);
         loc_rx_modtyp = ((int) (pn[idx].value));
+        break;
 
-      } else if (!strcmp("qrg_inc_s", pn[idx].name)) {
+      case RB_QRG_INC:
         //fprintf(stderr, "INFO - fpga_rb_get_fpga_params: #got qrg_inc_s = %d, was = %d\n", (int) (pn[idx].value), loc_qrg_inc);
         loc_qrg_inc = ((int) (pn[idx].value));
-      }  // else if ()
+        break;
+
+      default:
+        break;
+      }  // switch ()
     }  // for ()
   }
 
@@ -553,11 +588,11 @@ int fpga_rb_get_fpga_params(rb_app_params_t* pb, rb_app_params_t** p_pn)  // pb:
             &loc_RD_ovrdrv);
 
     if (loc_qrg_inc != 50) {
-      rb_update_param(p_pn, "tx_car_osc_qrg_f", loc_RD_tx_car_osc_qrg);
-      rb_update_param(p_pn, "rx_car_osc_qrg_f", loc_RD_rx_car_osc_qrg);
+      rb_update_param(p_pn, RB_TX_CAR_OSC_QRG, loc_RD_tx_car_osc_qrg);
+      rb_update_param(p_pn, RB_RX_CAR_OSC_QRG, loc_RD_rx_car_osc_qrg);
     }
 
-    rb_update_param(p_pn, "ovrdrv_s", loc_RD_ovrdrv);
+    rb_update_param(p_pn, RB_OVRDRV, loc_RD_ovrdrv);
 
     //print_rb_params(*p_pn);
   }
@@ -567,6 +602,19 @@ int fpga_rb_get_fpga_params(rb_app_params_t* pb, rb_app_params_t** p_pn)  // pb:
 }
 
 
+/*----------------------------------------------------------------------------*/
+static int fpga_rb_tx_car_osc_scanning(void)
+{
+    return FPGA_RB_RD(tx_car_osc_inc_scnr_lo) || FPGA_RB_RD(tx_car_osc_inc_scnr_hi);
+}
+
+/*----------------------------------------------------------------------------*/
+static int fpga_rb_rx_car_osc_scanning(void)
+{
+    return FPGA_RB_RD(rx_car_osc_inc_scnr_lo) || FPGA_RB_RD(rx_car_osc_inc_scnr_hi);
+}
+
+
 /*----------------------------------------------------------------------------*/
 void fpga_rb_set_ctrl(int rb_run, int tx_modsrc, int tx_modtyp, int rx_modtyp, int src_con_pnt, int src_con_pnt2, int rx_muxin_src,
         double tx_car_osc_qrg, double rx_car_osc_qrg,
@@ -666,8 +714,8 @@ void fpga_rb_set_ctrl(int rb_run, int tx_modsrc, int tx_modtyp, int rx_modtyp, i
       fpga_rb_set_rfout1_gain_ofs(rfout1_amp_gain, calib_get_DAC_offset(&g_rp_main_calib_params, 0x20));   // RFOUT1_AMP    gain correction setting of the RF Output 1 line, DAC offset value
       fpga_rb_set_rfout2_gain_ofs(rfout2_amp_gain, calib_get_DAC_offset(&g_rp_main_calib_params, 0x21));   // RFOUT2_AMP    gain correction setting of the RF Output 2 line, DAC offset value
 
-      g_fpga_rb_reg_mem->src_con_pnt  = src_con_pnt;
-      g_fpga_rb_reg_mem->src_con_pnt2 = src_con_pnt2;
+      FPGA_RB_WR(src_con_pnt, src_con_pnt);
+      FPGA_RB_WR(src_con_pnt2, src_con_pnt2);
     }
 
     if (rb_run) {
@@ -683,7 +731,7 @@ void fpga_rb_set_ctrl(int rb_run, int tx_modsrc, int tx_modtyp, int rx_modtyp, i
         //fprintf(stderr, "INFO - fpga_rb_set_ctrl: setting FPGA tx_modsrc to (none)\n");
 
         fpga_rb_set_tx_muxin_gain(0, 0x0000);                                                              // TX MUXIN gain setting
-        g_fpga_rb_reg_mem->tx_muxin_src = 0x00000000;
+        FPGA_RB_WR(tx_muxin_src, 0x00000000);
       }
       break;
 
@@ -691,7 +739,7 @@ void fpga_rb_set_ctrl(int rb_run, int tx_modsrc, int tx_modtyp, int rx_modtyp, i
         //fprintf(stderr, "INFO - fpga_rb_set_ctrl: setting FPGA tx_modsrc to TX_MOD_OSC\n");
 
         fpga_rb_set_tx_muxin_gain(0, 0x0000);                                                              // TX MUXIN gain setting
-        g_fpga_rb_reg_mem->tx_muxin_src = 0x00000000;
+        FPGA_RB_WR(tx_muxin_src, 0x00000000);
       }
       break;
 
@@ -699,8 +747,8 @@ void fpga_rb_set_ctrl(int rb_run, int tx_modsrc, int tx_modtyp, int rx_modtyp, i
         //fprintf(stderr, "INFO - fpga_rb_set_ctrl: setting FPGA tx_modsrc to RF_inp_1\n");
 
         fpga_rb_set_tx_muxin_gain(tx_muxin_gain, calib_get_ADC_offset(&g_rp_main_calib_params, 0x20));     // TX MUXIN gain setting
-        g_fpga_rb_reg_mem->tx_muxin_src = 0x00000020;                                                      // source ID: 32
-        g_fpga_rb_reg_mem->ctrl |= adc_auto_ofs;                                                           // ADC automatic offset compensation
+        FPGA_RB_WR(tx_muxin_src, 0x00000020);                                                              // source ID: 32
+        FPGA_RB_WR(ctrl, FPGA_RB_RD(ctrl) | adc_auto_ofs);                                                 // ADC automatic offset compensation
       }
       break;
 
@@ -708,8 +756,8 @@ void fpga_rb_set_ctrl(int rb_run, int tx_modsrc, int tx_modtyp, int rx_modtyp, i
         //fprintf(stderr, "INFO - fpga_rb_set_ctrl: setting FPGA tx_modsrc to RF_inp_2\n");
 
         fpga_rb_set_tx_muxin_gain(tx_muxin_gain, calib_get_ADC_offset(&g_rp_main_calib_params, 0x21));     // TX MUXIN gain setting
-        g_fpga_rb_reg_mem->tx_muxin_src = 0x00000021;                                                      // source ID: 33
-        g_fpga_rb_reg_mem->ctrl |= adc_auto_ofs;                                                           // ADC automatic offset compensation
+        FPGA_RB_WR(tx_muxin_src, 0x00000021);                                                              // source ID: 33
+        FPGA_RB_WR(ctrl, FPGA_RB_RD(ctrl) | adc_auto_ofs);                                                 // ADC automatic offset compensation
       }
       break;
 
@@ -717,8 +765,8 @@ void fpga_rb_set_ctrl(int rb_run, int tx_modsrc, int tx_modtyp, int rx_modtyp, i
         //fprintf(stderr, "INFO - fpga_rb_set_ctrl: setting FPGA tx_modsrc to AI0\n");
 
         fpga_rb_set_tx_muxin_gain(tx_muxin_gain, calib_get_ADC_offset(&g_rp_main_calib_params, 0x10));     // TX MUXIN gain setting
-        g_fpga_rb_reg_mem->tx_muxin_src = 0x00000010;                                                      // source ID: 16
-        g_fpga_rb_reg_mem->ctrl |= adc_auto_ofs;                                                           // ADC automatic offset compensation
+        FPGA_RB_WR(tx_muxin_src, 0x00000010);                                                              // source ID: 16
+        FPGA_RB_WR(ctrl, FPGA_RB_RD(ctrl) | adc_auto_ofs);                                                 // ADC automatic offset compensation
       }
       break;
 
@@ -726,8 +774,8 @@ void fpga_rb_set_ctrl(int rb_run, int tx_modsrc, int tx_modtyp, int rx_modtyp, i
         //fprintf(stderr, "INFO - fpga_rb_set_ctrl: setting FPGA tx_modsrc to AI1\n");
 
         fpga_rb_set_tx_muxin_gain(tx_muxin_gain, calib_get_ADC_offset(&g_rp_main_calib_params, 0x18));     // TX MUXIN gain setting
-        g_fpga_rb_reg_mem->tx_muxin_src = 0x00000018;                                                      // source ID: 24
-        g_fpga_rb_reg_mem->ctrl |= adc_auto_ofs;                                                           // ADC automatic offset compensation
+        FPGA_RB_WR(tx_muxin_src, 0x00000018);                                                              // source ID: 24
+        FPGA_RB_WR(ctrl, FPGA_RB_RD(ctrl) | adc_auto_ofs);                                                 // ADC automatic offset compensation
       }
       break;
 
@@ -735,8 +783,8 @@ void fpga_rb_set_ctrl(int rb_run, int tx_modsrc, int tx_modtyp, int rx_modtyp, i
         //fprintf(stderr, "INFO - fpga_rb_set_ctrl: setting FPGA tx_modsrc to AI2\n");
 
         fpga_rb_set_tx_muxin_gain(tx_muxin_gain, calib_get_ADC_offset(&g_rp_main_calib_params, 0x11));     // TX MUXIN gain setting
-        g_fpga_rb_reg_mem->tx_muxin_src = 0x00000011;                                                      // source ID: 17
-        g_fpga_rb_reg_mem->ctrl |= adc_auto_ofs;                                                           // ADC automatic offset compensation
+        FPGA_RB_WR(tx_muxin_src, 0x00000011);                                                              // source ID: 17
+        FPGA_RB_WR(ctrl, FPGA_RB_RD(ctrl) | adc_auto_ofs);                                                 // ADC automatic offset compensation
       }
       break;
 
@@ -744,15 +792,15 @@ void fpga_rb_set_ctrl(int rb_run, int tx_modsrc, int tx_modtyp, int rx_modtyp, i
         //fprintf(stderr, "INFO - fpga_rb_set_ctrl: setting FPGA tx_modsrc to AI3\n");
 
         fpga_rb_set_tx_muxin_gain(tx_muxin_gain, calib_get_ADC_offset(&g_rp_main_calib_params, 0x19));     // TX MUXIN gain setting
-        g_fpga_rb_reg_mem->tx_muxin_src = 0x00000019;                                                      // source ID: 25
-        g_fpga_rb_reg_mem->ctrl |= adc_auto_ofs;                                                           // ADC automatic offset compensation
+        FPGA_RB_WR(tx_muxin_src, 0x00000019);                                                              // source ID: 25
+        FPGA_RB_WR(ctrl, FPGA_RB_RD(ctrl) | adc_auto_ofs);                                                 // ADC automatic offset compensation
       }
       break;
 
 #if 0
       case RB_MODSRC_VP_VN: {
         fpga_rb_set_tx_muxin_gain(tx_muxin_gain, calib_get_ADC_offset(&g_rp_main_calib_params, 0x03));     // TX MUXIN gain setting
-        g_fpga_rb_reg_mem->tx_muxin_src = 0x00000003;                                                      // source ID: 3
+        FPGA_RB_WR(tx_muxin_src, 0x00000003);                                                              // source ID: 3
       }
       break;
 #endif
@@ -761,7 +809,7 @@ void fpga_rb_set_ctrl(int rb_run, int tx_modsrc, int tx_modtyp, int rx_modtyp, i
         //fprintf(stderr, "INFO - fpga_rb_set_ctrl: setting FPGA tx_modsrc to AC97 LINEIN Left\n");
 
         fpga_rb_set_tx_muxin_gain(tx_muxin_gain, 0);                                                       // TX MUXIN gain setting
-        g_fpga_rb_reg_mem->tx_muxin_src = 0x00000030;                                                      // source ID: 48
+        FPGA_RB_WR(tx_muxin_src, 0x00000030);                                                              // source ID: 48
       }
       break;
 
@@ -769,7 +817,7 @@ void fpga_rb_set_ctrl(int rb_run, int tx_modsrc, int tx_modtyp, int rx_modtyp, i
         //fprintf(stderr, "INFO - fpga_rb_set_ctrl: setting FPGA tx_modsrc to AC97 LINEIN Right\n");
 
         fpga_rb_set_tx_muxin_gain(tx_muxin_gain, 0);                                                       // TX MUXIN gain setting
-        g_fpga_rb_reg_mem->tx_muxin_src = 0x00000031;                                                      // source ID: 49
+        FPGA_RB_WR(tx_muxin_src, 0x00000031);                                                              // source ID: 49
       }
       break;
 
@@ -784,7 +832,7 @@ void fpga_rb_set_ctrl(int rb_run, int tx_modsrc, int tx_modtyp, int rx_modtyp, i
           //fprintf(stderr, "INFO - fpga_rb_set_ctrl: setting FPGA for TX: off\n");
 
           fpga_rb_set_tx_modtyp(RB_TX_MODTYP_AM);                                                          // enable power if it was absent
-          g_fpga_rb_reg_mem->ctrl &= ~0x00007076;                                                          // TX: turn off all STREAMING, RESET and RESYNC signals
+          FPGA_RB_WR(ctrl, FPGA_RB_RD(ctrl) & ~0x00007076);                                                // TX: turn off all STREAMING, RESET and RESYNC signals
           fpga_rb_set_tx_amp_rf_gain_ofs__4mod_all(0.0, 0.0);                                              // TX_AMP_RF  turn off output
           fpga_rb_set_tx_modtyp(tx_modtyp);                                                                // power savings control: set TX modulation variant
         }
@@ -794,7 +842,7 @@ void fpga_rb_set_ctrl(int rb_run, int tx_modsrc, int tx_modtyp, int rx_modtyp, i
           //fprintf(stderr, "INFO - fpga_rb_set_ctrl: setting FPGA for TX: USB\n");
 
           fpga_rb_set_tx_modtyp(tx_modtyp);                                                                // power savings control: set TX modulation variant
-          g_fpga_rb_reg_mem->ctrl &= ~0x00007076;                                                          // TX: turn off all STREAMING, RESET and RESYNC signals
+          FPGA_RB_WR(ctrl, FPGA_RB_RD(ctrl) & ~0x00007076);                                                // TX: turn off all STREAMING, RESET and RESYNC signals
           fpga_rb_set_tx_amp_rf_gain_ofs__4mod_all(tx_amp_rf_gain * 1.5, 0.0);                             // TX_AMP_RF  gain setting [mV] is global and not modulation dependent
           if (tx_car_osc_qrg_inc == 50) {
             fpga_rb_set_tx_car_osc_qrg__4mod_cw_ssb_am_pm(tx_car_osc_qrg + ssb_weaver_osc_qrg);            // TX_CAR_OSC frequency with ssb_weaver_osc_qrg correction
@@ -810,7 +858,7 @@ void fpga_rb_set_ctrl(int rb_run, int tx_modsrc, int tx_modtyp, int rx_modtyp, i
           //fprintf(stderr, "INFO - fpga_rb_set_ctrl: setting FPGA for TX: LSB\n");
 
           fpga_rb_set_tx_modtyp(tx_modtyp);                                                                // power savings control: set TX modulation variant
-          g_fpga_rb_reg_mem->ctrl &= ~0x00007076;                                                          // TX: turn off all STREAMING, RESET and RESYNC signals
+          FPGA_RB_WR(ctrl, FPGA_RB_RD(ctrl) & ~0x00007076);                                                // TX: turn off all STREAMING, RESET and RESYNC signals
           fpga_rb_set_tx_amp_rf_gain_ofs__4mod_all(tx_amp_rf_gain * 1.5, 0.0);                             // TX_AMP_RF  gain setting [mV] is global and not modulation dependent
           if (tx_car_osc_qrg_inc == 50) {
             fpga_rb_set_tx_car_osc_qrg__4mod_cw_ssb_am_pm(tx_car_osc_qrg - ssb_weaver_osc_qrg);            // TX_CAR_OSC frequency with ssb_weaver_osc_qrg correction
@@ -826,7 +874,7 @@ void fpga_rb_set_ctrl(int rb_run, int tx_modsrc, int tx_modtyp, int rx_modtyp, i
           //fprintf(stderr, "INFO - fpga_rb_set_ctrl: setting FPGA for TX: AM\n");
 
           fpga_rb_set_tx_modtyp(tx_modtyp);                                                                // power savings control: set TX modulation variant
-          g_fpga_rb_reg_mem->ctrl &= ~0x00007076;                                                          // TX: turn off all STREAMING, RESET and RESYNC signals
+          FPGA_RB_WR(ctrl, FPGA_RB_RD(ctrl) & ~0x00007076);                                                // TX: turn off all STREAMING, RESET and RESYNC signals
           fpga_rb_set_tx_amp_rf_gain_ofs__4mod_all(tx_amp_rf_gain, 0.0);                                   // TX_AMP_RF  gain setting [mV] is global and not modulation dependent
           if (tx_car_osc_qrg_inc == 50) {
             fpga_rb_set_tx_car_osc_qrg__4mod_cw_ssb_am_pm(tx_car_osc_qrg);                                 // TX_CAR_OSC frequency
@@ -837,10 +885,12 @@ void fpga_rb_set_ctrl(int rb_run, int tx_modsrc, int tx_modtyp, int rx_modtyp, i
             fpga_rb_set_tx_mod_osc_qrg__4mod_ssbweaver_am_fm_pm(tx_mod_osc_qrg);                           // TX_MOD_OSC frequency
           } else {
             fpga_rb_set_tx_mod_osc_qrg__4mod_ssbweaver_am_fm_pm(0.0);                                      // TX_MOD_OSC turning off
+            fpga_rb_shadow_commit();                                                                       // TX_MOD_OSC stopped before its phase is checked
             if (!(g_fpga_rb_reg_mem->status & 0x00000100)) {
               // TX_MOD_OSC phase not zero: reset phase oscillator
-              g_fpga_rb_reg_mem->ctrl &= ~0x00001000;                                                      // TX_MOD RESYNC activate
-              g_fpga_rb_reg_mem->ctrl |=  0x00001000;                                                      // TX_MOD RESYNC deactivate
+              FPGA_RB_PULSE(ctrl,
+                      FPGA_RB_RD(ctrl) & ~0x00001000,                                                      // TX_MOD RESYNC activate
+                      FPGA_RB_RD(ctrl) |  0x00001000);                                                     // TX_MOD RESYNC deactivate
             }
           }
 
@@ -856,16 +906,18 @@ void fpga_rb_set_ctrl(int rb_run, int tx_modsrc, int tx_modtyp, int rx_modtyp, i
           //fprintf(stderr, "INFO - fpga_rb_set_ctrl: setting FPGA for TX: FM\n");
 
           fpga_rb_set_tx_modtyp(tx_modtyp);                                                                // power savings control: set TX modulation variant
-          g_fpga_rb_reg_mem->ctrl &= ~0x00007056;                                                          // TX: turn off offset STREAMING, RESET and RESYNC signals
+          FPGA_RB_WR(ctrl, FPGA_RB_RD(ctrl) & ~0x00007056);                                                // TX: turn off offset STREAMING, RESET and RESYNC signals
           fpga_rb_set_tx_amp_rf_gain_ofs__4mod_all(tx_amp_rf_gain, 0.0);                                   // TX_AMP_RF  gain setting [mV] is global and not modulation dependent
           if (tx_modsrc == RB_MODSRC_MOD_OSC) {  // TODO scanner does not work for TX_MOD_FM
             fpga_rb_set_tx_mod_osc_qrg__4mod_ssbweaver_am_fm_pm(tx_mod_osc_qrg);                           // TX_MOD_OSC frequency
           } else {
             fpga_rb_set_tx_mod_osc_qrg__4mod_ssbweaver_am_fm_pm(0.0);                                      // TX_MOD_OSC turning off
+            fpga_rb_shadow_commit();                                                                       // TX_MOD_OSC stopped before its phase is checked
             if (!(g_fpga_rb_reg_mem->status & 0x00000100)) {
               // TX_MOD_OSC phase not zero: reset phase oscillator
-              g_fpga_rb_reg_mem->ctrl &= ~0x00001000;                                                      // TX_MOD RESYNC activate
-              g_fpga_rb_reg_mem->ctrl |=  0x00001000;                                                      // TX_MOD RESYNC deactivate
+              FPGA_RB_PULSE(ctrl,
+                      FPGA_RB_RD(ctrl) & ~0x00001000,                                                      // TX_MOD RESYNC activate
+                      FPGA_RB_RD(ctrl) |  0x00001000);                                                     // TX_MOD RESYNC deactivate
             }
           }
 
@@ -874,7 +926,7 @@ void fpga_rb_set_ctrl(int rb_run, int tx_modsrc, int tx_modtyp, int rx_modtyp, i
           } else {
             fpga_rb_set_tx_mod_qmix_gain_ofs__4mod_fm(tx_car_osc_qrg, tx_mod_osc_mag);                     // FM by streaming in DDS increment
           }
-          g_fpga_rb_reg_mem->ctrl |=  0x00000020;                                                          // control: FM by TX_CAR_OSC increment streaming
+          FPGA_RB_WR(ctrl, FPGA_RB_RD(ctrl) | 0x00000020);                                                 // control: FM by TX_CAR_OSC increment streaming
         }
         break;
 
@@ -882,7 +934,7 @@ void fpga_rb_set_ctrl(int rb_run, int tx_modsrc, int tx_modtyp, int rx_modtyp, i
           //fprintf(stderr, "INFO - fpga_rb_set_ctrl: setting FPGA for TX: PM\n");
 
           fpga_rb_set_tx_modtyp(tx_modtyp);                                                                // power savings control: set TX modulation variant
-          g_fpga_rb_reg_mem->ctrl &= ~0x00007036;                                                          // TX: turn off increment STREAMING, RESET and RESYNC signals
+          FPGA_RB_WR(ctrl, FPGA_RB_RD(ctrl) & ~0x00007036);                                                // TX: turn off increment STREAMING, RESET and RESYNC signals
           fpga_rb_set_tx_amp_rf_gain_ofs__4mod_all(tx_amp_rf_gain, 0.0);                                   // TX_AMP_RF  gain setting [mV] is global and not modulation dependent
           if (tx_car_osc_qrg_inc == 50) {
             fpga_rb_set_tx_car_osc_qrg__4mod_cw_ssb_am_pm(tx_car_osc_qrg);                                 // TX_CAR_OSC frequency
@@ -893,10 +945,12 @@ void fpga_rb_set_ctrl(int rb_run, int tx_modsrc, int tx_modtyp, int rx_modtyp, i
             fpga_rb_set_tx_mod_osc_qrg__4mod_ssbweaver_am_fm_pm(tx_mod_osc_qrg);                           // TX_MOD_OSC frequency
           } else {
             fpga_rb_set_tx_mod_osc_qrg__4mod_ssbweaver_am_fm_pm(0.0);                                      // TX_MOD_OSC turning off
+            fpga_rb_shadow_commit();                                                                       // TX_MOD_OSC stopped before its phase is checked
             if (!(g_fpga_rb_reg_mem->status & 0x00000100)) {
               // TX_MOD_OSC phase not zero: reset phase oscillator
-              g_fpga_rb_reg_mem->ctrl &= ~0x00001000;                                                      // TX_MOD RESYNC activate
-              g_fpga_rb_reg_mem->ctrl |=  0x00001000;                                                      // TX_MOD RESYNC deactivate
+              FPGA_RB_PULSE(ctrl,
+                      FPGA_RB_RD(ctrl) & ~0x00001000,                                                      // TX_MOD RESYNC activate
+                      FPGA_RB_RD(ctrl) |  0x00001000);                                                     // TX_MOD RESYNC deactivate
             }
           }
 
@@ -905,7 +959,7 @@ void fpga_rb_set_ctrl(int rb_run, int tx_modsrc, int tx_modtyp, int rx_modtyp, i
           } else {
             fpga_rb_set_tx_mod_qmix_gain_ofs__4mod_pm(tx_car_osc_qrg, tx_mod_osc_mag);                     // PM by streaming in DDS phase offset
           }
-          g_fpga_rb_reg_mem->ctrl |=  0x00000040;                                                          // control: PM by TX_CAR_OSC offset streaming
+          FPGA_RB_WR(ctrl, FPGA_RB_RD(ctrl) | 0x00000040);                                                 // control: PM by TX_CAR_OSC offset streaming
         }
         break;
 
@@ -914,7 +968,7 @@ void fpga_rb_set_ctrl(int rb_run, int tx_modsrc, int tx_modtyp, int rx_modtyp, i
 
       // -- 8< --
 
-      g_fpga_rb_reg_mem->ctrl |= agc_auto_on;                                                              // control: AGC_AUTO_ON
+      FPGA_RB_WR(ctrl, FPGA_RB_RD(ctrl) | agc_auto_on);                                                    // control: AGC_AUTO_ON
 
       switch (rx_muxin_src) {
 
@@ -923,7 +977,7 @@ void fpga_rb_set_ctrl(int rb_run, int tx_modsrc, int tx_modtyp, int rx_modtyp, i
         //fprintf(stderr, "INFO - fpga_rb_set_ctrl: setting FPGA rx_modsrc to (none)\n");
 
         fpga_rb_set_rx_muxin_gain(rx_muxin_gain, 0x0000);                                                  // RX MUXIN gain setting
-        g_fpga_rb_reg_mem->rx_muxin_src = 0x00000000;
+        FPGA_RB_WR(rx_muxin_src, 0x00000000);
       }
       break;
 
@@ -931,8 +985,8 @@ void fpga_rb_set_ctrl(int rb_run, int tx_modsrc, int tx_modtyp, int rx_modtyp, i
         //fprintf(stderr, "INFO - fpga_rb_set_ctrl: setting FPGA rx_modsrc to RF_inp_1\n");
 
         fpga_rb_set_rx_muxin_gain(rx_muxin_gain, calib_get_ADC_offset(&g_rp_main_calib_params, 0x20));     // RX MUXIN gain setting
-        g_fpga_rb_reg_mem->rx_muxin_src = 0x00000020;
-        g_fpga_rb_reg_mem->ctrl |= adc_auto_ofs;                                                           // ADC automatic offset compensation
+        FPGA_RB_WR(rx_muxin_src, 0x00000020);
+        FPGA_RB_WR(ctrl, FPGA_RB_RD(ctrl) | adc_auto_ofs);                                                 // ADC automatic offset compensation
       }
       break;
 
@@ -940,8 +994,8 @@ void fpga_rb_set_ctrl(int rb_run, int tx_modsrc, int tx_modtyp, int rx_modtyp, i
         //fprintf(stderr, "INFO - fpga_rb_set_ctrl: setting FPGA rx_modsrc to RF_inp_2\n");
 
         fpga_rb_set_rx_muxin_gain(rx_muxin_gain, calib_get_ADC_offset(&g_rp_main_calib_params, 0x21));     // RX MUXIN gain setting
-        g_fpga_rb_reg_mem->rx_muxin_src = 0x00000021;
-        g_fpga_rb_reg_mem->ctrl |= adc_auto_ofs;                                                           // ADC automatic offset compensation
+        FPGA_RB_WR(rx_muxin_src, 0x00000021);
+        FPGA_RB_WR(ctrl, FPGA_RB_RD(ctrl) | adc_auto_ofs);                                                 // ADC automatic offset compensation
       }
       break;
 
@@ -949,8 +1003,8 @@ void fpga_rb_set_ctrl(int rb_run, int tx_modsrc, int tx_modtyp, int rx_modtyp, i
         //fprintf(stderr, "INFO - fpga_rb_set_ctrl: setting FPGA rx_modsrc to AI0\n");
 
         fpga_rb_set_rx_muxin_gain(rx_muxin_gain, calib_get_ADC_offset(&g_rp_main_calib_params, 0x10));     // RX MUXIN gain setting
-        g_fpga_rb_reg_mem->rx_muxin_src = 0x00000010;
-        g_fpga_rb_reg_mem->ctrl |= adc_auto_ofs;                                                           // ADC automatic offset compensation
+        FPGA_RB_WR(rx_muxin_src, 0x00000010);
+        FPGA_RB_WR(ctrl, FPGA_RB_RD(ctrl) | adc_auto_ofs);                                                 // ADC automatic offset compensation
       }
       break;
 
@@ -958,8 +1012,8 @@ void fpga_rb_set_ctrl(int rb_run, int tx_modsrc, int tx_modtyp, int rx_modtyp, i
         //fprintf(stderr, "INFO - fpga_rb_set_ctrl: setting FPGA rx_modsrc to AI1\n");
 
         fpga_rb_set_rx_muxin_gain(rx_muxin_gain, calib_get_ADC_offset(&g_rp_main_calib_params, 0x18));     // RX MUXIN gain setting
-        g_fpga_rb_reg_mem->rx_muxin_src = 0x00000018;
-        g_fpga_rb_reg_mem->ctrl |= adc_auto_ofs;                                                           // ADC automatic offset compensation
+        FPGA_RB_WR(rx_muxin_src, 0x00000018);
+        FPGA_RB_WR(ctrl, FPGA_RB_RD(ctrl) | adc_auto_ofs);                                                 // ADC automatic offset compensation
       }
       break;
 
@@ -967,8 +1021,8 @@ void fpga_rb_set_ctrl(int rb_run, int tx_modsrc, int tx_modtyp, int rx_modtyp, i
         //fprintf(stderr, "INFO - fpga_rb_set_ctrl: setting FPGA rx_modsrc to AI2\n");
 
         fpga_rb_set_rx_muxin_gain(rx_muxin_gain, calib_get_ADC_offset(&g_rp_main_calib_params, 0x11));     // RX MUXIN gain setting
-        g_fpga_rb_reg_mem->rx_muxin_src = 0x00000011;
-        g_fpga_rb_reg_mem->ctrl |= adc_auto_ofs;                                                           // ADC automatic offset compensation
+        FPGA_RB_WR(rx_muxin_src, 0x00000011);
+        FPGA_RB_WR(ctrl, FPGA_RB_RD(ctrl) | adc_auto_ofs);                                                 // ADC automatic offset compensation
       }
       break;
 
@@ -976,15 +1030,15 @@ void fpga_rb_set_ctrl(int rb_run, int tx_modsrc, int tx_modtyp, int rx_modtyp, i
         //fprintf(stderr, "INFO - fpga_rb_set_ctrl: setting FPGA rx_modsrc to AI3\n");
 
         fpga_rb_set_rx_muxin_gain(rx_muxin_gain, calib_get_ADC_offset(&g_rp_main_calib_params, 0x19));     // RX MUXIN gain setting
-        g_fpga_rb_reg_mem->rx_muxin_src = 0x00000019;
-        g_fpga_rb_reg_mem->ctrl |= adc_auto_ofs;                                                           // ADC automatic offset compensation
+        FPGA_RB_WR(rx_muxin_src, 0x00000019);
+        FPGA_RB_WR(ctrl, FPGA_RB_RD(ctrl) | adc_auto_ofs);                                                 // ADC automatic offset compensation
       }
       break;
 
 #if 0
       case RB_MODSRC_VP_VN: {
         fpga_rb_set_rx_muxin_gain(rx_muxin_gain, calib_get_ADC_offset(&g_rp_main_calib_params, 0x03));     // RX MUXIN gain setting
-        g_fpga_rb_reg_mem->rx_muxin_src = 0x00000003;
+        FPGA_RB_WR(rx_muxin_src, 0x00000003);
       }
       break;
 #endif
@@ -993,7 +1047,7 @@ void fpga_rb_set_ctrl(int rb_run, int tx_modsrc, int tx_modtyp, int rx_modtyp, i
         //fprintf(stderr, "INFO - fpga_rb_set_ctrl: setting FPGA rx_modsrc to AC97-LINEOUT Left\n");
 
         fpga_rb_set_rx_muxin_gain(rx_muxin_gain, 0);                                                       // RX MUXIN gain setting
-        g_fpga_rb_reg_mem->rx_muxin_src = 0x00000030;
+        FPGA_RB_WR(rx_muxin_src, 0x00000030);
       }
       break;
 
@@ -1001,7 +1055,7 @@ void fpga_rb_set_ctrl(int rb_run, int tx_modsrc, int tx_modtyp, int rx_modtyp, i
         //fprintf(stderr, "INFO - fpga_rb_set_ctrl: setting FPGA rx_modsrc to AC97-LINEOUT Right\n");
 
         fpga_rb_set_rx_muxin_gain(rx_muxin_gain, 0);                                                       // RX MUXIN gain setting
-        g_fpga_rb_reg_mem->rx_muxin_src = 0x00000031;
+        FPGA_RB_WR(rx_muxin_src, 0x00000031);
       }
       break;
 
@@ -1014,7 +1068,7 @@ void fpga_rb_set_ctrl(int rb_run, int tx_modsrc, int tx_modtyp, int rx_modtyp, i
         //fprintf(stderr, "INFO - fpga_rb_set_ctrl: setting FPGA for RX: USB\n");
 
         fpga_rb_set_rx_modtyp(rx_modtyp & 0x0f);                                                           // power savings control: set RX modulation variant, main part of modulation-type
-        g_fpga_rb_reg_mem->ctrl &= ~0x10760000;                                                            // RX: turn off RX RESET, RESYNC, INCREMENT- and PHASE-STREAMING signals
+        FPGA_RB_WR(ctrl, FPGA_RB_RD(ctrl) & ~0x10760000);                                                  // RX: turn off RX RESET, RESYNC, INCREMENT- and PHASE-STREAMING signals
         if (rx_car_osc_qrg_inc == 50) {
           fpga_rb_set_rx_car_osc_qrg__4mod_ssb_am_fm_pm(rx_car_osc_qrg + ssb_weaver_osc_qrg);              // RX_CAR_OSC frequency with ssb_weaver_osc_qrg correction
         }
@@ -1027,7 +1081,7 @@ void fpga_rb_set_ctrl(int rb_run, int tx_modsrc, int tx_modtyp, int rx_modtyp, i
         //fprintf(stderr, "INFO - fpga_rb_set_ctrl: setting FPGA for RX: LSB\n");
 
         fpga_rb_set_rx_modtyp(rx_modtyp & 0x0f);                                                           // power savings control: set RX modulation variant, main part of modulation-type
-        g_fpga_rb_reg_mem->ctrl &= ~0x10760000;                                                            // RX: turn off RX RESET, RESYNC, INCREMENT- and PHASE-STREAMING signals
+        FPGA_RB_WR(ctrl, FPGA_RB_RD(ctrl) & ~0x10760000);                                                  // RX: turn off RX RESET, RESYNC, INCREMENT- and PHASE-STREAMING signals
         if (rx_car_osc_qrg_inc == 50) {
           fpga_rb_set_rx_car_osc_qrg__4mod_ssb_am_fm_pm(rx_car_osc_qrg - ssb_weaver_osc_qrg);              // RX_CAR_OSC frequency with ssb_weaver_osc_qrg correction
         }
@@ -1040,8 +1094,8 @@ void fpga_rb_set_ctrl(int rb_run, int tx_modsrc, int tx_modtyp, int rx_modtyp, i
         //fprintf(stderr, "INFO - fpga_rb_set_ctrl: setting FPGA for RX: AM-SYNC (USB)\n");
 
         fpga_rb_set_rx_modtyp(rx_modtyp & 0x0f);                                                           // power savings control: set RX modulation variant, main part of modulation-type
-        g_fpga_rb_reg_mem->ctrl &= ~0x10560000;                                                            // RX: turn off RX RESET, RESYNC and PHASE-STREAMING signals
-        g_fpga_rb_reg_mem->ctrl |=  0x00200000;                                                            // RX: AM-SYNC detection by AFC increment streaming
+        FPGA_RB_WR(ctrl, FPGA_RB_RD(ctrl) & ~0x10560000);                                                  // RX: turn off RX RESET, RESYNC and PHASE-STREAMING signals
+        FPGA_RB_WR(ctrl, FPGA_RB_RD(ctrl) | 0x00200000);                                                   // RX: AM-SYNC detection by AFC increment streaming
         if (rx_car_osc_qrg_inc == 50) {
           fpga_rb_set_rx_car_osc_qrg__4mod_ssb_am_fm_pm(rx_car_osc_qrg + ssb_weaver_osc_qrg);              // RX_CAR_OSC frequency with ssb_weaver_osc_qrg correction
         }
@@ -1055,8 +1109,8 @@ void fpga_rb_set_ctrl(int rb_run, int tx_modsrc, int tx_modtyp, int rx_modtyp, i
         //fprintf(stderr, "INFO - fpga_rb_set_ctrl: setting FPGA for RX: AM-SYNC (LSB)\n");
 
         fpga_rb_set_rx_modtyp(rx_modtyp & 0x0f);                                                           // power savings control: set RX modulation variant, main part of modulation-type
-        g_fpga_rb_reg_mem->ctrl &= ~0x10560000;                                                            // RX: turn off RX RESET, RESYNC and PHASE-STREAMING signals
-        g_fpga_rb_reg_mem->ctrl |=  0x00200000;                                                            // RX: AM-SYNC detection by AFC increment streaming
+        FPGA_RB_WR(ctrl, FPGA_RB_RD(ctrl) & ~0x10560000);                                                  // RX: turn off RX RESET, RESYNC and PHASE-STREAMING signals
+        FPGA_RB_WR(ctrl, FPGA_RB_RD(ctrl) | 0x00200000);                                                   // RX: AM-SYNC detection by AFC increment streaming
         if (rx_car_osc_qrg_inc == 50) {
           fpga_rb_set_rx_car_osc_qrg__4mod_ssb_am_fm_pm(rx_car_osc_qrg - ssb_weaver_osc_qrg);              // RX_CAR_OSC frequency with ssb_weaver_osc_qrg correction
         }
@@ -1070,8 +1124,8 @@ void fpga_rb_set_ctrl(int rb_run, int tx_modsrc, int tx_modtyp, int rx_modtyp, i
         //fprintf(stderr, "INFO - fpga_rb_set_ctrl: setting FPGA for RX: FM\n");
 
         fpga_rb_set_rx_modtyp(rx_modtyp & 0x0f);                                                           // power savings control: set RX modulation variant, main part of modulation-type
-        g_fpga_rb_reg_mem->ctrl &= ~0x10560000;                                                            // RX: turn off RX RESET, RESYNC and PHASE-STREAMING signals
-        g_fpga_rb_reg_mem->ctrl |=  0x00200000;                                                            // RX: FM detection by AFC increment streaming
+        FPGA_RB_WR(ctrl, FPGA_RB_RD(ctrl) & ~0x10560000);                                                  // RX: turn off RX RESET, RESYNC and PHASE-STREAMING signals
+        FPGA_RB_WR(ctrl, FPGA_RB_RD(ctrl) | 0x00200000);                                                   // RX: FM detection by AFC increment streaming
         if (rx_car_osc_qrg_inc == 50) {
           fpga_rb_set_rx_car_osc_qrg__4mod_ssb_am_fm_pm(rx_car_osc_qrg);                                   // RX_CAR_OSC frequency
         }
@@ -1084,8 +1138,8 @@ void fpga_rb_set_ctrl(int rb_run, int tx_modsrc, int tx_modtyp, int rx_modtyp, i
         //fprintf(stderr, "INFO - fpga_rb_set_ctrl: setting FPGA for RX: PM\n");
 
         fpga_rb_set_rx_modtyp(rx_modtyp & 0x0f);                                                           // power savings control: set RX modulation variant, main part of modulation-type
-        g_fpga_rb_reg_mem->ctrl &= ~0x10560000;                                                            // RX: turn off RX RESET, RESYNC and PHASE-STREAMING signals
-        g_fpga_rb_reg_mem->ctrl |=  0x00200000;                                                            // RX: PM detection by AFC increment streaming
+        FPGA_RB_WR(ctrl, FPGA_RB_RD(ctrl) & ~0x10560000);                                                  // RX: turn off RX RESET, RESYNC and PHASE-STREAMING signals
+        FPGA_RB_WR(ctrl, FPGA_RB_RD(ctrl) | 0x00200000);                                                   // RX: PM detection by AFC increment streaming
         if (rx_car_osc_qrg_inc == 50) {
           fpga_rb_set_rx_car_osc_qrg__4mod_ssb_am_fm_pm(rx_car_osc_qrg);                                   // RX_CAR_OSC frequency
         }
@@ -1098,8 +1152,8 @@ void fpga_rb_set_ctrl(int rb_run, int tx_modsrc, int tx_modtyp, int rx_modtyp, i
         //fprintf(stderr, "INFO - fpga_rb_set_ctrl: setting FPGA for RX: AM-ENV\n");
 
         fpga_rb_set_rx_modtyp(rx_modtyp & 0x0f);                                                           // power savings control: set RX modulation variant, main part of modulation-type
-        g_fpga_rb_reg_mem->ctrl &= ~0x10560000;                                                            // RX: turn off RX RESET, RESYNC and PHASE-STREAMING signals
-        g_fpga_rb_reg_mem->ctrl |=  0x00200000;                                                            // RX: AM-ENV detection by AFC increment streaming
+        FPGA_RB_WR(ctrl, FPGA_RB_RD(ctrl) & ~0x10560000);                                                  // RX: turn off RX RESET, RESYNC and PHASE-STREAMING signals
+        FPGA_RB_WR(ctrl, FPGA_RB_RD(ctrl) | 0x00200000);                                                   // RX: AM-ENV detection by AFC increment streaming
         if (rx_car_osc_qrg_inc == 50) {
           fpga_rb_set_rx_car_osc_qrg__4mod_ssb_am_fm_pm(rx_car_osc_qrg);                                   // RX_CAR_OSC frequency
         }
@@ -1119,19 +1173,21 @@ void fpga_rb_set_ctrl(int rb_run, int tx_modsrc, int tx_modtyp, int rx_modtyp, i
 
     } else {  // else if (rb_run)
       //fprintf(stderr, "INFO - fpga_rb_set_ctrl: rb_run==false settings()\n");
-      g_fpga_rb_reg_mem->ctrl &= ~0x10767076;                                                              // TX/RX: turn off all STREAMING, RESET and RESYNC signals
-      g_fpga_rb_reg_mem->tx_muxin_src = 0x00000000;                                                        // TX_MUXIN input off
+      FPGA_RB_WR(ctrl, FPGA_RB_RD(ctrl) & ~0x10767076);                                                    // TX/RX: turn off all STREAMING, RESET and RESYNC signals
+      FPGA_RB_WR(tx_muxin_src, 0x00000000);                                                                // TX_MUXIN input off
       fpga_rb_set_tx_amp_rf_gain_ofs__4mod_all(0.0, 0.0);                                                  // TX_AMP_RF gain/offset control
       //fpga_rb_set_tx_car_osc_qrg__4mod_cw_ssb_am_pm(0.0);                                                // do not loose current frequency of TX_CAR_OSC
       fpga_rb_set_tx_car_osc_qrg_inc__4mod_cw_ssb_am_pm(50);                                               // TX_CAR_OSC frequency sweep increment, mid-range
       fpga_rb_set_tx_mod_osc_qrg__4mod_ssbweaver_am_fm_pm(0.0);                                            // TX_MOD_OSC frequency
       fpga_rb_set_tx_mod_qmix_gain_ofs__4mod_fm(0.0f, 0.0);                                                // TX_MOD_QMIX gain/offset control
-      g_fpga_rb_reg_mem->rx_muxin_src = 0;                                                                 // RX_MUX input off
+      FPGA_RB_WR(rx_muxin_src, 0);                                                                         // RX_MUX input off
       //fpga_rb_set_rx_car_osc_qrg__4mod_ssb_am_fm_pm(0.0);                                                // do not loose current frequency of RX_CAR_OSC frequency
       fpga_rb_set_rx_car_osc_qrg_inc__4mod_ssb_am_fm_pm(50);                                               // RX_CAR_OSC frequency sweep increment, mid-range
       fpga_rb_set_rx_calc_afc_weaver__4mod_am_fm_pm(0.0);                                                  // RX_CAR_CALC_WEAVER frequency
       fpga_rb_set_rx_mod_osc_qrg__4mod_ssbweaver_am(0.0);                                                  // RX_MOD_OSC frequency
     }
+
+    fpga_rb_shadow_commit();                                                                               // write all changed registers at once
 }
 
 
@@ -1175,9 +1231,10 @@ void fpga_rb_get_ctrl(int tx_modtyp, int rx_modtyp,
 void fpga_rb_set_tx_modtyp(int tx_modtyp)
 {
     int tx = tx_modtyp & 0xff;
-    uint32_t masked = g_fpga_rb_reg_mem->pwr_ctrl & 0xffff00ff;
-    g_fpga_rb_reg_mem->pwr_ctrl = masked;                                                                     // first disable and reset before entering new modulation variant
-    g_fpga_rb_reg_mem->pwr_ctrl = masked | (tx << 0x08);
+    uint32_t masked = FPGA_RB_RD(pwr_ctrl) & 0xffff00ff;
+    if ((masked | (tx << 0x08)) != FPGA_RB_RD(pwr_ctrl)) {
+        FPGA_RB_PULSE(pwr_ctrl, masked, masked | (tx << 0x08));                                               // first disable and reset before entering new modulation variant
+    }
 }
 
 
@@ -1191,22 +1248,22 @@ void fpga_rb_set_tx_muxin_gain(int tx_muxin_gain, int tx_muxin_ofs)
     }
 
     if (tx_muxin_gain <= 0) {
-        g_fpga_rb_reg_mem->tx_muxin_gain = 0;
-        //fprintf(stderr, "INFO - fpga_rb_set_tx_muxin_gain: ZERO   tx_muxin_gain=%d --> bitfield=0x%08x\n", tx_muxin_gain, g_fpga_rb_reg_mem->tx_muxin_gain);
+        FPGA_RB_WR(tx_muxin_gain, 0);
+        //fprintf(stderr, "INFO - fpga_rb_set_tx_muxin_gain: ZERO   tx_muxin_gain=%d --> bitfield=0x%08x\n", tx_muxin_gain, FPGA_RB_RD(tx_muxin_gain));
 
     } else if (tx_muxin_gain < 80) {  // 0% .. 80%-
         uint32_t bitfield = (uint32_t) (0.5 + (tx_muxin_gain * ((double) 0xffff) / 80.0));
-        g_fpga_rb_reg_mem->tx_muxin_gain = (0xffff & bitfield);  // 16 bit gain value and no booster shift bits
-        //fprintf(stderr, "INFO - fpga_rb_set_tx_muxin_gain: NORMAL tx_muxin_gain=%d --> bitfield=0x%08x\n", tx_muxin_gain, g_fpga_rb_reg_mem->tx_muxin_gain);
+        FPGA_RB_WR(tx_muxin_gain, 0xffff & bitfield);  // 16 bit gain value and no booster shift bits
+        //fprintf(stderr, "INFO - fpga_rb_set_tx_muxin_gain: NORMAL tx_muxin_gain=%d --> bitfield=0x%08x\n", tx_muxin_gain, FPGA_RB_RD(tx_muxin_gain));
 
     } else {  // 80% .. 100%: set the logarithmic amplifier
         p  = (tx_muxin_gain - 80) * (7.0 / 20.0);
         uint32_t bitfield = (uint32_t) (0.5 + p);
-        g_fpga_rb_reg_mem->tx_muxin_gain = ((bitfield << 16) | 0xffff);  // open mixer completely and activate booster
-        //fprintf(stderr, "INFO - fpga_rb_set_tx_muxin_gain: BOOST  tx_muxin_gain=%d --> bitfield=0x%08x\n", tx_muxin_gain, g_fpga_rb_reg_mem->tx_muxin_gain);
+        FPGA_RB_WR(tx_muxin_gain, (bitfield << 16) | 0xffff);  // open mixer completely and activate booster
+        //fprintf(stderr, "INFO - fpga_rb_set_tx_muxin_gain: BOOST  tx_muxin_gain=%d --> bitfield=0x%08x\n", tx_muxin_gain, FPGA_RB_RD(tx_muxin_gain));
     }
 
-    g_fpga_rb_reg_mem->tx_muxin_ofs = tx_muxin_ofs & 0xffff;
+    FPGA_RB_WR(tx_muxin_ofs, tx_muxin_ofs & 0xffff);
 }
 
 /*----------------------------------------------------------------------------*/
@@ -1229,10 +1286,10 @@ void fpga_rb_set_tx_mod_osc_qrg__4mod_ssbweaver_am_fm_pm(double tx_mod_osc_qrg)
     //        bf_lo,
     //        tx_mod_osc_qrg);
 
-    g_fpga_rb_reg_mem->tx_mod_osc_inc_lo = bf_lo;
-    g_fpga_rb_reg_mem->tx_mod_osc_inc_hi = bf_hi;
-    g_fpga_rb_reg_mem->tx_mod_osc_ofs_lo = 0UL;                                                            // no carrier phase offset
-    g_fpga_rb_reg_mem->tx_mod_osc_ofs_hi = 0UL;                                                            // no carrier phase offset
+    FPGA_RB_WR(tx_mod_osc_inc_lo, bf_lo);
+    FPGA_RB_WR(tx_mod_osc_inc_hi, bf_hi);
+    FPGA_RB_WR(tx_mod_osc_ofs_lo, 0UL);                                                                    // no carrier phase offset
+    FPGA_RB_WR(tx_mod_osc_ofs_hi, 0UL);                                                                    // no carrier phase offset
 }
 
 /*----------------------------------------------------------------------------*/
@@ -1252,9 +1309,9 @@ void fpga_rb_set_tx_mod_qmix_gain_ofs__4mod_cw_ssbweaver_am(double tx_mod_qmix_g
     //fprintf(stderr, "INFO - fpga_rb_set_tx_mod_qmix_gain_ofs__4mod_cw_am: (gain=%lf, ofs=%lf) <-- in(tx_mod_qmix_grade=%lf)\n",
     //        gain, ofs, tx_mod_qmix_grade);
 
-    g_fpga_rb_reg_mem->tx_mod_qmix_gain   = ((uint32_t) gain) & 0xffff;
-    g_fpga_rb_reg_mem->tx_mod_qmix_ofs_lo = (uint32_t) (((uint64_t) ofs)  & 0xffffffff);                   // CW, and AM have carrier enabled,
-    g_fpga_rb_reg_mem->tx_mod_qmix_ofs_hi = (uint32_t) (((uint64_t) ofs) >> 32);                           // SSB is zero symmetric w/o a carrier
+    FPGA_RB_WR(tx_mod_qmix_gain, ((uint32_t) gain) & 0xffff);
+    FPGA_RB_WR(tx_mod_qmix_ofs_lo, (uint32_t) (((uint64_t) ofs)  & 0xffffffff));                           // CW, and AM have carrier enabled,
+    FPGA_RB_WR(tx_mod_qmix_ofs_hi, (uint32_t) (((uint64_t) ofs) >> 32));                                   // SSB is zero symmetric w/o a carrier
 }
 
 /*----------------------------------------------------------------------------*/
@@ -1265,9 +1322,9 @@ void fpga_rb_set_tx_mod_qmix_gain_ofs__4mod_fm(double tx_car_osc_qrg, double tx_
     //fprintf(stderr, "INFO - fpga_rb_set_tx_mod_qmix_gain_ofs__4mod_fm: (gain=%lf, ofs=%lf) <-- in(tx_car_osc_qrg=%lf, tx_mod_osc_mag=%lf)\n",
     //        gain, ofs, tx_car_osc_qrg, tx_mod_osc_mag);
 
-    g_fpga_rb_reg_mem->tx_mod_qmix_gain   = ((uint32_t) gain) & 0xffff;                                    // FM deviation
-    g_fpga_rb_reg_mem->tx_mod_qmix_ofs_lo = (uint32_t) (((uint64_t) ofs)  & 0xffffffff);                   // FM carrier frequency
-    g_fpga_rb_reg_mem->tx_mod_qmix_ofs_hi = (uint32_t) (((uint64_t) ofs) >> 32);
+    FPGA_RB_WR(tx_mod_qmix_gain, ((uint32_t) gain) & 0xffff);                                              // FM deviation
+    FPGA_RB_WR(tx_mod_qmix_ofs_lo, (uint32_t) (((uint64_t) ofs)  & 0xffffffff));                           // FM carrier frequency
+    FPGA_RB_WR(tx_mod_qmix_ofs_hi, (uint32_t) (((uint64_t) ofs) >> 32));
 }
 
 /*----------------------------------------------------------------------------*/
@@ -1277,9 +1334,9 @@ void fpga_rb_set_tx_mod_qmix_gain_ofs__4mod_pm(double tx_car_osc_qrg, double tx_
     //fprintf(stderr, "INFO - fpga_rb_set_tx_mod_osc_mixer_mod_pm: tx_car_osc_qrg=%lf, tx_mod_osc_mag=%lf\n",
     //        tx_car_osc_qrg, tx_mod_osc_mag);
 
-    g_fpga_rb_reg_mem->tx_mod_qmix_gain   = ((uint32_t) gain) & 0xffff;                                    // PM phase magnitude
-    g_fpga_rb_reg_mem->tx_mod_qmix_ofs_lo = 0UL;                                                           // PM based on zero phase w/o modulation
-    g_fpga_rb_reg_mem->tx_mod_qmix_ofs_hi = 0UL;
+    FPGA_RB_WR(tx_mod_qmix_gain, ((uint32_t) gain) & 0xffff);                                              // PM phase magnitude
+    FPGA_RB_WR(tx_mod_qmix_ofs_lo, 0UL);                                                                   // PM based on zero phase w/o modulation
+    FPGA_RB_WR(tx_mod_qmix_ofs_hi, 0UL);
 }
 
 /*----------------------------------------------------------------------------*/
@@ -1302,18 +1359,26 @@ void fpga_rb_set_tx_car_osc_qrg__4mod_cw_ssb_am_pm(double tx_car_osc_qrg)
     //        bf_lo,
     //        tx_car_osc_qrg);
 
-    g_fpga_rb_reg_mem->tx_car_osc_inc_lo = bf_lo;
-    g_fpga_rb_reg_mem->tx_car_osc_inc_hi = bf_hi;
-    g_fpga_rb_reg_mem->tx_car_osc_ofs_lo = 0UL;                                                            // no carrier phase offset
-    g_fpga_rb_reg_mem->tx_car_osc_ofs_hi = 0UL;                                                            // no carrier phase offset
+    if (fpga_rb_tx_car_osc_scanning()) {  // the scanner has moved the increment on its own
+        fpga_rb_shadow_invalidate(FPGA_RB_IDX(tx_car_osc_inc_lo));
+        fpga_rb_shadow_invalidate(FPGA_RB_IDX(tx_car_osc_inc_hi));
+    }
+    FPGA_RB_WR(tx_car_osc_inc_lo, bf_lo);
+    FPGA_RB_WR(tx_car_osc_inc_hi, bf_hi);
+    FPGA_RB_WR(tx_car_osc_ofs_lo, 0UL);                                                                    // no carrier phase offset
+    FPGA_RB_WR(tx_car_osc_ofs_hi, 0UL);                                                                    // no carrier phase offset
 }
 
 /*----------------------------------------------------------------------------*/
 double fpga_rb_get_tx_car_osc_qrg()
 {
     int64_t bitfield;
-    bitfield  =            g_fpga_rb_reg_mem->tx_car_osc_inc_lo;
-    bitfield |= ((int64_t) g_fpga_rb_reg_mem->tx_car_osc_inc_hi) << 32;
+    if (fpga_rb_tx_car_osc_scanning()) {  // read back what the scanner has reached
+        fpga_rb_shadow_invalidate(FPGA_RB_IDX(tx_car_osc_inc_lo));
+        fpga_rb_shadow_invalidate(FPGA_RB_IDX(tx_car_osc_inc_hi));
+    }
+    bitfield  =            FPGA_RB_RD(tx_car_osc_inc_lo);
+    bitfield |= ((int64_t) FPGA_RB_RD(tx_car_osc_inc_hi)) << 32;
 
     double tx_car_osc_qrg = g_rp_main_calib_params.base_osc125mhz_realhz * (((double) bitfield) / ((double) (1ULL << 48)));
     tx_car_osc_qrg = floor(tx_car_osc_qrg + 0.5);
@@ -1331,8 +1396,8 @@ void fpga_rb_set_tx_car_osc_qrg_inc__4mod_cw_ssb_am_pm(int tx_car_osc_qrg_inc)
 
     if (fabs(rngctrlr) < 0.1) {  // middle-range is inactive  +/-10 %
         //fprintf(stderr, "INFO - fpga_rb_set_tx_car_osc_qrg_inc__4mod_cw_ssb_am_pm: STOPPING SCANNER <-- mid-range\n");
-        g_fpga_rb_reg_mem->tx_car_osc_inc_scnr_lo = 0;
-        g_fpga_rb_reg_mem->tx_car_osc_inc_scnr_hi = 0;
+        FPGA_RB_WR(tx_car_osc_inc_scnr_lo, 0);
+        FPGA_RB_WR(tx_car_osc_inc_scnr_hi, 0);
         return;
     }
 
@@ -1360,16 +1425,16 @@ void fpga_rb_set_tx_car_osc_qrg_inc__4mod_cw_ssb_am_pm(int tx_car_osc_qrg_inc)
     //        bf_lo,
     //        tx_car_osc_qrg_inc);
 
-    g_fpga_rb_reg_mem->tx_car_osc_inc_scnr_lo = bf_lo;
-    g_fpga_rb_reg_mem->tx_car_osc_inc_scnr_hi = bf_hi;
+    FPGA_RB_WR(tx_car_osc_inc_scnr_lo, bf_lo);
+    FPGA_RB_WR(tx_car_osc_inc_scnr_hi, bf_hi);
 }
 
 /*----------------------------------------------------------------------------*/
 double fpga_rb_get_tx_car_osc_qrg_inc()
 {
     int neg            = 0;
-    int64_t bitfield   =            g_fpga_rb_reg_mem->tx_car_osc_inc_scnr_lo;
-    bitfield          |= ((int64_t) g_fpga_rb_reg_mem->tx_car_osc_inc_scnr_hi) << 32;
+    int64_t bitfield   =            FPGA_RB_RD(tx_car_osc_inc_scnr_lo);
+    bitfield          |= ((int64_t) FPGA_RB_RD(tx_car_osc_inc_scnr_hi)) << 32;
     if (!bitfield) {
         return 0.0;
     }
@@ -1396,8 +1461,8 @@ void fpga_rb_set_tx_amp_rf_gain_ofs__4mod_all(double tx_amp_rf_gain, double tx_a
     //fprintf(stderr, "INFO - fpga_rb_set_tx_amp_rf_gain_ofs__4mod_all: (gain=%lf, ofs=%lf) <-- in(tx_amp_rf_gain=%lf, tx_amp_rf_ofs=%lf)\n",
     //        gain, ofs, tx_amp_rf_gain, tx_amp_rf_ofs);
 
-    g_fpga_rb_reg_mem->tx_amp_rf_gain = ((uint32_t) gain) & 0xffff;
-    g_fpga_rb_reg_mem->tx_amp_rf_ofs  = ((uint32_t) ofs)  & 0xffff;
+    FPGA_RB_WR(tx_amp_rf_gain, ((uint32_t) gain) & 0xffff);
+    FPGA_RB_WR(tx_amp_rf_ofs, ((uint32_t) ofs)  & 0xffff);
 }
 
 
@@ -1405,9 +1470,10 @@ void fpga_rb_set_tx_amp_rf_gain_ofs__4mod_all(double tx_amp_rf_gain, double tx_a
 void fpga_rb_set_rx_modtyp(int rx_modtyp)
 {
     int rx = rx_modtyp & 0xff;
-    uint32_t masked = g_fpga_rb_reg_mem->pwr_ctrl & 0xffffff00;
-    g_fpga_rb_reg_mem->pwr_ctrl = masked;                                                                     // first disable and reset before entering new modulation variant
-    g_fpga_rb_reg_mem->pwr_ctrl = masked | rx;
+    uint32_t masked = FPGA_RB_RD(pwr_ctrl) & 0xffffff00;
+    if ((masked | rx) != FPGA_RB_RD(pwr_ctrl)) {
+        FPGA_RB_PULSE(pwr_ctrl, masked, masked | rx);                                                         // first disable and reset before entering new modulation variant
+    }
 }
 
 /*----------------------------------------------------------------------------*/
@@ -1420,22 +1486,22 @@ void fpga_rb_set_rx_muxin_gain(int rx_muxin_gain, int rx_muxin_ofs)
     }
 
     if (rx_muxin_gain <= 0) {
-        g_fpga_rb_reg_mem->rx_muxin_gain = 0;
-        //fprintf(stderr, "INFO - fpga_rb_set_rx_muxin_gain: ZERO   rx_muxin_gain=%d --> bitfield=0x%08x\n", rx_muxin_gain, g_fpga_rb_reg_mem->rx_muxin_gain);
+        FPGA_RB_WR(rx_muxin_gain, 0);
+        //fprintf(stderr, "INFO - fpga_rb_set_rx_muxin_gain: ZERO   rx_muxin_gain=%d --> bitfield=0x%08x\n", rx_muxin_gain, FPGA_RB_RD(rx_muxin_gain));
 
     } else if (rx_muxin_gain < 80) {  // 0% .. 80%-
         uint32_t bitfield = (uint32_t) (0.5 + (rx_muxin_gain * ((double) 0xffff) / 80.0));
-        g_fpga_rb_reg_mem->rx_muxin_gain = (0xffff & bitfield);  // 16 bit gain value and no booster shift bits
-        //fprintf(stderr, "INFO - fpga_rb_set_rx_muxin_gain: NORMAL rx_muxin_gain=%lf --> bitfield=0x%08x\n", rx_muxin_gain, g_fpga_rb_reg_mem->rx_muxin_gain);
+        FPGA_RB_WR(rx_muxin_gain, 0xffff & bitfield);  // 16 bit gain value and no booster shift bits
+        //fprintf(stderr, "INFO - fpga_rb_set_rx_muxin_gain: NORMAL rx_muxin_gain=%lf --> bitfield=0x%08x\n", rx_muxin_gain, FPGA_RB_RD(rx_muxin_gain));
 
     } else {  // 80% .. 100%: set the logarithmic amplifier
         p  = (rx_muxin_gain - 80) * (5.0 / 20.0);
         uint32_t bitfield = (uint32_t) (0.5 + p);
-        g_fpga_rb_reg_mem->rx_muxin_gain = ((bitfield << 16) | 0xffff);  // open mixer completely and activate booster
-        //fprintf(stderr, "INFO - fpga_rb_set_rx_muxin_gain: BOOST  rx_muxin_gain=%d --> bitfield=0x%08x\n", rx_muxin_gain, g_fpga_rb_reg_mem->rx_muxin_gain);
+        FPGA_RB_WR(rx_muxin_gain, (bitfield << 16) | 0xffff);  // open mixer completely and activate booster
+        //fprintf(stderr, "INFO - fpga_rb_set_rx_muxin_gain: BOOST  rx_muxin_gain=%d --> bitfield=0x%08x\n", rx_muxin_gain, FPGA_RB_RD(rx_muxin_gain));
     }
 
-    g_fpga_rb_reg_mem->rx_muxin_ofs = rx_muxin_ofs & 0xffff;
+    FPGA_RB_WR(rx_muxin_ofs, rx_muxin_ofs & 0xffff);
 }
 
 /*----------------------------------------------------------------------------*/
@@ -1458,18 +1524,26 @@ void fpga_rb_set_rx_car_osc_qrg__4mod_ssb_am_fm_pm(double rx_car_osc_qrg)
     //        bf_lo,
     //        rx_car_osc_qrg);
 
-    g_fpga_rb_reg_mem->rx_car_osc_inc_lo = bf_lo;
-    g_fpga_rb_reg_mem->rx_car_osc_inc_hi = bf_hi;
-    g_fpga_rb_reg_mem->rx_car_osc_ofs_lo = 0UL;                                                            // no carrier phase offset
-    g_fpga_rb_reg_mem->rx_car_osc_ofs_hi = 0UL;                                                            // no carrier phase offset
+    if (fpga_rb_rx_car_osc_scanning()) {  // the scanner has moved the increment on its own
+        fpga_rb_shadow_invalidate(FPGA_RB_IDX(rx_car_osc_inc_lo));
+        fpga_rb_shadow_invalidate(FPGA_RB_IDX(rx_car_osc_inc_hi));
+    }
+    FPGA_RB_WR(rx_car_osc_inc_lo, bf_lo);
+    FPGA_RB_WR(rx_car_osc_inc_hi, bf_hi);
+    FPGA_RB_WR(rx_car_osc_ofs_lo, 0UL);                                                                    // no carrier phase offset
+    FPGA_RB_WR(rx_car_osc_ofs_hi, 0UL);                                                                    // no carrier phase offset
 }
 
 /*----------------------------------------------------------------------------*/
 double fpga_rb_get_rx_car_osc_qrg()
 {
     int64_t bitfield;
-    bitfield  =            g_fpga_rb_reg_mem->rx_car_osc_inc_lo;
-    bitfield |= ((int64_t) g_fpga_rb_reg_mem->rx_car_osc_inc_hi) << 32;
+    if (fpga_rb_rx_car_osc_scanning()) {  // read back what the scanner has reached
+        fpga_rb_shadow_invalidate(FPGA_RB_IDX(rx_car_osc_inc_lo));
+        fpga_rb_shadow_invalidate(FPGA_RB_IDX(rx_car_osc_inc_hi));
+    }
+    bitfield  =            FPGA_RB_RD(rx_car_osc_inc_lo);
+    bitfield |= ((int64_t) FPGA_RB_RD(rx_car_osc_inc_hi)) << 32;
 
     double rx_car_osc_qrg = g_rp_main_calib_params.base_osc125mhz_realhz * (((double) bitfield) / ((double) (1ULL << 48)));
     rx_car_osc_qrg = floor(rx_car_osc_qrg + 0.5);
@@ -1487,8 +1561,8 @@ void fpga_rb_set_rx_car_osc_qrg_inc__4mod_ssb_am_fm_pm(int rx_car_osc_qrg_inc)
 
     if (fabs(rngctrlr) < 0.1) {  // middle-range is inactive  +/-10 %
         //fprintf(stderr, "INFO - fpga_rb_set_rx_car_osc_qrg_inc__4mod_ssb_am_fm_pm: STOPPING SCANNER <-- mid-range\n");
-        g_fpga_rb_reg_mem->rx_car_osc_inc_scnr_lo = 0;
-        g_fpga_rb_reg_mem->rx_car_osc_inc_scnr_hi = 0;
+        FPGA_RB_WR(rx_car_osc_inc_scnr_lo, 0);
+        FPGA_RB_WR(rx_car_osc_inc_scnr_hi, 0);
         return;
     }
 
@@ -1516,16 +1590,16 @@ void fpga_rb_set_rx_car_osc_qrg_inc__4mod_ssb_am_fm_pm(int rx_car_osc_qrg_inc)
     //        bf_lo,
     //        rx_car_osc_qrg_inc);
 
-    g_fpga_rb_reg_mem->rx_car_osc_inc_scnr_lo = bf_lo;
-    g_fpga_rb_reg_mem->rx_car_osc_inc_scnr_hi = bf_hi;
+    FPGA_RB_WR(rx_car_osc_inc_scnr_lo, bf_lo);
+    FPGA_RB_WR(rx_car_osc_inc_scnr_hi, bf_hi);
 }
 
 /*----------------------------------------------------------------------------*/
 double fpga_rb_get_rx_car_osc_qrg_inc()
 {
     int neg            = 0;
-    int64_t bitfield   =            g_fpga_rb_reg_mem->rx_car_osc_inc_scnr_lo;
-    bitfield          |= ((int64_t) g_fpga_rb_reg_mem->rx_car_osc_inc_scnr_hi) << 32;
+    int64_t bitfield   =            FPGA_RB_RD(rx_car_osc_inc_scnr_lo);
+    bitfield          |= ((int64_t) FPGA_RB_RD(rx_car_osc_inc_scnr_hi)) << 32;
     if (!bitfield) {
         return 0.0;
     }
@@ -1543,6 +1617,200 @@ double fpga_rb_get_rx_car_osc_qrg_inc()
     return rx_car_osc_qrg_inc;
 }
 
+/*----------------------------------------------------------------------------*/
+int fpga_rb_sweep_prepare(fpga_rb_sweep_plan_t* plan, double start_qrg, double stop_qrg, double step_qrg, double dwell_us, int osc_mask,
+        int tx_modtyp, int rx_modtyp)
+{
+    const int ssb_weaver_osc_qrg = 1700.0;
+    const double span = stop_qrg - start_qrg;
+    double tx_ofs_qrg = 0.0;
+    double rx_ofs_qrg = 0.0;
+    int points;
+    int i;
+
+    if (!plan || !(osc_mask & (FPGA_RB_SWEEP_TX | FPGA_RB_SWEEP_RX)) || (start_qrg < 0.0) || (stop_qrg < 0.0) ||
+            (g_rp_main_calib_params.base_osc125mhz_realhz <= 0.0)) {
+        fprintf(stderr, "ERROR - fpga_rb_sweep_prepare: bad parameter (plan=%p, start=%lf, stop=%lf, osc_mask=%d)\n", plan, start_qrg, stop_qrg, osc_mask);
+        return -1;
+    }
+
+    step_qrg = fabs(step_qrg);
+    if ((step_qrg > 0.0) && ((fabs(span) / step_qrg) < (FPGA_RB_SWEEP_POINTS_MAX - 1))) {
+        points = 1 + (int) floor(fabs(span) / step_qrg + 1e-9);
+
+    } else if (span != 0.0) {  // spread the maximum count of points over the range
+        points   = FPGA_RB_SWEEP_POINTS_MAX;
+        step_qrg = fabs(span) / (FPGA_RB_SWEEP_POINTS_MAX - 1);
+
+    } else {
+        points = 1;
+    }
+    if (span < 0.0) {
+        step_qrg = -step_qrg;
+    }
+
+    plan->points   = points;
+    plan->osc_mask = osc_mask;
+    plan->dwell_ns = (long) (dwell_us * 1e3);
+    if (((long long) plan->dwell_ns * points) > FPGA_RB_SWEEP_DURATION_MAX_NS) {
+        plan->dwell_ns = (long) (FPGA_RB_SWEEP_DURATION_MAX_NS / points);
+        fprintf(stderr, "WARNING - fpga_rb_sweep_prepare: dwell time shortened to %ld us to keep the sweep within %lld s\n",
+                plan->dwell_ns / 1000L, FPGA_RB_SWEEP_DURATION_MAX_NS / 1000000000LL);
+    }
+    if (plan->dwell_ns < FPGA_RB_SWEEP_DWELL_MIN_NS) {
+        plan->dwell_ns = FPGA_RB_SWEEP_DWELL_MIN_NS;
+    }
+
+    /* the same weaver offsets as fpga_rb_set_ctrl() applies to the carrier oscillators */
+    switch (tx_modtyp) {
+    case RB_TX_MODTYP_USB:
+      tx_ofs_qrg = +ssb_weaver_osc_qrg;
+      break;
+
+    case RB_TX_MODTYP_LSB:
+      tx_ofs_qrg = -ssb_weaver_osc_qrg;
+      break;
+    }
+
+    switch (rx_modtyp & 0x0f) {
+    case RB_RX_MODTYP_USB:
+    case RB_RX_MODTYP_AMSYNC_USB:
+      rx_ofs_qrg = +ssb_weaver_osc_qrg;
+      break;
+
+    case RB_RX_MODTYP_LSB:
+    case RB_RX_MODTYP_AMSYNC_LSB:
+      rx_ofs_qrg = -ssb_weaver_osc_qrg;
+      break;
+    }
+
+    /* the same increments as fpga_rb_set_rx_car_osc_qrg__4mod_ssb_am_fm_pm() programs, calculated once */
+    const double inc_per_hz = ((double) (1ULL << 48)) / g_rp_main_calib_params.base_osc125mhz_realhz;
+    for (i = 0; i < points; i++) {
+        double  qrg         = start_qrg + i * step_qrg;
+        int64_t tx_bitfield = (int64_t) ((qrg + tx_ofs_qrg) * inc_per_hz + 0.5);
+        int64_t rx_bitfield = (int64_t) ((qrg + rx_ofs_qrg) * inc_per_hz + 0.5);
+
+        plan->qrg[i]       = (float) qrg;
+        plan->tx_inc_lo[i] = (uint32_t) (tx_bitfield & 0xffffffff);
+        plan->tx_inc_hi[i] = (uint32_t) (tx_bitfield >> 32);
+        plan->rx_inc_lo[i] = (uint32_t) (rx_bitfield & 0xffffffff);
+        plan->rx_inc_hi[i] = (uint32_t) (rx_bitfield >> 32);
+    }
+
+    //fprintf(stderr, "INFO - fpga_rb_sweep_prepare: %d points from %lf Hz in steps of %lf Hz, dwell = %ld ns\n", points, start_qrg, step_qrg, plan->dwell_ns);
+    return points;
+}
+
+/*----------------------------------------------------------------------------*/
+int fpga_rb_sweep_begin(fpga_rb_sweep_plan_t* plan)
+{
+    if (!g_fpga_rb_reg_mem || !plan) {
+        fprintf(stderr, "ERROR - fpga_rb_sweep_begin: bad parameter (plan=%p) or not init'ed(g=%p)\n", plan, g_fpga_rb_reg_mem);
+        return -1;
+    }
+
+    /* pause the scanners and keep the increments they have reached */
+    if (plan->osc_mask & FPGA_RB_SWEEP_TX) {
+        plan->tx_saved[2] = FPGA_RB_RD(tx_car_osc_inc_scnr_lo);
+        plan->tx_saved[3] = FPGA_RB_RD(tx_car_osc_inc_scnr_hi);
+        FPGA_RB_WR(tx_car_osc_inc_scnr_lo, 0);
+        FPGA_RB_WR(tx_car_osc_inc_scnr_hi, 0);
+    }
+    if (plan->osc_mask & FPGA_RB_SWEEP_RX) {
+        plan->rx_saved[2] = FPGA_RB_RD(rx_car_osc_inc_scnr_lo);
+        plan->rx_saved[3] = FPGA_RB_RD(rx_car_osc_inc_scnr_hi);
+        FPGA_RB_WR(rx_car_osc_inc_scnr_lo, 0);
+        FPGA_RB_WR(rx_car_osc_inc_scnr_hi, 0);
+    }
+    fpga_rb_shadow_commit();
+
+    if (plan->osc_mask & FPGA_RB_SWEEP_TX) {
+        if (plan->tx_saved[2] || plan->tx_saved[3]) {
+            fpga_rb_shadow_invalidate(FPGA_RB_IDX(tx_car_osc_inc_lo));
+            fpga_rb_shadow_invalidate(FPGA_RB_IDX(tx_car_osc_inc_hi));
+        }
+        plan->tx_saved[0] = FPGA_RB_RD(tx_car_osc_inc_lo);
+        plan->tx_saved[1] = FPGA_RB_RD(tx_car_osc_inc_hi);
+    }
+    if (plan->osc_mask & FPGA_RB_SWEEP_RX) {
+        if (plan->rx_saved[2] || plan->rx_saved[3]) {
+            fpga_rb_shadow_invalidate(FPGA_RB_IDX(rx_car_osc_inc_lo));
+            fpga_rb_shadow_invalidate(FPGA_RB_IDX(rx_car_osc_inc_hi));
+        }
+        plan->rx_saved[0] = FPGA_RB_RD(rx_car_osc_inc_lo);
+        plan->rx_saved[1] = FPGA_RB_RD(rx_car_osc_inc_hi);
+    }
+    return 0;
+}
+
+/*----------------------------------------------------------------------------*/
+void fpga_rb_sweep_step(const fpga_rb_sweep_plan_t* plan, int idx)
+{
+    if (plan->osc_mask & FPGA_RB_SWEEP_TX) {
+        FPGA_RB_WR(tx_car_osc_inc_lo, plan->tx_inc_lo[idx]);
+        FPGA_RB_WR(tx_car_osc_inc_hi, plan->tx_inc_hi[idx]);
+    }
+    if (plan->osc_mask & FPGA_RB_SWEEP_RX) {
+        FPGA_RB_WR(rx_car_osc_inc_lo, plan->rx_inc_lo[idx]);
+        FPGA_RB_WR(rx_car_osc_inc_hi, plan->rx_inc_hi[idx]);
+    }
+    fpga_rb_shadow_commit();
+}
+
+/*----------------------------------------------------------------------------*/
+void fpga_rb_sweep_sample(const fpga_rb_sweep_plan_t* plan, int idx, float* strength, float* mag)
+{
+    strength[idx] = (float) g_fpga_rb_reg_mem->rx_signal_strength;
+    mag[idx]      = (float) g_fpga_rb_reg_mem->rx_afc_cordic_mag;
+}
+
+/*----------------------------------------------------------------------------*/
+void fpga_rb_sweep_end(const fpga_rb_sweep_plan_t* plan)
+{
+    /* back to the frequency and the scanner speed before the sweep */
+    if (plan->osc_mask & FPGA_RB_SWEEP_TX) {
+        FPGA_RB_WR(tx_car_osc_inc_lo,      plan->tx_saved[0]);
+        FPGA_RB_WR(tx_car_osc_inc_hi,      plan->tx_saved[1]);
+        FPGA_RB_WR(tx_car_osc_inc_scnr_lo, plan->tx_saved[2]);
+        FPGA_RB_WR(tx_car_osc_inc_scnr_hi, plan->tx_saved[3]);
+    }
+    if (plan->osc_mask & FPGA_RB_SWEEP_RX) {
+        FPGA_RB_WR(rx_car_osc_inc_lo,      plan->rx_saved[0]);
+        FPGA_RB_WR(rx_car_osc_inc_hi,      plan->rx_saved[1]);
+        FPGA_RB_WR(rx_car_osc_inc_scnr_lo, plan->rx_saved[2]);
+        FPGA_RB_WR(rx_car_osc_inc_scnr_hi, plan->rx_saved[3]);
+    }
+    fpga_rb_shadow_commit();
+}
+
+/*----------------------------------------------------------------------------*/
+int fpga_rb_read_rx_telemetry(fpga_rb_rx_telemetry_t* tlm)
+{
+    volatile fpga_rb_reg_mem_t* regs = g_fpga_rb_reg_mem;
+    uint32_t hi, lo;
+
+    if (!regs || !tlm) {
+        return -1;
+    }
+
+    tlm->signal_strength     =           regs->rx_signal_strength;
+    tlm->afc_cordic_mag      = (int16_t) regs->rx_afc_cordic_mag;
+    tlm->afc_cordic_phs      = (int16_t) regs->rx_afc_cordic_phs;
+    tlm->afc_cordic_phs_diff = (int16_t) regs->rx_afc_cordic_phs_diff;
+    tlm->rfin1               = (int16_t) regs->readout_rfin1;
+    tlm->rfin2               = (int16_t) regs->readout_rfin2;
+
+    /* the AFC moves the increment on its own, retry when a carry has passed between both halves */
+    do {
+        hi = regs->rx_car_afc_inc_hi;
+        lo = regs->rx_car_afc_inc_lo;
+    } while (hi != regs->rx_car_afc_inc_hi);
+    tlm->car_afc_inc = ((int64_t) (((uint64_t) (hi & 0xffff)) << 48) >> 16) | lo;  // sign extension of bit 47
+
+    return 0;
+}
+
 /*----------------------------------------------------------------------------*/
 void fpga_rb_set_rx_mod_osc_qrg__4mod_ssbweaver_am(double rx_mod_osc_qrg)
 {
@@ -1564,10 +1832,10 @@ void fpga_rb_set_rx_mod_osc_qrg__4mod_ssbweaver_am(double rx_mod_osc_qrg)
     //        bf_lo,
     //        rx_mod_osc_qrg);
 
-    g_fpga_rb_reg_mem->rx_mod_osc_inc_lo = bf_lo;
-    g_fpga_rb_reg_mem->rx_mod_osc_inc_hi = bf_hi;
-    g_fpga_rb_reg_mem->rx_mod_osc_ofs_lo = 0UL;                                                            // no carrier phase offset
-    g_fpga_rb_reg_mem->rx_mod_osc_ofs_hi = 0UL;                                                            // no carrier phase offset
+    FPGA_RB_WR(rx_mod_osc_inc_lo, bf_lo);
+    FPGA_RB_WR(rx_mod_osc_inc_hi, bf_hi);
+    FPGA_RB_WR(rx_mod_osc_ofs_lo, 0UL);                                                                    // no carrier phase offset
+    FPGA_RB_WR(rx_mod_osc_ofs_hi, 0UL);                                                                    // no carrier phase offset
 }
 
 /*----------------------------------------------------------------------------*/
@@ -1592,8 +1860,8 @@ void fpga_rb_set_rx_calc_afc_weaver__4mod_am_fm_pm(double rx_weaver_qrg)
     //        bf_lo,
     //        rx_weaver_qrg);
 
-    g_fpga_rb_reg_mem->rx_car_calc_weaver_inc_lo = bf_lo;
-    g_fpga_rb_reg_mem->rx_car_calc_weaver_inc_hi = bf_hi;
+    FPGA_RB_WR(rx_car_calc_weaver_inc_lo, bf_lo);
+    FPGA_RB_WR(rx_car_calc_weaver_inc_hi, bf_hi);
 }
 
 /*----------------------------------------------------------------------------*/
@@ -1604,7 +1872,7 @@ void fpga_rb_set_rx_amenv_filtvar(int rx_amenv_filtvar)
     else if (rx_amenv_filtvar > 2)
         rx_amenv_filtvar = 2;
 
-    g_fpga_rb_reg_mem->rx_amenv_filtvar = ((uint32_t) rx_amenv_filtvar) & 0x0003;
+    FPGA_RB_WR(rx_amenv_filtvar, ((uint32_t) rx_amenv_filtvar) & 0x0003);
 }
 
 /*----------------------------------------------------------------------------*/
@@ -1615,7 +1883,7 @@ void fpga_rb_set_rx_mod_ssb_am_gain__4mod_ssb_am(double rx_mod_ssb_am_gain)
     //fprintf(stderr, "INFO - fpga_rb_set_rx_mod_ssb_am_gain__4mod_ssb_am: (gain=%lf) <-- in(rx_mod_ssb_am_gain=%lf)\n",
     //        gain, rx_mod_ssb_am_gain);
 
-    g_fpga_rb_reg_mem->rx_mod_ssb_am_gain = ((uint32_t) gain) & 0xffff;
+    FPGA_RB_WR(rx_mod_ssb_am_gain, ((uint32_t) gain) & 0xffff);
 }
 
 /*----------------------------------------------------------------------------*/
@@ -1626,7 +1894,7 @@ void fpga_rb_set_rx_mod_amenv_gain__4mod_amenv(double rx_mod_amenv_gain)
     //fprintf(stderr, "INFO - fpga_rb_set_rx_mod_amenv_gain__4mod_amenv: (gain=%lf) <-- in(rx_mod_amenv_gain=%lf)\n",
     //        gain, rx_mod_amenv_gain);
 
-    g_fpga_rb_reg_mem->rx_mod_amenv_gain = ((uint32_t) gain) & 0xffff;
+    FPGA_RB_WR(rx_mod_amenv_gain, ((uint32_t) gain) & 0xffff);
 }
 
 /*----------------------------------------------------------------------------*/
@@ -1637,7 +1905,7 @@ void fpga_rb_set_rx_mod_fm_gain__4mod_fm(double rx_mod_fm_gain)
     //fprintf(stderr, "INFO - fpga_rb_set_rx_mod_fm_gain__4mod_fm: (gain=%lf) <-- in(rx_mod_fm_gain=%lf)\n",
     //        gain, rx_mod_fm_gain);
 
-    g_fpga_rb_reg_mem->rx_mod_fm_gain = ((uint32_t) gain) & 0xffff;
+    FPGA_RB_WR(rx_mod_fm_gain, ((uint32_t) gain) & 0xffff);
 }
 
 /*----------------------------------------------------------------------------*/
@@ -1648,7 +1916,7 @@ void fpga_rb_set_rx_mod_pm_gain__4mod_pm(double rx_mod_pm_gain)
     //fprintf(stderr, "INFO - fpga_rb_set_rx_mod_pm_gain__4mod_pm: (gain=%lf) <-- in(rx_mod_pm_gain=%lf)\n",
     //        gain, rx_mod_pm_gain);
 
-    g_fpga_rb_reg_mem->rx_mod_pm_gain = ((uint32_t) gain) & 0xffff;
+    FPGA_RB_WR(rx_mod_pm_gain, ((uint32_t) gain) & 0xffff);
 }
 
 /*----------------------------------------------------------------------------*/
@@ -1662,8 +1930,8 @@ void fpga_rb_set_rfout1_gain_ofs(double rfout1_gain, uint16_t rfout1_ofs)
     //fprintf(stderr, "INFO - fpga_rb_set_rfout1_gain_ofs: (gain=0x%08x) <-- in(rfout1_gain=%lf, rfout1_ofs=%d)\n",
     //                (uint32_t) gain, rfout1_gain, rfout1_ofs);
 
-    g_fpga_rb_reg_mem->rfout1_gain = ((uint32_t) gain) & 0xffff;
-    g_fpga_rb_reg_mem->rfout1_ofs  = rfout1_ofs;
+    FPGA_RB_WR(rfout1_gain, ((uint32_t) gain) & 0xffff);
+    FPGA_RB_WR(rfout1_ofs, rfout1_ofs);
 }
 
 /*----------------------------------------------------------------------------*/
@@ -1677,8 +1945,8 @@ void fpga_rb_set_rfout2_gain_ofs(double rfout2_gain, uint16_t rfout2_ofs)
     //fprintf(stderr, "INFO - fpga_rb_set_rfout2_gain_ofs: (gain=0x%08x) <-- in(rfout2_gain=%lf, rfout2_ofs=%d)\n",
     //                (uint32_t) gain, rfout2_gain, rfout2_ofs);
 
-    g_fpga_rb_reg_mem->rfout2_gain = ((uint32_t) gain) & 0xffff;
-    g_fpga_rb_reg_mem->rfout2_ofs  = rfout2_ofs;
+    FPGA_RB_WR(rfout2_gain, ((uint32_t) gain) & 0xffff);
+    FPGA_RB_WR(rfout2_ofs, rfout2_ofs);
 }
 
 /*----------------------------------------------------------------------------*/
@@ -1697,68 +1965,80 @@ uint16_t fpga_rb_get_ovrdrv()
 void prepare_rx_measurement(int inputLine)
 {
     // enable RB
-    g_fpga_rb_reg_mem->ctrl = 0x00000001;
+    FPGA_RB_WR_THRU(ctrl, 0x00000001);
 
     // power up the RX_CAR and RX_AFC section like for modulation FM (broad RX_AFC_FIR filter)
-    g_fpga_rb_reg_mem->pwr_ctrl = 0x00000007;
+    FPGA_RB_WR_THRU(pwr_ctrl, 0x00000007);
 
     // keep all output silent
-    g_fpga_rb_reg_mem->src_con_pnt = 0x00000000;
+    FPGA_RB_WR_THRU(src_con_pnt, 0x00000000);
 
     // RX_OSC set to 10 kHz
-    g_fpga_rb_reg_mem->rx_car_osc_inc_lo = 0x3e2d6238;
-    g_fpga_rb_reg_mem->rx_car_osc_inc_hi = 0x00000005;
+    FPGA_RB_WR_THRU(rx_car_osc_inc_lo, 0x3e2d6238);
+    FPGA_RB_WR_THRU(rx_car_osc_inc_hi, 0x00000005);
 
     // select input line
     //fprintf(stderr, "\nDEBUG prepare_rx_measurement: preparing ADC channel 0x%02x\n", inputLine);
-    g_fpga_rb_reg_mem->rx_muxin_src = inputLine;
+    FPGA_RB_WR_THRU(rx_muxin_src, inputLine);
 
     // set the input gain to maximum but no boost enabled
-    g_fpga_rb_reg_mem->rx_muxin_gain = 0x00001fff;
+    FPGA_RB_WR_THRU(rx_muxin_gain, 0x00001fff);
 }
 
 void finish_rx_measurement()
 {
     // clear the input offset register
-    g_fpga_rb_reg_mem->rx_muxin_ofs = 0x00000000;
+    FPGA_RB_WR_THRU(rx_muxin_ofs, 0x00000000);
 
     // close input line
-    g_fpga_rb_reg_mem->rx_muxin_src = 0;
+    FPGA_RB_WR_THRU(rx_muxin_src, 0);
 
     // RX_OSC clear
-    g_fpga_rb_reg_mem->rx_car_osc_inc_lo = 0;
-    g_fpga_rb_reg_mem->rx_car_osc_inc_hi = 0;
+    FPGA_RB_WR_THRU(rx_car_osc_inc_lo, 0);
+    FPGA_RB_WR_THRU(rx_car_osc_inc_hi, 0);
 
     // no power savings enabled
-    g_fpga_rb_reg_mem->pwr_ctrl = 0x00000000;
+    FPGA_RB_WR_THRU(pwr_ctrl, 0x00000000);
 
     // disable RB
-    g_fpga_rb_reg_mem->ctrl = 0;
+    FPGA_RB_WR_THRU(ctrl, 0);
+}
+
+/*----------------------------------------------------------------------------*/
+static void fpga_rb_spin_ns(struct timespec* deadline, long ns)
+{
+    struct timespec now;
+
+    deadline->tv_nsec += ns;
+    while (deadline->tv_nsec >= 1000000000L) {
+        deadline->tv_nsec -= 1000000000L;
+        deadline->tv_sec++;
+    }
+
+    /* far below the granularity of nanosleep(), poll the clock instead */
+    do {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+    } while ((now.tv_sec < deadline->tv_sec) || ((now.tv_sec == deadline->tv_sec) && (now.tv_nsec < deadline->tv_nsec)));
 }
 
-uint32_t test_rx_measurement(int16_t adc_offset_val, int reduction)
+uint32_t test_rx_measurement(int16_t adc_offset_val, int reduction, int reads)
 {
+    struct timespec deadline;
     uint32_t sumreg = 0;
 
     // set the ADC offset value
-    g_fpga_rb_reg_mem->rx_muxin_ofs = adc_offset_val;
+    FPGA_RB_WR_THRU(rx_muxin_ofs, adc_offset_val);
 
-    g_fpga_rb_reg_mem->rx_muxin_gain = 0x0000ffff >> reduction;
+    FPGA_RB_WR_THRU(rx_muxin_gain, 0x0000ffff >> reduction);
 
     // delay for filters going to be stable
-    {
-        struct timespec rqtp;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    fpga_rb_spin_ns(&deadline, FPGA_RB_CALIB_SETTLE_NS);
 
-        // each 200 kHz timestamp there is a new result available - sum up to reduce noise during measurement
-        rqtp.tv_sec  = 0;
-        rqtp.tv_nsec = 5000L;
-        nanosleep(&rqtp, NULL);
-
-        int iter;
-        for (iter = 8; iter; --iter) {
-            sumreg += ((g_fpga_rb_reg_mem->rx_afc_cordic_mag + 16) >> 5);  // each part is rounded
-            nanosleep(&rqtp, NULL);
-        }
+    // each 200 kHz timestamp there is a new result available - sum up to reduce noise during measurement
+    for (; reads > 0; --reads) {
+        sumreg += ((g_fpga_rb_reg_mem->rx_afc_cordic_mag + 16) >> 5);  // each part is rounded
+        fpga_rb_spin_ns(&deadline, FPGA_RB_CALIB_PERIOD_NS);
     }
 
     // read the current magnitude value of the CORDIC engine
@@ -1781,21 +2061,28 @@ int16_t rp_minimize_noise()
         if (reduction < 0) {
             reduction = 0;
         }
+        // the coarse steps are far apart from each other, two reads are enough to tell them apart
+        int reads = (i >= 8) ?  2 : 8;
 
         test_ofs_lo = min_ofs_value | (0b01 << (i - 1));
         test_ofs_hi = min_ofs_value | (0b11 << (i - 1));
 
-        test_sig_lo = test_rx_measurement((int16_t) (((int32_t) test_ofs_lo) - 0x8000), reduction);
-        test_sig_hi = test_rx_measurement((int16_t) (((int32_t) test_ofs_hi) - 0x8000), reduction);
+        test_sig_lo = test_rx_measurement((int16_t) (((int32_t) test_ofs_lo) - 0x8000), reduction, reads);
+        test_sig_hi = test_rx_measurement((int16_t) (((int32_t) test_ofs_hi) - 0x8000), reduction, reads);
         //fprintf(stderr, "DEBUG rp_minimize_noise: i=%02d, test_ofs_lo=0x%04x sig=%08x - test_ofs_hi=0x%04x sig=%08x\n", i, test_ofs_lo, test_sig_lo, test_ofs_hi, test_sig_hi);
+        if ((i < 8) && (test_sig_hi == test_sig_lo)) {
+            // down in the noise floor the remaining bits can not be resolved, take the middle of the range
+            min_ofs_value |= (1 << i);
+            return (int16_t) (((int32_t) min_ofs_value) - 0x8000);
+        }
         if (test_sig_hi < test_sig_lo) {
             min_ofs_value |= (1 << i);
         }
     }
     test_ofs_lo = min_ofs_value;
     test_ofs_hi = min_ofs_value | 0b1;
-    test_sig_lo = test_rx_measurement((int16_t) (((int32_t) test_ofs_lo) - 0x8000), 0);
-    test_sig_hi = test_rx_measurement((int16_t) (((int32_t) test_ofs_hi) - 0x8000), 0);
+    test_sig_lo = test_rx_measurement((int16_t) (((int32_t) test_ofs_lo) - 0x8000), 0, 8);
+    test_sig_hi = test_rx_measurement((int16_t) (((int32_t) test_ofs_hi) - 0x8000), 0, 8);
     //fprintf(stderr, "DEBUG rp_minimize_noise: i=%02d, test_ofs_lo=0x%04x sig=%08x - test_ofs_hi=0x%04x sig=%08x\n", 0, test_ofs_lo, test_sig_lo, test_ofs_hi, test_sig_hi);
     if (test_sig_hi < test_sig_lo) {
         min_ofs_value = test_ofs_hi;
@@ -1807,56 +2094,58 @@ int16_t rp_minimize_noise()
 
 void rp_measure_calib_params(rp_calib_params_t* calib_params)
 {
-    int16_t thisOfsValue;
+    /* input lines of the RX_MUXIN: ADC channels 0/1 "RF In 1/2", XADC channels #8, #0, #1, #9 "Vin0..3" */
+    static const int    lines[]      = { 0x20, 0x21, 0x18, 0x10, 0x11, 0x19 };
+    static const char*  line_names[] = { " ADC channel 0", " ADC channel 1", "XADC channel 0", "XADC channel 1", "XADC channel 2", "XADC channel 3" };
+    const int           count        = sizeof(lines) / sizeof(lines[0]);
+    int16_t             ofs[sizeof(lines) / sizeof(lines[0])];
+    const float         temp         = fpga_sys_xadc_get_temperature();
+    struct timespec     t0, t1;
+    int i;
 
     fprintf(stderr, "\n<== ADC offset calibration ==>\n");
+    clock_gettime(CLOCK_MONOTONIC, &t0);
 
-    // measure offset of channel ADC0 mapped to "RF In 1"
-    prepare_rx_measurement(0x20);
-    thisOfsValue = rp_minimize_noise();
-    fprintf(stderr, "INFO rp_measure_calib_params:  ADC channel 0 - ofs=0x%04x = %d\n", thisOfsValue, thisOfsValue);
-    calib_set_ADC_offset(calib_params, 0x20, thisOfsValue);
-
-    // measure offset of channel ADC1 mapped to "RF In 2"
-    prepare_rx_measurement(0x21);
-    thisOfsValue = rp_minimize_noise();
-    fprintf(stderr, "INFO rp_measure_calib_params:  ADC channel 1 - ofs=0x%04x = %d\n", thisOfsValue, thisOfsValue);
-    calib_set_ADC_offset(calib_params, 0x21, thisOfsValue);
-
-    // measure offset of XADC channel #8 mapped to "Vin0"
-    prepare_rx_measurement(0x18);
-    thisOfsValue = rp_minimize_noise();
-    fprintf(stderr, "INFO rp_measure_calib_params: XADC channel 0 - ofs=0x%04x = %d\n", thisOfsValue, thisOfsValue);
-    calib_set_ADC_offset(calib_params, 0x18, thisOfsValue);
-
-    // measure offset of XADC channel #0 mapped to "Vin1"
-    prepare_rx_measurement(0x10);
-    thisOfsValue = rp_minimize_noise();
-    fprintf(stderr, "INFO rp_measure_calib_params: XADC channel 1 - ofs=0x%04x = %d\n", thisOfsValue, thisOfsValue);
-    calib_set_ADC_offset(calib_params, 0x10, thisOfsValue);
-
-    // measure offset of XADC channel #1 mapped to "Vin2"
-    prepare_rx_measurement(0x11);
-    thisOfsValue = rp_minimize_noise();
-    fprintf(stderr, "INFO rp_measure_calib_params: XADC channel 2 - ofs=0x%04x = %d\n", thisOfsValue, thisOfsValue);
-    calib_set_ADC_offset(calib_params, 0x11, thisOfsValue);
-
-    // measure offset of XADC channel #9 mapped to "Vin3"
-    prepare_rx_measurement(0x19);
-    thisOfsValue = rp_minimize_noise();
-    fprintf(stderr, "INFO rp_measure_calib_params: XADC channel 3 - ofs=0x%04x = %d\n", thisOfsValue, thisOfsValue);
-    calib_set_ADC_offset(calib_params, 0x19, thisOfsValue);
+    // one set-up for all lines, only the input line is switched in between
+    prepare_rx_measurement(lines[0]);
+    for (i = 0; i < count; i++) {
+        if (i) {
+            FPGA_RB_WR_THRU(rx_muxin_src, lines[i]);
+        }
+        ofs[i] = rp_minimize_noise();
+        fprintf(stderr, "INFO rp_measure_calib_params: %s - ofs=0x%04x = %d\n", line_names[i], (uint16_t) ofs[i], ofs[i]);
+        calib_set_ADC_offset(calib_params, lines[i], ofs[i]);
+    }
 
 #if 0
     // measure offset of XADC channel Vp/Vn mapped to "Vin4"
-    prepare_rx_measurement(0x03);
-    thisOfsValue = rp_minimize_noise();
+    FPGA_RB_WR_THRU(rx_muxin_src, 0x03);
+    int16_t thisOfsValue = rp_minimize_noise();
     fprintf(stderr, "INFO rp_measure_calib_params: XADC channel 4 - ofs=0x%04x = %d\n", thisOfsValue, thisOfsValue);
     calib_set_ADC_offset(calib_params, 0x03, thisOfsValue);
 #endif
 
     finish_rx_measurement();
-    fprintf(stderr, "\n");
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    fprintf(stderr, "INFO rp_measure_calib_params: done in %.1f ms at %.1f degC\n\n",
+            (t1.tv_sec - t0.tv_sec) * 1e3 + (t1.tv_nsec - t0.tv_nsec) / 1e6, temp);
+
+    if (!isnan(temp)) {
+        calib_write_ADC_offset_cache(lines, ofs, count, temp);
+    }
+}
+
+void rp_calib_adc_offsets(rp_calib_params_t* calib_params, int measure)
+{
+    const float temp = fpga_sys_xadc_get_temperature();
+
+    if (measure) {
+        rp_measure_calib_params(calib_params);
+
+    } else if (!isnan(temp) && (calib_read_ADC_offset_cache(calib_params, temp) > 0)) {
+        fprintf(stderr, "INFO rp_calib_adc_offsets: ADC offsets taken from the cache at %.1f degC\n", temp);
+    }
 }
 
 
@@ -1201,6 +1201,81 @@ typedef struct fpga_rb_reg_mem_s {
 
 } fpga_rb_reg_mem_t;
 
+/** @brief Number of 32 bit words of the RadioBox register file. */
+#define FPGA_RB_REG_WORDS       (sizeof(fpga_rb_reg_mem_t) >> 2)
+
+
+/** @brief Maximum count of frequency steps of a sweep, one trace sample each. */
+#define FPGA_RB_SWEEP_POINTS_MAX    TRACE_LENGTH
+
+/** @brief Shortest dwell time of a sweep step: one result period of the 200 kHz receiver pipeline. */
+#define FPGA_RB_SWEEP_DWELL_MIN_NS  5000L
+
+/** @brief Longest duration of a complete sweep, the dwell time is shortened to fit. */
+#define FPGA_RB_SWEEP_DURATION_MAX_NS   60000000000LL
+
+/** @brief Sweep steps the TX_CAR_OSC, e.g. as a tracking generator. */
+#define FPGA_RB_SWEEP_TX            0x01
+/** @brief Sweep steps the RX_CAR_OSC. */
+#define FPGA_RB_SWEEP_RX            0x02
+
+/** @brief Frequency sweep plan - @see fpga_rb_sweep_prepare() */
+typedef struct fpga_rb_sweep_plan_s {
+    /** @brief points  Count of frequency steps, 1 .. FPGA_RB_SWEEP_POINTS_MAX */
+    int      points;
+
+    /** @brief osc_mask  Oscillators being stepped, FPGA_RB_SWEEP_TX and/or FPGA_RB_SWEEP_RX */
+    int      osc_mask;
+
+    /** @brief dwell_ns  Settling time of each step before the receiver is sampled */
+    long     dwell_ns;
+
+    /** @brief qrg  Frequency of each step in Hz */
+    float    qrg[FPGA_RB_SWEEP_POINTS_MAX];
+
+    /** @brief tx_inc_lo  Lower 32 bits of the 48 bit TX_CAR_OSC increment of each step, SSB weaver offset included */
+    uint32_t tx_inc_lo[FPGA_RB_SWEEP_POINTS_MAX];
+
+    /** @brief tx_inc_hi  Upper 16 bits of the 48 bit TX_CAR_OSC increment of each step, SSB weaver offset included */
+    uint32_t tx_inc_hi[FPGA_RB_SWEEP_POINTS_MAX];
+
+    /** @brief rx_inc_lo  Lower 32 bits of the 48 bit RX_CAR_OSC increment of each step, SSB weaver offset included */
+    uint32_t rx_inc_lo[FPGA_RB_SWEEP_POINTS_MAX];
+
+    /** @brief rx_inc_hi  Upper 16 bits of the 48 bit RX_CAR_OSC increment of each step, SSB weaver offset included */
+    uint32_t rx_inc_hi[FPGA_RB_SWEEP_POINTS_MAX];
+
+    /** @brief tx_saved  TX_CAR_OSC increment (lo, hi) and scanner increment (lo, hi) before the sweep */
+    uint32_t tx_saved[4];
+
+    /** @brief rx_saved  RX_CAR_OSC increment (lo, hi) and scanner increment (lo, hi) before the sweep */
+    uint32_t rx_saved[4];
+} fpga_rb_sweep_plan_t;
+
+/** @brief Snapshot of the RX status registers - @see fpga_rb_read_rx_telemetry() */
+typedef struct fpga_rb_rx_telemetry_s {
+    /** @brief signal_strength  RX_SIGNAL_STRENGTH, RX_AFC_CORDIC magnitude mean value */
+    uint32_t signal_strength;
+
+    /** @brief afc_cordic_mag  RX_AFC_CORDIC_MAG */
+    int16_t  afc_cordic_mag;
+
+    /** @brief afc_cordic_phs  RX_AFC_CORDIC_PHS */
+    int16_t  afc_cordic_phs;
+
+    /** @brief afc_cordic_phs_diff  RX_AFC_CORDIC_PHS_DIFF, phase advance within one 200 kHz clock */
+    int16_t  afc_cordic_phs_diff;
+
+    /** @brief rfin1  READOUT_RFIN1, current ADC value */
+    int16_t  rfin1;
+
+    /** @brief rfin2  READOUT_RFIN2, current ADC value */
+    int16_t  rfin2;
+
+    /** @brief car_afc_inc  RX_CAR_AFC_INC, 48 bit phase increment of the AFC sign extended */
+    int64_t  car_afc_inc;
+} fpga_rb_rx_telemetry_t;
+
 
 /* function declarations, detailed descriptions is in apparent implementation file  */
 
@@ -1239,6 +1314,24 @@ void fpga_rb_enable(int enable);
  */
 void fpga_rb_reset(void);
 
+/**
+ * @brief Forgets all register values held in the shadow register file
+ *
+ * The next write to each register goes to the FPGA unconditionally, the next read
+ * of each register is fetched from the FPGA. Used whenever the FPGA is (re-)mapped.
+ */
+void fpga_rb_shadow_reset(void);
+
+/**
+ * @brief Writes all modified registers of the shadow register file to the FPGA
+ *
+ * The fpga_rb_set_* functions stage their values in the shadow register file only.
+ * This function writes the changed words in ascending address order. Both halves of
+ * a 48 bit LO/HI register pair are written back to back, LO first, when either one
+ * has changed.
+ */
+void fpga_rb_shadow_commit(void);
+
 /**
  * @brief Updates all modified data attributes to the RadioBox FPGA sub-module
  *
@@ -1469,6 +1562,75 @@ void fpga_rb_set_rx_car_osc_qrg_inc__4mod_ssb_am_fm_pm(int rx_car_osc_qrg_inc);
  */
 double fpga_rb_get_rx_car_osc_qrg_inc();
 
+/**
+ * @brief Precomputes the oscillator increments of a frequency sweep
+ *
+ * The frequency runs from start_qrg towards stop_qrg in steps of step_qrg. When the
+ * range needs more than FPGA_RB_SWEEP_POINTS_MAX steps, or step_qrg is zero, the step
+ * width is widened to spread FPGA_RB_SWEEP_POINTS_MAX points over the range. The dwell
+ * time is shortened when the sweep would last longer than FPGA_RB_SWEEP_DURATION_MAX_NS.
+ * In the SSB modes the oscillators get the same weaver offset as fpga_rb_set_ctrl() applies.
+ *
+ * @param[out] plan         Sweep plan to be filled in.
+ * @param[in]  start_qrg    First frequency in Hz.
+ * @param[in]  stop_qrg     Last frequency in Hz, may be below start_qrg for a downward sweep.
+ * @param[in]  step_qrg     Frequency step width in Hz, the sign is taken from the range.
+ * @param[in]  dwell_us     Settling time of each step in us, at least FPGA_RB_SWEEP_DWELL_MIN_NS.
+ * @param[in]  osc_mask     Oscillators to be stepped, FPGA_RB_SWEEP_TX and/or FPGA_RB_SWEEP_RX.
+ * @param[in]  tx_modtyp    Current TX modulation variant, out of RB_TX_MODTYP_ENUM.
+ * @param[in]  rx_modtyp    Current RX modulation variant, out of RB_RX_MODTYP_ENUM.
+ * @retval     int          Count of frequency steps of the plan, -1 on bad arguments.
+ */
+int fpga_rb_sweep_prepare(fpga_rb_sweep_plan_t* plan, double start_qrg, double stop_qrg, double step_qrg, double dwell_us, int osc_mask,
+        int tx_modtyp, int rx_modtyp);
+
+/**
+ * @brief Pauses the carrier scanners of the stepped oscillators and keeps their state in the plan
+ *
+ * The sweep is then done step by step with fpga_rb_sweep_step() and fpga_rb_sweep_sample(),
+ * so the caller can wait for each dwell time without being blocked for the whole sweep.
+ *
+ * @param[in,out] plan      Sweep plan out of fpga_rb_sweep_prepare().
+ * @retval        int       0 on success, -1 when the FPGA is not mapped.
+ */
+int fpga_rb_sweep_begin(fpga_rb_sweep_plan_t* plan);
+
+/**
+ * @brief Programs the stepped oscillators to one frequency of the plan
+ *
+ * @param[in]  plan         Sweep plan, started by fpga_rb_sweep_begin().
+ * @param[in]  idx          Step 0 .. plan->points - 1.
+ */
+void fpga_rb_sweep_step(const fpga_rb_sweep_plan_t* plan, int idx);
+
+/**
+ * @brief Samples the receiver after the dwell time of a step has passed
+ *
+ * @param[in]  plan         Sweep plan, started by fpga_rb_sweep_begin().
+ * @param[in]  idx          Step 0 .. plan->points - 1.
+ * @param[out] strength     RX_SIGNAL_STRENGTH, stored at strength[idx].
+ * @param[out] mag          RX_AFC_CORDIC_MAG, stored at mag[idx].
+ */
+void fpga_rb_sweep_sample(const fpga_rb_sweep_plan_t* plan, int idx, float* strength, float* mag);
+
+/**
+ * @brief Sets the oscillators and scanners back to where they were before the sweep
+ *
+ * @param[in]  plan         Sweep plan, started by fpga_rb_sweep_begin().
+ */
+void fpga_rb_sweep_end(const fpga_rb_sweep_plan_t* plan);
+
+/**
+ * @brief Reads the RX status registers directly from the FPGA
+ *
+ * Only read-only registers are touched and the shadow register file is bypassed,
+ * so this function may be called from any thread.
+ *
+ * @param[out] tlm          Snapshot of the RX status registers.
+ * @retval     int          0 on success, -1 when the FPGA is not mapped.
+ */
+int fpga_rb_read_rx_telemetry(fpga_rb_rx_telemetry_t* tlm);
+
 /**
  * @brief Calculates and programs the FPGA RX_MOD_OSC for SSB and AM
  *
@@ -1570,13 +1732,16 @@ void finish_rx_measurement();
  *
  * @param[in] adc_offset_val  ADC offset value to be tried and measured.
  * @param[in] reduction       shift right value to reduce the input signal magnitude
+ * @param[in] reads           count of CORDIC magnitude results summed up, one each 200 kHz clock.
  * @retval                    signal strength as unsigned 32 bit value: lower is better.
  */
-uint32_t test_rx_measurement(int16_t adc_offset_val, int reduction);
+uint32_t test_rx_measurement(int16_t adc_offset_val, int reduction, int reads);
 
 /**
  * @brief Minimizing the noise by ADC offset value compensation
  *
+ * Successive approximation of the offset value, stopped early as soon as the
+ * noise floor does not allow to tell both candidates apart.
  */
 int16_t rp_minimize_noise();
 
@@ -1587,6 +1752,18 @@ int16_t rp_minimize_noise();
  */
 void rp_measure_calib_params(rp_calib_params_t* calib_params);
 
+/**
+ * @brief Sets up the ADC offsets of calib_params, measured or from the cache
+ *
+ * Without measure the offsets measured last are taken over when the die temperature
+ * is within CALIB_ADC_OFS_CACHE_TEMP_DEV of the one they were measured at, otherwise
+ * nothing is changed. With measure the offsets are measured and the cache is updated.
+ *
+ * @param[inout]  calib_params  set of calibration data to be updated.
+ * @param[in]     measure       nonzero to measure, zero to take over cached offsets only.
+ */
+void rp_calib_adc_offsets(rp_calib_params_t* calib_params, int measure);
+
 
 #if 0
 uint32_t fpga_rb_read_register(unsigned int rb_reg_ofs);
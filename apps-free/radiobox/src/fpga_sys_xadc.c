@@ -13,7 +13,7 @@
 #include <stdio.h>
 //#include <stdlib.h>
 #include <string.h>
-//#include <math.h>
+#include <math.h>
 //#include <pthread.h>
 #include <errno.h>
 //#include <sys/mman.h>
@@ -24,6 +24,7 @@
 
 #include "main.h"
 #include "fpga.h"
+#include "xadc_mon.h"
 
 
 /** @brief The system GPIO for XADC memory file descriptor used to mmap() the FPGA space. */
@@ -158,6 +159,20 @@ int fpga_sys_xadc_init(void)
     return 0;
 }
 
+/*----------------------------------------------------------------------------*/
+float fpga_sys_xadc_get_temperature(void)
+{
+    const float temp = xadc_mon_get_value(XADC_MON_CH_TEMP);
+
+    if (!isnan(temp)) {
+        return temp;  // cached by the XADC monitor
+    }
+    if (!g_fpga_sys_xadc_reg_mem) {
+        return NAN;
+    }
+    return (((float) g_fpga_sys_xadc_reg_mem->stat_temp) * 503.975f / 65536.0f) - 273.15f;
+}
+
 /*----------------------------------------------------------------------------*/
 int fpga_sys_xadc_exit(void)
 {
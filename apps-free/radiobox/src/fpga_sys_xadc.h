@@ -1208,6 +1208,15 @@ int fpga_sys_xadc_init(void);
  */
 int fpga_sys_xadc_exit(void);
 
+/**
+ * @brief Returns the current temperature of the die
+ *
+ * Taken from the XADC monitor while it is running, read from the XADC otherwise.
+ *
+ * @retval  float  Temperature in degrees Celsius, NAN when the XADC is not mapped.
+ */
+float fpga_sys_xadc_get_temperature(void);
+
 
 /** @} */
 
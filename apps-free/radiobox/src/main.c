@@ -18,6 +18,7 @@
 //#include <math.h>
 #include <errno.h>
 #include <pthread.h>
+#include <time.h>
 //#include <sys/types.h>
 #include <sys/mman.h>
 
@@ -69,94 +70,133 @@ fpga_rb_reg_mem_t*              g_fpga_rb_reg_mem = NULL;
 /** @brief Describes app. parameters with some info/limitations in high definition - compare initial values with: fpga_rb.fpga_rb_enable() */
 const rb_app_params_t g_rb_default_params[RB_PARAMS_NUM + 1] = {
     { /* Running mode - transport_pktIdx 1 */
-        "rb_run",                   0.0,   1, 0, 0.0,       1.0  },
+        "rb_run",                   0.0,   1, 0, 0.0,       1.0, RB_RUN  },
 
     { /* ADC biasing mode - transport_pktIdx 1 */
-        "rb_calib",                 0.0,   1, 0, 0.0,       1.0  },
+        "rb_calib",                 0.0,   1, 0, 0.0,       1.0, RB_CALIB  },
 
     { /* TX_CAR_OSC modulation source selector - transport_pktIdx 1 */
-        "tx_modsrc_s",              0.0,   1,  0, 0.0,    255.0  },
+        "tx_modsrc_s",              0.0,   1,  0, 0.0,    255.0, RB_TX_MODSRC  },
 
     { /* TX modulation type selector - transport_pktIdx 1 */
-        "tx_modtyp_s",              0.0,   1,  0, 0.0,    255.0  },
+        "tx_modtyp_s",              0.0,   1,  0, 0.0,    255.0, RB_TX_MODTYP  },
 
     { /* TX modulation type selector - transport_pktIdx 1 */
-        "rx_modtyp_s",              0.0,   1,  0, 0.0,    255.0  },
+        "rx_modtyp_s",              0.0,   1,  0, 0.0,    255.0, RB_RX_MODTYP  },
 
     { /* RBLED CON_SRC_PNT - transport_pktIdx 1 */
-        "rbled_csp_s",              0.0,   1,  0, 0.0,    255.0  },
+        "rbled_csp_s",              0.0,   1,  0, 0.0,    255.0, RB_LED_CON_SRC_PNT  },
 
     { /* RFOUT1 CON_SRC_PNT - transport_pktIdx 1 */
-        "rfout1_csp_s",             0.0,   1,  0, 0.0,    255.0  },
+        "rfout1_csp_s",             0.0,   1,  0, 0.0,    255.0, RB_RFOUT1_CON_SRC_PNT  },
 
     { /* RFOUT2 CON_SRC_PNT - transport_pktIdx 1 */
-        "rfout2_csp_s",             0.0,   1,  0, 0.0,    255.0  },
+        "rfout2_csp_s",             0.0,   1,  0, 0.0,    255.0, RB_RFOUT2_CON_SRC_PNT  },
 
     { /* RX_MUX source - transport_pktIdx 1 */
-        "rx_muxin_src_s",           0.0,   1,  0, 0.0,    255.0  },
+        "rx_muxin_src_s",           0.0,   1,  0, 0.0,    255.0, RB_RX_MUXIN_SRC  },
 
 
     { /* TX_CAR_OSC frequency (Hz) - transport_pktIdx 2 */
-        "tx_car_osc_qrg_f",         0.0,   1,  0, 0.0,  62.5e+6  },
+        "tx_car_osc_qrg_f",         0.0,   1,  0, 0.0,  62.5e+6, RB_TX_CAR_OSC_QRG  },
 
     { /* RX_CAR_OSC frequency (Hz) - transport_pktIdx 2 */
-        "rx_car_osc_qrg_f",         0.0,   1,  0, 0.0,  62.5e+6  },
+        "rx_car_osc_qrg_f",         0.0,   1,  0, 0.0,  62.5e+6, RB_RX_CAR_OSC_QRG  },
 
 
     { /* TX_MOD_OSC frequency (Hz) - transport_pktIdx 3 */
-        "tx_mod_osc_qrg_f",         0.0,   1,  0, 0.0,  62.5e+6  },
+        "tx_mod_osc_qrg_f",         0.0,   1,  0, 0.0,  62.5e+6, RB_TX_MOD_OSC_QRG  },
 
     { /* TX_MUX in (Mic in) slider ranges from 0% to 100% - transport_pktIdx 3 */
-        "tx_muxin_gain_s",          0.0,   1,  0, 0.0,    100.0  },
+        "tx_muxin_gain_s",          0.0,   1,  0, 0.0,    100.0, RB_TX_MUXIN_GAIN  },
 
     { /* RX_MUX in - transport_pktIdx 3 */
-        "rx_muxin_gain_s",          0.0,   1,  0, 0.0,    100.0  },
+        "rx_muxin_gain_s",          0.0,   1,  0, 0.0,    100.0, RB_RX_MUXIN_GAIN  },
 
     { /* Frequency QRG controller influences TX - transport_pktIdx 3 */
-        "tx_qrg_sel_s",             0.0,   1,  0, 0.0,      1.0  },
+        "tx_qrg_sel_s",             0.0,   1,  0, 0.0,      1.0, RB_TX_QRG_SEL  },
 
     { /* Frequency QRG controller influences RX - transport_pktIdx 3 */
-        "rx_qrg_sel_s",             0.0,   1,  0, 0.0,      1.0  },
+        "rx_qrg_sel_s",             0.0,   1,  0, 0.0,      1.0, RB_RX_QRG_SEL  },
 
 
     { /* TX_AMP_RF amplitude (mV) - transport_pktIdx 4 */
-        "tx_amp_rf_gain_s",         0.0,   1,  0, 0.0,   2047.0  },
+        "tx_amp_rf_gain_s",         0.0,   1,  0, 0.0,   2047.0, RB_TX_AMP_RF_GAIN  },
 
     { /* TX_MOD_OSC magnitude (AM:%, FM:Hz, PM:°) - transport_pktIdx 4 */
-        "tx_mod_osc_mag_s",         0.0,   1,  0, 0.0,     1e+6  },
+        "tx_mod_osc_mag_s",         0.0,   1,  0, 0.0,     1e+6, RB_TX_MOD_OSC_MAG  },
 
     { /* RFOUT1 termination information - transport_pktIdx 4 */
-        "rfout1_term_s",            0.0,   1,  0, 0.0,      1.0  },
+        "rfout1_term_s",            0.0,   1,  0, 0.0,      1.0, RB_RFOUT1_TERM  },
 
     { /* RFOUT2 termination information - transport_pktIdx 4 */
-        "rfout2_term_s",            0.0,   1,  0, 0.0,      1.0  },
+        "rfout2_term_s",            0.0,   1,  0, 0.0,      1.0, RB_RFOUT2_TERM  },
 
     { /* Frequency QRG increment range controller - transport_pktIdx 4 */
-        "qrg_inc_s",               50.0,   1,  0, 0.0,    100.0  },
+        "qrg_inc_s",               50.0,   1,  0, 0.0,    100.0, RB_QRG_INC  },
 
     { /* Overdrive flags - transport_pktIdx 4 */
-        "ovrdrv_s",                 0.0,   1,  0, 0.0,  65535.0  },
+        "ovrdrv_s",                 0.0,   1,  0, 0.0,  65535.0, RB_OVRDRV  },
 
     { /* AC97 LineOut Left  CON_SRC_PNT - transport_pktIdx 4 */
-        "ac97_lil_s",               0.0,   1,  0, 0.0,    255.0  },
+        "ac97_lil_s",               0.0,   1,  0, 0.0,    255.0, RB_AC97_LOL  },
 
     { /* AC97 LineOut Right CON_SRC_PNT - transport_pktIdx 4 */
-        "ac97_lir_s",               0.0,   1,  0, 0.0,    255.0  },
+        "ac97_lir_s",               0.0,   1,  0, 0.0,    255.0, RB_AC97_LOR  },
+
+
+    { /* Sweep start frequency (Hz) - transport_pktIdx 5 */
+        "sweep_start_f",            0.0,   0,  0, 0.0,  62.5e+6, RB_SWEEP_START_QRG  },
+
+    { /* Sweep stop frequency (Hz) - transport_pktIdx 5 */
+        "sweep_stop_f",             0.0,   0,  0, 0.0,  62.5e+6, RB_SWEEP_STOP_QRG  },
+
+
+    { /* Sweep frequency step (Hz), 0: spread over TRACE_LENGTH points - transport_pktIdx 6 */
+        "sweep_step_f",             0.0,   0,  0, 0.0,  62.5e+6, RB_SWEEP_STEP_QRG  },
+
+    { /* Sweep dwell time at each step (us) - transport_pktIdx 6 */
+        "sweep_dwell_s",          100.0,   0,  0, 5.0,    1e+6, RB_SWEEP_DWELL  },
+
+    { /* Sweep single-shot start - transport_pktIdx 6 */
+        "sweep_run",                0.0,   0,  0, 0.0,      1.0, RB_SWEEP_RUN  },
+
+
+    { /* RX telemetry sampling rate (Hz), 0: off - transport_pktIdx 7 */
+        "tlm_rate_s",               0.0,   0,  0, 0.0,   100e+3, RB_TLM_RATE  },
+
+    { /* RX telemetry file sink, samples per line, 0: off - transport_pktIdx 7 */
+        "tlm_sink_s",               0.0,   0,  0, 0.0,  16384.0, RB_TLM_SINK  },
+
+    { /* RX telemetry signal strength, mean of 100 ms - transport_pktIdx 7 */
+        "tlm_strength_s",           0.0,   0,  1, 0.0,    4e+9, RB_TLM_STRENGTH  },
+
+    { /* RX telemetry RX_AFC_CORDIC magnitude, mean of 100 ms - transport_pktIdx 7 */
+        "tlm_mag_s",                0.0,   0,  1, -32768.0, 32767.0, RB_TLM_MAG  },
+
+    { /* RX telemetry AFC frequency offset (Hz), mean of 100 ms - transport_pktIdx 7 */
+        "tlm_afc_qrg_f",            0.0,   0,  1, -62.5e+6, 62.5e+6, RB_TLM_AFC_QRG  },
 
 
     { /* has to be last entry */
-        NULL,                       0.0,  -1, -1, 0.0,      0.0  }
+        NULL,                       0.0,  -1, -1, 0.0,      0.0, -1  }
 };
 
-/** @brief CallBack copy of params to inform the worker */
-rp_app_params_t*                g_rp_cb_in_params = NULL;
+/** @brief CallBack copy of params to inform the worker, pending while its count is not zero */
+rb_params_block_t               g_rb_cb_in_params;
 /** @brief Holds mutex to access on parameters from outside to the worker thread */
 pthread_mutex_t                 g_rp_cb_in_params_mutex = PTHREAD_MUTEX_INITIALIZER;
-
-/** @brief Current copy of params of the worker thread */
-rb_app_params_t*                g_rb_info_worker_params = NULL;
-/** @brief Holds mutex to access parameters from the worker thread to any other context */
+/** @brief Signaled with g_rp_cb_in_params_mutex held when new params are queued, taken or the worker finished them */
+pthread_cond_t                  g_rp_cb_in_params_cond = PTHREAD_COND_INITIALIZER;
+/** @brief Time the oldest params still waiting in g_rb_cb_in_params were queued */
+struct timespec                 g_rp_cb_in_params_queued;
+/** @brief Count of parameter packets merged into g_rb_cb_in_params */
+int                             g_rp_cb_in_params_sets = 0;
+
+/** @brief Holds mutex to wait for the first params the worker thread exports - @see worker_get_params() */
 pthread_mutex_t                 g_rb_info_worker_params_mutex = PTHREAD_MUTEX_INITIALIZER;
+/** @brief Signaled with g_rb_info_worker_params_mutex held when the worker exported new params */
+pthread_cond_t                  g_rb_info_worker_params_cond = PTHREAD_COND_INITIALIZER;
 
 
 /** @brief params initialized */
@@ -177,6 +217,58 @@ const char CAST_NAME_EXT_MI[]      = "MI_";
 const char CAST_NAME_EXT_LO[]      = "LO_";
 const int  CAST_NAME_EXT_LEN       = 3;
 
+/** @brief Transport packet each parameter is sent with, 0: only with complete parameter sets - @see rp_copy_params_rb2rp() */
+static const unsigned char      s_rb_params_pktIdx[RB_PARAMS_NUM] = {
+    [RB_RUN]                = 1,
+    [RB_CALIB]              = 0,
+    [RB_TX_MODSRC]          = 1,
+    [RB_TX_MODTYP]          = 1,
+    [RB_RX_MODTYP]          = 1,
+    [RB_LED_CON_SRC_PNT]    = 1,
+    [RB_RFOUT1_CON_SRC_PNT] = 1,
+    [RB_RFOUT2_CON_SRC_PNT] = 1,
+    [RB_RX_MUXIN_SRC]       = 1,
+
+    [RB_TX_CAR_OSC_QRG]     = 2,
+    [RB_RX_CAR_OSC_QRG]     = 2,
+
+    [RB_TX_MOD_OSC_QRG]     = 3,
+    [RB_TX_MUXIN_GAIN]      = 3,
+    [RB_RX_MUXIN_GAIN]      = 3,
+    [RB_TX_QRG_SEL]         = 3,
+    [RB_RX_QRG_SEL]         = 3,
+
+    [RB_TX_AMP_RF_GAIN]     = 4,
+    [RB_TX_MOD_OSC_MAG]     = 4,
+    [RB_RFOUT1_TERM]        = 4,
+    [RB_RFOUT2_TERM]        = 4,
+    [RB_QRG_INC]            = 4,
+    [RB_OVRDRV]             = 4,
+    [RB_AC97_LOL]           = 4,
+    [RB_AC97_LOR]           = 4,
+
+    [RB_SWEEP_START_QRG]    = 5,
+    [RB_SWEEP_STOP_QRG]     = 5,
+
+    [RB_SWEEP_STEP_QRG]     = 6,
+    [RB_SWEEP_DWELL]        = 6,
+    [RB_SWEEP_RUN]          = 6,
+
+    [RB_TLM_RATE]           = 7,
+    [RB_TLM_SINK]           = 7,
+    [RB_TLM_STRENGTH]       = 7,
+    [RB_TLM_MAG]            = 7,
+    [RB_TLM_AFC_QRG]        = 7
+};
+
+/** @brief Slots of the name to parameter ID hash table, power of two */
+#define RB_PARAMS_HASH_SIZE     128
+
+/** @brief Name to parameter ID hash table, entries hold ID + 1 and 0 for an empty slot - @see rb_params_init_ids() */
+static unsigned char            s_rb_params_hash[RB_PARAMS_HASH_SIZE];
+/** @brief Seed for which all names of g_rb_default_params hash to different slots */
+static unsigned int             s_rb_params_hash_seed = 0;
+
 
 /*----------------------------------------------------------------------------------*/
 int is_quad(const char* name)
@@ -391,12 +483,100 @@ int rb_find_parms_index(const rb_app_params_t* src, const char* name)
 
 
 /*----------------------------------------------------------------------------------*/
-void rb_update_param(rb_app_params_t** dst, const char* param_name, double param_value)
+int rb_find_parms_index_by_id(const rb_app_params_t* src, int len, int id)
+{
+    if (!src || id < 0 || id >= RB_PARAMS_NUM) {
+        return -2;
+    }
+
+    /* lists in RB_PARAMS_ENUM order have got each parameter at the index of its ID */
+    if (id < len && src[id].id == id) {
+        return id;
+    }
+
+    int i = 0;
+    while (src[i].name) {
+        if (src[i].id == id) {
+            return i;
+        }
+        ++i;
+    }
+    return -1;
+}
+
+
+/*----------------------------------------------------------------------------------*/
+static unsigned int rb_params_hash(const char* name, unsigned int seed)
+{
+    unsigned int h = 2166136261U ^ seed;  // FNV-1a
+
+    while (*name) {
+        h ^= (unsigned char) *(name++);
+        h *= 16777619U;
+    }
+    return (h ^ (h >> 16)) & (RB_PARAMS_HASH_SIZE - 1);
+}
+
+/*----------------------------------------------------------------------------------*/
+int rb_params_init_ids(void)
+{
+    unsigned int seed;
+
+    for (seed = 0; seed < 0x10000; seed++) {
+        int id;
+
+        memset(s_rb_params_hash, 0, sizeof(s_rb_params_hash));
+        for (id = 0; id < RB_PARAMS_NUM; id++) {
+            unsigned int slot = rb_params_hash(g_rb_default_params[id].name, seed);
+            if (s_rb_params_hash[slot]) {
+                break;  // collision, try next seed
+            }
+            s_rb_params_hash[slot] = id + 1;
+        }
+
+        if (id == RB_PARAMS_NUM) {
+            s_rb_params_hash_seed = seed;
+            return 0;
+        }
+    }
+
+    fprintf(stderr, "ERROR rb_params_init_ids - no collision free hash seed found.\n");
+    memset(s_rb_params_hash, 0, sizeof(s_rb_params_hash));
+    return -1;
+}
+
+/*----------------------------------------------------------------------------------*/
+int rb_params_id(const char* name)
+{
+    if (!name) {
+        return -1;
+    }
+
+    int id = s_rb_params_hash[rb_params_hash(name, s_rb_params_hash_seed)] - 1;
+    if (id < 0 || strcmp(g_rb_default_params[id].name, name)) {
+        return -1;
+    }
+    return id;
+}
+
+/*----------------------------------------------------------------------------------*/
+int rb_params_pktIdx(int id)
+{
+    if (id < 0 || id >= RB_PARAMS_NUM) {
+        return 0;
+    }
+    return s_rb_params_pktIdx[id];
+}
+
+
+/*----------------------------------------------------------------------------------*/
+void rb_update_param(rb_app_params_t** dst, int id, double param_value)
 {
-    if (!dst || !param_name) {
+    if (!dst || id < 0 || id >= RB_PARAMS_NUM) {
         fprintf(stderr, "ERROR rb_update_param - Bad function arguments received.\n");
         return;
     }
+    const char* param_name = g_rb_default_params[id].name;
     int l_num_params = 0;
     int param_name_len = strlen(param_name);
 
@@ -406,7 +586,7 @@ void rb_update_param(rb_app_params_t** dst, const char* param_name, double param
 
     rb_app_params_t* p_dst = *dst;
     if (p_dst) {
-        int idx = rb_find_parms_index(p_dst, param_name);
+        int idx = rb_find_parms_index_by_id(p_dst, -1, id);
         if (idx >= 0) {
             /* update existing entry */
 #if 0
@@ -431,15 +611,12 @@ void rb_update_param(rb_app_params_t** dst, const char* param_name, double param
         /* count entries */
         while (p_dst[l_num_params].name)
             l_num_params++;
-
-    } else {
-        l_num_params++;
     }
 
-    /* re-map to a bigger buffer */
-    //fprintf(stderr, "DEBUG rb_update_param - realloc buffer for %d elements. Old ptr = %p\n", l_num_params + 1, p_dst);
-    p_dst = *dst = realloc(p_dst, sizeof(rb_app_params_t) * (l_num_params + 1));
-    //fprintf(stderr, "DEBUG rb_update_param - realloc buffer for %d elements. New ptr = %p\n", l_num_params + 1, p_dst);
+    /* re-map to a bigger buffer, one more entry and the list terminator */
+    //fprintf(stderr, "DEBUG rb_update_param - realloc buffer for %d elements. Old ptr = %p\n", l_num_params + 2, p_dst);
+    p_dst = *dst = realloc(p_dst, sizeof(rb_app_params_t) * (l_num_params + 2));
+    //fprintf(stderr, "DEBUG rb_update_param - realloc buffer for %d elements. New ptr = %p\n", l_num_params + 2, p_dst);
 
     p_dst[l_num_params].name = malloc(param_name_len + 1);
     strncpy(p_dst[l_num_params].name, param_name, param_name_len + 1);
@@ -448,6 +625,7 @@ void rb_update_param(rb_app_params_t** dst, const char* param_name, double param
     p_dst[l_num_params].read_only   = 0;
     p_dst[l_num_params].min_val     = 0.0;
     p_dst[l_num_params].max_val     = 62.5e6;
+    p_dst[l_num_params].id          = id;
     p_dst[l_num_params + 1].name = NULL;
 
     //fprintf(stderr, "DEBUG rb_update_param - list after modify:\n");
@@ -600,6 +778,79 @@ int rp_copy_params(rp_app_params_t** dst, const rp_app_params_t src[], int len,
     return l_num_params;
 }
 
+/*----------------------------------------------------------------------------------*/
+static void rb_params_block_put(rb_params_block_t* dst, const char* name, double value)
+{
+    int part = -1;
+
+    if (!strncmp(CAST_NAME_EXT_SE, name, CAST_NAME_EXT_LEN)) {
+        part = 0;
+    } else if (!strncmp(CAST_NAME_EXT_HI, name, CAST_NAME_EXT_LEN)) {
+        part = 1;
+    } else if (!strncmp(CAST_NAME_EXT_MI, name, CAST_NAME_EXT_LEN)) {
+        part = 2;
+    } else if (!strncmp(CAST_NAME_EXT_LO, name, CAST_NAME_EXT_LEN)) {
+        part = 3;
+    }
+
+    const int id = rb_params_id((part >= 0) ?  (name + CAST_NAME_EXT_LEN) : name);  // the extension is stripped away before the lookup
+    if (id < 0) {
+        return;  // not a RadioBox parameter, e.g. the pktIdx
+    }
+
+    if (part >= 0) {                                                                                    // QUAD element
+        dst->quad[id][part] = (float) value;
+        dst->quad_mask[id] |= 1 << part;
+        if (dst->quad_mask[id] != 0x0f) {
+            return;  // wait for the other parts
+        }
+        dst->quad_mask[id] = 0;
+        dst->value[id] = cast_4xbf_to_1xdouble(dst->quad[id][0], dst->quad[id][1], dst->quad[id][2], dst->quad[id][3]);
+
+    } else {                                                                                            // SINGLE element
+        dst->value[id] = value;
+    }
+
+    if (!dst->set[id]) {
+        dst->set[id] = 1;
+        dst->count++;
+    }
+}
+
+/*----------------------------------------------------------------------------------*/
+int rb_params_block_merge(rb_params_block_t* dst, const rp_app_params_t src[], int len)
+{
+    /* check arguments */
+    if (!src || !dst) {
+        fprintf(stderr, "ERROR rb_params_block_merge - Internal error, the destination parameter block is not set.\n");
+        return -1;
+    }
+
+    int i;
+    for (i = 0; ((len < 0) || (i < len)) && src[i].name; i++) {
+        rb_params_block_put(dst, src[i].name, src[i].value);
+    }
+
+    return dst->count;
+}
+
+/*----------------------------------------------------------------------------------*/
+int rb_params_block_merge_hd(rb_params_block_t* dst, const rp_app_params_hd_t src[], int len)
+{
+    /* check arguments */
+    if (!src || !dst) {
+        fprintf(stderr, "ERROR rb_params_block_merge_hd - Internal error, the destination parameter block is not set.\n");
+        return -1;
+    }
+
+    int i;
+    for (i = 0; ((len < 0) || (i < len)) && src[i].name; i++) {
+        rb_params_block_put(dst, src[i].name, src[i].value);
+    }
+
+    return dst->count;
+}
+
 /*----------------------------------------------------------------------------------*/
 int rb_copy_params(rb_app_params_t** dst, const rb_app_params_t src[], int len, int do_copy_all_attr)
 {
@@ -622,12 +873,17 @@ int rb_copy_params(rb_app_params_t** dst, const rb_app_params_t src[], int len,
         //fprintf(stderr, "DEBUG rb_copy_params - dst exists - updating into dst vector.\n");
         /* destination buffer exists */
         int i, j;
+        int l_num_dst_params = 0;
+        while (p_dst[l_num_dst_params].name) {
+            l_num_dst_params++;
+        }
+
         for (i = 0, j = 0; s[i].name; i++) {
             l_num_params++;
             //fprintf(stderr, "DEBUG rb_copy_params - processing name = %s\n", s[i].name);
             /* process each parameter entry of the list */
 
-            j = rb_find_parms_index(p_dst, s[i].name);
+            j = rb_find_parms_index_by_id(p_dst, l_num_dst_params, s[i].id);
             if (j >= 0) {
                 //fprintf(stderr, "DEBUG rb_copy_params - fill in\n");
                 p_dst[j].value = s[i].value;
@@ -679,6 +935,7 @@ int rb_copy_params(rb_app_params_t** dst, const rb_app_params_t src[], int len,
 
             p_dst[i].value          = s[i].value;
             p_dst[i].fpga_update    = s[i].fpga_update;
+            p_dst[i].id             = s[i].id;
             if (do_copy_all_attr) {                                                                     // if default parameters are taken, use all attributes
                 p_dst[i].fpga_update    = s[i].fpga_update;
                 p_dst[i].read_only      = s[i].read_only;
@@ -749,55 +1006,13 @@ int rp_copy_params_rb2rp(rp_app_params_t** dst, const rb_app_params_t src[])
             const int slen = strlen(src[i].name);
             char found = 0;
 
-            /* limit transfer volume to a part of all param entries, @see main.g_rb_default_params (abt. line 70) for a full list */
-            switch (g_transport_pktIdx & 0x7f) {
-            case 1:
-                if (!strcmp("rb_run",              src[i].name) ||
-                    !strcmp("tx_modsrc_s",         src[i].name) ||
-                    !strcmp("tx_modtyp_s",         src[i].name) ||
-                    !strcmp("rx_modtyp_s",         src[i].name) ||
-                    !strcmp("rbled_csp_s",         src[i].name) ||
-                    !strcmp("rfout1_csp_s",        src[i].name) ||
-                    !strcmp("rfout2_csp_s",        src[i].name) ||
-                    !strcmp("rx_muxin_src_s",      src[i].name)) {
-                    found = 1;
-                }
-                break;
+            /* limit transfer volume to a part of all param entries, @see main.s_rb_params_pktIdx for the packet of each entry */
+            if ((g_transport_pktIdx & 0x7f) >= 1 && (g_transport_pktIdx & 0x7f) <= RB_TRANSPORT_PKTIDX_MAX) {
+                found = (rb_params_pktIdx(src[i].id) == (g_transport_pktIdx & 0x7f));
 
-            case 2:
-                if (!strcmp("tx_car_osc_qrg_f",    src[i].name) ||
-                    !strcmp("rx_car_osc_qrg_f",    src[i].name)) {
-                    found = 1;
-                }
-                break;
-
-            case 3:
-                if (!strcmp("tx_mod_osc_qrg_f",    src[i].name) ||
-                    !strcmp("tx_muxin_gain_s",     src[i].name) ||
-                    !strcmp("rx_muxin_gain_s",     src[i].name) ||
-                    !strcmp("tx_qrg_sel_s",        src[i].name) ||
-                    !strcmp("rx_qrg_sel_s",        src[i].name)) {
-                    found = 1;
-                }
-                break;
-
-            case 4:
-                if (!strcmp("tx_amp_rf_gain_s",    src[i].name) ||
-                    !strcmp("tx_mod_osc_mag_s",    src[i].name) ||
-                    !strcmp("rfout1_term_s",       src[i].name) ||
-                    !strcmp("rfout2_term_s",       src[i].name) ||
-                    !strcmp("qrg_inc_s",           src[i].name) ||
-                    !strcmp("ovrdrv_s",            src[i].name) ||
-                    !strcmp("ac97_lil_s",          src[i].name) ||
-                    !strcmp("ac97_lir_s",          src[i].name)) {
-                    found = 1;
-                }
-                break;
-
-            default:
+            } else {
                 /* no limitation of output data */
-                    found = 1;
-                break;
+                found = 1;
             }
 
             if (!found) {
@@ -874,6 +1089,69 @@ int rp_copy_params_rb2rp(rp_app_params_t** dst, const rb_app_params_t src[])
     return l_num_single_params + (l_num_quad_params << 2);
 }
 
+/*----------------------------------------------------------------------------------*/
+int rp_copy_params_rb2hd(rp_app_params_hd_t** dst, const rb_app_params_t src[])
+{
+    const int pktIdx = g_transport_pktIdx & 0x7f;
+    int l_num_params = 0;
+
+    /* check arguments */
+    if (!dst) {
+        fprintf(stderr, "ERROR rp_copy_params_rb2hd - Internal error, the destination Application parameters vector variable is not set.\n");
+        return -1;
+    }
+    if (!src) {
+        fprintf(stderr, "ERROR rp_copy_params_rb2hd - Internal error, the source Application parameters vector variable is not set.\n");
+        return -2;
+    }
+
+    /* check if destination buffer is allocated already */
+    if (*dst) {
+        rp_free_params_hd(dst);
+    }
+
+    /* allocate array of parameter entries for the worst case, parameter names must be allocated separately */
+    int i;
+    for (i = 0; src[i].name; i++) { }
+    rp_app_params_hd_t* p_dst = (rp_app_params_hd_t*) malloc(sizeof(rp_app_params_hd_t) * (i + 1));
+    if (!p_dst) {
+        fprintf(stderr, "ERROR rp_copy_params_rb2hd - memory problem, the destination buffer failed to be allocated (1).\n");
+        return -3;
+    }
+
+    for (i = 0; src[i].name; i++) {
+        /* limit transfer volume to a part of all param entries, @see main.s_rb_params_pktIdx for the packet of each entry */
+        if ((pktIdx >= 1) && (pktIdx <= RB_TRANSPORT_PKTIDX_MAX) && (rb_params_pktIdx(src[i].id) != pktIdx)) {
+            continue;
+        }
+
+        const int slen = strlen(src[i].name);
+        p_dst[l_num_params].name = (char*) malloc(slen + 1);
+        if (!(p_dst[l_num_params].name)) {
+            fprintf(stderr, "ERROR rp_copy_params_rb2hd - memory problem, the destination buffers failed to be allocated (2).\n");
+            p_dst[l_num_params].name = NULL;
+            *dst = p_dst;
+            return -3;
+        }
+        strncpy(p_dst[l_num_params].name, src[i].name, slen);
+        p_dst[l_num_params].name[slen] = '\0';
+
+        p_dst[l_num_params].value       = src[i].value;
+        p_dst[l_num_params].fpga_update = src[i].fpga_update;
+        p_dst[l_num_params].read_only   = src[i].read_only;
+        p_dst[l_num_params].min_val     = src[i].min_val;
+        p_dst[l_num_params].max_val     = src[i].max_val;
+        l_num_params++;
+    }
+
+    /* mark last one as final entry */
+    p_dst[l_num_params].name = NULL;
+    p_dst[l_num_params].value = -1;
+    *dst = p_dst;
+
+    return l_num_params;
+}
+
 /*----------------------------------------------------------------------------------*/
  int rp_copy_params_rp2rb(rb_app_params_t** dst, const rp_app_params_t src[])
 {
@@ -958,7 +1236,7 @@ int rp_copy_params_rb2rp(rp_app_params_t** dst, const rb_app_params_t src[])
                     continue;  // no quad found, ignore uncomplete entries
                 }
 
-                j = rb_find_parms_index(p_dst, src[i].name + CAST_NAME_EXT_LEN);  // the extension is stripped away before the compare
+                j = rb_find_parms_index_by_id(p_dst, -1, rb_params_id(src[i].name + CAST_NAME_EXT_LEN));  // the extension is stripped away before the lookup
                 if (j < 0) {
                     // discard new entry if not already known in target vector
                     fprintf(stderr, "WARNING rp_copy_params_rp2rb (1) - input element of vector is unknown - name = %s\n", src[i].name);
@@ -969,7 +1247,7 @@ int rp_copy_params_rb2rp(rp_app_params_t** dst, const rb_app_params_t src[])
                 //fprintf(stderr, "INFO rp_copy_params_rp2rb - out[%d] copied from in[%d, %d, %d, %d] - name = %s, val = %lf\n", j, i_se, i_hi, i_mi, i_lo, src[i_lo].name + CAST_NAME_EXT_LEN, p_dst[j].value);
 
             } else {                                                                                    // SINGLE element
-                j = rb_find_parms_index(p_dst, src[i].name);
+                j = rb_find_parms_index_by_id(p_dst, -1, rb_params_id(src[i].name));
                 if (j < 0) {
                     // discard new entry if not already known in target vector
                     fprintf(stderr, "WARNING rp_copy_params_rp2rb (2) - input element of vector is unknown - name = %s\n", src[i].name);
@@ -1046,6 +1324,7 @@ int rp_copy_params_rb2rp(rp_app_params_t** dst, const rb_app_params_t src[])
 
                 strncpy(p_dst[j].name, src[i_lo].name + CAST_NAME_EXT_LEN, slen);                       // yyy <-- LO_yyy
                 p_dst[j].name[slen] = '\0';
+                p_dst[j].id = rb_params_id(p_dst[j].name);
 
                 rp2rb_params_value_copy(&(p_dst[j]), src[i_se], src[i_hi], src[i_mi], src[i_lo]);
                 //fprintf(stderr, "INFO rp_copy_params_rp2rb - out[%d] copied from in[%d,%d,%d,%d] - name = %s, val = %lf\n", j, i_se, i_hi, i_mi, i_lo, src[i_lo].name + CAST_NAME_EXT_LEN, p_dst[j].value);
@@ -1070,6 +1349,7 @@ int rp_copy_params_rb2rp(rp_app_params_t** dst, const rb_app_params_t src[])
                 }
                 strncpy(p_dst[j].name, src[i].name, slen);
                 p_dst[j].name[slen] = '\0';
+                p_dst[j].id = rb_params_id(p_dst[j].name);
 
                 p_dst[j].value       = src[i].value;
                 p_dst[j].fpga_update = src[i].fpga_update;
@@ -1132,6 +1412,29 @@ int rp_free_params(rp_app_params_t** params)
     return 0;
 }
 
+/*----------------------------------------------------------------------------------*/
+int rp_free_params_hd(rp_app_params_hd_t** params)
+{
+    if (!params) {
+        return -1;
+    }
+
+    /* free params structure */
+    if (*params) {
+        rp_app_params_hd_t* p = *params;
+
+        int i;
+        for (i = 0; p[i].name; i++) {
+            free(p[i].name);
+            p[i].name = NULL;
+        }
+
+        free(*params);
+        *params = NULL;
+    }
+    return 0;
+}
+
 /*----------------------------------------------------------------------------------*/
 int rb_free_params(rb_app_params_t** params)
 {
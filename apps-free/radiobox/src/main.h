@@ -52,6 +52,31 @@ typedef struct rp_app_params_s {
     float  max_val;
 } rp_app_params_t;
 
+/** @brief Parameters description structure with double precision values - must be the same for all RP controllers
+ *
+ * Used by rp_set_params_hd() and rp_get_params_hd(), these carry the values natively
+ * instead of as quad encoded floats.
+ **/
+typedef struct rp_app_params_hd_s {
+    /** @brief name  Name of the parameter */
+    char  *name;
+
+    /** @brief value  Value of the parameter */
+    double value;
+
+    /** @brief fpga_update  Do a FPGA register update based on this parameter */
+    int    fpga_update;
+
+    /** @brief read_only  The value of this parameter can not be changed */
+    int    read_only;
+
+    /** @brief min_val  The lower limit of the value */
+    double min_val;
+
+    /** @brief max_val  The upper limit of the value */
+    double max_val;
+} rp_app_params_hd_t;
+
 /** @brief High definition parameters description structure
  *
  * This structure has got expanded data types for higher precision
@@ -75,11 +100,14 @@ typedef struct rb_app_params_s {
 
     /** @brief max_val  The upper limit of the value high precision */
     double max_val;
+
+    /** @brief id  Parameter ID out of RB_PARAMS_ENUM, -1 for unknown names */
+    int    id;
 } rb_app_params_t;
 
 
 /* Parameters indexes - these defines should be in the same order as
- * rp_app_params_t structure defined in main.c */
+ * g_rb_default_params defined in main.c, the enum value is the parameter ID */
 
 /** @brief RadioBox parameters */
 enum rb_params_enum_t {
@@ -111,9 +139,48 @@ enum rb_params_enum_t {
     RB_AC97_LOL,
     RB_AC97_LOR,
 
+    RB_SWEEP_START_QRG,
+    RB_SWEEP_STOP_QRG,
+
+    RB_SWEEP_STEP_QRG,
+    RB_SWEEP_DWELL,
+    RB_SWEEP_RUN,
+
+    RB_TLM_RATE,
+    RB_TLM_SINK,
+    RB_TLM_STRENGTH,
+    RB_TLM_MAG,
+    RB_TLM_AFC_QRG,
+
     RB_PARAMS_NUM
 } RB_PARAMS_ENUM;
 
+/** @brief Count of transport packets a complete parameter set is split into, @see rb_params_pktIdx() */
+#define RB_TRANSPORT_PKTIDX_MAX     7
+
+
+/** @brief Parameter set of fixed layout, indexed by parameter ID
+ *
+ * Used to hand parameters between the callbacks and the worker without
+ * any heap memory being involved.
+ **/
+typedef struct rb_params_block_s {
+    /** @brief value  Value of each parameter with high precision */
+    double        value[RB_PARAMS_NUM];
+
+    /** @brief set  Non-zero for each parameter this block carries a value for */
+    unsigned char set[RB_PARAMS_NUM];
+
+    /** @brief quad  Parts SE, HI, MI and LO of quad transported values */
+    float         quad[RB_PARAMS_NUM][4];
+
+    /** @brief quad_mask  Bit field of the quad parts received so far */
+    unsigned char quad_mask[RB_PARAMS_NUM];
+
+    /** @brief count  Count of parameters set */
+    int           count;
+} rb_params_block_t;
+
 
 /** @brief RadioBox modulation sources */
 enum rb_modsrc_enum_t {
@@ -287,15 +354,59 @@ int rp_find_parms_index(const rp_app_params_t* src, const char* name);
  */
 int rb_find_parms_index(const rb_app_params_t* src, const char* name);
 
+/**
+ * @brief Returns the index number of the params vector for which the id attribute matches
+ *
+ * Lists in RB_PARAMS_ENUM order, as copies of g_rb_default_params are, resolve without a scan.
+ *
+ * @param[in]   src      Params vector to be scanned.
+ * @param[in]   len      Count of valid entries in src, -1 if unknown.
+ * @param[in]   id       Parameter ID to be search for.
+ * @retval      -2       Bad attributes.
+ * @retval      -1       No matching vector entry found.
+ * @retval      int      Value 0..(n-1) as index of the vector.
+ */
+int rb_find_parms_index_by_id(const rb_app_params_t* src, int len, int id);
+
 
 /**
- * @brief Returns the index number of the params vector for which the name attribute matches
+ * @brief Builds the name to parameter ID hash table out of g_rb_default_params
+ *
+ * A hash seed is searched for which every parameter name gets a slot of its own,
+ * so rb_params_id() needs one hash and one strcmp() to resolve a name.
+ *
+ * @retval      0        Success.
+ * @retval      -1       No collision free seed found.
+ */
+int rb_params_init_ids(void);
+
+/**
+ * @brief Translates a parameter name into its ID
+ *
+ * @param[in]   name     Name of a RadioBox parameter, without any quad extension.
+ * @retval      -1       Unknown name.
+ * @retval      int      Parameter ID out of RB_PARAMS_ENUM.
+ */
+int rb_params_id(const char* name);
+
+/**
+ * @brief Returns the transport_pktIdx packet a parameter is sent with
+ *
+ * @param[in]   id       Parameter ID out of RB_PARAMS_ENUM.
+ * @retval      0        Parameter is only sent with complete parameter sets.
+ * @retval      int      Value 1..RB_TRANSPORT_PKTIDX_MAX of the transport packet.
+ */
+int rb_params_pktIdx(int id);
+
+
+/**
+ * @brief Updates the value of the parameter with the given ID or appends it to the params vector
  *
  * @param[inout] dst          Destination application parameters, in case of ptr to NULL a new parameter list is generated.
- * @param[in]    param_name   Param name to be updated or created.
+ * @param[in]    id           Parameter ID out of RB_PARAMS_ENUM to be updated or created.
  * @param[in]    param_value  Value to assign.
  */
-void rb_update_param(rb_app_params_t** dst, const char* param_name, double param_value);
+void rb_update_param(rb_app_params_t** dst, int id, double param_value);
 
 /**
  * @brief Copies RedPitaya standard parameters vector to RadioBox high definition parameters vector
@@ -344,6 +455,33 @@ void rb2rp_params_value_copy(rp_app_params_t* dst_line_se, rp_app_params_t* dst_
  */
 int rp_copy_params(rp_app_params_t** dst, const rp_app_params_t src[], int len, int do_copy_all_attr);
 
+/** @brief Merges transported parameters into a parameter block
+ *
+ * Names are translated to parameter IDs, quad transported values are put together
+ * as soon as all four parts arrived. Later values overwrite earlier ones, this way
+ * several parameter packets, each holding its own subset of parameters, can be
+ * collected into one block. Unknown names are ignored.
+ *
+ * @param[inout] dst     Destination parameter block.
+ * @param[in]    src     Source application parameters.
+ * @param[in]    len     The count of parameters in the src vector, -1 up to the terminating entry.
+ * @retval       count   Successful operation: count of parameters set in the dst block.
+ * @retval       <0      Failure, error message is output on standard error
+ */
+int rb_params_block_merge(rb_params_block_t* dst, const rp_app_params_t src[], int len);
+
+/** @brief Merges double precision transported parameters into a parameter block
+ *
+ * Same as rb_params_block_merge(), quad encoded values are still accepted.
+ *
+ * @param[inout] dst     Destination parameter block.
+ * @param[in]    src     Source application parameters.
+ * @param[in]    len     The count of parameters in the src vector, -1 up to the terminating entry.
+ * @retval       count   Successful operation: count of parameters set in the dst block.
+ * @retval       <0      Failure, error message is output on standard error
+ */
+int rb_params_block_merge_hd(rb_params_block_t* dst, const rp_app_params_hd_t src[], int len);
+
 /**
  * @brief Make a copy of Application parameters
  *
@@ -382,6 +520,21 @@ int rb_copy_params(rb_app_params_t** dst, const rb_app_params_t src[], int len,
  */
 int rp_copy_params_rb2rp(rp_app_params_t** dst, const rb_app_params_t src[]);
 
+/**
+ * @brief Copies the RadioBox high definition parameters vector to a double precision transport vector
+ *
+ * Like rp_copy_params_rb2rp() the entries are limited to the current transport packet,
+ * but values are not quad encoded.
+ *
+ * @param[out]  dst               Destination application parameters, in case of ptr to NULL a new parameter list is generated.
+ * @param[in]   src               Source application parameters.
+ * @retval      count             Successful operation: count of entries in the vector.
+ * @retval      -1                Failure, argument dst not valid
+ * @retval      -2                Failure, argument src not valid
+ * @retval      -3                Failure, out of memory
+ */
+int rp_copy_params_rb2hd(rp_app_params_hd_t** dst, const rb_app_params_t src[]);
+
 /**
  * @brief Copies a Red Pitaya parameters vector to the RadioBox high definition parameters vector
  *
@@ -422,6 +575,18 @@ int print_rb_params(rb_app_params_t* params);
  */
 int rp_free_params(rp_app_params_t** params);
 
+/**
+ * @brief Deallocate the specified buffer of double precision Application parameters
+ *
+ * Function is used to deallocate the specified buffers, which were previously
+ * allocated by calling rp_copy_params_rb2hd() function.
+ *
+ * @param[in]   params  Application parameters to be deallocated
+ * @retval      0       Success
+ * @retval      -1      Failed with non-valid params
+ */
+int rp_free_params_hd(rp_app_params_hd_t** params);
+
 /**
  * @brief Deallocate the specified buffer of Application parameters
  *
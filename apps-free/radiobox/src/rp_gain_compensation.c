@@ -12,10 +12,19 @@
 
 #include <stdio.h>
 #include <math.h>
+#include <stdint.h>
+#include <pthread.h>
 
 #include "rp_gain_compensation.h"
 
 
+/** @brief Lowest frequency the compensation is calculated for, below that it is clamped. */
+#define RB_GAIN_FREQUENCY_MIN       1e-2f
+
+/** @brief Highest frequency the compensation is calculated for, above that it is clamped. */
+#define RB_GAIN_FREQUENCY_MAX       62.5e6f
+
+
 const rb_gain_params_t g_rb_gain_params_hw_1v1[RB_GAIN_PARAMS_HW_1V1_NUM] = {
     //         R50       open
     {1e-12,   1e-16,    1e-16 },
@@ -134,6 +143,32 @@ const rb_gain_params_t g_rb_gain_params_hw_1v1[RB_GAIN_PARAMS_HW_1V1_NUM] = {
 };
 
 
+/** @brief Knot positions t = log10(frequency) of the gain table, @see compensation_init(). */
+static float s_rb_gain_knots_t[RB_GAIN_PARAMS_HW_1V1_NUM];
+
+/** @brief Start positions t of the spline segments, the last entry closes the last segment. */
+static float s_rb_gain_seg_t[RB_GAIN_PARAMS_HW_1V1_NUM + 1];
+
+/** @brief Number of spline segments within the frequency range. */
+static int s_rb_gain_seg_num;
+
+/** @brief Cubic polynomial of each segment in (t - segment start), index 0: open end, 1: terminated. */
+static float s_rb_gain_seg_poly[2][RB_GAIN_PARAMS_HW_1V1_NUM][4];
+
+/** @brief First segment touching each of the equally spaced log10(frequency) cells. */
+static uint8_t s_rb_gain_lut[RB_GAIN_LUT_SIZE];
+
+/** @brief log10() of the lowest and highest frequency of the look-up table. */
+static float s_rb_gain_lut_t_min;
+static float s_rb_gain_lut_t_max;
+
+/** @brief Look-up table cells per decade. */
+static float s_rb_gain_lut_scale;
+
+/** @brief Guards the one-time set-up of the tables. */
+static pthread_once_t s_rb_gain_once = PTHREAD_ONCE_INIT;
+
+
 /*----------------------------------------------------------------------------------*/
 int bspline_j_k_n(int j, int k, int n)
 {
@@ -146,21 +181,18 @@ int bspline_j_k_n(int j, int k, int n)
 }
 
 /*----------------------------------------------------------------------------------*/
-float bspline_n_i_k(int i, int k, float t)
+static float bspline_knot_t(int i)
 {
-    int i_p1        = i + 1;
-    int i_pk_m1     = i + k - 1;
-    int i_pk        = i + k;
-
-    int j           = bspline_j_k_n(i,       RB_GAIN_PARAMS_BSPLINE_K, RB_GAIN_PARAMS_HW_1V1_NUM - 1);
-    int j_p1        = bspline_j_k_n(i_p1,    RB_GAIN_PARAMS_BSPLINE_K, RB_GAIN_PARAMS_HW_1V1_NUM - 1);
-    int j_pk_m1     = bspline_j_k_n(i_pk_m1, RB_GAIN_PARAMS_BSPLINE_K, RB_GAIN_PARAMS_HW_1V1_NUM - 1);
-    int j_pk        = bspline_j_k_n(i_pk,    RB_GAIN_PARAMS_BSPLINE_K, RB_GAIN_PARAMS_HW_1V1_NUM - 1);
+    return s_rb_gain_knots_t[bspline_j_k_n(i, RB_GAIN_PARAMS_BSPLINE_K, RB_GAIN_PARAMS_HW_1V1_NUM - 1)];
+}
 
-    float t_i       = log10(g_rb_gain_params_hw_1v1[j      ].frequency_hz);
-    float t_i_p1    = log10(g_rb_gain_params_hw_1v1[j_p1   ].frequency_hz);
-    float t_i_pk_m1 = log10(g_rb_gain_params_hw_1v1[j_pk_m1].frequency_hz);
-    float t_i_pk    = log10(g_rb_gain_params_hw_1v1[j_pk   ].frequency_hz);
+/*----------------------------------------------------------------------------------*/
+static float bspline_n_i_k_cached(int i, int k, float t)
+{
+    float t_i       = bspline_knot_t(i);
+    float t_i_p1    = bspline_knot_t(i + 1);
+    float t_i_pk_m1 = bspline_knot_t(i + k - 1);
+    float t_i_pk    = bspline_knot_t(i + k);
 
     float q1;
     if (!(t_i_pk_m1 - t_i))
@@ -178,64 +210,175 @@ float bspline_n_i_k(int i, int k, float t)
     if (k == 1)
         r = ((t_i <= t) && (t < t_i_p1)) ?  1.0f : 0.0f;
     else if (k > 1)
-        r = q1 * bspline_n_i_k(i, k - 1, t) + q2 * bspline_n_i_k(i + 1, k - 1, t);
-
-#if 0
-    fprintf(stderr, "DEBUG bspline_n_i_k: k=%d - i=%02d, i_p1=%02d, i_pk_m1=%02d, i_pk=%02d\n",
-            k, i, i_p1, i_pk_m1, i_pk);
-    fprintf(stderr, "DEBUG bspline_n_i_k: k=%d - j=%02d, j_p1=%02d, j_pk_m1=%02d, j_pk=%02d\n",
-            k, j, j_p1, j_pk_m1, j_pk);
-    fprintf(stderr, "DEBUG bspline_n_i_k: k=%d - (t      - t_i)=%+12.3f, (t_i_pk_m1 - t_i   )=%+12.3f;\t t     =%12.3f, t_i=%12.3f, t_i_pk_m1=%12.3f\n",
-            k, t - t_i   , t_i_pk_m1 - t_i   ,  t     , t_i, t_i_pk_m1);
-    fprintf(stderr, "DEBUG bspline_n_i_k: k=%d - (t_i_pk - t  )=%+12.3f, (t_i_pk    - t_i_p1)=%+12.3f;\t t_i_pk=%12.3f, t  =%12.3f, t_i_p1   =%12.3f\n",
-            k, t_i_pk - t, t_i_pk    - t_i_p1,  t_i_pk, t  , t_i_p1   );
-    fprintf(stderr, "DEBUG bspline_n_i_k: k=%d - q1=%+9.3f, q2=%+9.3f\n",
-            k, q1, q2);
-    fprintf(stderr, "DEBUG bspline_n_i_k: k=%d --> return %+9.3f\n",
-            k, r);
-#endif
+        r = q1 * bspline_n_i_k_cached(i, k - 1, t) + q2 * bspline_n_i_k_cached(i + 1, k - 1, t);
+
     return r;
 }
 
 /*----------------------------------------------------------------------------------*/
-float get_compensation_factor(float frequency_hz, int isTerminated)
+float bspline_n_i_k(int i, int k, float t)
 {
-    if (!frequency_hz) {
-        return 0.0;  // marks the gain correction block to switch off
-    }
-
-    if (frequency_hz < 1e-2f) {
-        frequency_hz = 1e-2f;
-    } else if (frequency_hz > 62.5e6f) {
-        frequency_hz = 62.5e6f;
-    }
+    compensation_init();
+    return bspline_n_i_k_cached(i, k, t);
+}
 
+/*----------------------------------------------------------------------------------*/
+static float bspline_p(float t, int isTerminated)
+{
     // B-Spline calculation follows as explained there: @see http://www-lehre.informatik.uni-osnabrueck.de/~cg/2000/skript/7_4_B_Splines.html
     float bspline_p = 0.0f;
     int bspline_n = RB_GAIN_PARAMS_HW_1V1_NUM - 1;
 
     int bspline_i;
     for (bspline_i = 0; bspline_i <= bspline_n; bspline_i++) {  // Sigma over 0 to n
+        if ((t < bspline_knot_t(bspline_i)) || (t >= bspline_knot_t(bspline_i + RB_GAIN_PARAMS_BSPLINE_K))) {
+            continue;  // t is outside of the support of N_i_k, its weight is zero
+        }
+
         int bspline_i_m1 = bspline_i - 1;
         if (bspline_i_m1 < 0)
             bspline_i_m1 = 0;
 
-        float bspline_nik = bspline_n_i_k(bspline_i, RB_GAIN_PARAMS_BSPLINE_K, log10f(frequency_hz));
+        float bspline_nik = bspline_n_i_k_cached(bspline_i, RB_GAIN_PARAMS_BSPLINE_K, t);
         float bspline_p_i = isTerminated ?  g_rb_gain_params_hw_1v1[bspline_i_m1].gain_terminated50R :
                                             g_rb_gain_params_hw_1v1[bspline_i_m1].gain_openEnd       ;
 
-        float bspline_p_i_f = bspline_nik * bspline_p_i;
+        bspline_p += bspline_nik * bspline_p_i;
+    }
+    return bspline_p;
+}
+
+/*----------------------------------------------------------------------------------*/
+static void compensation_fit_segment(int seg, int isTerminated)
+{
+    const double t0 = s_rb_gain_seg_t[seg];
+    const double w  = s_rb_gain_seg_t[seg + 1] - t0;
+    double x[4], y[4];
+    int i, j;
+
+    /* the spline is a cubic polynomial between two knots, sample it away from the segment borders */
+    for (i = 0; i < 4; i++) {
+        x[i] = w * (2 * i + 1) / 8.0;
+        y[i] = bspline_p(t0 + x[i], isTerminated);
+    }
+
+    /* Newton divided differences, then expanded to power form */
+    for (j = 1; j < 4; j++) {
+        for (i = 3; i >= j; i--) {
+            y[i] = (y[i] - y[i - 1]) / (x[i] - x[i - j]);
+        }
+    }
+
+    double c[4] = { y[3], 0.0, 0.0, 0.0 };
+    for (i = 2; i >= 0; i--) {  // c(x) = c(x) * (x - x[i]) + y[i]
+        for (j = 3; j > 0; j--) {
+            c[j] = c[j - 1] - x[i] * c[j];
+        }
+        c[0] = y[i] - x[i] * c[0];
+    }
+
+    for (i = 0; i < 4; i++) {
+        s_rb_gain_seg_poly[isTerminated][seg][i] = (float) c[i];
+    }
+}
 
-        bspline_p += bspline_p_i_f;
-        //fprintf(stderr, "DEBUG get_compensation_factor: bspline_i=%2d, bspline_i_m1=%2d - frequency=%+12.3f, weight=%+6.3f, gain=%+6.3f --> part=%+6.3f\n",
-        //        bspline_i, bspline_i_m1, g_rb_gain_params_hw_1v1[bspline_i_m1].frequency_hz, bspline_nik, bspline_p_i, bspline_p_i_f);
+/*----------------------------------------------------------------------------------*/
+static void compensation_init_once(void)
+{
+    int idx;
+    for (idx = 0; idx < RB_GAIN_PARAMS_HW_1V1_NUM; idx++) {
+        s_rb_gain_knots_t[idx] = log10f(g_rb_gain_params_hw_1v1[idx].frequency_hz);
     }
 
-    if (bspline_p < 1e-6f) {  // out of table --> no correction
-        bspline_p = 1.0f;
+    s_rb_gain_lut_t_min = log10f(RB_GAIN_FREQUENCY_MIN);
+    s_rb_gain_lut_t_max = log10f(RB_GAIN_FREQUENCY_MAX);
+    s_rb_gain_lut_scale = RB_GAIN_LUT_SIZE / (s_rb_gain_lut_t_max - s_rb_gain_lut_t_min);
+
+    /* segments are the distinct knot intervals, clipped to the frequency range */
+    s_rb_gain_seg_num  = 0;
+    s_rb_gain_seg_t[0] = s_rb_gain_lut_t_min;
+    for (idx = 0; idx < RB_GAIN_PARAMS_HW_1V1_NUM; idx++) {
+        const float t = s_rb_gain_knots_t[idx];
+
+        if ((t > s_rb_gain_seg_t[s_rb_gain_seg_num]) && (t < s_rb_gain_lut_t_max)) {
+            s_rb_gain_seg_t[++s_rb_gain_seg_num] = t;
+        }
     }
-    //fprintf(stderr, "DEBUG get_compensation_factor: in(frequency_hz=%f, isTerminated=%d) with spline_k=%d --> out(gain=%f, correction=%f)\n",
-    //        frequency_hz, isTerminated, RB_GAIN_PARAMS_BSPLINE_K, bspline_p, 1.0/ bspline_p);
+    s_rb_gain_seg_t[++s_rb_gain_seg_num] = s_rb_gain_lut_t_max;
 
-    return 1.0f / bspline_p;
+    for (idx = 0; idx < s_rb_gain_seg_num; idx++) {
+        compensation_fit_segment(idx, 0);
+        compensation_fit_segment(idx, 1);
+    }
+
+    int seg = 0;
+    for (idx = 0; idx < RB_GAIN_LUT_SIZE; idx++) {
+        const float t = s_rb_gain_lut_t_min + idx / s_rb_gain_lut_scale;
+
+        while ((seg < s_rb_gain_seg_num - 1) && (t >= s_rb_gain_seg_t[seg + 1])) {
+            seg++;
+        }
+        s_rb_gain_lut[idx] = seg;
+    }
+}
+
+/*----------------------------------------------------------------------------------*/
+void compensation_init(void)
+{
+    pthread_once(&s_rb_gain_once, compensation_init_once);
+}
+
+/*----------------------------------------------------------------------------------*/
+static float compensation_lookup(const float (*poly)[4], float frequency_hz)
+{
+    if (!frequency_hz) {
+        return 0.0;  // marks the gain correction block to switch off
+    }
+
+    if (frequency_hz < RB_GAIN_FREQUENCY_MIN) {
+        frequency_hz = RB_GAIN_FREQUENCY_MIN;
+    } else if (frequency_hz > RB_GAIN_FREQUENCY_MAX) {
+        frequency_hz = RB_GAIN_FREQUENCY_MAX;
+    }
+
+    const float t   = log10f(frequency_hz);
+    int         idx = (int) ((t - s_rb_gain_lut_t_min) * s_rb_gain_lut_scale);
+    if (idx < 0) {
+        idx = 0;
+    } else if (idx > RB_GAIN_LUT_SIZE - 1) {
+        idx = RB_GAIN_LUT_SIZE - 1;
+    }
+
+    int seg = s_rb_gain_lut[idx];
+    while ((seg < s_rb_gain_seg_num - 1) && (t >= s_rb_gain_seg_t[seg + 1])) {
+        seg++;
+    }
+
+    const float  x = t - s_rb_gain_seg_t[seg];
+    const float* c = poly[seg];
+    float        p = ((c[3] * x + c[2]) * x + c[1]) * x + c[0];
+
+    if (p < 1e-6f) {  // out of table --> no correction
+        p = 1.0f;
+    }
+    return 1.0f / p;
+}
+
+/*----------------------------------------------------------------------------------*/
+float get_compensation_factor(float frequency_hz, int isTerminated)
+{
+    compensation_init();
+    return compensation_lookup(s_rb_gain_seg_poly[isTerminated ?  1 : 0], frequency_hz);
+}
+
+/*----------------------------------------------------------------------------------*/
+void get_compensation_factors(const float* frequency_hz, float* factors, int count, int isTerminated)
+{
+    compensation_init();
+
+    const float (*poly)[4] = s_rb_gain_seg_poly[isTerminated ?  1 : 0];
+    int idx;
+    for (idx = 0; idx < count; idx++) {
+        factors[idx] = compensation_lookup(poly, frequency_hz[idx]);
+    }
 }
@@ -39,6 +39,9 @@ typedef struct rb_gain_params_s {
 #define RB_GAIN_PARAMS_BSPLINE_K    4
 #define RB_GAIN_PARAMS_HW_1V1_NUM 113
 
+/** @brief Number of equally spaced log10(frequency) cells of the spline segment look-up table. */
+#define RB_GAIN_LUT_SIZE         1024
+
 enum rb_gain_params_columns {
     RB_GAIN_PARAMS_FREQUENCY = 0,
     RB_GAIN_PARAMS_GAIN_TERM,
@@ -66,15 +69,37 @@ int bspline_j_k_n(int j, int k, int n);
  */
 float bspline_n_i_k(int i, int k, float t);
 
+/**
+ * @brief Sets up the compensation look-up tables, done once
+ *
+ * The b-spline through the gain table is converted to one cubic polynomial per knot interval
+ * for the terminated and the open end case. A table of RB_GAIN_LUT_SIZE equally spaced
+ * log10(frequency) cells finds the interval of a frequency. Called on demand by the
+ * functions below, calling it at start-up keeps that work out of the first request.
+ */
+void compensation_init(void);
+
 /**
  * @brief Calculates the compensation factor for the out amplifier
  *
+ * Evaluates the precalculated polynomial of the b-spline segment holding that frequency.
+ *
  * @param[in]  frequency_hz    Frequency in hertz.
  * @param[in]  isTerminated    True if 50 ohms resistor is connected to the output line, False if the output line is open.
  * @retval     float           Compensation factor to be used for the output amplifier.
  */
 float get_compensation_factor(float frequency_hz, int isTerminated);
 
+/**
+ * @brief Calculates the compensation factors for a list of frequencies, e.g. a sweep
+ *
+ * @param[in]  frequency_hz    List of frequencies in hertz.
+ * @param[out] factors         List of compensation factors, same order as frequency_hz.
+ * @param[in]  count           Number of entries of both lists.
+ * @param[in]  isTerminated    True if 50 ohms resistor is connected to the output line, False if the output line is open.
+ */
+void get_compensation_factors(const float* frequency_hz, float* factors, int count, int isTerminated);
+
 
 /** @} */
 
@@ -0,0 +1,589 @@
+/**
+ * @brief Red Pitaya RadioBox RX telemetry sampler.
+ *
+ * @author Ulrich Habel (DF4IAH) <espero7757@gmx.net>
+ *
+ * (c) Red Pitaya  http://www.redpitaya.com
+ *
+ * This part of code is written in C programming language.
+ * Please visit http://en.wikipedia.org/wiki/C_(programming_language)
+ * for more details on the language used herein.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "main.h"
+#include "calib.h"
+#include "fpga.h"
+
+#include "telemetry.h"
+
+
+/** @brief calibration data layout within the EEPROM device */
+extern rp_calib_params_t        g_rp_main_calib_params;
+
+
+/** @brief Ring of samples, written by the sampler thread only */
+static telemetry_sample_t       s_telemetry_ring[TELEMETRY_RING_SIZE];
+/** @brief Count of samples published to the ring, the slot is taken modulo TELEMETRY_RING_SIZE */
+static uint32_t                 s_telemetry_head = 0;
+/** @brief Count of samples being written or published, one ahead of s_telemetry_head while a slot is written */
+static uint32_t                 s_telemetry_claim = 0;
+/** @brief Set as soon as each slot of the ring holds a sample */
+static int                      s_telemetry_full = 0;
+
+/** @brief Sampling period in ns, 0 while sampling is stopped */
+static long                     s_telemetry_period_ns = 0;
+/** @brief Count of sampling periods the sampler thread missed */
+static unsigned int             s_telemetry_overruns = 0;
+/** @brief Set to stop the sampler thread */
+static int                      s_telemetry_quit = 0;
+/** @brief Thread handler for the sampler */
+static pthread_t*               s_telemetry_thread_handler = NULL;
+
+/** @brief Count of samples per line of the sink, 0 stops the sink */
+static int                      s_telemetry_sink_decimation = 0;
+/** @brief Thread handler for the sink */
+static pthread_t*               s_telemetry_sink_handler = NULL;
+
+/** @brief Guards the thread handlers and the wake-up of an idle sampler */
+static pthread_mutex_t          s_telemetry_mutex = PTHREAD_MUTEX_INITIALIZER;
+/** @brief Signaled with s_telemetry_mutex held when the rate is set or the sampler has to quit */
+static pthread_cond_t           s_telemetry_cond = PTHREAD_COND_INITIALIZER;
+
+
+/** @brief Sums of the samples of one decimated point */
+typedef struct telemetry_bin_s {
+    int      count;
+    uint64_t ts_ns;
+    double   strength;
+    uint32_t strength_peak;
+    double   cordic_mag;
+    double   cordic_phs_diff;
+    double   afc_inc;
+    int      rfin1_peak;
+    int      rfin2_peak;
+} telemetry_bin_t;
+
+
+/*----------------------------------------------------------------------------------*/
+static void telemetry_push(const telemetry_sample_t* smp)
+{
+    const uint32_t head = s_telemetry_head;  // only this thread writes it
+
+    __atomic_store_n(&s_telemetry_claim, head + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    s_telemetry_ring[head & (TELEMETRY_RING_SIZE - 1)] = *smp;
+    if (head + 1 == TELEMETRY_RING_SIZE) {
+        __atomic_store_n(&s_telemetry_full, 1, __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&s_telemetry_head, head + 1, __ATOMIC_RELEASE);
+}
+
+/*----------------------------------------------------------------------------------*/
+static void telemetry_bin_add(telemetry_bin_t* bin, const telemetry_sample_t* smp)
+{
+    const int rfin1 = abs(smp->rx.rfin1);
+    const int rfin2 = abs(smp->rx.rfin2);
+
+    bin->count++;
+    bin->ts_ns            = smp->ts_ns;
+    bin->strength        += smp->rx.signal_strength;
+    bin->cordic_mag      += smp->rx.afc_cordic_mag;
+    bin->cordic_phs_diff += smp->rx.afc_cordic_phs_diff;
+    bin->afc_inc         += (double) smp->rx.car_afc_inc;
+    if (smp->rx.signal_strength > bin->strength_peak) {
+        bin->strength_peak = smp->rx.signal_strength;
+    }
+    if (rfin1 > bin->rfin1_peak) {
+        bin->rfin1_peak = rfin1;
+    }
+    if (rfin2 > bin->rfin2_peak) {
+        bin->rfin2_peak = rfin2;
+    }
+}
+
+/*----------------------------------------------------------------------------------*/
+static void telemetry_bin_out(telemetry_bin_t* bin, telemetry_point_t* pnt)
+{
+    const double n = bin->count;
+
+    pnt->ts              = bin->ts_ns / 1e9;
+    pnt->strength        = bin->strength / n;
+    pnt->strength_peak   = bin->strength_peak;
+    pnt->cordic_mag      = bin->cordic_mag / n;
+    pnt->cordic_phs_diff = bin->cordic_phs_diff / n;
+    pnt->afc_qrg         = (bin->afc_inc / n) * g_rp_main_calib_params.base_osc125mhz_realhz / ((double) (1ULL << 48));
+    pnt->rfin1_peak      = bin->rfin1_peak;
+    pnt->rfin2_peak      = bin->rfin2_peak;
+
+    memset(bin, 0, sizeof(*bin));
+}
+
+/*----------------------------------------------------------------------------------*/
+static void* telemetry_thread(void* args)
+{
+    struct timespec next = { 0, 0 };
+    long period_ns = 0;
+
+    while (1) {
+        const long p = __atomic_load_n(&s_telemetry_period_ns, __ATOMIC_RELAXED);
+        telemetry_sample_t smp;
+        struct timespec now;
+
+        if (!p || __atomic_load_n(&s_telemetry_quit, __ATOMIC_RELAXED)) {
+            /* sleep until a rate is set or telemetry_exit() is called */
+            pthread_mutex_lock(&s_telemetry_mutex);
+            while (!s_telemetry_quit && !s_telemetry_period_ns) {
+                pthread_cond_wait(&s_telemetry_cond, &s_telemetry_mutex);
+            }
+            pthread_mutex_unlock(&s_telemetry_mutex);
+
+            if (__atomic_load_n(&s_telemetry_quit, __ATOMIC_RELAXED)) {
+                break;
+            }
+            period_ns = 0;
+            continue;
+        }
+
+        if (p != period_ns) {  // (re-)start the timing with the new rate
+            period_ns = p;
+            clock_gettime(CLOCK_MONOTONIC, &next);
+        }
+
+        next.tv_nsec += period_ns;
+        while (next.tv_nsec >= 1000000000L) {
+            next.tv_nsec -= 1000000000L;
+            next.tv_sec++;
+        }
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL) == EINTR) {
+            /* the deadline is absolute, just go on sleeping */
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        smp.ts_ns = ((uint64_t) now.tv_sec) * 1000000000ULL + now.tv_nsec;
+        if (!fpga_rb_read_rx_telemetry(&smp.rx)) {
+            telemetry_push(&smp);
+        }
+
+        /* woken up too late for the next period: drop the lost periods instead of catching up */
+        if (((now.tv_sec - next.tv_sec) * 1000000000LL + (now.tv_nsec - next.tv_nsec)) > period_ns) {
+            next = now;
+            s_telemetry_overruns++;
+        }
+    }
+
+    return 0;
+}
+
+/*----------------------------------------------------------------------------------*/
+static int telemetry_sink_dir(void)
+{
+    struct stat st;
+
+    if (mkdir(TELEMETRY_SINK_DIR, 0700) && (errno != EEXIST)) {
+        fprintf(stderr, "ERROR telemetry_sink_thread - can not create %s: %s\n", TELEMETRY_SINK_DIR, strerror(errno));
+        return -1;
+    }
+
+    /* an existing entry has to be our own directory nobody else can write to */
+    if (lstat(TELEMETRY_SINK_DIR, &st) || !S_ISDIR(st.st_mode) || (st.st_uid != geteuid()) || (st.st_mode & (S_IWGRP | S_IWOTH))) {
+        fprintf(stderr, "ERROR telemetry_sink_thread - %s is not a private directory, sink refused\n", TELEMETRY_SINK_DIR);
+        return -1;
+    }
+    return 0;
+}
+
+/*----------------------------------------------------------------------------------*/
+static int telemetry_sink_open(int* is_file)
+{
+    struct stat st;
+    int fd;
+
+    if (telemetry_sink_dir()) {
+        return -1;
+    }
+
+    /* a FIFO without a reader is refused instead of blocking telemetry_exit(), writes to a stalled reader fail with EAGAIN */
+    fd = open(TELEMETRY_SINK_PATH, O_WRONLY | O_CREAT | O_NOFOLLOW | O_NONBLOCK, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "ERROR telemetry_sink_thread - can not open %s: %s\n", TELEMETRY_SINK_PATH, strerror(errno));
+        return -1;
+    }
+
+    /* truncate only after the check, a device node or the like is left untouched */
+    if (fstat(fd, &st) || !(S_ISREG(st.st_mode) || S_ISFIFO(st.st_mode))) {
+        fprintf(stderr, "ERROR telemetry_sink_thread - %s is neither a regular file nor a FIFO, sink refused\n", TELEMETRY_SINK_PATH);
+        close(fd);
+        return -1;
+    }
+    *is_file = S_ISREG(st.st_mode);
+    if (*is_file && ftruncate(fd, 0)) {
+        fprintf(stderr, "ERROR telemetry_sink_thread - can not truncate %s: %s\n", TELEMETRY_SINK_PATH, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/*----------------------------------------------------------------------------------*/
+static int telemetry_sink_write(int fd, const char* buf, size_t len)
+{
+    ssize_t n;
+
+    /* at most PIPE_BUF bytes: a FIFO takes all of them or none */
+    do {
+        n = write(fd, buf, len);
+    } while ((n < 0) && (errno == EINTR));
+    return (n == (ssize_t) len) ?  0 : -1;
+}
+
+/*----------------------------------------------------------------------------------*/
+static void* telemetry_sink_thread(void* args)
+{
+    static const char header[] = "# ts_s,strength,strength_peak,cordic_mag,cordic_phs_diff,afc_qrg_hz,rfin1_peak,rfin2_peak\n";
+    telemetry_sample_t chunk[256];
+    telemetry_bin_t bin;
+    telemetry_point_t pnt;
+    uint32_t pos = telemetry_head();
+    char buf[PIPE_BUF];
+    size_t len = 0;
+    int lines = 0;
+    unsigned int dropped = 0;
+    off_t written = 0;
+    int is_file = 0;
+    int fd;
+
+    fd = telemetry_sink_open(&is_file);
+    if (fd < 0) {
+        return 0;
+    }
+    if (!telemetry_sink_write(fd, header, sizeof(header) - 1)) {
+        written = sizeof(header) - 1;
+    }
+
+    memset(&bin, 0, sizeof(bin));
+    while (1) {
+        const int decimation = __atomic_load_n(&s_telemetry_sink_decimation, __ATOMIC_RELAXED);
+        struct timespec rqtp = { 0, 100000000L };
+        uint32_t lost;
+        int n, i;
+
+        if (decimation <= 0) {
+            break;
+        }
+
+        while ((n = telemetry_read(&pos, chunk, sizeof(chunk) / sizeof(chunk[0]), &lost)) > 0 || lost) {
+            if (lost) {
+                len += snprintf(buf + len, sizeof(buf) - len, "# lost %u samples\n", lost);
+                lines++;
+                memset(&bin, 0, sizeof(bin));
+            }
+            for (i = 0; i < n; i++) {
+                telemetry_bin_add(&bin, &chunk[i]);
+                if (bin.count < decimation) {
+                    continue;
+                }
+                telemetry_bin_out(&bin, &pnt);
+
+                /* one line is far below 128 bytes, hand the buffer over before it could overflow */
+                if (len > sizeof(buf) - 128) {
+                    if (telemetry_sink_write(fd, buf, len)) {
+                        dropped += lines;  // the reader stalls, the sampler never waits for it
+                    } else {
+                        written += len;
+                    }
+                    len   = 0;
+                    lines = 0;
+                }
+                if (dropped && !len) {
+                    len += snprintf(buf, sizeof(buf), "# dropped %u lines\n", dropped);
+                    lines++;
+                    dropped = 0;
+                }
+                len += snprintf(buf + len, sizeof(buf) - len, "%.6f,%.1f,%.0f,%.1f,%.2f,%.3f,%.0f,%.0f\n",
+                        pnt.ts, pnt.strength, pnt.strength_peak, pnt.cordic_mag, pnt.cordic_phs_diff, pnt.afc_qrg, pnt.rfin1_peak, pnt.rfin2_peak);
+                lines++;
+            }
+        }
+        if (len) {
+            if (telemetry_sink_write(fd, buf, len)) {
+                dropped += lines;
+            } else {
+                written += len;
+            }
+            len   = 0;
+            lines = 0;
+        }
+
+        /* a file on the tmpfs is rotated so it can not take up the RAM, a FIFO is not;
+         * rename() replaces the ".1" entry itself and both names live in the private directory */
+        if (is_file && (written >= TELEMETRY_SINK_SIZE_MAX)) {
+            close(fd);
+            if (rename(TELEMETRY_SINK_PATH, TELEMETRY_SINK_PATH ".1")) {
+                fprintf(stderr, "WARNING telemetry_sink_thread - can not rotate %s: %s\n", TELEMETRY_SINK_PATH, strerror(errno));
+            }
+            fd = telemetry_sink_open(&is_file);
+            if (fd < 0) {
+                return 0;
+            }
+            written = telemetry_sink_write(fd, header, sizeof(header) - 1) ?  0 : sizeof(header) - 1;
+        }
+
+        nanosleep(&rqtp, NULL);
+    }
+
+    close(fd);
+    return 0;
+}
+
+/*----------------------------------------------------------------------------------*/
+static pthread_t* telemetry_sink_stop(void)
+{
+    pthread_t* handler = s_telemetry_sink_handler;
+
+    /* called with s_telemetry_mutex held, the caller joins the returned thread after releasing it */
+    __atomic_store_n(&s_telemetry_sink_decimation, 0, __ATOMIC_RELAXED);
+    s_telemetry_sink_handler = NULL;
+    return handler;
+}
+
+/*----------------------------------------------------------------------------------*/
+static void telemetry_sink_join(pthread_t* handler)
+{
+    if (handler) {
+        pthread_join(*handler, NULL);
+        free(handler);
+    }
+}
+
+
+/*----------------------------------------------------------------------------------*/
+int telemetry_init(void)
+{
+    int ret_val;
+
+    if (s_telemetry_thread_handler) {
+        (void) telemetry_exit();
+    }
+
+    s_telemetry_quit      = 0;
+    s_telemetry_period_ns = 0;
+    s_telemetry_overruns  = 0;
+
+    s_telemetry_thread_handler = (pthread_t*) malloc(sizeof(pthread_t));
+    if (!s_telemetry_thread_handler) {
+        return -1;
+    }
+
+    ret_val = pthread_create(s_telemetry_thread_handler, NULL, telemetry_thread, NULL);
+    if (ret_val) {
+        fprintf(stderr, "ERROR pthread_create() failed: %s\n", strerror(ret_val));
+        free(s_telemetry_thread_handler);
+        s_telemetry_thread_handler = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+/*----------------------------------------------------------------------------------*/
+int telemetry_exit(void)
+{
+    pthread_t* sink;
+
+    pthread_mutex_lock(&s_telemetry_mutex);
+    sink = telemetry_sink_stop();
+
+    __atomic_store_n(&s_telemetry_quit, 1, __ATOMIC_RELAXED);
+    pthread_cond_broadcast(&s_telemetry_cond);
+    pthread_mutex_unlock(&s_telemetry_mutex);
+    telemetry_sink_join(sink);
+
+    if (s_telemetry_thread_handler) {
+        pthread_join(*s_telemetry_thread_handler, NULL);
+        free(s_telemetry_thread_handler);
+        s_telemetry_thread_handler = NULL;
+    }
+
+    if (s_telemetry_overruns) {
+        fprintf(stderr, "INFO telemetry - %u sampling periods missed\n", s_telemetry_overruns);
+    }
+    return 0;
+}
+
+/*----------------------------------------------------------------------------------*/
+void telemetry_set_rate(double rate_hz)
+{
+    long period_ns = 0;
+
+    if (rate_hz > TELEMETRY_RATE_MAX) {
+        rate_hz = TELEMETRY_RATE_MAX;
+    }
+    if (rate_hz > 0.0) {
+        period_ns = (long) (1e9 / rate_hz + 0.5);
+    }
+    if (period_ns == __atomic_load_n(&s_telemetry_period_ns, __ATOMIC_RELAXED)) {
+        return;
+    }
+
+    pthread_mutex_lock(&s_telemetry_mutex);
+    __atomic_store_n(&s_telemetry_period_ns, period_ns, __ATOMIC_RELAXED);
+    pthread_cond_broadcast(&s_telemetry_cond);
+    pthread_mutex_unlock(&s_telemetry_mutex);
+}
+
+/*----------------------------------------------------------------------------------*/
+void telemetry_set_sink(int decimation)
+{
+    pthread_t* sink = NULL;
+
+    if (decimation > TELEMETRY_RING_SIZE) {
+        decimation = TELEMETRY_RING_SIZE;
+    }
+
+    pthread_mutex_lock(&s_telemetry_mutex);
+    if (decimation <= 0) {
+        sink = telemetry_sink_stop();
+
+    } else {
+        __atomic_store_n(&s_telemetry_sink_decimation, decimation, __ATOMIC_RELAXED);
+        if (!s_telemetry_sink_handler) {
+            s_telemetry_sink_handler = (pthread_t*) malloc(sizeof(pthread_t));
+            if (s_telemetry_sink_handler && pthread_create(s_telemetry_sink_handler, NULL, telemetry_sink_thread, NULL)) {
+                fprintf(stderr, "ERROR telemetry_set_sink - pthread_create() failed\n");
+                free(s_telemetry_sink_handler);
+                s_telemetry_sink_handler = NULL;
+            }
+        }
+    }
+    pthread_mutex_unlock(&s_telemetry_mutex);
+    telemetry_sink_join(sink);
+}
+
+/*----------------------------------------------------------------------------------*/
+uint32_t telemetry_head(void)
+{
+    return __atomic_load_n(&s_telemetry_head, __ATOMIC_ACQUIRE);
+}
+
+/*----------------------------------------------------------------------------------*/
+int telemetry_read(uint32_t* pos, telemetry_sample_t* dst, int max, uint32_t* lost)
+{
+    const uint32_t head = __atomic_load_n(&s_telemetry_head, __ATOMIC_ACQUIRE);
+    uint32_t p       = *pos;
+    uint32_t avail   = head - p;
+    uint32_t skipped = 0;
+    uint32_t oldest;
+    uint32_t n, i;
+
+    if (avail > TELEMETRY_RING_SIZE) {  // overwritten before being read
+        skipped = avail - TELEMETRY_RING_SIZE;
+        p      += skipped;
+        avail   = TELEMETRY_RING_SIZE;
+    }
+
+    n = (max > 0) ? (((uint32_t) max < avail) ? (uint32_t) max : avail) : 0;
+    for (i = 0; i < n; i++) {
+        dst[i] = s_telemetry_ring[(p + i) & (TELEMETRY_RING_SIZE - 1)];
+    }
+
+    /* slots older than this may have been overwritten while being copied */
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    oldest = __atomic_load_n(&s_telemetry_claim, __ATOMIC_RELAXED) - TELEMETRY_RING_SIZE;
+    if ((int32_t) (oldest - p) > 0) {
+        uint32_t bad = oldest - p;
+
+        if (bad > n) {
+            bad = n;
+        }
+        memmove(dst, dst + bad, (n - bad) * sizeof(telemetry_sample_t));
+        n       -= bad;
+        p       += bad;
+        skipped += bad;
+    }
+
+    *pos = p + n;
+    if (lost) {
+        *lost = skipped;
+    }
+    return n;
+}
+
+/*----------------------------------------------------------------------------------*/
+int telemetry_get_view(telemetry_point_t* dst, int len, int decimation)
+{
+    telemetry_sample_t chunk[256];
+    telemetry_bin_t bin;
+    const uint32_t head  = telemetry_head();
+    const uint32_t avail = __atomic_load_n(&s_telemetry_full, __ATOMIC_RELAXED) ?  TELEMETRY_RING_SIZE : head;
+    uint32_t remaining, pos;
+    int points = 0;
+
+    if (!dst || (len <= 0) || (decimation <= 0) || (decimation > TELEMETRY_RING_SIZE)) {
+        return 0;
+    }
+    if (((uint32_t) len) * decimation > avail) {
+        len = avail / decimation;
+    }
+
+    remaining = ((uint32_t) len) * decimation;
+    pos       = head - remaining;
+    memset(&bin, 0, sizeof(bin));
+    while (remaining && (points < len)) {
+        const uint32_t want = (remaining < sizeof(chunk) / sizeof(chunk[0])) ?  remaining : sizeof(chunk) / sizeof(chunk[0]);
+        uint32_t lost;
+        int n, i;
+
+        n = telemetry_read(&pos, chunk, want, &lost);
+        remaining -= (lost < remaining) ?  lost : remaining;
+        if (n <= 0) {
+            if (!lost) {
+                break;
+            }
+            continue;
+        }
+        remaining -= ((uint32_t) n < remaining) ?  (uint32_t) n : remaining;
+
+        for (i = 0; i < n; i++) {
+            telemetry_bin_add(&bin, &chunk[i]);
+            if (bin.count >= decimation) {
+                telemetry_bin_out(&bin, &dst[points++]);
+                if (points >= len) {
+                    break;
+                }
+            }
+        }
+    }
+    return points;
+}
+
+/*----------------------------------------------------------------------------------*/
+void telemetry_get_params(rb_app_params_t params[RB_PARAMS_NUM + 1])
+{
+    const long period_ns = __atomic_load_n(&s_telemetry_period_ns, __ATOMIC_RELAXED);
+    telemetry_point_t pnt;
+    int decimation;
+
+    if (!period_ns) {
+        return;
+    }
+
+    decimation = (int) (100000000L / period_ns);  // 100 ms
+    if (decimation < 1) {
+        decimation = 1;
+    }
+    if (telemetry_get_view(&pnt, 1, decimation) == 1) {
+        params[RB_TLM_STRENGTH].value = pnt.strength;
+        params[RB_TLM_MAG].value      = pnt.cordic_mag;
+        params[RB_TLM_AFC_QRG].value  = pnt.afc_qrg;
+    }
+}
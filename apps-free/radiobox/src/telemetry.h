@@ -0,0 +1,155 @@
+/**
+ * @brief Red Pitaya RadioBox RX telemetry sampler.
+ *
+ * @author Ulrich Habel (DF4IAH) <espero7757@gmx.net>
+ *
+ * (c) Red Pitaya  http://www.redpitaya.com
+ *
+ * This part of code is written in C programming language.
+ * Please visit http://en.wikipedia.org/wiki/C_(programming_language)
+ * for more details on the language used herein.
+ */
+
+#ifndef __TELEMETRY_H
+#define __TELEMETRY_H
+
+#include <stdint.h>
+
+#include "main.h"
+#include "fpga_rb.h"
+
+
+/** @defgroup telemetry_h RadioBox RX telemetry sampler
+ * @{
+ */
+
+/** @brief Count of samples the ring holds, must be 2^n! */
+#define TELEMETRY_RING_SIZE     16384
+
+/** @brief Highest sampling rate in Hz accepted by telemetry_set_rate() */
+#define TELEMETRY_RATE_MAX      100000.0
+
+/** @brief Directory the sink writes to, created private to the app as nobody else may place a file or link there */
+#define TELEMETRY_SINK_DIR      "/run/radiobox"
+
+/** @brief File the sink writes the decimated samples to, may be a FIFO to stream them */
+#define TELEMETRY_SINK_PATH     TELEMETRY_SINK_DIR "/telemetry.csv"
+
+/** @brief Size a sink file is rotated at to TELEMETRY_SINK_PATH ".1", as /run takes up RAM */
+#define TELEMETRY_SINK_SIZE_MAX (4L << 20)
+
+
+/** @brief One sample of the RX status registers */
+typedef struct telemetry_sample_s {
+    /** @brief ts_ns  CLOCK_MONOTONIC time of the sample in ns */
+    uint64_t                ts_ns;
+
+    /** @brief rx  RX status registers */
+    fpga_rb_rx_telemetry_t  rx;
+} telemetry_sample_t;
+
+/** @brief One point of a decimated view, made of consecutive samples */
+typedef struct telemetry_point_s {
+    /** @brief ts  CLOCK_MONOTONIC time of the last sample of the point in s */
+    double ts;
+
+    /** @brief strength  Mean of RX_SIGNAL_STRENGTH */
+    float  strength;
+
+    /** @brief strength_peak  Maximum of RX_SIGNAL_STRENGTH */
+    float  strength_peak;
+
+    /** @brief cordic_mag  Mean of RX_AFC_CORDIC_MAG */
+    float  cordic_mag;
+
+    /** @brief cordic_phs_diff  Mean of RX_AFC_CORDIC_PHS_DIFF */
+    float  cordic_phs_diff;
+
+    /** @brief afc_qrg  Mean frequency of the AFC increment in Hz */
+    float  afc_qrg;
+
+    /** @brief rfin1_peak  Maximum magnitude of RFIN1 */
+    float  rfin1_peak;
+
+    /** @brief rfin2_peak  Maximum magnitude of RFIN2 */
+    float  rfin2_peak;
+} telemetry_point_t;
+
+
+/**
+ * @brief Starts the sampler thread, idle until telemetry_set_rate() is called
+ *
+ * @retval 0 success, -1 on failure
+ */
+int telemetry_init(void);
+
+/**
+ * @brief Stops the sampler and the sink thread
+ *
+ * Has to be called before the FPGA is unmapped.
+ *
+ * @retval 0 success, -1 on failure
+ */
+int telemetry_exit(void);
+
+/**
+ * @brief Sets the sampling rate
+ *
+ * @param[in]   rate_hz  Samples per second, 0 stops sampling.
+ */
+void telemetry_set_rate(double rate_hz);
+
+/**
+ * @brief Starts, stops or changes the file sink
+ *
+ * The sink thread appends one CSV line per decimated point to TELEMETRY_SINK_PATH.
+ * Lines a stalled FIFO reader does not take are dropped, a regular file is rotated
+ * when it reaches TELEMETRY_SINK_SIZE_MAX. Symbolic links and anything else than a
+ * regular file or a FIFO are refused.
+ *
+ * @param[in]   decimation  Count of samples per written point, 0 stops the sink.
+ */
+void telemetry_set_sink(int decimation);
+
+/**
+ * @brief Copies samples out of the ring, lock-free
+ *
+ * Each reader holds its own position. When the sampler has overwritten samples
+ * not read yet, the position skips forward to the oldest sample still valid.
+ *
+ * @param[inout] pos     Index of the next sample to be read, advanced by the count returned.
+ * @param[out]   dst     Samples read.
+ * @param[in]    max     Size of dst.
+ * @param[out]   lost    Count of samples skipped because they were overwritten, may be NULL.
+ * @retval       int     Count of samples copied to dst.
+ */
+int telemetry_read(uint32_t* pos, telemetry_sample_t* dst, int max, uint32_t* lost);
+
+/**
+ * @brief Returns the index of the next sample to be written
+ *
+ * @retval uint32_t  Position to start reading the latest samples from.
+ */
+uint32_t telemetry_head(void);
+
+/**
+ * @brief Calculates a decimated view of the latest samples
+ *
+ * @param[out]   dst         Points of the view, the latest one last.
+ * @param[in]    len         Count of points requested.
+ * @param[in]    decimation  Count of samples each point is made of.
+ * @retval       int         Count of points filled in, less than len while the ring is filling.
+ */
+int telemetry_get_view(telemetry_point_t* dst, int len, int decimation);
+
+/**
+ * @brief Fills the read-only telemetry parameters with the mean of the last 100 ms
+ *
+ * @param[inout] params  Complete parameter list, indexed by parameter ID.
+ */
+void telemetry_get_params(rb_app_params_t params[RB_PARAMS_NUM + 1]);
+
+/** @} */
+
+
+#endif /* __TELEMETRY_H */
@@ -18,9 +18,12 @@
 #include <math.h>
 #include <stdlib.h>
 #include <limits.h>
+#include <time.h>
+#include <sched.h>
 
 #include "cb_http.h"
 #include "fpga.h"
+#include "telemetry.h"
 
 #include "worker.h"
 
@@ -35,16 +38,34 @@ static pthread_mutex_t          s_worker_ctrl_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 /** @brief Parameter list for the worker thread */
 static rb_app_params_t*         s_worker_params = NULL;
-
-/** @brief CallBack copy of params to inform the worker */
-extern rp_app_params_t*         g_rp_cb_in_params;
+/** @brief Parameter list the worker applies, complete and allocated once: current values overlaid by the received ones */
+static rb_app_params_t*         s_worker_in_params = NULL;
+/** @brief Received params taken over from g_rb_cb_in_params */
+static rb_params_block_t        s_worker_in_block;
+
+/** @brief Params exported by the worker, guarded by the sequence lock s_worker_info_seq */
+static rb_app_params_t          s_worker_info_params[RB_PARAMS_NUM + 1];
+/** @brief Sequence lock of s_worker_info_params: odd while being written, 0 before the first export */
+static unsigned int             s_worker_info_seq = 0;
+
+/** @brief CallBack copy of params to inform the worker, pending while its count is not zero */
+extern rb_params_block_t        g_rb_cb_in_params;
 /** @brief Holds mutex to access on parameters from outside to the worker thread */
 extern pthread_mutex_t          g_rp_cb_in_params_mutex;
+/** @brief Signaled when new params are queued, taken or the worker finished them */
+extern pthread_cond_t           g_rp_cb_in_params_cond;
+/** @brief Time the oldest params still waiting in g_rb_cb_in_params were queued */
+extern struct timespec          g_rp_cb_in_params_queued;
+/** @brief Count of parameter packets merged into g_rb_cb_in_params */
+extern int                      g_rp_cb_in_params_sets;
+
+/** @brief Describes app. parameters with some info/limitations */
+extern const rb_app_params_t    g_rb_default_params[];
 
-/** @brief Current copy of params of the worker thread */
-extern rb_app_params_t*         g_rb_info_worker_params;
-/** @brief Holds mutex to access parameters from the worker thread to any other context */
+/** @brief Holds mutex to wait for the first params the worker thread exports */
 extern pthread_mutex_t          g_rb_info_worker_params_mutex;
+/** @brief Signaled when the worker exported new params */
+extern pthread_cond_t           g_rb_info_worker_params_cond;
 
 /** @brief The RadioBox memory layout of the FPGA registers. */
 extern fpga_rb_reg_mem_t*       g_fpga_rb_reg_mem;
@@ -61,6 +82,203 @@ extern int                      g_params_init_done;  /* @see main.c */
 /** @brief Holds last received transport frame index number and flag 0x80 for processing data */
 extern unsigned char            g_transport_pktIdx;
 
+/** @brief Below this time to the next sweep step the clock is polled, a sleep would overshoot */
+#define WORKER_SWEEP_SPIN_NS    100000L
+/** @brief Longest time the worker keeps stepping a sweep before it looks for new params again */
+#define WORKER_SWEEP_SLICE_NS   10000000L
+
+/** @brief Frequency sweep in progress, stepped on by the idle worker - kept off the stack of the worker thread */
+static fpga_rb_sweep_plan_t     s_worker_sweep_plan;
+/** @brief Step of s_worker_sweep_plan the receiver is settling at, -1 while no sweep is running */
+static int                      s_worker_sweep_idx = -1;
+/** @brief CLOCK_MONOTONIC time the receiver has settled at the current sweep step */
+static struct timespec          s_worker_sweep_deadline;
+
+/** @brief Latency from queuing params to their FPGA register writes - written by the worker thread only, logged after it is joined */
+static worker_latency_t         s_worker_latency;
+
+
+/*----------------------------------------------------------------------------------*/
+static int worker_quit_requested(void)
+{
+    int l_quit;
+
+    pthread_mutex_lock(&s_worker_ctrl_mutex);
+    l_quit = (s_worker_ctrl_state == worker_quit_state);
+    pthread_mutex_unlock(&s_worker_ctrl_mutex);
+    return l_quit;
+}
+
+/*----------------------------------------------------------------------------------*/
+static void worker_account_latency(const struct timespec* queued, int sets)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double us = (now.tv_sec - queued->tv_sec) * 1e6 + (now.tv_nsec - queued->tv_nsec) / 1e3;
+
+    s_worker_latency.passes++;
+    s_worker_latency.sets += sets;
+    s_worker_latency.last_us = us;
+    s_worker_latency.sum_us += us;
+    if (us > s_worker_latency.max_us) {
+        s_worker_latency.max_us = us;
+    }
+}
+
+/*----------------------------------------------------------------------------------*/
+static long worker_ts_diff_ns(const struct timespec* a, const struct timespec* b)
+{
+    return (a->tv_sec - b->tv_sec) * 1000000000L + (a->tv_nsec - b->tv_nsec);
+}
+
+/*----------------------------------------------------------------------------------*/
+static void worker_sweep_settle(void)
+{
+    clock_gettime(CLOCK_MONOTONIC, &s_worker_sweep_deadline);
+    s_worker_sweep_deadline.tv_nsec += s_worker_sweep_plan.dwell_ns;
+    while (s_worker_sweep_deadline.tv_nsec >= 1000000000L) {
+        s_worker_sweep_deadline.tv_nsec -= 1000000000L;
+        s_worker_sweep_deadline.tv_sec++;
+    }
+}
+
+/*----------------------------------------------------------------------------------*/
+static void worker_sweep_abort(void)
+{
+    if (s_worker_sweep_idx < 0) {
+        return;
+    }
+
+    fpga_rb_sweep_end(&s_worker_sweep_plan);
+    s_worker_sweep_idx = -1;
+    fprintf(stderr, "INFO worker - RadioBox: sweep aborted by new settings\n");
+}
+
+/*----------------------------------------------------------------------------------*/
+static void worker_sweep_start(const rb_app_params_t* params)
+{
+    int osc_mask = 0;
+
+    worker_sweep_abort();  // a new request starts over
+
+    if (!(int) params[RB_RUN].value) {
+        fprintf(stderr, "WARNING worker - RadioBox: sweep requested while not running, ignored\n");
+        return;
+    }
+
+    /* the sweep steps the same oscillators the QRG controller acts on, the RX one by default */
+    if ((int) params[RB_TX_QRG_SEL].value) {
+        osc_mask |= FPGA_RB_SWEEP_TX;
+    }
+    if ((int) params[RB_RX_QRG_SEL].value || !osc_mask) {
+        osc_mask |= FPGA_RB_SWEEP_RX;
+    }
+
+    if (fpga_rb_sweep_prepare(&s_worker_sweep_plan, params[RB_SWEEP_START_QRG].value, params[RB_SWEEP_STOP_QRG].value,
+            params[RB_SWEEP_STEP_QRG].value, params[RB_SWEEP_DWELL].value, osc_mask,
+            (int) params[RB_TX_MODTYP].value, (int) params[RB_RX_MODTYP].value) <= 0) {
+        return;
+    }
+    if (fpga_rb_sweep_begin(&s_worker_sweep_plan)) {
+        return;
+    }
+
+    s_worker_sweep_idx = 0;
+    fpga_rb_sweep_step(&s_worker_sweep_plan, 0);
+    worker_sweep_settle();
+}
+
+/*----------------------------------------------------------------------------------*/
+static void worker_sweep_continue(void)
+{
+    struct timespec begin, now;
+
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    while (s_worker_sweep_idx >= 0) {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (worker_ts_diff_ns(&now, &begin) >= WORKER_SWEEP_SLICE_NS) {
+            return;  // give queued params a chance
+        }
+
+        const long remain = worker_ts_diff_ns(&s_worker_sweep_deadline, &now);
+        if (remain >= WORKER_SWEEP_SPIN_NS) {
+            return;  // the idle worker sleeps until the deadline
+        } else if (remain > 0) {
+            continue;
+        }
+
+        fpga_rb_sweep_sample(&s_worker_sweep_plan, s_worker_sweep_idx, s_worker_traces_tmp[1], s_worker_traces_tmp[2]);
+        if (++s_worker_sweep_idx < s_worker_sweep_plan.points) {
+            fpga_rb_sweep_step(&s_worker_sweep_plan, s_worker_sweep_idx);
+            worker_sweep_settle();
+            continue;
+        }
+
+        fpga_rb_sweep_end(&s_worker_sweep_plan);
+        s_worker_sweep_idx = -1;
+
+        /* trace 0: frequency, trace 1: RX signal strength, trace 2: RX_AFC_CORDIC magnitude */
+        memcpy(s_worker_traces_tmp[0], s_worker_sweep_plan.qrg, sizeof(float) * s_worker_sweep_plan.points);
+        worker_set_signals(s_worker_traces_tmp, s_worker_sweep_plan.points);
+    }
+}
+
+/*----------------------------------------------------------------------------------*/
+static void worker_sweep_wake_time(struct timespec* wake)
+{
+    struct timespec now;
+    long remain;
+
+    /* g_rp_cb_in_params_cond runs on CLOCK_REALTIME, the sweep deadline on CLOCK_MONOTONIC */
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    remain = worker_ts_diff_ns(&s_worker_sweep_deadline, &now);
+    if (remain < 0) {
+        remain = 0;
+    }
+
+    clock_gettime(CLOCK_REALTIME, wake);
+    wake->tv_sec  += remain / 1000000000L;
+    wake->tv_nsec += remain % 1000000000L;
+    if (wake->tv_nsec >= 1000000000L) {
+        wake->tv_nsec -= 1000000000L;
+        wake->tv_sec++;
+    }
+}
+
+/*----------------------------------------------------------------------------------*/
+static void worker_take_params(const rb_params_block_t* blk)
+{
+    int id;
+
+    for (id = 0; id < RB_PARAMS_NUM; id++) {
+        s_worker_in_params[id].value       = (blk && blk->set[id]) ?  blk->value[id] : s_worker_params[id].value;
+        s_worker_in_params[id].fpga_update = s_worker_params[id].fpga_update & ~0x80;
+    }
+}
+
+/*----------------------------------------------------------------------------------*/
+static void worker_export_params(void)
+{
+    unsigned int seq = s_worker_info_seq;
+    int id;
+
+    __atomic_store_n(&s_worker_info_seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    for (id = 0; id < RB_PARAMS_NUM; id++) {
+        s_worker_info_params[id].value       = s_worker_params[id].value;
+        s_worker_info_params[id].fpga_update = s_worker_params[id].fpga_update;
+        s_worker_info_params[id].read_only   = s_worker_params[id].read_only;
+        s_worker_info_params[id].min_val     = s_worker_params[id].min_val;
+        s_worker_info_params[id].max_val     = s_worker_params[id].max_val;
+    }
+    __atomic_store_n(&s_worker_info_seq, seq + 2, __ATOMIC_RELEASE);
+
+    /* only wakes up readers still waiting for the first export */
+    pthread_mutex_lock(&g_rb_info_worker_params_mutex);
+    pthread_cond_broadcast(&g_rb_info_worker_params_cond);
+    pthread_mutex_unlock(&g_rb_info_worker_params_mutex);
+}
+
 
 /*----------------------------------------------------------------------------------*/
 int worker_init(rb_app_params_t* params, int params_len)
@@ -75,11 +293,32 @@ int worker_init(rb_app_params_t* params, int params_len)
     }
 
     s_worker_ctrl_state = worker_idle_state;
+    memset(&s_worker_latency, 0, sizeof(s_worker_latency));
 
     /* create a new parameter list to the worker context */
     rb_copy_params((rb_app_params_t**) &s_worker_params, params, params_len, 1);
+    rb_copy_params((rb_app_params_t**) &s_worker_in_params, params, params_len, 1);
     //print_rb_params(s_worker_params);
 
+    if (rp_create_traces(&s_worker_traces) || rp_create_traces(&s_worker_traces_tmp)) {
+        worker_exit();
+        return -1;
+    }
+    s_worker_traces_dirty   = 0;
+    s_worker_traces_lastIdx = 0;
+
+    /* the exported list keeps the names of the default table, only the values change */
+    {
+        int id;
+
+        memset(s_worker_info_params, 0, sizeof(s_worker_info_params));
+        for (id = 0; id < RB_PARAMS_NUM; id++) {
+            s_worker_info_params[id].name = g_rb_default_params[id].name;
+            s_worker_info_params[id].id   = id;
+        }
+        s_worker_info_seq = 0;
+    }
+
     s_worker_thread_handler = (pthread_t*) malloc(sizeof(pthread_t));
     if (!s_worker_thread_handler) {
         worker_exit();
@@ -110,6 +349,11 @@ int worker_exit(void)
     pthread_mutex_lock(&s_worker_ctrl_mutex);
     s_worker_ctrl_state = worker_quit_state;
     pthread_mutex_unlock(&s_worker_ctrl_mutex);
+
+    /* wake up the idle worker */
+    pthread_mutex_lock(&g_rp_cb_in_params_mutex);
+    pthread_cond_broadcast(&g_rp_cb_in_params_cond);
+    pthread_mutex_unlock(&g_rp_cb_in_params_mutex);
     //fprintf(stderr, "worker_exit: after signaling quit\n");
 
     if (s_worker_thread_handler) {
@@ -127,6 +371,12 @@ int worker_exit(void)
         fprintf(stderr, "ERROR pthread_join() failed: %s\n", strerror(errno));
     }
 
+    if (s_worker_latency.passes) {
+        fprintf(stderr, "INFO worker - %u FPGA update passes for %u parameter packets, latency avg = %.0f us, max = %.0f us\n",
+                s_worker_latency.passes, s_worker_latency.sets,
+                s_worker_latency.sum_us / s_worker_latency.passes, s_worker_latency.max_us);
+    }
+
     //fprintf(stderr, "worker_exit: before freeing traces\n");
     rp_free_traces(&s_worker_traces);
     rp_free_traces(&s_worker_traces_tmp);
@@ -135,6 +385,7 @@ int worker_exit(void)
     //fprintf(stderr, "worker_exit: before freeing worker_params\n");
     //fprintf(stderr, "INFO pthread_join: freeing (1) ...\n");
     rb_free_params(&s_worker_params);
+    rb_free_params(&s_worker_in_params);
     //fprintf(stderr, "worker_exit: after freeing worker_params\n");
 
     //fprintf(stderr, "DEBUG worker_exit: END\n");
@@ -144,9 +395,11 @@ int worker_exit(void)
 /*----------------------------------------------------------------------------------*/
 void* worker_thread(void* args)
 {
-    rb_app_params_t* l_cb_in_copy_params  = NULL;
+    rb_app_params_t* l_cb_in_copy_params  = NULL;  // points to s_worker_in_params while params are to be applied
     worker_state_t l_state;
     int l_do_normal_state = 0;
+    struct timespec l_queued = { 0, 0 };
+    int l_sets = 0;
 #if 0
     int l_cnt = 0;
 #endif
@@ -167,20 +420,26 @@ void* worker_thread(void* args)
         if (!l_params_init_done) {
             /* the FPGA is going to be configured by these entries */
             //fprintf(stderr, "DEBUG worker_thread: rp_cb_in_params - INITIAL data, copying ...\n");
-            rb_copy_params(&l_cb_in_copy_params, s_worker_params, -1, 1);
+            worker_take_params(NULL);
+            l_cb_in_copy_params = s_worker_in_params;
             //print_rb_params(s_worker_params);
             //fprintf(stderr, "DEBUG worker_thread: rp_cb_in_params - INITIAL data, ... done.\n");
 
             /* take FSM out of idle l_state */
             l_do_normal_state = 1;
 
-        } else if (g_rp_cb_in_params) {
+        } else if (g_rb_cb_in_params.count) {
             /* check if new parameters are available */
-            //fprintf(stderr, "DEBUG worker_thread: g_rp_cb_in_params - new data, copying ...\n");
-            rp_copy_params_rp2rb(&l_cb_in_copy_params, g_rp_cb_in_params);
+            //fprintf(stderr, "DEBUG worker_thread: g_rb_cb_in_params - new data, copying ...\n");
+            s_worker_in_block = g_rb_cb_in_params;
+            l_queued = g_rp_cb_in_params_queued;
+            l_sets = g_rp_cb_in_params_sets;
+
+            //fprintf(stderr, "DEBUG worker_thread: g_rb_cb_in_params - emptying (2) ...\n");
+            memset(&g_rb_cb_in_params, 0, sizeof(g_rb_cb_in_params));
 
-            //fprintf(stderr, "DEBUG worker_thread: g_rp_cb_in_params - freeing (2) ...\n");
-            rp_free_params(&g_rp_cb_in_params);
+            worker_take_params(&s_worker_in_block);
+            l_cb_in_copy_params = s_worker_in_params;
 
             /* take FSM out of idle */
             l_do_normal_state = 1;
@@ -190,17 +449,6 @@ void* worker_thread(void* args)
         }
         pthread_mutex_unlock(&g_rp_cb_in_params_mutex);
 
-        /* when new data is seen, purge old revisions at the interfaces */
-        if (l_cb_in_copy_params) {
-            /* drop outdated output data */
-            pthread_mutex_lock(&g_rb_info_worker_params_mutex);
-            {
-                //fprintf(stderr, "INFO worker_thread: g_rb_info_worker_params - freeing (5) ...\n");
-                rb_free_params(&g_rb_info_worker_params);
-            }
-            pthread_mutex_unlock(&g_rb_info_worker_params_mutex);
-        }
-
         if (l_do_normal_state) {
             pthread_mutex_lock(&s_worker_ctrl_mutex);
             s_worker_ctrl_state = l_state = worker_normal_state;
@@ -213,23 +461,29 @@ void* worker_thread(void* args)
         if (l_state == worker_quit_state) {
             //fprintf(stderr, "worker_thread: worker_quit_state received\n");
             //fprintf(stderr, "worker_thread: before freeing curr_params\n");
-#if 1
-            //fprintf(stderr, "INFO worker_thread: rp_cb_in_params - freeing (9a) ...\n");
-            rp_free_params(&g_rp_cb_in_params);
-#else
-            //fprintf(stderr, "INFO worker_thread: rp_cb_in_params - NULLing (9b) ...\n");
-            g_rp_cb_in_params = NULL;
-#endif
-
-            //fprintf(stderr, "INFO worker_thread: rp_cb_in_params - freeing (9c) ...\n");
-            rb_free_params(&l_cb_in_copy_params);
-            //fprintf(stderr, "INFO worker_thread: rp_cb_in_params - freeing (9d) ...\n");
-            rb_free_params(&g_rb_info_worker_params);
+            //fprintf(stderr, "INFO worker_thread: rb_cb_in_params - emptying (9a) ...\n");
+            pthread_mutex_lock(&g_rp_cb_in_params_mutex);
+            memset(&g_rb_cb_in_params, 0, sizeof(g_rb_cb_in_params));
+            pthread_mutex_unlock(&g_rp_cb_in_params_mutex);
             //fprintf(stderr, "worker_thread: after freeing curr_params\n");
+            worker_sweep_abort();
             break;
 
         } else if (l_state == worker_idle_state) {
-            usleep(10000);  // request for a 10 ms delay
+            /* step a running sweep on, then sleep until its next step is due, rp_set_params() queues new params or worker_exit() is called */
+            worker_sweep_continue();
+            pthread_mutex_lock(&g_rp_cb_in_params_mutex);
+            while (g_params_init_done && !g_rb_cb_in_params.count && !worker_quit_requested()) {
+                if (s_worker_sweep_idx >= 0) {
+                    struct timespec l_wake;
+
+                    worker_sweep_wake_time(&l_wake);
+                    pthread_cond_timedwait(&g_rp_cb_in_params_cond, &g_rp_cb_in_params_mutex, &l_wake);
+                    break;
+                }
+                pthread_cond_wait(&g_rp_cb_in_params_cond, &g_rp_cb_in_params_mutex);
+            }
+            pthread_mutex_unlock(&g_rp_cb_in_params_mutex);
 #if 0
             if (++l_cnt >= 100) {
                 l_cnt = 0;
@@ -247,10 +501,16 @@ void* worker_thread(void* args)
 
                 //fprintf(stderr, "INFO worker_thread: worker_normal_state, processing new data --> update_count = %d\n", fpga_update_count);
                 if (fpga_update_count > 0) {
+                    /* new settings would be overwritten by the next sweep step and its final restore */
+                    worker_sweep_abort();
+
                     //fprintf(stderr, "DEBUG worker_thread: fpga_update: -->  delegate to fpga_rb_update_all_params()\n");
                     if (fpga_rb_update_all_params(s_worker_params, &l_cb_in_copy_params)) {
                         fprintf(stderr, "ERROR worker - RadioBox: setting/getting of FPGA registers failed\n");
                     }
+                    if (l_sets) {
+                        worker_account_latency(&l_queued, l_sets);
+                    }
 
                     pthread_mutex_lock(&g_rp_cb_in_params_mutex);
                     g_params_init_done = 1;
@@ -260,23 +520,35 @@ void* worker_thread(void* args)
                 /* read back current values of automatic FPGA registers */
                 fpga_rb_get_fpga_params(s_worker_params, &l_cb_in_copy_params);
 
+                /* single-shot frequency sweep: only its first step is set here, this pass still drops the 0x80 working flag
+                 * and the idle worker steps the sweep on, the results are handed out as signals */
+                if ((int) l_cb_in_copy_params[RB_SWEEP_RUN].value) {
+                    worker_sweep_start(l_cb_in_copy_params);
+                    l_cb_in_copy_params[RB_SWEEP_RUN].value = 0.0;  // remove single-shot tag
+                }
+
                 /* update worker_params */
                 //fprintf(stderr, "DEBUG worker_thread: updating worker_params\n");
                 rb_copy_params(&s_worker_params, l_cb_in_copy_params, -1, 0);  // copy back changed values
 
-                // new position of returning values
-                pthread_mutex_lock(&g_rb_info_worker_params_mutex);
-                rb_free_params(&g_rb_info_worker_params);  // invalidate old data
-                //fprintf(stderr, "DEBUG worker_thread: UPDATE RETURNED DATA  g_rb_info_worker_params\n");
-                rb_copy_params(&g_rb_info_worker_params, s_worker_params, -1, 1);
-                //print_rb_params(g_rb_info_worker_params);
-                pthread_mutex_unlock(&g_rb_info_worker_params_mutex);
+                /* the telemetry sampler runs on its own, it only takes over its settings */
+                telemetry_set_rate(s_worker_params[RB_TLM_RATE].value);
+                telemetry_set_sink((int) s_worker_params[RB_TLM_SINK].value);
+
+                // new position of returning values, readers never hold up the worker
+                //fprintf(stderr, "DEBUG worker_thread: UPDATE RETURNED DATA  s_worker_info_params\n");
+                worker_export_params();
 
-                //fprintf(stderr, "INFO worker_thread: rp_cb_in_params - freeing (1) ...\n");
-                rb_free_params(&l_cb_in_copy_params);
+                l_cb_in_copy_params = NULL;
+            }
+            /* drop working flag, unless more params were queued meanwhile */
+            l_sets = 0;
+            pthread_mutex_lock(&g_rp_cb_in_params_mutex);
+            if (!g_rb_cb_in_params.count) {
+                g_transport_pktIdx &= 0x7f;
+                pthread_cond_broadcast(&g_rp_cb_in_params_cond);
             }
-            /* drop working flag */
-            g_transport_pktIdx &= 0x7f;
+            pthread_mutex_unlock(&g_rp_cb_in_params_mutex);
 
             //fprintf(stderr, "DEBUG worker_thread: mutex - before l_state change to idle\n");
             pthread_mutex_lock(&s_worker_ctrl_mutex);
@@ -310,18 +582,8 @@ int mark_changed_fpga_update_entries(const rb_app_params_t* ref, rb_app_params_t
     int i = 0;
     while (cmp[i].name) {  // for each cmp parameter entry of the list do a check and mark
         //fprintf(stderr, "INFO mark_changed_fpga_update_entries: processing name = %s, value = %f\n", cmp[i].name, cmp[i].value);
-        int idx = -1;
-        int j = 0;
-        while (ref[j].name) {
-            if (!strcmp(ref[j].name, cmp[i].name)) {  // known parameter
-                idx = j;
-                //fprintf(stderr, "INFO mark_changed_fpga_update_entries: matching idx = %d\n", idx);
-                break;
-            }
-            j++;
-        }
-
-        if (idx == -1) {  // ignore unknown parameter
+        int idx = rb_find_parms_index_by_id(ref, RB_PARAMS_NUM, cmp[i].id);  // ref is a complete list, the ID is the index
+        if (idx < 0) {  // ignore unknown parameter
             fprintf(stderr, "WARNING mark_changed_fpga_update_entries - unknown param: name = %s\n", cmp[i].name);
             i++;
             continue;
@@ -344,12 +606,36 @@ int mark_changed_fpga_update_entries(const rb_app_params_t* ref, rb_app_params_t
 }
 
 
+/*----------------------------------------------------------------------------------*/
+int worker_get_params(rb_app_params_t dst[RB_PARAMS_NUM + 1])
+{
+    unsigned int seq;
+
+    do {
+        seq = __atomic_load_n(&s_worker_info_seq, __ATOMIC_ACQUIRE);
+        if (!seq) {
+            return -1;  // nothing exported yet
+        }
+        if (seq & 1) {
+            sched_yield();  // the worker is just writing
+            continue;
+        }
+
+        memcpy(dst, s_worker_info_params, sizeof(s_worker_info_params));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while ((seq & 1) || (seq != __atomic_load_n(&s_worker_info_seq, __ATOMIC_RELAXED)));
+
+    dst[RB_PARAMS_NUM].name = NULL;
+    return 0;
+}
+
+
 /*----------------------------------------------------------------------------------*/
 int worker_get_signals(float*** traces, int* trc_idx)
 {
     float** trc = *traces;
 
-    fprintf(stderr, "worker_get_signals: BEGIN\n");
+    //fprintf(stderr, "worker_get_signals: BEGIN\n");
 
     pthread_mutex_lock(&s_worker_traces_mutex);
     *trc_idx = s_worker_traces_lastIdx;
@@ -363,14 +649,14 @@ int worker_get_signals(float*** traces, int* trc_idx)
     s_worker_traces_dirty = 0;
     pthread_mutex_unlock(&s_worker_traces_mutex);
 
-    fprintf(stderr, "worker_get_signals: END\n");
+    //fprintf(stderr, "worker_get_signals: END\n");
     return 0;
 }
 
 /*----------------------------------------------------------------------------------*/
 int worker_set_signals(float** source, int index)
 {
-    fprintf(stderr, "worker_set_signals: BEGIN\n");
+    //fprintf(stderr, "worker_set_signals: BEGIN\n");
 
     pthread_mutex_lock(&s_worker_traces_mutex);
     memcpy(&s_worker_traces[0][0], &source[0][0], sizeof(float) * TRACE_LENGTH);
@@ -380,6 +666,6 @@ int worker_set_signals(float** source, int index)
     s_worker_traces_dirty = 1;
     pthread_mutex_unlock(&s_worker_traces_mutex);
 
-    fprintf(stderr, "worker_set_signals: END\n");
+    //fprintf(stderr, "worker_set_signals: END\n");
     return 0;
 }
@@ -40,6 +40,25 @@ typedef enum worker_state_e {
 } worker_state_t;
 
 
+/** @brief Statistics of the way from rp_set_params() to the FPGA registers, logged by worker_exit() */
+typedef struct worker_latency_s {
+    /** @brief FPGA update passes done for queued params */
+    unsigned int passes;
+
+    /** @brief parameter packets these passes took, more than passes when packets were merged */
+    unsigned int sets;
+
+    /** @brief time from queuing the oldest packet of the last pass to its register writes */
+    double last_us;
+
+    /** @brief maximum of last_us */
+    double max_us;
+
+    /** @brief sum of last_us over all passes */
+    double sum_us;
+} worker_latency_t;
+
+
 /** @brief Sets-up a running worker thread
  *
  * @param[in]    params        The initial parameter list the worker thread will take a copy from.
@@ -65,12 +84,23 @@ int worker_exit(void);
 void* worker_thread(void* args);
 
 
+/** @brief Takes a consistent copy of the params the worker exported last
+ *
+ * The copy is taken under a sequence lock, so the worker is never held up by
+ * readers. Entry names point into the default parameter table.
+ *
+ * @param[out]   dst      Complete parameter list in RB_PARAMS_ENUM order, terminated by a NULL name.
+ * @retval       0        Success.
+ * @retval       -1       The worker has not exported any params yet.
+ */
+int worker_get_params(rb_app_params_t dst[RB_PARAMS_NUM + 1]);
+
 /** @brief Marks all changed values for that entries which are having a fpga_update flag set
  *
  * This function marks all changed parameter entries which are having the fpga_update attribute set.
  * Additional the count of this modified parameter entries is returned.
  *
- * @param[in]    ref      Reference parameter list for old values taken as reference.
+ * @param[in]    ref      Reference parameter list for old values taken as reference, complete and in RB_PARAMS_ENUM order.
  * @param[inout] cmp      Comparison parameter list for new values to be compare against the reference.
  * @param[in]    do_init  If true all comparisons will indicate a changed state.
  * @retval       int      Number of parameters that changed the value AND their attribute fpga_update is set.
@@ -0,0 +1,407 @@
+/**
+ * @brief Red Pitaya RadioBox XADC monitor service.
+ *
+ * @author Ulrich Habel (DF4IAH) <espero7757@gmx.net>
+ *
+ * (c) Red Pitaya  http://www.redpitaya.com
+ *
+ * This part of code is written in C programming language.
+ * Please visit http://en.wikipedia.org/wiki/C_(programming_language)
+ * for more details on the language used herein.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "main.h"
+#include "fpga.h"
+
+#include "xadc_mon.h"
+
+
+/** @brief The system GPIO for XADC memory layout of the FPGA registers. */
+extern fpga_sys_xadc_reg_mem_t* g_fpga_sys_xadc_reg_mem;
+
+
+/** @brief Offsets of the status registers within fpga_sys_xadc_reg_mem_t, the VAUX registers follow each other */
+static const size_t             s_xadc_mon_reg_ofs[XADC_MON_CH_VAUX_00 + 1] = {
+    offsetof(fpga_sys_xadc_reg_mem_t, stat_temp),
+    offsetof(fpga_sys_xadc_reg_mem_t, stat_vccint),
+    offsetof(fpga_sys_xadc_reg_mem_t, stat_vccaux),
+    offsetof(fpga_sys_xadc_reg_mem_t, stat_vpvn),
+    offsetof(fpga_sys_xadc_reg_mem_t, stat_vrefp),
+    offsetof(fpga_sys_xadc_reg_mem_t, stat_vrefn),
+    offsetof(fpga_sys_xadc_reg_mem_t, stat_vccbram),
+    offsetof(fpga_sys_xadc_reg_mem_t, stat_vccpint),
+    offsetof(fpga_sys_xadc_reg_mem_t, stat_vccpaux),
+    offsetof(fpga_sys_xadc_reg_mem_t, stat_vccoddr),
+    offsetof(fpga_sys_xadc_reg_mem_t, stat_vaux_00)
+};
+
+/** @brief Readings, either the shared-memory segment or process local memory */
+static xadc_mon_shm_t*          s_xadc_mon_shm = NULL;
+/** @brief Set when s_xadc_mon_shm is the shared-memory segment */
+static int                      s_xadc_mon_shm_mapped = 0;
+/** @brief Held for reading while s_xadc_mon_shm is accessed from outside the sampler, for writing to release it */
+static pthread_rwlock_t         s_xadc_mon_shm_lock = PTHREAD_RWLOCK_INITIALIZER;
+
+/** @brief Raw samples of the window of each channel, written by the sampler thread only */
+static uint16_t                 s_xadc_mon_win[XADC_MON_CH_COUNT][XADC_MON_WINDOW];
+/** @brief Sum of the raw samples of the window of each channel */
+static uint32_t                 s_xadc_mon_win_sum[XADC_MON_CH_COUNT];
+
+/** @brief Sampling period in ns, 0 while sampling is stopped */
+static long                     s_xadc_mon_period_ns = 0;
+/** @brief Set to stop the sampler thread */
+static int                      s_xadc_mon_quit = 0;
+/** @brief Thread handler for the sampler */
+static pthread_t*               s_xadc_mon_thread_handler = NULL;
+
+/** @brief Guards the wake-up of an idle sampler */
+static pthread_mutex_t          s_xadc_mon_mutex = PTHREAD_MUTEX_INITIALIZER;
+/** @brief Signaled with s_xadc_mon_mutex held when the rate is set or the sampler has to quit */
+static pthread_cond_t           s_xadc_mon_cond = PTHREAD_COND_INITIALIZER;
+
+
+/*----------------------------------------------------------------------------------*/
+static float xadc_mon_raw2value(int ch, uint32_t raw)
+{
+    switch (ch) {
+    case XADC_MON_CH_TEMP:
+        return (((float) raw) * 503.975f / 65536.0f) - 273.15f;
+
+    case XADC_MON_CH_VCCINT:
+    case XADC_MON_CH_VCCAUX:
+    case XADC_MON_CH_VREFP:
+    case XADC_MON_CH_VREFN:
+    case XADC_MON_CH_VCCBRAM:
+    case XADC_MON_CH_VCCPINT:
+    case XADC_MON_CH_VCCPAUX:
+    case XADC_MON_CH_VCCODDR:
+        return ((float) raw) * 3.0f / 65536.0f;                               // supply sensors: 3 V full scale
+
+    default:
+        return ((float) raw) / 65536.0f;                                      // unipolar analog inputs: 1 V full scale
+    }
+}
+
+/*----------------------------------------------------------------------------------*/
+static void xadc_mon_sample(uint64_t ts_ns)
+{
+    const volatile uint8_t* regs = (const volatile uint8_t*) g_fpga_sys_xadc_reg_mem;
+    xadc_mon_shm_t* shm = s_xadc_mon_shm;
+    const uint64_t samples = shm->samples + 1;
+    const int slot = (int) ((samples - 1) & (XADC_MON_WINDOW - 1));
+    const int fill = (samples < XADC_MON_WINDOW) ?  (int) samples : XADC_MON_WINDOW;
+    uint16_t raw[XADC_MON_CH_COUNT];
+    int ch, i;
+
+    /* the uncached AXI reads are done ahead of the update to keep it short */
+    for (ch = 0; ch < XADC_MON_CH_COUNT; ch++) {
+        const size_t ofs = (ch < XADC_MON_CH_VAUX_00) ?  s_xadc_mon_reg_ofs[ch]
+                                                      : s_xadc_mon_reg_ofs[XADC_MON_CH_VAUX_00] + ((ch - XADC_MON_CH_VAUX_00) << 2);
+        raw[ch] = (uint16_t) *((const volatile uint32_t*) (regs + ofs));
+    }
+
+    __atomic_store_n(&shm->seq, shm->seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    for (ch = 0; ch < XADC_MON_CH_COUNT; ch++) {
+        uint16_t* win = s_xadc_mon_win[ch];
+        uint16_t raw_min = raw[ch];
+        uint16_t raw_max = raw[ch];
+
+        if (samples > XADC_MON_WINDOW) {
+            s_xadc_mon_win_sum[ch] -= win[slot];
+        }
+        win[slot] = raw[ch];
+        s_xadc_mon_win_sum[ch] += raw[ch];
+
+        for (i = 0; i < fill; i++) {
+            if (win[i] < raw_min) {
+                raw_min = win[i];
+            }
+            if (win[i] > raw_max) {
+                raw_max = win[i];
+            }
+        }
+
+        shm->ch[ch].cur = xadc_mon_raw2value(ch, raw[ch]);
+        shm->ch[ch].min = xadc_mon_raw2value(ch, raw_min);
+        shm->ch[ch].max = xadc_mon_raw2value(ch, raw_max);
+        shm->ch[ch].avg = xadc_mon_raw2value(ch, (s_xadc_mon_win_sum[ch] + (fill >> 1)) / fill);
+    }
+    shm->window  = fill;
+    shm->samples = samples;
+    shm->ts_ns   = ts_ns;
+
+    __atomic_store_n(&shm->seq, shm->seq + 1, __ATOMIC_RELEASE);
+}
+
+/*----------------------------------------------------------------------------------*/
+static void* xadc_mon_thread(void* args)
+{
+    struct timespec next = { 0, 0 };
+    long period_ns = 0;
+
+    while (1) {
+        const long p = __atomic_load_n(&s_xadc_mon_period_ns, __ATOMIC_RELAXED);
+        struct timespec now;
+
+        if (!p || __atomic_load_n(&s_xadc_mon_quit, __ATOMIC_RELAXED)) {
+            /* sleep until a rate is set or xadc_mon_exit() is called */
+            pthread_mutex_lock(&s_xadc_mon_mutex);
+            while (!s_xadc_mon_quit && !s_xadc_mon_period_ns) {
+                pthread_cond_wait(&s_xadc_mon_cond, &s_xadc_mon_mutex);
+            }
+            pthread_mutex_unlock(&s_xadc_mon_mutex);
+
+            if (__atomic_load_n(&s_xadc_mon_quit, __ATOMIC_RELAXED)) {
+                break;
+            }
+            period_ns = 0;
+            continue;
+        }
+
+        if (p != period_ns) {  // (re-)start the timing with the new rate
+            period_ns = p;
+            clock_gettime(CLOCK_MONOTONIC, &next);
+        }
+
+        next.tv_nsec += period_ns;
+        while (next.tv_nsec >= 1000000000L) {
+            next.tv_nsec -= 1000000000L;
+            next.tv_sec++;
+        }
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL) == EINTR) {
+            /* the deadline is absolute, just go on sleeping */
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (g_fpga_sys_xadc_reg_mem) {
+            xadc_mon_sample(((uint64_t) now.tv_sec) * 1000000000ULL + now.tv_nsec);
+        }
+
+        /* woken up too late for the next period: drop the lost periods instead of catching up */
+        if (((now.tv_sec - next.tv_sec) * 1000000000LL + (now.tv_nsec - next.tv_nsec)) > period_ns) {
+            next = now;
+        }
+    }
+
+    return 0;
+}
+
+
+/*----------------------------------------------------------------------------------*/
+int xadc_mon_init(double rate_hz)
+{
+    xadc_mon_shm_t* shm = NULL;
+    int ret_val;
+    int fd;
+
+    if (s_xadc_mon_thread_handler) {
+        (void) xadc_mon_exit();
+    }
+
+    /* other processes find the readings by the name of the segment */
+    fd = shm_open(XADC_MON_SHM_NAME, O_CREAT | O_RDWR, 0644);
+    if (fd >= 0) {
+        if (!ftruncate(fd, sizeof(xadc_mon_shm_t))) {
+            void* mem = mmap(NULL, sizeof(xadc_mon_shm_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (mem != MAP_FAILED) {
+                shm = (xadc_mon_shm_t*) mem;
+                s_xadc_mon_shm_mapped = 1;
+            }
+        }
+        close(fd);
+    }
+    if (!shm) {
+        fprintf(stderr, "WARNING xadc_mon_init - no shared-memory segment %s: %s, readings are kept local\n", XADC_MON_SHM_NAME, strerror(errno));
+        shm = (xadc_mon_shm_t*) malloc(sizeof(xadc_mon_shm_t));
+        if (!shm) {
+            return -1;
+        }
+    }
+
+    memset(shm, 0, sizeof(xadc_mon_shm_t));
+    memset(s_xadc_mon_win_sum, 0, sizeof(s_xadc_mon_win_sum));
+    shm->version = XADC_MON_VERSION;
+    __atomic_store_n(&shm->magic, XADC_MON_MAGIC, __ATOMIC_RELEASE);
+
+    /* readers of other threads only see the readings after they are set up */
+    pthread_rwlock_wrlock(&s_xadc_mon_shm_lock);
+    s_xadc_mon_shm = shm;
+    pthread_rwlock_unlock(&s_xadc_mon_shm_lock);
+
+    s_xadc_mon_quit      = 0;
+    s_xadc_mon_period_ns = 0;
+    xadc_mon_set_rate((rate_hz > 0.0) ?  rate_hz : XADC_MON_RATE_DEFAULT);
+
+    s_xadc_mon_thread_handler = (pthread_t*) malloc(sizeof(pthread_t));
+    if (!s_xadc_mon_thread_handler) {
+        xadc_mon_exit();
+        return -1;
+    }
+
+    ret_val = pthread_create(s_xadc_mon_thread_handler, NULL, xadc_mon_thread, NULL);
+    if (ret_val) {
+        fprintf(stderr, "ERROR pthread_create() failed: %s\n", strerror(ret_val));
+        free(s_xadc_mon_thread_handler);
+        s_xadc_mon_thread_handler = NULL;
+        xadc_mon_exit();
+        return -1;
+    }
+    return 0;
+}
+
+/*----------------------------------------------------------------------------------*/
+int xadc_mon_exit(void)
+{
+    xadc_mon_shm_t* shm = s_xadc_mon_shm;
+
+    pthread_mutex_lock(&s_xadc_mon_mutex);
+    __atomic_store_n(&s_xadc_mon_quit, 1, __ATOMIC_RELAXED);
+    pthread_cond_broadcast(&s_xadc_mon_cond);
+    pthread_mutex_unlock(&s_xadc_mon_mutex);
+
+    if (s_xadc_mon_thread_handler) {
+        pthread_join(*s_xadc_mon_thread_handler, NULL);
+        free(s_xadc_mon_thread_handler);
+        s_xadc_mon_thread_handler = NULL;
+    }
+
+    if (!shm) {
+        return 0;
+    }
+
+    /* wait for readers of other threads still holding the pointer */
+    pthread_rwlock_wrlock(&s_xadc_mon_shm_lock);
+    s_xadc_mon_shm = NULL;
+    pthread_rwlock_unlock(&s_xadc_mon_shm_lock);
+
+    if (s_xadc_mon_shm_mapped) {
+        /* attached readers keep their mapping, they see the segment becoming invalid */
+        __atomic_store_n(&shm->magic, 0, __ATOMIC_RELEASE);
+        munmap(shm, sizeof(xadc_mon_shm_t));
+        shm_unlink(XADC_MON_SHM_NAME);
+        s_xadc_mon_shm_mapped = 0;
+
+    } else {
+        free(shm);
+    }
+    return 0;
+}
+
+/*----------------------------------------------------------------------------------*/
+void xadc_mon_set_rate(double rate_hz)
+{
+    long period_ns = 0;
+
+    if (rate_hz > XADC_MON_RATE_MAX) {
+        rate_hz = XADC_MON_RATE_MAX;
+    }
+    if (rate_hz > 0.0) {
+        period_ns = (long) (1e9 / rate_hz + 0.5);
+    }
+    if (period_ns == __atomic_load_n(&s_xadc_mon_period_ns, __ATOMIC_RELAXED)) {
+        return;
+    }
+
+    pthread_mutex_lock(&s_xadc_mon_mutex);
+    __atomic_store_n(&s_xadc_mon_period_ns, period_ns, __ATOMIC_RELAXED);
+    pthread_rwlock_rdlock(&s_xadc_mon_shm_lock);
+    if (s_xadc_mon_shm) {
+        s_xadc_mon_shm->rate_hz = (period_ns > 0) ?  (float) (1e9 / period_ns) : 0.0f;
+    }
+    pthread_rwlock_unlock(&s_xadc_mon_shm_lock);
+    pthread_cond_broadcast(&s_xadc_mon_cond);
+    pthread_mutex_unlock(&s_xadc_mon_mutex);
+}
+
+/*----------------------------------------------------------------------------------*/
+float xadc_mon_get_value(int ch)
+{
+    const xadc_mon_shm_t* shm;
+    float value = NAN;
+
+    if ((ch < 0) || (ch >= XADC_MON_CH_COUNT)) {
+        return NAN;
+    }
+
+    /* xadc_mon_exit() does not release the readings while they are read */
+    pthread_rwlock_rdlock(&s_xadc_mon_shm_lock);
+    shm = s_xadc_mon_shm;
+    if (shm && __atomic_load_n(&shm->samples, __ATOMIC_RELAXED)) {
+        value = shm->ch[ch].cur;  // a single aligned word, no torn reads
+    }
+    pthread_rwlock_unlock(&s_xadc_mon_shm_lock);
+    return value;
+}
+
+/*----------------------------------------------------------------------------------*/
+int xadc_mon_read(const xadc_mon_shm_t* shm, xadc_mon_shm_t* dst)
+{
+    uint32_t seq;
+
+    if (!dst) {
+        return -1;
+    }
+    if (!shm) {
+        /* the own readings, kept from being released while they are copied */
+        int ret_val;
+
+        pthread_rwlock_rdlock(&s_xadc_mon_shm_lock);
+        ret_val = s_xadc_mon_shm ?  xadc_mon_read(s_xadc_mon_shm, dst) : -1;
+        pthread_rwlock_unlock(&s_xadc_mon_shm_lock);
+        return ret_val;
+    }
+
+    do {
+        while ((seq = __atomic_load_n(&shm->seq, __ATOMIC_ACQUIRE)) & 1) {
+            /* the update takes a few hundred ns only */
+        }
+        memcpy(dst, shm, sizeof(xadc_mon_shm_t));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while (seq != __atomic_load_n(&shm->seq, __ATOMIC_RELAXED));
+
+    if ((dst->magic != XADC_MON_MAGIC) || (dst->version != XADC_MON_VERSION) || !dst->samples) {
+        return -1;
+    }
+    return 0;
+}
+
+/*----------------------------------------------------------------------------------*/
+const xadc_mon_shm_t* xadc_mon_attach(void)
+{
+    void* mem;
+    int fd;
+
+    fd = shm_open(XADC_MON_SHM_NAME, O_RDONLY, 0);
+    if (fd < 0) {
+        return NULL;
+    }
+    mem = mmap(NULL, sizeof(xadc_mon_shm_t), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mem == MAP_FAILED) {
+        return NULL;
+    }
+    return (const xadc_mon_shm_t*) mem;
+}
+
+/*----------------------------------------------------------------------------------*/
+void xadc_mon_detach(const xadc_mon_shm_t* shm)
+{
+    if (shm) {
+        munmap((void*) shm, sizeof(xadc_mon_shm_t));
+    }
+}
@@ -0,0 +1,172 @@
+/**
+ * @brief Red Pitaya RadioBox XADC monitor service.
+ *
+ * @author Ulrich Habel (DF4IAH) <espero7757@gmx.net>
+ *
+ * (c) Red Pitaya  http://www.redpitaya.com
+ *
+ * This part of code is written in C programming language.
+ * Please visit http://en.wikipedia.org/wiki/C_(programming_language)
+ * for more details on the language used herein.
+ */
+
+#ifndef __XADC_MON_H
+#define __XADC_MON_H
+
+#include <stdint.h>
+
+
+/** @defgroup xadc_mon_h RadioBox XADC monitor service
+ * @{
+ */
+
+/** @brief Name of the shared-memory segment the readings are published to */
+#define XADC_MON_SHM_NAME       "/radiobox_xadc"
+
+/** @brief Magic value of the shared-memory segment, "XADC" */
+#define XADC_MON_MAGIC          0x43444158
+
+/** @brief Layout version of the shared-memory segment */
+#define XADC_MON_VERSION        1
+
+/** @brief Sampling rate in Hz used until xadc_mon_set_rate() is called */
+#define XADC_MON_RATE_DEFAULT   10.0
+
+/** @brief Highest sampling rate in Hz accepted by xadc_mon_set_rate() */
+#define XADC_MON_RATE_MAX       1000.0
+
+/** @brief Count of samples the min/max/avg window of each channel spans, must be 2^n! */
+#define XADC_MON_WINDOW         64
+
+
+/** @brief Channels of the XADC monitor, in the order of the status registers */
+enum xadc_mon_ch_enum_t {
+    XADC_MON_CH_TEMP = 0,
+    XADC_MON_CH_VCCINT,
+    XADC_MON_CH_VCCAUX,
+    XADC_MON_CH_VPVN,
+    XADC_MON_CH_VREFP,
+    XADC_MON_CH_VREFN,
+    XADC_MON_CH_VCCBRAM,
+    XADC_MON_CH_VCCPINT,
+    XADC_MON_CH_VCCPAUX,
+    XADC_MON_CH_VCCODDR,
+    XADC_MON_CH_VAUX_00,
+    XADC_MON_CH_VAUX_15 = XADC_MON_CH_VAUX_00 + 15,
+
+    XADC_MON_CH_COUNT
+};
+
+
+/** @brief Reading of one channel, temperature in degC and voltages in V */
+typedef struct xadc_mon_value_s {
+    /** @brief cur  Latest sample */
+    float cur;
+
+    /** @brief min  Minimum within the window */
+    float min;
+
+    /** @brief max  Maximum within the window */
+    float max;
+
+    /** @brief avg  Mean of the window */
+    float avg;
+} xadc_mon_value_t;
+
+/** @brief Readings as published to the shared-memory segment
+ *
+ * The sampler is the only writer. It makes seq odd before and even again after
+ * each update, a reader retries its copy while seq is odd or has changed.
+ */
+typedef struct xadc_mon_shm_s {
+    /** @brief magic  XADC_MON_MAGIC as soon as the segment is valid */
+    uint32_t          magic;
+
+    /** @brief version  XADC_MON_VERSION */
+    uint32_t          version;
+
+    /** @brief seq  Sequence counter of the updates */
+    uint32_t          seq;
+
+    /** @brief window  Count of samples the min/max/avg values are taken from */
+    uint32_t          window;
+
+    /** @brief samples  Count of samples taken since start-up */
+    uint64_t          samples;
+
+    /** @brief ts_ns  CLOCK_MONOTONIC time of the latest sample in ns */
+    uint64_t          ts_ns;
+
+    /** @brief rate_hz  Current sampling rate, 0 while sampling is stopped */
+    float             rate_hz;
+
+    /** @brief ch  Readings indexed by enum xadc_mon_ch_enum_t */
+    xadc_mon_value_t  ch[XADC_MON_CH_COUNT];
+} xadc_mon_shm_t;
+
+
+/**
+ * @brief Starts the sampler thread and creates the shared-memory segment
+ *
+ * When the segment can not be created the readings are kept process local.
+ *
+ * @param[in]   rate_hz  Samples per second, 0 takes XADC_MON_RATE_DEFAULT.
+ * @retval 0 success, -1 on failure
+ */
+int xadc_mon_init(double rate_hz);
+
+/**
+ * @brief Stops the sampler thread and removes the shared-memory segment
+ *
+ * Has to be called before the FPGA is unmapped.
+ *
+ * @retval 0 success, -1 on failure
+ */
+int xadc_mon_exit(void);
+
+/**
+ * @brief Sets the sampling rate
+ *
+ * @param[in]   rate_hz  Samples per second, 0 stops sampling.
+ */
+void xadc_mon_set_rate(double rate_hz);
+
+/**
+ * @brief Returns the latest sample of one channel
+ *
+ * Only a read lock is taken, which xadc_mon_exit() waits for before the readings are released.
+ *
+ * @param[in]   ch     Channel out of enum xadc_mon_ch_enum_t.
+ * @retval      float  Temperature in degC or voltage in V, NAN while the monitor is not running.
+ */
+float xadc_mon_get_value(int ch);
+
+/**
+ * @brief Copies a consistent set of readings
+ *
+ * The segment of another process is read lock-free, the own readings under the read lock of xadc_mon_get_value().
+ *
+ * @param[in]   shm  Readings of this process (NULL) or of a segment returned by xadc_mon_attach().
+ * @param[out]  dst  Copy of the readings.
+ * @retval 0 success, -1 when no readings are available
+ */
+int xadc_mon_read(const xadc_mon_shm_t* shm, xadc_mon_shm_t* dst);
+
+/**
+ * @brief Maps the shared-memory segment of a running monitor read-only
+ *
+ * @retval      Segment to be passed to xadc_mon_read(), NULL when no monitor is running.
+ */
+const xadc_mon_shm_t* xadc_mon_attach(void);
+
+/**
+ * @brief Unmaps a segment returned by xadc_mon_attach()
+ *
+ * @param[in]   shm  Segment to be unmapped.
+ */
+void xadc_mon_detach(const xadc_mon_shm_t* shm);
+
+/** @} */
+
+
+#endif /* __XADC_MON_H */
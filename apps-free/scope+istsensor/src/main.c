@@ -243,6 +243,10 @@ static rp_app_params_t rp_main_params[PARAMS_NUM+1] = {
         "pid_IST_ki",  0, 1, 0, -8192, 8191 },
     { /* IST PID derivative gain   Kd in [ADC] counts. */
         "pid_IST_kd",  0, 1, 0, -8192, 8191 },
+    /* meas_rms_ch1 [V] - RMS value of the signal, DC part included, measured
+     * like the values above */
+    {  "meas_rms_ch1", 0, 0, 1, 0, +1000 },
+
     { /* Must be last! */
         NULL, 0.0, -1, -1, 0.0, 0.0 }     
 };
@@ -1058,6 +1062,7 @@ int rp_update_meas_data(rp_osc_meas_res_t ch1_meas, rp_osc_meas_res_t ch2_meas)
     rp_main_params[MEAS_AVG_CH1].value = ch1_meas.avg;
     rp_main_params[MEAS_FREQ_CH1].value = ch1_meas.freq;
     rp_main_params[MEAS_PER_CH1].value = ch1_meas.period;
+    rp_main_params[MEAS_RMS_CH1].value = ch1_meas.rms;
 
     rp_main_params[IST_MIN].value = ISTmin;
     rp_main_params[IST_MAX].value = ISTmax;
@@ -159,6 +159,12 @@ static rp_app_params_t rp_main_params[PARAMS_NUM+1] = {
         "scale_ch1", 0, 0, 1, -1000, 1000 },
     { /* scale_ch2 - Jumper & probe attenuation dependent Y scaling factor for Channel 2 */
         "scale_ch2", 0, 0, 1, -1000, 1000 },
+    { /* dec_mode - How display points are made out of the acquired samples:
+       *    0 - stride, every n-th sample
+       *    1 - envelope, min/max pairs of the samples in between
+       *    2 - mean of the samples in between
+       *    3 - RMS of the samples in between */
+        "dec_mode", 0, 0, 0, 0, 3 },
 
     /********************************************************/
     /* Arbitrary Waveform Generator parameters from here on */
@@ -293,6 +299,11 @@ static rp_app_params_t rp_main_params[PARAMS_NUM+1] = {
     { /* pid_NN_kd - PID NN derivative gain   Kd in [ADC] counts. */
         "pid_22_kd",  0, 1, 0, -8192, 8191 },
 
+    /* meas_rms_chN [V] - RMS value of the signal, DC part included, measured
+     * like the values above */
+    {  "meas_rms_ch1", 0, 0, 1, 0, +1000 },
+    {  "meas_rms_ch2", 0, 0, 1, 0, +1000 },
+
     { /* Must be last! */
         NULL, 0.0, -1, -1, 0.0, 0.0 }     
 };
@@ -1118,6 +1129,7 @@ int rp_update_meas_data(rp_osc_meas_res_t ch1_meas, rp_osc_meas_res_t ch2_meas)
     rp_main_params[MEAS_AVG_CH1].value = ch1_meas.avg;
     rp_main_params[MEAS_FREQ_CH1].value = ch1_meas.freq;
     rp_main_params[MEAS_PER_CH1].value = ch1_meas.period;
+    rp_main_params[MEAS_RMS_CH1].value = ch1_meas.rms;
 
     rp_main_params[MEAS_MIN_CH2].value = ch2_meas.min;
     rp_main_params[MEAS_MAX_CH2].value = ch2_meas.max;
@@ -1125,6 +1137,7 @@ int rp_update_meas_data(rp_osc_meas_res_t ch1_meas, rp_osc_meas_res_t ch2_meas)
     rp_main_params[MEAS_AVG_CH2].value = ch2_meas.avg;
     rp_main_params[MEAS_FREQ_CH2].value = ch2_meas.freq;
     rp_main_params[MEAS_PER_CH2].value = ch2_meas.period;
+    rp_main_params[MEAS_RMS_CH2].value = ch2_meas.rms;
 
     pthread_mutex_unlock(&rp_main_params_mutex);
     return 0;
@@ -39,13 +39,20 @@ typedef struct rp_osc_meas_res_s {
     float max;
     float amp;
     float avg;
+    float rms;
     float freq;
     float period;
+
+    /* sums of the samples and their squares in ADC counts, accumulated in
+     * double to stay exact over a whole acquisition, rp_osc_meas_avg_amp()
+     * turns them into avg and rms */
+    double sum;
+    double sum_sq;
 } rp_osc_meas_res_t;
 
 /* Parameters indexes - these defines should be in the same order as 
  * rp_app_params_t structure defined in main.c */
-#define PARAMS_NUM        81
+#define PARAMS_NUM        84
 #define MIN_GUI_PARAM     0
 #define MAX_GUI_PARAM     1
 #define TRIG_MODE_PARAM   2
@@ -88,61 +95,72 @@ typedef struct rp_osc_meas_res_s {
 #define GEN_DC_NORM_2     39
 #define SCALE_CH1         40
 #define SCALE_CH2         41
+#define DEC_MODE_PARAM    42
 /* AWG parameters */
-#define GEN_TRIG_MODE_CH1 42
-#define GEN_SIG_TYPE_CH1  43
-#define GEN_ENABLE_CH1    44
-#define GEN_SINGLE_CH1    45
-#define GEN_SIG_AMP_CH1   46
-#define GEN_SIG_FREQ_CH1  47
-#define GEN_SIG_DCOFF_CH1 48
-#define GEN_TRIG_MODE_CH2 49
-#define GEN_SIG_TYPE_CH2  50
-#define GEN_ENABLE_CH2    51
-#define GEN_SINGLE_CH2    52
-#define GEN_SIG_AMP_CH2   53
-#define GEN_SIG_FREQ_CH2  54
-#define GEN_SIG_DCOFF_CH2 55
-#define GEN_AWG_REFRESH   56
+#define GEN_TRIG_MODE_CH1 43
+#define GEN_SIG_TYPE_CH1  44
+#define GEN_ENABLE_CH1    45
+#define GEN_SINGLE_CH1    46
+#define GEN_SIG_AMP_CH1   47
+#define GEN_SIG_FREQ_CH1  48
+#define GEN_SIG_DCOFF_CH1 49
+#define GEN_TRIG_MODE_CH2 50
+#define GEN_SIG_TYPE_CH2  51
+#define GEN_ENABLE_CH2    52
+#define GEN_SINGLE_CH2    53
+#define GEN_SIG_AMP_CH2   54
+#define GEN_SIG_FREQ_CH2  55
+#define GEN_SIG_DCOFF_CH2 56
+#define GEN_AWG_REFRESH   57
 /* PID parameters */
-#define PID_11_ENABLE     57
-#define PID_11_RESET      58
-#define PID_11_SP         59
-#define PID_11_KP         60
-#define PID_11_KI         61
-#define PID_11_KD         62
-#define PID_12_ENABLE     63
-#define PID_12_RESET      64
-#define PID_12_SP         65
-#define PID_12_KP         66
-#define PID_12_KI         67
-#define PID_12_KD         68
-#define PID_21_ENABLE     69
-#define PID_21_RESET      70
-#define PID_21_SP         71
-#define PID_21_KP         72
-#define PID_21_KI         73
-#define PID_21_KD         74
-#define PID_22_ENABLE     75
-#define PID_22_RESET      76
-#define PID_22_SP         77
-#define PID_22_KP         78
-#define PID_22_KI         79
-#define PID_22_KD         80
+#define PID_11_ENABLE     58
+#define PID_11_RESET      59
+#define PID_11_SP         60
+#define PID_11_KP         61
+#define PID_11_KI         62
+#define PID_11_KD         63
+#define PID_12_ENABLE     64
+#define PID_12_RESET      65
+#define PID_12_SP         66
+#define PID_12_KP         67
+#define PID_12_KI         68
+#define PID_12_KD         69
+#define PID_21_ENABLE     70
+#define PID_21_RESET      71
+#define PID_21_SP         72
+#define PID_21_KP         73
+#define PID_21_KI         74
+#define PID_21_KD         75
+#define PID_22_ENABLE     76
+#define PID_22_RESET      77
+#define PID_22_SP         78
+#define PID_22_KP         79
+#define PID_22_KI         80
+#define PID_22_KD         81
+
+/* RMS measurements, appended to leave the indices above as they are */
+#define MEAS_RMS_CH1      82
+#define MEAS_RMS_CH2      83
 
 /* Defines from which parameters on are AWG parameters (used in set_param() to
  * trigger update only on needed part - either Oscilloscope, AWG or PID */
-#define PARAMS_AWG_PARAMS 42
+#define PARAMS_AWG_PARAMS 43
 
 /* Defines from which parameters on are PID parameters (used in set_param() to
  * trigger update only on needed part - either Oscilloscope, AWG or PID */
-#define PARAMS_PID_PARAMS 57
+#define PARAMS_PID_PARAMS 58
 #define PARAMS_PER_PID     6
 
 /* Output signals */
 #define SIGNAL_LENGTH (1024) /* Must be 2^n! */
 #define SIGNALS_NUM   3
 
+/* Display decimation modes, see DEC_MODE_PARAM */
+#define DEC_MODE_STRIDE   0 /* every n-th sample */
+#define DEC_MODE_ENVELOPE 1 /* min/max pairs of 2*n samples */
+#define DEC_MODE_MEAN     2 /* mean of n samples */
+#define DEC_MODE_RMS      3 /* RMS of n samples */
+
 
 /* module entry points */
 int rp_app_init(void);
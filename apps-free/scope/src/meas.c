@@ -0,0 +1,162 @@
+/**
+ * @brief Red Pitaya Oscilloscope signal measurement kernel.
+ *
+ * (c) Red Pitaya  http://www.redpitaya.com
+ *
+ * This part of code is written in C programming language.
+ * Please visit http://en.wikipedia.org/wiki/C_(programming_language)
+ * for more details on the language used herein.
+ */
+
+#include <limits.h>
+
+#include "meas.h"
+#include "fpga.h"
+
+/**
+ * GENERAL DESCRIPTION:
+ *
+ * The measurements of the workers used to take several walks over the 16k
+ * samples of each channel, calling a helper per sample and wrapping the ring
+ * index with a modulo each time. The kernel below takes min, max, sum and sum
+ * of squares of both channels in a single branch-free pass the compiler is able
+ * to vectorize. The crossings need the thresholds out of min and max, they are
+ * searched afterwards in a walk over the two linear segments of the ring
+ * which ends as soon as enough crossings are found.
+ */
+
+
+/*----------------------------------------------------------------------------------*/
+/* 14 bit two's complement to signed */
+static inline int rp_meas_sign(int in_data, int adc_mask, int adc_sign)
+{
+    return ((in_data & adc_mask) ^ adc_sign) - adc_sign;
+}
+
+
+/*----------------------------------------------------------------------------------*/
+void rp_meas_clear(rp_meas_raw_t *raw)
+{
+    raw->min       = INT_MAX;
+    raw->max       = INT_MIN;
+    raw->sum       = 0;
+    raw->sum_sq    = 0;
+    raw->len       = 0;
+    raw->crossings = 0;
+    raw->period    = 0;
+    raw->scan_min  = INT_MAX;
+    raw->scan_max  = INT_MIN;
+}
+
+
+/*----------------------------------------------------------------------------------*/
+void rp_meas_stats(rp_meas_raw_t *raw_a, const int *cha,
+                   rp_meas_raw_t *raw_b, const int *chb, int len)
+{
+    const int adc_sign = 1 << (c_osc_fpga_adc_bits-1);
+    const int adc_mask = (1 << c_osc_fpga_adc_bits) - 1;
+    int     min_a = raw_a->min, max_a = raw_a->max;
+    int64_t sum_a = 0, sq_a = 0;
+    int i;
+
+    if(chb && raw_b) {
+        int     min_b = raw_b->min, max_b = raw_b->max;
+        int64_t sum_b = 0, sq_b = 0;
+
+        for(i = 0; i < len; i++) {
+            const int a = rp_meas_sign(cha[i], adc_mask, adc_sign);
+            const int b = rp_meas_sign(chb[i], adc_mask, adc_sign);
+
+            min_a = (a < min_a) ? a : min_a;
+            max_a = (a > max_a) ? a : max_a;
+            min_b = (b < min_b) ? b : min_b;
+            max_b = (b > max_b) ? b : max_b;
+            sum_a += a;
+            sum_b += b;
+            sq_a  += (int64_t)a * a;
+            sq_b  += (int64_t)b * b;
+        }
+
+        raw_b->min     = min_b;
+        raw_b->max     = max_b;
+        raw_b->sum    += sum_b;
+        raw_b->sum_sq += sq_b;
+        raw_b->len    += len;
+    } else {
+        for(i = 0; i < len; i++) {
+            const int a = rp_meas_sign(cha[i], adc_mask, adc_sign);
+
+            min_a = (a < min_a) ? a : min_a;
+            max_a = (a > max_a) ? a : max_a;
+            sum_a += a;
+            sq_a  += (int64_t)a * a;
+        }
+    }
+
+    raw_a->min     = min_a;
+    raw_a->max     = max_a;
+    raw_a->sum    += sum_a;
+    raw_a->sum_sq += sq_a;
+    raw_a->len    += len;
+}
+
+
+/*----------------------------------------------------------------------------------*/
+void rp_meas_crossings(rp_meas_raw_t *raw, const int *sig, int len,
+                       int start_idx, float thr_lo, float thr_hi, int max_span)
+{
+    const int adc_sign = 1 << (c_osc_fpga_adc_bits-1);
+    const int adc_mask = (1 << c_osc_fpga_adc_bits) - 1;
+    float t_first = 0, t_last = 0;
+    int   below = 0;
+    int   prev  = 0;
+    int   ix    = 0;
+    int   done  = 0;
+    int   seg;
+
+    raw->crossings = 0;
+    raw->period    = 0;
+    raw->scan_min  = INT_MAX;
+    raw->scan_max  = INT_MIN;
+
+    if((start_idx < 0) || (start_idx >= len))
+        start_idx = 0;
+
+    /* the ring from start_idx to its end, then from its begin to start_idx */
+    for(seg = 0; (seg < 2) && !done; seg++) {
+        const int *p     = seg ? &sig[0] : &sig[start_idx];
+        const int *p_end = seg ? &sig[start_idx] : &sig[len];
+
+        for(; (p < p_end) && !done; p++, ix++) {
+            const int s = rp_meas_sign(*p, adc_mask, adc_sign);
+
+            if(s < raw->scan_min)
+                raw->scan_min = s;
+            if(s > raw->scan_max)
+                raw->scan_max = s;
+
+            if(!below) {
+                /* lower transition */
+                if(s < thr_lo)
+                    below = 1;
+            } else if(s >= thr_hi) {
+                /* upper transition - the previous sample is below thr_hi,
+                 * interpolate where the signal passed it */
+                const float t = ix ? (ix - 1) + (thr_hi - prev) / (float)(s - prev) : 0;
+
+                below = 0;
+                if(raw->crossings++ == 0)
+                    t_first = t;
+                else
+                    t_last = t;
+
+                if((t_last - t_first) > max_span)
+                    done = 1;
+            }
+            prev = s;
+        }
+    }
+
+    if(raw->crossings >= 2)
+        raw->period = (t_last - t_first) / (raw->crossings - 1);
+}
@@ -0,0 +1,49 @@
+/**
+ * @brief Red Pitaya Oscilloscope signal measurement kernel.
+ *
+ * (c) Red Pitaya  http://www.redpitaya.com
+ *
+ * This part of code is written in C programming language.
+ * Please visit http://en.wikipedia.org/wiki/C_(programming_language)
+ * for more details on the language used herein.
+ */
+
+#ifndef __MEAS_H
+#define __MEAS_H
+
+#include <stdint.h>
+
+/* Measurement of one channel in ADC counts, as accumulated by the kernel.
+ * The statistics may be accumulated over several calls, rp_meas_clear()
+ * starts a new measurement.
+ */
+typedef struct rp_meas_raw_s {
+    int     min;        /* minimum sample */
+    int     max;        /* maximum sample */
+    int64_t sum;        /* sum of the samples */
+    int64_t sum_sq;     /* sum of the squared samples */
+    int     len;        /* count of samples taken into the statistics */
+
+    int     crossings;  /* count of rising crossings found */
+    float   period;     /* interpolated mean distance of the crossings in samples,
+                         * 0 with less than two crossings */
+    int     scan_min;   /* minimum of the samples walked for the crossings */
+    int     scan_max;   /* maximum of the samples walked for the crossings */
+} rp_meas_raw_t;
+
+/* clears the measurement */
+void rp_meas_clear(rp_meas_raw_t *raw);
+
+/* accumulates min, max, sum and sum of squares of both channels in one pass
+ * over len samples, the channel B arguments may be NULL */
+void rp_meas_stats(rp_meas_raw_t *raw_a, const int *cha,
+                   rp_meas_raw_t *raw_b, const int *chb, int len);
+
+/* counts the rising crossings of the ring buffer sig with a hysteresis from
+ * below thr_lo to at least thr_hi, walking from start_idx on. The crossing
+ * instants are interpolated between the samples. The walk ends as soon as the
+ * crossings span more than max_span samples or the ring is done. */
+void rp_meas_crossings(rp_meas_raw_t *raw, const int *sig, int len,
+                       int start_idx, float thr_lo, float thr_hi, int max_span);
+
+#endif /* __MEAS_H */
@@ -0,0 +1,244 @@
+/**
+ * @brief Red Pitaya wait for the acquisition trigger.
+ *
+ * (c) Red Pitaya  http://www.redpitaya.com
+ *
+ * This part of code is written in C programming language.
+ * Please visit http://en.wikipedia.org/wiki/C_(programming_language)
+ * for more details on the language used herein.
+ */
+
+#define _GNU_SOURCE     /* ppoll() */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <sys/eventfd.h>
+
+#include "trig_wait.h"
+
+/**
+ * GENERAL DESCRIPTION:
+ *
+ * The workers used to spin on the trigger status register, the spectrum
+ * analyzer without any sleep at all. The wait below blocks on the trigger
+ * interrupt when the FPGA image exports one as a UIO device. Without it the
+ * trigger is polled with an interval starting short, so fast acquisitions
+ * are picked up right away, and doubling up to a limit, so slow ones do
+ * not cost CPU time. In both cases an eventfd lets state changes of the
+ * application end the wait at once.
+ */
+
+
+/*----------------------------------------------------------------------------------*/
+static int trig_wait_open_uio(const char *uio_name)
+{
+    char path[64];
+    char name[64];
+    int  i;
+
+    if(!uio_name)
+        return -1;
+
+    for(i = 0; i < 16; i++) {
+        FILE *fp;
+        int   found = 0;
+
+        snprintf(path, sizeof(path), "/sys/class/uio/uio%d/name", i);
+        if((fp = fopen(path, "r")) == NULL)
+            continue;
+        if(fgets(name, sizeof(name), fp)) {
+            name[strcspn(name, "\n")] = '\0';
+            found = !strcmp(name, uio_name);
+        }
+        fclose(fp);
+
+        if(found) {
+            snprintf(path, sizeof(path), "/dev/uio%d", i);
+            return open(path, O_RDWR);
+        }
+    }
+    return -1;
+}
+
+
+/*----------------------------------------------------------------------------------*/
+static double trig_wait_diff(const struct timespec *t0, const struct timespec *t1)
+{
+    return (t1->tv_sec - t0->tv_sec) + (t1->tv_nsec - t0->tv_nsec) * 1e-9;
+}
+
+
+/*----------------------------------------------------------------------------------*/
+int trig_wait_init(trig_wait_t *tw, const char *uio_name)
+{
+    memset(&tw->stats, 0, sizeof(tw->stats));
+    pthread_mutex_init(&tw->stats_mutex, NULL);
+
+    tw->uio_fd   = trig_wait_open_uio(uio_name);
+    tw->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if(tw->event_fd < 0) {
+        fprintf(stderr, "eventfd() failed, state changes are polled\n");
+    }
+    return 0;
+}
+
+
+/*----------------------------------------------------------------------------------*/
+int trig_wait_exit(trig_wait_t *tw)
+{
+    if(tw->uio_fd >= 0) {
+        close(tw->uio_fd);
+        tw->uio_fd = -1;
+    }
+    if(tw->event_fd >= 0) {
+        close(tw->event_fd);
+        tw->event_fd = -1;
+    }
+    return 0;
+}
+
+
+/*----------------------------------------------------------------------------------*/
+int trig_wait_for(trig_wait_t *tw, trig_wait_triggered_fn triggered,
+                  trig_wait_aborted_fn aborted, void *ctx)
+{
+    struct timespec t_start, t_end, cpu_start, cpu_end;
+    int      interval_us = TRIG_WAIT_POLL_MIN_US;
+    uint32_t irqs  = 0;
+    uint64_t polls = 0;
+    int      ret;
+
+    clock_gettime(CLOCK_MONOTONIC, &t_start);
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu_start);
+
+    while(1) {
+        struct pollfd   fds[2];
+        struct timespec tmo;
+        int nfds = 0;
+        int i;
+
+        if(aborted && aborted(ctx)) {
+            ret = TRIG_WAIT_ABORTED;
+            break;
+        }
+        polls++;
+        if(triggered(ctx)) {
+            ret = TRIG_WAIT_TRIGGERED;
+            break;
+        }
+
+        if(tw->uio_fd >= 0) {
+            /* (re-)enable the interrupt - an edge before that is caught
+             * by the next poll, latest after TRIG_WAIT_POLL_MAX_US */
+            const uint32_t irq_on = 1;
+
+            if(write(tw->uio_fd, &irq_on, sizeof(irq_on)) == sizeof(irq_on)) {
+                fds[nfds].fd     = tw->uio_fd;
+                fds[nfds].events = POLLIN;
+                nfds++;
+                interval_us = TRIG_WAIT_POLL_MAX_US;
+            }
+        }
+        if(tw->event_fd >= 0) {
+            fds[nfds].fd     = tw->event_fd;
+            fds[nfds].events = POLLIN;
+            nfds++;
+        }
+
+        tmo.tv_sec  = interval_us / 1000000;
+        tmo.tv_nsec = (interval_us % 1000000) * 1000L;
+        if(nfds) {
+            if(ppoll(fds, nfds, &tmo, NULL) > 0) {
+                for(i = 0; i < nfds; i++) {
+                    if(!(fds[i].revents & POLLIN))
+                        continue;
+                    if(fds[i].fd == tw->uio_fd) {
+                        /* UIO reads exactly the 32 bit interrupt count */
+                        uint32_t cnt;
+
+                        if(read(fds[i].fd, &cnt, sizeof(cnt)) == sizeof(cnt))
+                            irqs++;
+                    } else {
+                        /* clears the eventfd counter */
+                        uint64_t cnt;
+
+                        if(read(fds[i].fd, &cnt, sizeof(cnt)) != sizeof(cnt))
+                            continue;
+                    }
+                }
+            }
+        } else {
+            usleep(interval_us);
+        }
+
+        if(interval_us < TRIG_WAIT_POLL_MAX_US) {
+            interval_us <<= 1;
+            if(interval_us > TRIG_WAIT_POLL_MAX_US)
+                interval_us = TRIG_WAIT_POLL_MAX_US;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t_end);
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu_end);
+
+    pthread_mutex_lock(&tw->stats_mutex);
+    tw->stats.irqs  += irqs;
+    tw->stats.polls += polls;
+    if(ret == TRIG_WAIT_TRIGGERED) {
+        tw->stats.waits++;
+        tw->stats.last_ttt = trig_wait_diff(&t_start, &t_end);
+        tw->stats.sum_ttt += tw->stats.last_ttt;
+    } else {
+        tw->stats.aborts++;
+    }
+    tw->stats.last_cpu = trig_wait_diff(&cpu_start, &cpu_end);
+    tw->stats.sum_cpu += tw->stats.last_cpu;
+    pthread_mutex_unlock(&tw->stats_mutex);
+
+    return ret;
+}
+
+
+/*----------------------------------------------------------------------------------*/
+void trig_wait_wake(trig_wait_t *tw)
+{
+    const uint64_t one = 1;
+
+    if(tw->event_fd >= 0) {
+        if(write(tw->event_fd, &one, sizeof(one)) != sizeof(one)) {
+            /* counter saturated - the waiter is woken up anyway */
+        }
+    }
+}
+
+
+/*----------------------------------------------------------------------------------*/
+void trig_wait_get_stats(trig_wait_t *tw, trig_wait_stats_t *stats)
+{
+    pthread_mutex_lock(&tw->stats_mutex);
+    *stats = tw->stats;
+    pthread_mutex_unlock(&tw->stats_mutex);
+}
+
+
+/*----------------------------------------------------------------------------------*/
+void trig_wait_print_stats(trig_wait_t *tw, FILE *fp, const char *name)
+{
+    trig_wait_stats_t s;
+    uint32_t n;
+
+    trig_wait_get_stats(tw, &s);
+    n = s.waits + s.aborts;
+
+    fprintf(fp, "%s: trigger %s, %u waits, %u aborted, %u irqs, %llu polls, "
+            "time to trigger avg %.3f ms, CPU per wait avg %.1f us\n",
+            name, (tw->uio_fd >= 0) ? "interrupt" : "polled",
+            s.waits, s.aborts, s.irqs, (unsigned long long)s.polls,
+            s.waits ? (s.sum_ttt / s.waits * 1e3) : 0.0,
+            n ? (s.sum_cpu / n * 1e6) : 0.0);
+}
@@ -0,0 +1,93 @@
+/**
+ * @brief Red Pitaya wait for the acquisition trigger.
+ *
+ * (c) Red Pitaya  http://www.redpitaya.com
+ *
+ * This part of code is written in C programming language.
+ * Please visit http://en.wikipedia.org/wiki/C_(programming_language)
+ * for more details on the language used herein.
+ */
+
+#ifndef __TRIG_WAIT_H
+#define __TRIG_WAIT_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <pthread.h>
+
+/** @defgroup trig_wait_h Trigger wait
+ * @{
+ */
+
+/** Name of the UIO device signalling the trigger interrupt, when the FPGA image provides one. */
+#define TRIG_WAIT_UIO_NAME      "rp_acq_trig"
+
+/** Shortest poll interval in [us], the first interval after each wait started. */
+#define TRIG_WAIT_POLL_MIN_US   20
+/** Longest poll interval in [us], also the longest interrupt wait before the trigger is polled again. */
+#define TRIG_WAIT_POLL_MAX_US   5000
+
+/** trig_wait_for() return values */
+#define TRIG_WAIT_TRIGGERED     0
+#define TRIG_WAIT_ABORTED       1
+
+/** Time and CPU cost of the waits done. */
+typedef struct trig_wait_stats_s {
+    /** Count of waits ended by the trigger */
+    uint32_t waits;
+    /** Count of waits ended by the abort callback */
+    uint32_t aborts;
+    /** Count of interrupts received */
+    uint32_t irqs;
+    /** Count of trigger polls */
+    uint64_t polls;
+    /** Time to trigger of the last wait [s] */
+    double   last_ttt;
+    /** Sum of the times to trigger [s] */
+    double   sum_ttt;
+    /** Thread CPU time the last wait took [s] */
+    double   last_cpu;
+    /** Sum of the thread CPU times of all waits [s] */
+    double   sum_cpu;
+} trig_wait_stats_t;
+
+/** Wait context of one acquisition thread, TRIG_WAIT_INITIALIZER makes
+ * trig_wait_wake() and trig_wait_exit() safe before trig_wait_init(). */
+typedef struct trig_wait_s {
+    /** UIO device of the trigger interrupt, -1 to poll */
+    int               uio_fd;
+    /** Wakes the wait up early, written by trig_wait_wake() */
+    int               event_fd;
+    /** Statistics, see trig_wait_get_stats() */
+    trig_wait_stats_t stats;
+    /** Guards stats */
+    pthread_mutex_t   stats_mutex;
+} trig_wait_t;
+
+#define TRIG_WAIT_INITIALIZER   { -1, -1, { 0 }, PTHREAD_MUTEX_INITIALIZER }
+
+/** Returns != 0 as soon as the trigger happened. */
+typedef int (*trig_wait_triggered_fn)(void *ctx);
+/** Returns != 0 when the wait is to be given up. */
+typedef int (*trig_wait_aborted_fn)(void *ctx);
+
+int  trig_wait_init(trig_wait_t *tw, const char *uio_name);
+int  trig_wait_exit(trig_wait_t *tw);
+
+/* Waits until triggered() reports the trigger or aborted() asks to give up,
+ * both are checked before each wait step. Blocks on the trigger interrupt
+ * when available, otherwise polls with an interval doubling from
+ * TRIG_WAIT_POLL_MIN_US up to TRIG_WAIT_POLL_MAX_US. */
+int  trig_wait_for(trig_wait_t *tw, trig_wait_triggered_fn triggered,
+                   trig_wait_aborted_fn aborted, void *ctx);
+
+/* Makes a running trig_wait_for() check aborted() right away, may be called
+ * from any thread */
+void trig_wait_wake(trig_wait_t *tw);
+
+void trig_wait_get_stats(trig_wait_t *tw, trig_wait_stats_t *stats);
+void trig_wait_print_stats(trig_wait_t *tw, FILE *fp, const char *name);
+
+/** @} */
+
+#endif /* __TRIG_WAIT_H */
@@ -23,6 +23,8 @@
 
 #include "worker.h"
 #include "fpga.h"
+#include "meas.h"
+#include "trig_wait.h"
 
 pthread_t *rp_osc_thread_handler = NULL;
 void *rp_osc_worker_thread(void *args);
@@ -45,6 +47,44 @@ int                  *rp_fpga_cha_signal, *rp_fpga_chb_signal;
 /* Calibration parameters read from EEPROM */
 rp_calib_params_t *rp_calib_params = NULL;
 
+/* Trigger wait of the worker thread */
+trig_wait_t           rp_osc_trig_wait = TRIG_WAIT_INITIALIZER;
+
+/* State seen by the trigger wait callbacks */
+typedef struct rp_osc_wait_ctx_s {
+    rp_osc_worker_state_t old_state;
+    rp_osc_worker_state_t state;
+    int                   params_dirty;
+    int                   long_acq;
+    int                   long_acq_init_trig_ptr;
+} rp_osc_wait_ctx_t;
+
+static int rp_osc_wait_triggered(void *ctx)
+{
+    rp_osc_wait_ctx_t *c = (rp_osc_wait_ctx_t *)ctx;
+
+    if(c->long_acq) {
+        int trig_ptr, curr_ptr;
+        osc_fpga_get_wr_ptr(&curr_ptr, &trig_ptr);
+        /* FPGA wrote new trigger pointer - which means new trigger happened */
+        return (c->long_acq_init_trig_ptr != trig_ptr) || osc_fpga_triggered();
+    }
+    return osc_fpga_triggered();
+}
+
+static int rp_osc_wait_aborted(void *ctx)
+{
+    rp_osc_wait_ctx_t *c = (rp_osc_wait_ctx_t *)ctx;
+
+    pthread_mutex_lock(&rp_osc_ctrl_mutex);
+    c->state = rp_osc_ctrl;
+    c->params_dirty = rp_osc_params_dirty;
+    pthread_mutex_unlock(&rp_osc_ctrl_mutex);
+
+    /* change in state, abort waiting */
+    return (c->state != c->old_state) || c->params_dirty;
+}
+
 
 /*----------------------------------------------------------------------------------*/
 int rp_osc_worker_init(rp_app_params_t *params, int params_len,
@@ -78,6 +118,8 @@ int rp_osc_worker_init(rp_app_params_t *params, int params_len,
 
     osc_fpga_get_sig_ptr(&rp_fpga_cha_signal, &rp_fpga_chb_signal);
 
+    trig_wait_init(&rp_osc_trig_wait, TRIG_WAIT_UIO_NAME);
+
     rp_osc_thread_handler = (pthread_t *)malloc(sizeof(pthread_t));
     if(rp_osc_thread_handler == NULL) {
         rp_cleanup_signals(&rp_osc_signals);
@@ -115,6 +157,8 @@ int rp_osc_worker_exit(void)
         fprintf(stderr, "pthread_join() failed: %s\n", 
                 strerror(errno));
     }
+    trig_wait_print_stats(&rp_osc_trig_wait, stderr, "scope");
+    trig_wait_exit(&rp_osc_trig_wait);
     osc_fpga_exit();
 
     rp_cleanup_signals(&rp_osc_signals);
@@ -134,6 +178,7 @@ int rp_osc_worker_change_state(rp_osc_worker_state_t new_state)
     pthread_mutex_lock(&rp_osc_ctrl_mutex);
     rp_osc_ctrl = new_state;
     pthread_mutex_unlock(&rp_osc_ctrl_mutex);
+    trig_wait_wake(&rp_osc_trig_wait);
     return 0;
 }
 
@@ -159,6 +204,7 @@ int rp_osc_worker_update_params(rp_app_params_t *params, int fpga_update)
     rp_osc_params[PARAMS_NUM].value = -1;
 
     pthread_mutex_unlock(&rp_osc_ctrl_mutex);
+    trig_wait_wake(&rp_osc_trig_wait);
     return 0;
 }
 
@@ -409,32 +455,14 @@ void *rp_osc_worker_thread(void *args)
         }
 
         if(long_acq_idx == 0) {
-            /* polling until data is ready */
-            while(1) {
-                pthread_mutex_lock(&rp_osc_ctrl_mutex);
-                state = rp_osc_ctrl;
-                params_dirty = rp_osc_params_dirty;
-                pthread_mutex_unlock(&rp_osc_ctrl_mutex);
-                /* change in state, abort polling */
-                if((state != old_state) || params_dirty) {
-                    break;
-                }
-                
-                if(!long_acq && osc_fpga_triggered()) {
-                    /* for non-long acquisition wait for trigger */
-                    break;
-                } else if(long_acq) {
-                    int trig_ptr, curr_ptr;
-                    osc_fpga_get_wr_ptr(&curr_ptr, &trig_ptr);
-                    if((long_acq_init_trig_ptr != trig_ptr) || osc_fpga_triggered()) {
-                        /* FPGA wrote new trigger pointer - which means
-                         * new trigger happened 
-                         */
-                        break;
-                    }
-                }
-                usleep(1000);
-            }
+            /* waiting until data is ready */
+            rp_osc_wait_ctx_t wait_ctx = { old_state, state, params_dirty,
+                                           long_acq, long_acq_init_trig_ptr };
+
+            trig_wait_for(&rp_osc_trig_wait, rp_osc_wait_triggered,
+                          rp_osc_wait_aborted, &wait_ctx);
+            state        = wait_ctx.state;
+            params_dirty = wait_ctx.params_dirty;
         }
 
         if((state != old_state) || params_dirty) {
@@ -507,7 +535,8 @@ void *rp_osc_worker_thread(void *args)
                             curr_params[TIME_UNIT_PARAM].value, 
                             &ch1_meas, &ch2_meas, ch1_max_adc_v, ch2_max_adc_v,
                             curr_params[GEN_DC_OFFS_1].value,
-                            curr_params[GEN_DC_OFFS_2].value);
+                            curr_params[GEN_DC_OFFS_2].value,
+                            curr_params[DEC_MODE_PARAM].value);
         } else {
             long_acq_idx = rp_osc_decimate_partial((float **)&rp_tmp_signals[1], 
                                              &rp_fpga_cha_signal[0], 
@@ -608,6 +637,97 @@ int rp_osc_prepare_time_vector(float **out_signal, int dec_factor,
 }
 
 
+/*----------------------------------------------------------------------------------*/
+/* Makes SIGNAL_LENGTH display points out of the FPGA ring buffer, beginning at
+ * in_idx with t_step samples per point. DEC_MODE_STRIDE touches one sample per
+ * point, all other modes take a single pass over the covered samples, the
+ * wrap of the ring splits it into at most two linear segments.
+ */
+static void rp_osc_decimate_ring(float *out, const int *in, int in_idx, int t_step,
+                                 int dec_mode, float max_adc_v,
+                                 int calib_dc_off, float user_dc_off)
+{
+    const int   adc_sign = 1 << (c_osc_fpga_adc_bits-1);
+    const int   adc_mask = (1 << c_osc_fpga_adc_bits) - 1;
+    const float v_per_cnt = max_adc_v / (float)adc_sign;
+    int bin_len, bins, span;
+    int out_idx = 0;
+    int cnt = 0;
+    int smp_min = INT_MAX, smp_max = INT_MIN;
+    int64_t sum = 0, sum_sq = 0;
+
+    if(dec_mode == DEC_MODE_STRIDE) {
+        for(; out_idx < SIGNAL_LENGTH; out_idx++, in_idx += t_step) {
+            if(in_idx >= OSC_FPGA_SIG_LEN)
+                in_idx = in_idx % OSC_FPGA_SIG_LEN;
+            out[out_idx] = osc_fpga_cnv_cnt_to_v(in[in_idx], max_adc_v,
+                                                 calib_dc_off, user_dc_off);
+        }
+        return;
+    }
+
+    /* an envelope point is a pair of values, it covers two strides */
+    bins    = (dec_mode == DEC_MODE_ENVELOPE) ? (SIGNAL_LENGTH >> 1) : SIGNAL_LENGTH;
+    bin_len = (dec_mode == DEC_MODE_ENVELOPE) ? (t_step << 1) : t_step;
+    if(bins * bin_len > OSC_FPGA_SIG_LEN)
+        bin_len = OSC_FPGA_SIG_LEN / bins;
+    span = bins * bin_len;
+
+    while(span > 0) {
+        int seg = OSC_FPGA_SIG_LEN - in_idx;
+        const int *p, *p_end;
+
+        if(seg > span)
+            seg = span;
+        p     = &in[in_idx];
+        p_end = p + seg;
+        span  -= seg;
+        in_idx = 0;
+
+        for(; p < p_end; p++) {
+            /* 14 bit two's complement to signed */
+            const int m = ((*p & adc_mask) ^ adc_sign) - adc_sign;
+
+            if(m < smp_min)
+                smp_min = m;
+            if(m > smp_max)
+                smp_max = m;
+            sum += m;
+            sum_sq += (int64_t)(m + calib_dc_off) * (m + calib_dc_off);
+
+            if(++cnt < bin_len)
+                continue;
+
+            /* bin complete */
+            switch(dec_mode) {
+            case DEC_MODE_ENVELOPE:
+                out[out_idx++] = osc_fpga_cnv_cnt_to_v(smp_min & adc_mask, max_adc_v,
+                                                       calib_dc_off, user_dc_off);
+                out[out_idx++] = osc_fpga_cnv_cnt_to_v(smp_max & adc_mask, max_adc_v,
+                                                       calib_dc_off, user_dc_off);
+                break;
+            case DEC_MODE_MEAN:
+                out[out_idx++] = ((float)sum / cnt + calib_dc_off) * v_per_cnt + user_dc_off;
+                break;
+            case DEC_MODE_RMS:
+            default: {
+                /* RMS of the displayed voltage, the user offset included */
+                const float mean = ((float)sum / cnt + calib_dc_off) * v_per_cnt;
+                const float ms   = (float)sum_sq / cnt * v_per_cnt * v_per_cnt;
+                out[out_idx++] = sqrtf(ms + 2 * mean * user_dc_off + user_dc_off * user_dc_off);
+                break;
+            }
+            }
+
+            cnt = 0;
+            smp_min = INT_MAX;
+            smp_max = INT_MIN;
+            sum = sum_sq = 0;
+        }
+    }
+}
+
+
 /*----------------------------------------------------------------------------------*/
 int rp_osc_decimate(float **cha_signal, int *in_cha_signal,
                     float **chb_signal, int *in_chb_signal,
@@ -615,7 +735,8 @@ int rp_osc_decimate(float **cha_signal, int *in_cha_signal,
                     float t_start, float t_stop, int time_unit,
                     rp_osc_meas_res_t *ch1_meas, rp_osc_meas_res_t *ch2_meas,
                     float ch1_max_adc_v, float ch2_max_adc_v,
-                    float ch1_user_dc_off, float ch2_user_dc_off)
+                    float ch1_user_dc_off, float ch2_user_dc_off,
+                    int dec_mode)
 {
     int t_start_idx, t_stop_idx;
     float smpl_period = c_osc_fpga_smpl_period * dec_factor;
@@ -655,38 +776,33 @@ int rp_osc_decimate(float **cha_signal, int *in_cha_signal,
         in_idx = in_idx % OSC_FPGA_SIG_LEN;
 
     /* First perform measurements on non-decimated signal:
-     *  - min, max - performed in the loop
-     *  - avg, amp - performed after the loop
-     *  - freq, period - performed in the next decimation loop
+     *  - min, max, avg, RMS - one pass of the kernel over both channels
+     *  - amp - performed after the decimation
+     *  - freq, period - performed after the decimation
      */
-    for(out_idx=0; out_idx < OSC_FPGA_SIG_LEN; out_idx++) {
-        rp_osc_meas_min_max(ch1_meas, in_cha_signal[out_idx]);
-        rp_osc_meas_min_max(ch2_meas, in_chb_signal[out_idx]);
+    rp_osc_meas_stats(ch1_meas, in_cha_signal, ch2_meas, in_chb_signal);
+
+    rp_osc_decimate_ring(cha_s, in_cha_signal, in_idx, t_step, dec_mode, ch1_max_adc_v,
+                         rp_calib_params->fe_ch1_dc_offs, ch1_user_dc_off);
+    rp_osc_decimate_ring(chb_s, in_chb_signal, in_idx, t_step, dec_mode, ch2_max_adc_v,
+                         rp_calib_params->fe_ch2_dc_offs, ch2_user_dc_off);
+
+    if(dec_mode == DEC_MODE_ENVELOPE) {
+        /* both values of a min/max pair share the time of the pair, the UI
+         * draws them as a band */
+        for(out_idx=0, t_idx=0; out_idx < SIGNAL_LENGTH; out_idx+=2, t_idx+=2*t_step)
+            t[out_idx] = t[out_idx+1] = (t_start + (t_idx * smpl_period)) * t_unit_factor;
+    } else {
+        for(out_idx=0, t_idx=0; out_idx < SIGNAL_LENGTH; out_idx++, t_idx+=t_step)
+            t[out_idx] = (t_start + (t_idx * smpl_period)) * t_unit_factor;
     }
 
-    for(out_idx=0, t_idx=0; out_idx < SIGNAL_LENGTH; 
-        out_idx++, in_idx+=t_step, t_idx+=t_step) {
-        /* Wrap the pointer */
-        if(in_idx >= OSC_FPGA_SIG_LEN)
-            in_idx = in_idx % OSC_FPGA_SIG_LEN;
-
-        cha_s[out_idx] = osc_fpga_cnv_cnt_to_v(in_cha_signal[in_idx], ch1_max_adc_v,
-                                               rp_calib_params->fe_ch1_dc_offs,
-                                               ch1_user_dc_off);
-
-        chb_s[out_idx] = osc_fpga_cnv_cnt_to_v(in_chb_signal[in_idx], ch2_max_adc_v,
-                                               rp_calib_params->fe_ch2_dc_offs,
-                                               ch2_user_dc_off);
-
-        t[out_idx] = (t_start + (t_idx * smpl_period)) * t_unit_factor;
-
-        /* A bug in FPGA? - Trig & write pointers not sample-accurate. */
-        if ( (dec_factor > 64) && (out_idx == 1) ) {
-            int i;
-            for (i=0; i < out_idx; i++) {
-                cha_s[i] = cha_s[out_idx];
-                chb_s[i] = chb_s[out_idx];
-            }
+    /* A bug in FPGA? - Trig & write pointers not sample-accurate. */
+    if(dec_factor > 64) {
+        int first = (dec_mode == DEC_MODE_ENVELOPE) ? 2 : 1;
+        for(out_idx=0; out_idx < first; out_idx++) {
+            cha_s[out_idx] = cha_s[out_idx+first];
+            chb_s[out_idx] = chb_s[out_idx+first];
         }
     }
 
@@ -803,7 +919,7 @@ int rp_osc_auto_set(rp_app_params_t *orig_params,
 {
     const int c_noise_thr = 500; /* noise threshold */
     rp_osc_worker_state_t old_state, state;
-    int params_dirty;
+    rp_osc_wait_ctx_t wait_ctx = { 0 };
     /* Min/maxes from both channel */
     int max_cha = INT_MIN;
     int max_chb = INT_MIN;
@@ -841,19 +957,10 @@ int rp_osc_auto_set(rp_app_params_t *orig_params,
         osc_fpga_set_trigger(1);
 
         /* Wait for trigger to finish */
-        while(1) {
-            pthread_mutex_lock(&rp_osc_ctrl_mutex);
-            state = rp_osc_ctrl;
-            params_dirty = rp_osc_params_dirty;
-            pthread_mutex_unlock(&rp_osc_ctrl_mutex);
-            /* change in state, abort polling */
-            if((state != old_state) || params_dirty) {
-                return -1;
-            }
-            if(osc_fpga_triggered()) {
-                break;
-            }
-            usleep(500);
+        wait_ctx.old_state = old_state;
+        if(trig_wait_for(&rp_osc_trig_wait, rp_osc_wait_triggered,
+                         rp_osc_wait_aborted, &wait_ctx) != TRIG_WAIT_TRIGGERED) {
+            return -1;
         }
 
         /* Get the signals - available at rp_fpga_chX_signal vectors */
@@ -1007,22 +1114,11 @@ int rp_osc_auto_set(rp_app_params_t *orig_params,
             osc_fpga_arm_trigger();
             osc_fpga_set_trigger(trig_source);
 
-            /* Wait for trigger */
             /* Wait for trigger to finish */
-            while(1) {
-                pthread_mutex_lock(&rp_osc_ctrl_mutex);
-                state = rp_osc_ctrl;
-                params_dirty = rp_osc_params_dirty;
-                pthread_mutex_unlock(&rp_osc_ctrl_mutex);
-
-                /* change in state, abort polling */
-                if((state != old_state) || params_dirty) {
-                    return -1;
-                }
-                if(osc_fpga_triggered()) {
-                    break;
-                }    
-                usleep(500);
+            wait_ctx.old_state = old_state;
+            if(trig_wait_for(&rp_osc_trig_wait, rp_osc_wait_triggered,
+                             rp_osc_wait_aborted, &wait_ctx) != TRIG_WAIT_TRIGGERED) {
+                return -1;
             }
 
             // Checking where acquisition starts
@@ -1118,6 +1214,9 @@ int rp_osc_meas_clear(rp_osc_meas_res_t *ch_meas)
     ch_meas->max = -1e9;
     ch_meas->amp = 0;
     ch_meas->avg = 0;
+    ch_meas->rms = 0;
+    ch_meas->sum = 0;
+    ch_meas->sum_sq = 0;
     ch_meas->freq = 0;
     ch_meas->period = 0;
 
@@ -1145,7 +1244,34 @@ int rp_osc_meas_min_max(rp_osc_meas_res_t *ch_meas, int sig_data)
     if(ch_meas->max < s_data)
         ch_meas->max = s_data;
 
-    ch_meas->avg += s_data;
+    ch_meas->sum += s_data;
+    ch_meas->sum_sq += (double)s_data * s_data;
+
+    return 0;
+}
+
+
+/*----------------------------------------------------------------------------------*/
+int rp_osc_meas_stats(rp_osc_meas_res_t *ch1_meas, int *in_cha_signal,
+                      rp_osc_meas_res_t *ch2_meas, int *in_chb_signal)
+{
+    rp_osc_meas_res_t *meas[2] = { ch1_meas, ch2_meas };
+    rp_meas_raw_t raw[2];
+    int ch;
+
+    rp_meas_clear(&raw[0]);
+    rp_meas_clear(&raw[1]);
+    rp_meas_stats(&raw[0], in_cha_signal, &raw[1], in_chb_signal, OSC_FPGA_SIG_LEN);
+
+    for(ch = 0; ch < 2; ch++) {
+        if(meas[ch]->min > raw[ch].min)
+            meas[ch]->min = raw[ch].min;
+        if(meas[ch]->max < raw[ch].max)
+            meas[ch]->max = raw[ch].max;
+
+        meas[ch]->sum += raw[ch].sum;
+        meas[ch]->sum_sq += raw[ch].sum_sq;
+    }
 
     return 0;
 }
@@ -1154,7 +1280,9 @@ int rp_osc_meas_min_max(rp_osc_meas_res_t *ch_meas, int sig_data)
 /*----------------------------------------------------------------------------------*/
 int rp_osc_meas_avg_amp(rp_osc_meas_res_t *ch_meas, int avg_len)
 {
-    ch_meas->avg /= avg_len;
+    ch_meas->avg = ch_meas->sum / avg_len;
+    /* mean square, rp_osc_meas_convert() takes the root */
+    ch_meas->rms = ch_meas->sum_sq / avg_len;
     ch_meas->amp = ch_meas->max - ch_meas->min;
     return 0;
 }
@@ -1185,10 +1313,7 @@ int meas_period(rp_osc_meas_res_t *meas, int *in_signal, int wr_ptr_trig, int de
     const float c_min_period = 19.6e-9; // 51 MHz
 
     float thr1, thr2, cen;
-    int state = 0;
-    int trig_t[2] = { 0, 0 };
-    int trig_cnt = 0;
-    int ix, ix_corr;
+    rp_meas_raw_t raw;
 
     float acq_dur=(float)(OSC_FPGA_SIG_LEN)/((float) c_osc_fpga_smpl_freq) * (float) dec_factor;
 
@@ -1198,48 +1323,19 @@ int meas_period(rp_osc_meas_res_t *meas, int *in_signal, int wr_ptr_trig, int de
     thr2 = cen + 0.2 * (meas->max - cen);
 
     meas->period = 0;
-    *max = INT_MIN;
-    *min = INT_MAX;
-
-    for(ix = 0; ix < (OSC_FPGA_SIG_LEN); ix++) {
-        ix_corr = ix + wr_ptr_trig;
 
-        if (ix_corr >= OSC_FPGA_SIG_LEN) {
-            ix_corr %= OSC_FPGA_SIG_LEN;
-        }
-
-        int sa = rp_osc_adc_sign(in_signal[ix_corr]);
-
-        /* Another max, min calculation at lower rate to avoid evaluation errors on slower signals */
-        if (sa > *max)
-            *max = sa;
-        if (sa < *min)
-            *min = sa;
-
-        /* Lower transitions */
-        if((state == 0) && (ix_corr > 0) && (sa < thr1)) {
-            state = 1;
-        }
-
-        /* Upper transitions - count them & store edge times. */
-        if((state == 1) && (sa >= thr2) ) {
-            state = 0;
-            if (trig_cnt++ == 0) {
-                trig_t[0] = ix;
-            } else {
-                trig_t[1] = ix;
-            }
-        }
-
-        if ((trig_t[1] - trig_t[0]) > c_meas_time_thr) {
-            break;
-        }
-    }
+    /* Count the transitions & interpolate the edge times, another max, min
+     * calculation over the walked samples to avoid evaluation errors on
+     * slower signals */
+    rp_meas_clear(&raw);
+    rp_meas_crossings(&raw, in_signal, OSC_FPGA_SIG_LEN, wr_ptr_trig,
+                      thr1, thr2, c_meas_time_thr);
+    *max = raw.scan_max;
+    *min = raw.scan_min;
 
     /* Period calculation - taking into account at least meas_time_thr samples */
-    if(trig_cnt >= 2) {
-        meas->period = (trig_t[1] - trig_t[0]) /
-            ((float)c_osc_fpga_smpl_freq * (trig_cnt - 1)) * dec_factor;
+    if(raw.crossings >= 2) {
+        meas->period = raw.period / (float)c_osc_fpga_smpl_freq * dec_factor;
     }
 
     if( ((thr2 - thr1) < c_meas_freq_thr) ||
@@ -1266,6 +1362,11 @@ inline float rp_osc_meas_cnv_cnt(float data, float adc_max_v)
 /*----------------------------------------------------------------------------------*/
 int rp_osc_meas_convert(rp_osc_meas_res_t *ch_meas, float adc_max_v, int32_t cal_dc_offs)
 {
+    /* RMS of the calibrated signal, out of the mean square and the average */
+    float ms = ch_meas->rms + 2 * cal_dc_offs * ch_meas->avg +
+               (float)cal_dc_offs * cal_dc_offs;
+
+    ch_meas->rms = rp_osc_meas_cnv_cnt(sqrtf((ms > 0) ? ms : 0), adc_max_v);
     ch_meas->min = rp_osc_meas_cnv_cnt(ch_meas->min+cal_dc_offs, adc_max_v);
     ch_meas->max = rp_osc_meas_cnv_cnt(ch_meas->max+cal_dc_offs, adc_max_v);
     ch_meas->amp = rp_osc_meas_cnv_cnt(ch_meas->amp, adc_max_v);
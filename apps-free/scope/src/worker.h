@@ -61,6 +61,7 @@ int rp_osc_prepare_time_vector(float **out_signal, int dec_factor,
  * dec_factor - set in FPGA
  * t_start    - user set start time
  * t_stop     - user set stop time
+ * dec_mode   - DEC_MODE_STRIDE, _ENVELOPE (min/max pairs), _MEAN or _RMS
  * TODO: Remove time vector generation from these functions, it should
  * be created at the beginning
  */
@@ -70,7 +71,8 @@ int rp_osc_decimate(float **cha_signal, int *in_cha_signal,
                     float t_start, float t_stop, int time_unit,
                     rp_osc_meas_res_t *ch1_meas, rp_osc_meas_res_t *ch2_meas,
                     float ch1_max_adc_v, float ch2_max_adc_v,
-                    float ch1_user_dc_off, float ch2_user_dc_off);
+                    float ch1_user_dc_off, float ch2_user_dc_off,
+                    int dec_mode);
 
 int rp_osc_decimate_partial(float **cha_out_signal, int *cha_in_signal, 
                             float **chb_out_signal, int *chb_in_signal,
@@ -95,6 +97,10 @@ int rp_osc_get_time_unit_factor(int time_unit);
 int rp_osc_meas_clear(rp_osc_meas_res_t *ch_meas);
 /* helper function - calculates min, max and accumulates average value */
 int rp_osc_meas_min_max(rp_osc_meas_res_t *ch_meas, int sig_data);
+/* helper function - min, max and accumulated average and mean square of the
+ * whole buffer of both channels, one pass of the measurement kernel */
+int rp_osc_meas_stats(rp_osc_meas_res_t *ch1_meas, int *in_cha_signal,
+                      rp_osc_meas_res_t *ch2_meas, int *in_chb_signal);
 /* helper function - calculates average and amplitude */
 int rp_osc_meas_avg_amp(rp_osc_meas_res_t *ch_meas, int avg_len);
 /* helper function - calculates period and frequency */
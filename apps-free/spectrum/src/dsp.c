@@ -24,7 +24,7 @@
 #include "main.h"
 #include "fpga.h"
 #include "dsp.h"
-#include "kiss_fftr.h"
+#include "kiss_fft.h"
 
 extern float g_spectr_fpga_adc_max_v;
 extern const int c_spectr_fpga_adc_bits;
@@ -33,10 +33,28 @@ extern const int c_spectr_fpga_adc_bits;
 const int c_dsp_sig_len = SPECTR_FPGA_SIG_LEN>>1;
 
 /* Internal structures used in DSP  */
-double                *rp_hann_window   = NULL;
-kiss_fft_cpx         *rp_kiss_fft_out1 = NULL;
-kiss_fft_cpx         *rp_kiss_fft_out2 = NULL;
-kiss_fftr_cfg         rp_kiss_fft_cfg  = NULL;
+/* Hann windows of the Welch segment lengths, SPECTR_FPGA_SIG_LEN>>level */
+float                *rp_hann_window[RP_SPECTR_OVERLAP_MAX+1];
+kiss_fft_cpx         *rp_kiss_fft_in   = NULL;
+kiss_fft_cpx         *rp_kiss_fft_out  = NULL;
+kiss_fft_cfg          rp_kiss_fft_cfg  = NULL;
+
+/* FFT plans - allocated once per size, kept until rp_spectr_fft_clean() */
+#define RP_SPECTR_FFT_PLANS 4
+static struct {
+    int          nfft;
+    kiss_fft_cfg cfg;
+} rp_kiss_fft_plans[RP_SPECTR_FFT_PLANS];
+
+/* Spectral estimation - per bin accumulators of c_dsp_sig_len bins, running
+ * estimate resp. block sum and the last complete block of RP_SPECTR_AVG_LIN */
+static float *rp_avg_acc[2]   = { NULL, NULL };
+static float *rp_avg_block[2] = { NULL, NULL };
+static int    rp_avg_cnt      = 0;
+static int    rp_avg_blk_ok   = 0;
+static int    rp_avg_mode     = RP_SPECTR_AVG_OFF;
+static int    rp_avg_num      = 1;
+static int    rp_avg_overlap  = 0;
 
 /* constants - calibration dependant */
 /* Power calc. impedance*/
@@ -87,19 +105,24 @@ int rp_spectr_prepare_freq_vector(float **freq_out, double f_s, float freq_range
 
 int rp_spectr_hann_init()
 {
-    int i;
+    int i, l;
 
-    rp_spectr_hann_clean(rp_hann_window);
+    rp_spectr_hann_clean();
 
-    rp_hann_window = (double *)malloc(SPECTR_FPGA_SIG_LEN * sizeof(double));
-    if(rp_hann_window == NULL) {
-        fprintf(stderr, "rp_spectr_hann_create() can not allocate mem");
-        return -1;
-    }
+    for(l = 0; l <= RP_SPECTR_OVERLAP_MAX; l++) {
+        const int n = SPECTR_FPGA_SIG_LEN >> l;
+
+        rp_hann_window[l] = (float *)malloc(n * sizeof(float));
+        if(rp_hann_window[l] == NULL) {
+            fprintf(stderr, "rp_spectr_hann_create() can not allocate mem");
+            rp_spectr_hann_clean();
+            return -1;
+        }
     
-    for(i = 0; i < SPECTR_FPGA_SIG_LEN; i++) {
-        rp_hann_window[i] = RP_SPECTR_HANN_AMP * 
-            (1 - cos(2*M_PI*i / (double)(SPECTR_FPGA_SIG_LEN-1)));
+        for(i = 0; i < n; i++) {
+            rp_hann_window[l][i] = RP_SPECTR_HANN_AMP * 
+                (1 - cos(2*M_PI*i / (double)(n-1)));
+        }
     }
 
     return 0;
@@ -107,92 +130,335 @@ int rp_spectr_hann_init()
 
 int rp_spectr_hann_clean()
 {
-    if(rp_hann_window) {
-        free(rp_hann_window);
-        rp_hann_window = NULL;
+    int l;
+
+    for(l = 0; l <= RP_SPECTR_OVERLAP_MAX; l++) {
+        if(rp_hann_window[l]) {
+            free(rp_hann_window[l]);
+            rp_hann_window[l] = NULL;
+        }
     }
     return 0;
 }
 
 
-int rp_spectr_hann_filter(double *cha_in, double *chb_in,
-                          double **cha_out, double **chb_out)
+kiss_fft_cfg rp_spectr_fft_plan(int nfft)
 {
     int i;
-    double *cha_o = *cha_out;
-    double *chb_o = *chb_out;
 
-    if(!cha_in || !chb_in || !*cha_out || !*chb_out)
-        return -1;
-    for(i = 0; i < SPECTR_FPGA_SIG_LEN; i++) {
-        cha_o[i] = cha_in[i] * rp_hann_window[i];
-        chb_o[i] = chb_in[i] * rp_hann_window[i];
+    for(i = 0; i < RP_SPECTR_FFT_PLANS; i++) {
+        if(rp_kiss_fft_plans[i].cfg && (rp_kiss_fft_plans[i].nfft == nfft))
+            return rp_kiss_fft_plans[i].cfg;
     }
-
-    return 0;
+    for(i = 0; i < RP_SPECTR_FFT_PLANS; i++) {
+        if(!rp_kiss_fft_plans[i].cfg) {
+            rp_kiss_fft_plans[i].cfg  = kiss_fft_alloc(nfft, 0, NULL, NULL);
+            rp_kiss_fft_plans[i].nfft = nfft;
+            return rp_kiss_fft_plans[i].cfg;
+        }
+    }
+    fprintf(stderr, "rp_spectr_fft_plan() no free plan for %d points\n", nfft);
+    return NULL;
 }
 
 int rp_spectr_fft_init()
 {
-    if(rp_kiss_fft_out1 || rp_kiss_fft_out2 || rp_kiss_fft_cfg) {
+    if(rp_kiss_fft_in || rp_kiss_fft_out || rp_kiss_fft_cfg) {
         rp_spectr_fft_clean();
     }
 
-    rp_kiss_fft_out1 = 
+    rp_kiss_fft_in = 
         (kiss_fft_cpx *)malloc(SPECTR_FPGA_SIG_LEN * sizeof(kiss_fft_cpx));
-    rp_kiss_fft_out2 =
+    rp_kiss_fft_out =
         (kiss_fft_cpx *)malloc(SPECTR_FPGA_SIG_LEN * sizeof(kiss_fft_cpx));
 
-    rp_kiss_fft_cfg = kiss_fftr_alloc(SPECTR_FPGA_SIG_LEN, 0, NULL, NULL);
+    rp_kiss_fft_cfg = rp_spectr_fft_plan(SPECTR_FPGA_SIG_LEN);
 
+    if(!rp_kiss_fft_in || !rp_kiss_fft_out || !rp_kiss_fft_cfg) {
+        rp_spectr_fft_clean();
+        return -1;
+    }
     return 0;
 }
 
 int rp_spectr_fft_clean()
 {
-    kiss_fft_cleanup();
-    if(rp_kiss_fft_out1) {
-        free(rp_kiss_fft_out1);
-        rp_kiss_fft_out1 = NULL;
+    int i;
+
+    for(i = 0; i < RP_SPECTR_FFT_PLANS; i++) {
+        if(rp_kiss_fft_plans[i].cfg) {
+            free(rp_kiss_fft_plans[i].cfg);
+            rp_kiss_fft_plans[i].cfg = NULL;
+        }
     }
-    if(rp_kiss_fft_out2) {
-        free(rp_kiss_fft_out2);
-        rp_kiss_fft_out2 = NULL;
+    rp_kiss_fft_cfg = NULL;
+    kiss_fft_cleanup();
+    if(rp_kiss_fft_in) {
+        free(rp_kiss_fft_in);
+        rp_kiss_fft_in = NULL;
     }
-    if(rp_kiss_fft_cfg) {
-        free(rp_kiss_fft_cfg);
-        rp_kiss_fft_cfg = NULL;
+    if(rp_kiss_fft_out) {
+        free(rp_kiss_fft_out);
+        rp_kiss_fft_out = NULL;
     }
     return 0;
 }
 
-int rp_spectr_fft(double *cha_in, double *chb_in, 
-                  double **cha_out, double **chb_out)
+/* Transforms n points of both channels, adds scale * |X|^2 of the n/2 bins
+ * to cha_o and chb_o */
+static void rp_spectr_fft_pw(const double *cha_in, const double *chb_in,
+                             const float *win, kiss_fft_cfg cfg, int n,
+                             float scale, float *cha_o, float *chb_o)
 {
-    double *cha_o = *cha_out;
-    double *chb_o = *chb_out;
     int i;
+
+    /* Both real channels windowed into one complex signal z = a + j*b */
+    for(i = 0; i < n; i++) {
+        rp_kiss_fft_in[i].r = (float)cha_in[i] * win[i];
+        rp_kiss_fft_in[i].i = (float)chb_in[i] * win[i];
+    }
+
+    kiss_fft(cfg, rp_kiss_fft_in, rp_kiss_fft_out);
+
+    /* FFT limited to fs/2, specter of powers |X|^2. The spectra of the two
+     * real signals are split off the complex one:
+     *   A[k] = (Z[k] + Z*[n-k]) / 2,  B[k] = (Z[k] - Z*[n-k]) / 2j
+     */
+    scale *= 0.25f;
+    for(i = 0; i < (n>>1); i++) {
+        const kiss_fft_cpx *zk = &rp_kiss_fft_out[i];
+        const kiss_fft_cpx *zm = &rp_kiss_fft_out[i ? (n - i) : 0];
+        const float ar = zk->r + zm->r;
+        const float ai = zk->i - zm->i;
+        const float br = zk->i + zm->i;
+        const float bi = zm->r - zk->r;
+
+        cha_o[i] += scale * (ar * ar + ai * ai);
+        chb_o[i] += scale * (br * br + bi * bi);
+    }
+}
+
+int rp_spectr_fft(double *cha_in, double *chb_in, 
+                  float **cha_out, float **chb_out)
+{
     if(!cha_in || !chb_in || !*cha_out || !*chb_out)
         return -1;
 
-    if(!rp_kiss_fft_out1 || !rp_kiss_fft_out2 || !rp_kiss_fft_cfg) {
+    if(!rp_kiss_fft_in || !rp_kiss_fft_out || !rp_kiss_fft_cfg || !rp_hann_window[0]) {
         fprintf(stderr, "rp_spect_fft not initialized");
         return -1;
     }
 
-    kiss_fftr(rp_kiss_fft_cfg, (kiss_fft_scalar *)cha_in, rp_kiss_fft_out1);
-    kiss_fftr(rp_kiss_fft_cfg, (kiss_fft_scalar *)chb_in, rp_kiss_fft_out2);
+    memset(*cha_out, 0, c_dsp_sig_len * sizeof(float));
+    memset(*chb_out, 0, c_dsp_sig_len * sizeof(float));
+    rp_spectr_fft_pw(cha_in, chb_in, rp_hann_window[0], rp_kiss_fft_cfg,
+                     SPECTR_FPGA_SIG_LEN, 1.0f, *cha_out, *chb_out);
+    return 0;
+}
+
+int rp_spectr_welch(double *cha_in, double *chb_in, 
+                    float **cha_out, float **chb_out, int overlap)
+{
+    const int n = SPECTR_FPGA_SIG_LEN;
+    float *cha_o = *cha_out;
+    float *chb_o = *chb_out;
+    int seg_len, hop, segs, bins, spread;
+    kiss_fft_cfg cfg;
+    float scale;
+    int i, j;
+
+    if(overlap <= 0)
+        return rp_spectr_fft(cha_in, chb_in, cha_out, chb_out);
+    if(overlap > RP_SPECTR_OVERLAP_MAX)
+        overlap = RP_SPECTR_OVERLAP_MAX;
+
+    if(!cha_in || !chb_in || !*cha_out || !*chb_out)
+        return -1;
 
-    for(i = 0; i < c_dsp_sig_len; i++) {                     // FFT limited to fs/2, specter of amplitudes
-        cha_o[i] = sqrt(pow(rp_kiss_fft_out1[i].r, 2) + 
-                        pow(rp_kiss_fft_out1[i].i, 2));
-        chb_o[i] = sqrt(pow(rp_kiss_fft_out2[i].r, 2) + 
-                        pow(rp_kiss_fft_out2[i].i, 2));
+    if(!rp_kiss_fft_in || !rp_kiss_fft_out || !rp_hann_window[overlap]) {
+        fprintf(stderr, "rp_spectr_welch not initialized");
+        return -1;
+    }
+
+    seg_len = n >> overlap;
+    hop     = seg_len >> 1;
+    segs    = (n - seg_len) / hop + 1;
+    bins    = seg_len >> 1;
+    spread  = n / seg_len;
+
+    cfg = rp_spectr_fft_plan(seg_len);
+    if(!cfg)
+        return -1;
+
+    /* Mean of the segment powers in the first bins of the outputs. The
+     * decimation normalizes to n points, a tone gains (n/seg_len)^2 with it,
+     * of which 1/spread goes to each of the spread output bins. */
+    scale = (float)spread / (float)segs;
+    memset(cha_o, 0, c_dsp_sig_len * sizeof(float));
+    memset(chb_o, 0, c_dsp_sig_len * sizeof(float));
+    for(i = 0; i < segs; i++) {
+        rp_spectr_fft_pw(&cha_in[i * hop], &chb_in[i * hop],
+                         rp_hann_window[overlap], cfg, seg_len, scale,
+                         cha_o, chb_o);
+    }
+
+    /* Spread to the nearest output bins, backwards as the source bin
+     * never lies above the output bin */
+    for(j = c_dsp_sig_len - 1; j >= 0; j--) {
+        int k = (j + (spread >> 1)) >> overlap;
+
+        if(k >= bins)
+            k = bins - 1;
+        cha_o[j] = cha_o[k];
+        chb_o[j] = chb_o[k];
+    }
+    return 0;
+}
+
+int rp_spectr_avg_init()
+{
+    int c;
+
+    rp_spectr_avg_clean();
+
+    for(c = 0; c < 2; c++) {
+        rp_avg_acc[c]   = (float *)malloc(c_dsp_sig_len * sizeof(float));
+        rp_avg_block[c] = (float *)malloc(c_dsp_sig_len * sizeof(float));
+        if(!rp_avg_acc[c] || !rp_avg_block[c]) {
+            fprintf(stderr, "rp_spectr_avg_init() can not allocate mem");
+            rp_spectr_avg_clean();
+            return -1;
+        }
+    }
+    rp_spectr_avg_reset();
+    return 0;
+}
+
+int rp_spectr_avg_clean()
+{
+    int c;
+
+    for(c = 0; c < 2; c++) {
+        if(rp_avg_acc[c]) {
+            free(rp_avg_acc[c]);
+            rp_avg_acc[c] = NULL;
+        }
+        if(rp_avg_block[c]) {
+            free(rp_avg_block[c]);
+            rp_avg_block[c] = NULL;
+        }
     }
     return 0;
 }
 
-int rp_spectr_decimate(double *cha_in, double *chb_in, 
+void rp_spectr_avg_reset()
+{
+    int c;
+
+    for(c = 0; c < 2; c++) {
+        if(rp_avg_acc[c])
+            memset(rp_avg_acc[c], 0, c_dsp_sig_len * sizeof(float));
+    }
+    rp_avg_cnt    = 0;
+    rp_avg_blk_ok = 0;
+}
+
+int rp_spectr_avg(float **cha_io, float **chb_io, int mode, int num, int overlap)
+{
+    int c, i;
+
+    if(!*cha_io || !*chb_io)
+        return -1;
+
+    if(num < 1)
+        num = 1;
+    /* frames of another segmentation have another resolution and noise floor */
+    if((mode != rp_avg_mode) || (num != rp_avg_num) || (overlap != rp_avg_overlap)) {
+        rp_avg_mode    = mode;
+        rp_avg_num     = num;
+        rp_avg_overlap = overlap;
+        rp_spectr_avg_reset();
+    }
+
+    if((mode == RP_SPECTR_AVG_OFF) || !rp_avg_acc[0] || !rp_avg_acc[1])
+        return 1;
+
+    for(c = 0; c < 2; c++) {
+        float *x   = c ? *chb_io : *cha_io;
+        float *acc = rp_avg_acc[c];
+        float *blk = rp_avg_block[c];
+
+        switch(mode) {
+        case RP_SPECTR_AVG_EXP: {
+            /* equal weights while the estimate is made of less than num
+             * frames, 1/num afterwards */
+            const float w = 1.0f / ((rp_avg_cnt < num) ? rp_avg_cnt + 1 : num);
+
+            for(i = 0; i < c_dsp_sig_len; i++) {
+                acc[i] += (x[i] - acc[i]) * w;
+                x[i]    = acc[i];
+            }
+            break;
+        }
+        case RP_SPECTR_AVG_LIN:
+            if(rp_avg_cnt + 1 < num) {
+                /* shows the last block, the running one until there is one */
+                const float w = 1.0f / (rp_avg_cnt + 1);
+
+                for(i = 0; i < c_dsp_sig_len; i++) {
+                    acc[i] += x[i];
+                    x[i]    = rp_avg_blk_ok ? blk[i] : acc[i] * w;
+                }
+            } else {
+                const float w = 1.0f / num;
+
+                for(i = 0; i < c_dsp_sig_len; i++) {
+                    blk[i] = (acc[i] + x[i]) * w;
+                    acc[i] = 0;
+                    x[i]   = blk[i];
+                }
+            }
+            break;
+        case RP_SPECTR_AVG_MAX:
+            if(rp_avg_cnt == 0) {
+                memcpy(acc, x, c_dsp_sig_len * sizeof(float));
+                break;
+            }
+            for(i = 0; i < c_dsp_sig_len; i++) {
+                acc[i] = (x[i] > acc[i]) ? x[i] : acc[i];
+                x[i]   = acc[i];
+            }
+            break;
+        case RP_SPECTR_AVG_MIN:
+            if(rp_avg_cnt == 0) {
+                memcpy(acc, x, c_dsp_sig_len * sizeof(float));
+                break;
+            }
+            for(i = 0; i < c_dsp_sig_len; i++) {
+                acc[i] = (x[i] < acc[i]) ? x[i] : acc[i];
+                x[i]   = acc[i];
+            }
+            break;
+        default:
+            return 1;
+        }
+    }
+
+    if(mode == RP_SPECTR_AVG_LIN) {
+        if(++rp_avg_cnt >= num) {
+            rp_avg_cnt    = 0;
+            rp_avg_blk_ok = 1;
+        }
+        return rp_avg_blk_ok ? num : rp_avg_cnt;
+    }
+
+    /* hold modes count on, limited to keep the counter from wrapping */
+    if(rp_avg_cnt < 1000000)
+        rp_avg_cnt++;
+    return ((mode == RP_SPECTR_AVG_EXP) && (rp_avg_cnt > num)) ? num : rp_avg_cnt;
+}
+
+int rp_spectr_decimate(float *cha_in, float *chb_in, 
                        float **cha_out, float **chb_out,
                        int in_len, int out_len)
 {
@@ -220,18 +486,14 @@ int rp_spectr_decimate(double *cha_in, double *chb_in,
 	
 	/* Conversion factor from ADC counts to Volts */
     	double c2v = g_spectr_fpga_adc_max_v/(float)((int)(1<<(c_spectr_fpga_adc_bits-1)));
+
+	/* Conversion of |X|^2 to power (Watts) */
+        const float c_x2w = c2v * c2v / c_imp /                 // c_imp = 50 Ohms, is the transmission line impdeance
+            (double)SPECTR_FPGA_SIG_LEN / (double)SPECTR_FPGA_SIG_LEN * 2; // x 2 for unilateral spectral density representation
 	
         for(k=j; k < j+step; k++) {
-	
-	/* Conversion to power (Watts) */  
-        double cha_p = pow(cha_in[k] * c2v, 2) / c_imp /
-            (double)SPECTR_FPGA_SIG_LEN / (double)SPECTR_FPGA_SIG_LEN * 2; // x 2 for unilateral spectral density representation
-        double chb_p = pow(chb_in[k] * c2v, 2) / c_imp /                   // c_imp = 50 Ohms, is the transmission line impdeance   
-            (double)SPECTR_FPGA_SIG_LEN / (double)SPECTR_FPGA_SIG_LEN * 2;
-	  
-	  
-            cha_o[i] += (float)cha_p;  // Summing the power expressed in Watts associated to each FFT bin
-            chb_o[i] += (float)chb_p;
+            cha_o[i] += cha_in[k] * c_x2w;  // Summing the power expressed in Watts associated to each FFT bin
+            chb_o[i] += chb_in[k] * c_x2w;
         }
     }
 
@@ -15,6 +15,8 @@
 #ifndef __DSP_H
 #define __DSP_H
 
+#include "kiss_fft.h"
+
 extern const int c_dsp_sig_len;
 
 extern const double c_c2v;
@@ -25,29 +27,61 @@ int rp_spectr_prepare_freq_vector(float **freq_out, double f_s,
 
 /* Processing stuff - Hanning window */
 #define RP_SPECTR_HANN_AMP 0.8165 // Hann window power scaling (1/sqrt(sum(rcos.^2/N)))
+/* Welch segments: level 0 is one segment of SPECTR_FPGA_SIG_LEN, level n
+ * splits the capture into segments of SPECTR_FPGA_SIG_LEN>>n overlapping by
+ * 50 % (3 segments at level 1, 7 at level 2) */
+#define RP_SPECTR_OVERLAP_MAX 2
 int rp_spectr_hann_init();
 int rp_spectr_hann_clean();
 
-/* Input & Outputs of SPECTR_FPGA_SIG_LEN */
-int rp_spectr_hann_filter(double *cha_in, double *chb_in,
-                          double **cha_out, double **chb_out);
+/* Returns the FFT plan of nfft points, allocated on first use */
+kiss_fft_cfg rp_spectr_fft_plan(int nfft);
 
 int rp_spectr_fft_init();
 int rp_spectr_fft_clean();
 
 /* Inputs length: SPECTR_FPGA_SIG_LEN
  * Outputs length: floor(SPECTR_FPGA_SIG_LEN/2) 
- * Output is not complex number as usually is from the FFT but abs() value of the
- * calculation.
+ * The inputs are Hann windowed and transformed together in one complex FFT.
+ * Output is not complex number as usually is from the FFT but the power |X|^2
+ * of each bin.
  */
 int rp_spectr_fft(double *cha_in, double *chb_in, 
-                  double **cha_out, double **chb_out);
+                  float **cha_out, float **chb_out);
+
+/* Same as rp_spectr_fft() with Welch segments of the given overlap level,
+ * averaging |X|^2 of all segments. The coarser bins are spread over the
+ * c_dsp_sig_len output bins, scaled so rp_spectr_decimate() reports the same
+ * power for tones and noise as with level 0.
+ */
+int rp_spectr_welch(double *cha_in, double *chb_in, 
+                    float **cha_out, float **chb_out, int overlap);
+
+/* Spectral estimation modes (avg_mode parameter) */
+#define RP_SPECTR_AVG_OFF  0 // every frame as it is
+#define RP_SPECTR_AVG_EXP  1 // exponential, weight 1/avg_num (linear until avg_num frames)
+#define RP_SPECTR_AVG_LIN  2 // linear mean of blocks of avg_num frames
+#define RP_SPECTR_AVG_MAX  3 // max hold
+#define RP_SPECTR_AVG_MIN  4 // min hold
+
+int rp_spectr_avg_init();
+int rp_spectr_avg_clean();
+/* Drops the accumulated frames, the next frame starts a new estimate */
+void rp_spectr_avg_reset();
+
+/* Adds the |X|^2 frame of length c_dsp_sig_len to the per bin accumulators
+ * and replaces it with the current estimate. Returns the count of frames the
+ * estimate is made of. A change of mode, num or the overlap the frame was
+ * computed with by rp_spectr_welch() starts a new estimate.
+ */
+int rp_spectr_avg(float **cha_io, float **chb_io, int mode, int num, int overlap);
 
 
 /*
- * Decimation (usually from internal 8k -> output 2k)
+ * Decimation (usually from internal 8k -> output 2k), sums the |X|^2 of the
+ * bins as power in [W]
 */
-int rp_spectr_decimate(double *cha_in, double *chb_in,
+int rp_spectr_decimate(float *cha_in, float *chb_in,
                        float **cha_out, float **chb_out,
                        int in_len, int out_len);
 
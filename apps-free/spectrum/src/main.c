@@ -63,6 +63,22 @@ static rp_app_params_t rp_main_params[PARAMS_NUM+1] = {
 		   *    0 - disable
 		   *    1 - enable */
 		"en_avg_at_dec", 1, 0, 1,      0,         1 },
+    { /* avg_mode - spectral estimation of the frames:
+       *    0 - off
+       *    1 - exponential averaging
+       *    2 - linear averaging of avg_num frames
+       *    3 - max hold
+       *    4 - min hold */
+        "avg_mode", 0, 0, 0,         0,         4 },
+    { /* avg_num - frames averaged */
+        "avg_num", 16, 0, 0,         1,      1000 },
+    { /* overlap - Welch segments of the capture:
+       *    0 - one segment, full resolution
+       *    1 - 3 segments of half length, 50 % overlap
+       *    2 - 7 segments of quarter length, 50 % overlap */
+        "overlap", 0, 0, 0,         0,         2 },
+    { /* avg_cnt - frames the shown spectrum is made of */
+        "avg_cnt", 0, 0, 1,         0,    1e6 },
     { /* Must be last! */
         NULL, 0.0, -1, -1, 0.0, 0.0 }
 };
@@ -228,6 +244,7 @@ int rp_get_signals(float ***s, int *sig_num, int *sig_len)
     rp_main_params[PEAK_PW_FREQ_CHA_PARAM].value = (float)result.peak_pw_freq_cha;
     rp_main_params[PEAK_PW_CHB_PARAM].value      = (float)result.peak_pw_chb;
     rp_main_params[PEAK_PW_FREQ_CHB_PARAM].value = (float)result.peak_pw_freq_chb;
+    rp_main_params[AVG_CNT_PARAM].value          = (float)result.avg_cnt;
 
 
     return 0;
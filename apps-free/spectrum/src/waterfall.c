@@ -192,7 +192,7 @@ int rp_spectr_wf_clean_map(void)
     return 0;
 }
 
-int rp_spectr_wf_calc(double *cha_in, double *chb_in)
+int rp_spectr_wf_calc(float *cha_in, float *chb_in)
 {
     if(!cha_in || !chb_in) {
         fprintf(stderr, "rp_spectr_wf_calc(): input signals not initialized\n");
@@ -263,7 +263,7 @@ int rp_spectr_wf_save_jpeg(const char *wf_cha_file, const char *wf_chb_file)
  *  - avg. filter: RP_SPECTR_WF_AVG_FILT
  *  - output: c_dsp_sig_len + RP_SPECTR_WF_AVG_FILT - 1 
  */
-int rp_spectr_wf_conv(double *cha_in, double *chb_in,
+int rp_spectr_wf_conv(float *cha_in, float *chb_in,
                       double **cha_out, double **chb_out)
 {
     double *cha_o = *cha_out;
@@ -320,9 +320,9 @@ int rp_spectr_wf_dec_map(double *cha_in, double *chb_in,
         if(i >= c_dsp_sig_len) {
             continue;
         }
-        /* put to linear scale */
-        cha_s = 20*log10(cha_in[i]);
-        chb_s = 20*log10(chb_in[i]);
+        /* put to linear scale - the inputs are powers |X|^2 */
+        cha_s = 10*log10(cha_in[i]);
+        chb_s = 10*log10(chb_in[i]);
 
         /* prepare map */
         cha_o[o] = __rp_spectr_wf_limit(round(cha_s * g_mm + g_qq));
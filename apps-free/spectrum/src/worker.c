@@ -27,6 +27,7 @@
 #include "fpga.h"
 #include "dsp.h"
 #include "waterfall.h"
+#include "trig_wait.h"
 
 /* JPG outputs: c_jpg_file_path+[1|2]+_+jpg_cnt(3 digits)+c_jpg_file_suf */
 const char c_jpg_dir_path[]="/tmp/ram";
@@ -51,8 +52,8 @@ double *rp_chb_in = NULL;
 
 /* DSP structures */
 /* size = c_dsp_sig_len */
-double *rp_cha_fft = NULL;
-double *rp_chb_fft = NULL;
+float *rp_cha_fft = NULL;
+float *rp_chb_fft = NULL;
 
 /* Output 3 x SPECTR_OUT_SIG signals - used internally for calculation */
 float               **rp_tmp_signals = NULL;
@@ -69,6 +70,34 @@ float                **rp_spectr_signals = NULL;
 rp_spectr_worker_res_t rp_spectr_result;
 int                    rp_spectr_signals_dirty = 0;
 
+/* Trigger wait of the worker thread */
+trig_wait_t            rp_spectr_trig_wait = TRIG_WAIT_INITIALIZER;
+
+/* State seen by the trigger wait callbacks */
+typedef struct rp_spectr_wait_ctx_s {
+    rp_spectr_worker_state_t old_state;
+    rp_spectr_worker_state_t state;
+    int                      params_dirty;
+} rp_spectr_wait_ctx_t;
+
+static int rp_spectr_wait_triggered(void *ctx)
+{
+    return spectr_fpga_triggered();
+}
+
+static int rp_spectr_wait_aborted(void *ctx)
+{
+    rp_spectr_wait_ctx_t *c = (rp_spectr_wait_ctx_t *)ctx;
+
+    pthread_mutex_lock(&rp_spectr_ctrl_mutex);
+    c->state = rp_spectr_ctrl;
+    c->params_dirty = rp_spectr_params_dirty;
+    pthread_mutex_unlock(&rp_spectr_ctrl_mutex);
+
+    /* change in state, abort waiting */
+    return (c->state != c->old_state) || c->params_dirty;
+}
+
 int rp_spectr_worker_init(void)
 {
     int ret_val;
@@ -92,8 +121,8 @@ int rp_spectr_worker_init(void)
 
     rp_cha_in = (double *)malloc(sizeof(double) * SPECTR_FPGA_SIG_LEN);
     rp_chb_in = (double *)malloc(sizeof(double) * SPECTR_FPGA_SIG_LEN);
-    rp_cha_fft = (double *)malloc(sizeof(double) * c_dsp_sig_len);
-    rp_chb_fft = (double *)malloc(sizeof(double) * c_dsp_sig_len);
+    rp_cha_fft = (float *)malloc(sizeof(float) * c_dsp_sig_len);
+    rp_chb_fft = (float *)malloc(sizeof(float) * c_dsp_sig_len);
     if(!rp_cha_in || !rp_chb_in || !rp_cha_fft || !rp_chb_fft) {
         rp_spectr_worker_clean();
         return -1;
@@ -128,8 +157,15 @@ int rp_spectr_worker_init(void)
         return -1;
     }
 
+    if(rp_spectr_avg_init() < 0) {
+        rp_spectr_worker_clean();
+        return -1;
+    }
+
     spectr_fpga_get_sig_ptr(&rp_fpga_cha_signal, &rp_fpga_chb_signal);
 
+    trig_wait_init(&rp_spectr_trig_wait, TRIG_WAIT_UIO_NAME);
+
     rp_spectr_thread_handler = (pthread_t *)malloc(sizeof(pthread_t));
     if(rp_spectr_thread_handler == NULL) {
         rp_cleanup_signals(&rp_spectr_signals);
@@ -161,6 +197,7 @@ int rp_spectr_worker_clean(void)
     rp_spectr_hann_clean();
     rp_spectr_fft_clean();
     rp_spectr_wf_clean();
+    rp_spectr_avg_clean();
 
     if(jpg_fname_cha) {
         free(jpg_fname_cha);
@@ -204,6 +241,8 @@ int rp_spectr_worker_exit(void)
         fprintf(stderr, "pthread_join() failed: %s\n", 
                 strerror(errno));
     }
+    trig_wait_print_stats(&rp_spectr_trig_wait, stderr, "spectrum");
+    trig_wait_exit(&rp_spectr_trig_wait);
     rp_spectr_worker_clean();
     rp_spectr_clean_tmpdir(c_jpg_dir_path);
     return 0;
@@ -216,6 +255,7 @@ int rp_spectr_worker_change_state(rp_spectr_worker_state_t new_state)
     pthread_mutex_lock(&rp_spectr_ctrl_mutex);
     rp_spectr_ctrl = new_state;
     pthread_mutex_unlock(&rp_spectr_ctrl_mutex);
+    trig_wait_wake(&rp_spectr_trig_wait);
     return 0;
 }
 
@@ -226,6 +266,7 @@ int rp_spectr_worker_update_params(rp_app_params_t *params, int fpga_update)
     rp_spectr_params_dirty       = 1;
     rp_spectr_params_fpga_update = fpga_update;
     pthread_mutex_unlock(&rp_spectr_ctrl_mutex);
+    trig_wait_wake(&rp_spectr_trig_wait);
     return 0;
 }
 
@@ -306,6 +347,7 @@ int rp_spectr_get_signals(float ***signals, rp_spectr_worker_res_t *result)
     result->peak_pw_freq_cha = rp_spectr_result.peak_pw_freq_cha;
     result->peak_pw_chb      = rp_spectr_result.peak_pw_chb;
     result->peak_pw_freq_chb = rp_spectr_result.peak_pw_freq_chb;
+    result->avg_cnt          = rp_spectr_result.avg_cnt;
 
     pthread_mutex_unlock(&rp_spectr_sig_mutex);
     return 0;
@@ -325,6 +367,7 @@ int rp_spectr_set_signals(float **source, rp_spectr_worker_res_t result)
     rp_spectr_result.peak_pw_freq_cha = result.peak_pw_freq_cha;
     rp_spectr_result.peak_pw_chb      = result.peak_pw_chb;
     rp_spectr_result.peak_pw_freq_chb = result.peak_pw_freq_chb;
+    rp_spectr_result.avg_cnt          = result.avg_cnt;
 
     pthread_mutex_unlock(&rp_spectr_sig_mutex);
 
@@ -342,6 +385,7 @@ void *rp_spectr_worker_thread(void *args)
     /* depends on freq_range - do not save too much or too less */
     int                      jpg_write_div = 10;
     rp_spectr_worker_res_t   tmp_result;
+    rp_spectr_wait_ctx_t     wait_ctx;
 
     pthread_mutex_lock(&rp_spectr_ctrl_mutex);
     old_state = state = rp_spectr_ctrl;
@@ -377,6 +421,7 @@ void *rp_spectr_worker_thread(void *args)
 
             fpga_update = 0;
             rp_spectr_wf_clean_map();
+            rp_spectr_avg_reset();
             switch((int)curr_params[FREQ_RANGE_PARAM].value) {
             case 0:
             case 1:
@@ -415,21 +460,12 @@ void *rp_spectr_worker_thread(void *args)
             break;
         }
 
-        /* polling until data is ready */
-        while(1) {
-            pthread_mutex_lock(&rp_spectr_ctrl_mutex);
-            state = rp_spectr_ctrl;
-            params_dirty = rp_spectr_params_dirty;
-            pthread_mutex_unlock(&rp_spectr_ctrl_mutex);
-            /* change in state, abort polling */
-            if((state != old_state) || params_dirty) {
-                break;
-            }
-                
-            if(spectr_fpga_triggered()) {
-                break;
-            }
-        }
+        /* waiting until data is ready */
+        wait_ctx.old_state = old_state;
+        trig_wait_for(&rp_spectr_trig_wait, rp_spectr_wait_triggered,
+                      rp_spectr_wait_aborted, &wait_ctx);
+        state        = wait_ctx.state;
+        params_dirty = wait_ctx.params_dirty;
 
         if((state != old_state) || params_dirty) {
             params_dirty = 0;
@@ -443,11 +479,16 @@ void *rp_spectr_worker_thread(void *args)
                                       c_spectr_fpga_smpl_freq,
                                       curr_params[FREQ_RANGE_PARAM].value);
 
-        rp_spectr_hann_filter(&rp_cha_in[0], &rp_chb_in[0],
-                              &rp_cha_in, &rp_chb_in);
-        
-        rp_spectr_fft(&rp_cha_in[0], &rp_chb_in[0], 
-                      (double **)&rp_cha_fft, (double **)&rp_chb_fft);
+        rp_spectr_welch(&rp_cha_in[0], &rp_chb_in[0], 
+                        &rp_cha_fft, &rp_chb_fft,
+                        (int)curr_params[OVERLAP_PARAM].value);
+
+        /* Averaging resp. hold - the waterfall shows the estimate, too */
+        tmp_result.avg_cnt = 
+            rp_spectr_avg(&rp_cha_fft, &rp_chb_fft,
+                          (int)curr_params[AVG_MODE_PARAM].value,
+                          (int)curr_params[AVG_NUM_PARAM].value,
+                          (int)curr_params[OVERLAP_PARAM].value);
         
         rp_spectr_decimate(&rp_cha_fft[0], &rp_chb_fft[0], 
                            (float **)&rp_tmp_signals[1], 
@@ -32,6 +32,7 @@ typedef struct rp_spectr_worker_res_s {
     float peak_pw_freq_cha;
     float peak_pw_chb;
     float peak_pw_freq_chb;
+    int   avg_cnt;          /* frames the spectrum is estimated of */
 } rp_spectr_worker_res_t;
 
 int rp_spectr_worker_init(void);
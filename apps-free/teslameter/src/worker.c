@@ -24,6 +24,7 @@
  #include <math.h>
 #include "worker.h"
 #include "fpga.h"
+#include "meas.h"
 #include <sys/mman.h>
 
 
@@ -791,14 +792,11 @@ int rp_osc_decimate(float **cha_signal, int *in_cha_signal,
         in_idx = in_idx % OSC_FPGA_SIG_LEN;
 
     /* First perform measurements on non-decimated signal:
-     *  - min, max - performed in the loop
-     *  - avg, amp - performed after the loop
-     *  - freq, period - performed in the next decimation loop
+     *  - min, max, avg, RMS - one pass of the kernel over both channels
+     *  - amp - performed after the decimation
+     *  - freq, period - performed after the decimation
      */
-    for(out_idx=0; out_idx < OSC_FPGA_SIG_LEN; out_idx++) {
-        rp_osc_meas_min_max(ch1_meas, in_cha_signal[out_idx]);
-        rp_osc_meas_min_max(ch2_meas, in_chb_signal[out_idx]);
-    }
+    rp_osc_meas_stats(ch1_meas, in_cha_signal, ch2_meas, in_chb_signal);
 
     for(out_idx=0, t_idx=0; out_idx < SIGNAL_LENGTH; 
         out_idx++, in_idx+=t_step, t_idx+=t_step) {
@@ -1324,6 +1322,9 @@ int rp_osc_meas_clear(rp_osc_meas_res_t *ch_meas)
     ch_meas->max = -1e9;
     ch_meas->amp = 0;
     ch_meas->avg = 0;
+    ch_meas->rms = 0;
+    ch_meas->sum = 0;
+    ch_meas->sum_sq = 0;
     ch_meas->freq = 0;
     ch_meas->period = 0;
 
@@ -1351,7 +1352,34 @@ int rp_osc_meas_min_max(rp_osc_meas_res_t *ch_meas, int sig_data)
     if(ch_meas->max < s_data)
         ch_meas->max = s_data;
 
-    ch_meas->avg += s_data;
+    ch_meas->sum += s_data;
+    ch_meas->sum_sq += (double)s_data * s_data;
+
+    return 0;
+}
+
+
+/*----------------------------------------------------------------------------------*/
+int rp_osc_meas_stats(rp_osc_meas_res_t *ch1_meas, int *in_cha_signal,
+                      rp_osc_meas_res_t *ch2_meas, int *in_chb_signal)
+{
+    rp_osc_meas_res_t *meas[2] = { ch1_meas, ch2_meas };
+    rp_meas_raw_t raw[2];
+    int ch;
+
+    rp_meas_clear(&raw[0]);
+    rp_meas_clear(&raw[1]);
+    rp_meas_stats(&raw[0], in_cha_signal, &raw[1], in_chb_signal, OSC_FPGA_SIG_LEN);
+
+    for(ch = 0; ch < 2; ch++) {
+        if(meas[ch]->min > raw[ch].min)
+            meas[ch]->min = raw[ch].min;
+        if(meas[ch]->max < raw[ch].max)
+            meas[ch]->max = raw[ch].max;
+
+        meas[ch]->sum += raw[ch].sum;
+        meas[ch]->sum_sq += raw[ch].sum_sq;
+    }
 
     return 0;
 }
@@ -1360,7 +1388,9 @@ int rp_osc_meas_min_max(rp_osc_meas_res_t *ch_meas, int sig_data)
 /*----------------------------------------------------------------------------------*/
 int rp_osc_meas_avg_amp(rp_osc_meas_res_t *ch_meas, int avg_len)
 {
-    ch_meas->avg /= avg_len;
+    ch_meas->avg = ch_meas->sum / avg_len;
+    /* mean square, rp_osc_meas_convert() takes the root */
+    ch_meas->rms = ch_meas->sum_sq / avg_len;
     ch_meas->amp = ch_meas->max - ch_meas->min;
     return 0;
 }
@@ -1391,10 +1421,7 @@ int meas_period(rp_osc_meas_res_t *meas, int *in_signal, int wr_ptr_trig, int de
     const float c_min_period = 19.6e-9; // 51 MHz
 
     float thr1, thr2, cen;
-    int state = 0;
-    int trig_t[2] = { 0, 0 };
-    int trig_cnt = 0;
-    int ix, ix_corr;
+    rp_meas_raw_t raw;
 
     float acq_dur=(float)(OSC_FPGA_SIG_LEN)/((float) c_osc_fpga_smpl_freq) * (float) dec_factor;
 
@@ -1404,48 +1431,19 @@ int meas_period(rp_osc_meas_res_t *meas, int *in_signal, int wr_ptr_trig, int de
     thr2 = cen + 0.2 * (meas->max - cen);
 
     meas->period = 0;
-    *max = INT_MIN;
-    *min = INT_MAX;
-
-    for(ix = 0; ix < (OSC_FPGA_SIG_LEN); ix++) {
-        ix_corr = ix + wr_ptr_trig;
-
-        if (ix_corr >= OSC_FPGA_SIG_LEN) {
-            ix_corr %= OSC_FPGA_SIG_LEN;
-        }
 
-        int sa = rp_osc_adc_sign(in_signal[ix_corr]);
-
-        /* Another max, min calculation at lower rate to avoid evaluation errors on slower signals */
-        if (sa > *max)
-            *max = sa;
-        if (sa < *min)
-            *min = sa;
-
-        /* Lower transitions */
-        if((state == 0) && (ix_corr > 0) && (sa < thr1)) {
-            state = 1;
-        }
-
-        /* Upper transitions - count them & store edge times. */
-        if((state == 1) && (sa >= thr2) ) {
-            state = 0;
-            if (trig_cnt++ == 0) {
-                trig_t[0] = ix;
-            } else {
-                trig_t[1] = ix;
-            }
-        }
-
-        if ((trig_t[1] - trig_t[0]) > c_meas_time_thr) {
-            break;
-        }
-    }
+    /* Count the transitions & interpolate the edge times, another max, min
+     * calculation over the walked samples to avoid evaluation errors on
+     * slower signals */
+    rp_meas_clear(&raw);
+    rp_meas_crossings(&raw, in_signal, OSC_FPGA_SIG_LEN, wr_ptr_trig,
+                      thr1, thr2, c_meas_time_thr);
+    *max = raw.scan_max;
+    *min = raw.scan_min;
 
     /* Period calculation - taking into account at least meas_time_thr samples */
-    if(trig_cnt >= 2) {
-        meas->period = (trig_t[1] - trig_t[0]) /
-            ((float)c_osc_fpga_smpl_freq * (trig_cnt - 1)) * dec_factor;
+    if(raw.crossings >= 2) {
+        meas->period = raw.period / (float)c_osc_fpga_smpl_freq * dec_factor;
     }
 
     if( ((thr2 - thr1) < c_meas_freq_thr) ||
@@ -1472,6 +1470,11 @@ inline float rp_osc_meas_cnv_cnt(float data, float adc_max_v)
 /*----------------------------------------------------------------------------------*/
 int rp_osc_meas_convert(rp_osc_meas_res_t *ch_meas, float adc_max_v, int32_t cal_dc_offs)
 {
+    /* RMS of the calibrated signal, out of the mean square and the average */
+    float ms = ch_meas->rms + 2 * cal_dc_offs * ch_meas->avg +
+               (float)cal_dc_offs * cal_dc_offs;
+
+    ch_meas->rms = rp_osc_meas_cnv_cnt(sqrtf((ms > 0) ? ms : 0), adc_max_v);
     ch_meas->min = rp_osc_meas_cnv_cnt(ch_meas->min+cal_dc_offs, adc_max_v);
     ch_meas->max = rp_osc_meas_cnv_cnt(ch_meas->max+cal_dc_offs, adc_max_v);
     ch_meas->amp = rp_osc_meas_cnv_cnt(ch_meas->amp, adc_max_v);
@@ -97,7 +97,12 @@ enum {
     BIT_AC97CTRL_STAT_REG_ACCESS_FINISHED           , // 0 = AC97 Controller waiting for access to control/status register in Codec to complete.  1 = AC97 Controller is finished accessing the control/status register in Codec.
     BIT_AC97CTRL_STAT_CODEC_READY                   , // 0 = Codec is not ready to receive commands or data.                                      1 = Codec ready to run
     BIT_AC97CTRL_STAT_FIFO_PLAY_UNDERRUN            , // 0 = FIFO has not underrun                                                                1 = FIFO has underrun
-    BIT_AC97CTRL_STAT_FIFO_REC_UNDERRUN               // 0 = FIFO has not underrun                                                                1 = FIFO has underrun
+    BIT_AC97CTRL_STAT_FIFO_REC_UNDERRUN             , // 0 = FIFO has not underrun                                                                1 = FIFO has underrun
+    BIT_AC97CTRL_STAT_FIFO_PLAY_LEVEL      =       8, // [11: 8] count of stereo frames in the play   FIFO
+    BIT_AC97CTRL_STAT_FIFO_REC_LEVEL       =      12, // [15:12] count of stereo frames in the record FIFO
+    BIT_AC97CTRL_STAT_FIFO_PLAY_ODD        =      16, // 0 = next play   word is a left sample,                                                 1 = left sample latched, right sample outstanding
+    BIT_AC97CTRL_STAT_FIFO_REC_ODD         =      17, // 0 = next record word is a left sample,                                                 1 = left sample read, right sample outstanding
+    BIT_AC97CTRL_STAT_FIFO_LEVELS_VALID    =      31  // 1 = bits [17:8] are valid, a driver may burst-copy the number of words they announce
 } REG_AC97CTRL_STAT_ENUMS;
 
 enum {
@@ -548,7 +553,8 @@ else begin
       /* control */
       REG_RO_AC97CTRL_STAT: begin
          sys_ack                                  <= sys_en;
-         sys_rdata                                <= { {C_OPB_DWIDTH -   8{1'b0}}, ac97ctrl_rec_fifo_overrun, ac97ctrl_play_fifo_underrun, ac97ctrl_codec_ready, ac97ctrl_access_ready, ac97ctrl_rec_fifo_empty, ac97ctrl_rec_fifo_full, ac97ctrl_play_fifo_hf, ac97ctrl_play_fifo_full};
+         sys_rdata                                <= { 1'b1, {C_OPB_DWIDTH -  19{1'b0}}, ac97ctrl_rec_is_right, ac97ctrl_play_is_right, ac97ctrl_rec_fifo_ctr[3:0], ac97ctrl_play_fifo_ctr[3:0],
+                                                       ac97ctrl_rec_fifo_overrun, ac97ctrl_play_fifo_underrun, ac97ctrl_codec_ready, ac97ctrl_access_ready, ac97ctrl_rec_fifo_empty, ac97ctrl_rec_fifo_full, ac97ctrl_play_fifo_hf, ac97ctrl_play_fifo_full};
          end
       REG_RO_AC97CTRL_CODEC_DATA_READ: begin
          sys_ack                                  <= sys_en;
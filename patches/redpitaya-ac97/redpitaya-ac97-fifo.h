@@ -0,0 +1,194 @@
+/*
+ * FIFO access of the RedPitaya AC97 Controller Emulation of the RadioBox sub-module
+ *
+ *  Copyright (c) by 2016  Ulrich Habel <espero7757@gmx.net>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ */
+
+/* Some notes about this file:
+ *
+ * The FPGA FIFOs hold stereo frames, the bus transports one 16 bit sample per
+ * word, left sample first. Newer FPGA bitstreams report the fill level of both
+ * FIFOs in the status register and set CTRL_LEVELS_VALID. Then one status read
+ * is enough to burst-copy all the words the FIFO takes or holds. With older
+ * bitstreams the status is polled before each word as it has been done before.
+ *
+ * All register accesses go through CTRL_FIFO_RD() / CTRL_FIFO_WR(). Outside of
+ * the kernel they default to plain volatile accesses and may be defined before
+ * this file is included, e.g. to run the copy loops against an emulated
+ * register block.
+ */
+
+#ifndef __REDPITAYA_AC97_FIFO_H
+#define __REDPITAYA_AC97_FIFO_H
+
+#ifdef __KERNEL__
+#include <linux/types.h>
+#include <linux/io.h>
+
+#define CTRL_FIFO_RD(port, reg)		ioread32((port) + (reg))
+#define CTRL_FIFO_WR(port, reg, v)	iowrite32((v), (port) + (reg))
+#define CTRL_FIFO_IOMEM			__iomem
+
+#else
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint16_t u16;
+typedef uint32_t u32;
+
+#ifndef CTRL_FIFO_RD
+#define CTRL_FIFO_RD(port, reg)		(*(volatile u32 *)((char *)(port) + (reg)))
+#endif
+#ifndef CTRL_FIFO_WR
+#define CTRL_FIFO_WR(port, reg, v)	(*(volatile u32 *)((char *)(port) + (reg)) = (v))
+#endif
+#define CTRL_FIFO_IOMEM			/* nothing */
+#endif
+
+
+/* direct registers */
+#define CTRL_REG_PLAYFIFO 	    0x00
+#define CTRL_PLAYDATA(a)	    ((a) & 0xFFFF)
+
+#define CTRL_REG_RECFIFO	    0x04
+#define CTRL_RECDATA(a) 	    ((a) & 0xFFFF)
+
+#define CTRL_REG_STATUS		    0x08
+#define   CTRL_LEVELS_VALID	    (1<<31)
+#define   CTRL_RECODD		    (1<<17)
+#define   CTRL_PLAYODD		    (1<<16)
+#define   CTRL_RECLEVEL(s)	    (((s) >> 12) & 0xF)
+#define   CTRL_PLAYLEVEL(s)	    (((s) >>  8) & 0xF)
+#define   CTRL_RECOVER		    (1<<7)
+#define   CTRL_PLAYUNDER	    (1<<6)
+#define   CTRL_CODECREADY 	    (1<<5)
+#define   CTRL_RAF		    (1<<4)
+#define   CTRL_RECEMPTY		    (1<<3)
+#define   CTRL_RECFULL		    (1<<2)
+#define   CTRL_PLAYHALF		    (1<<1)
+#define   CTRL_PLAYFULL		    (1<<0)
+
+#define CTRL_REG_RESETFIFO	    0x0C
+#define   CTRL_RECRESET		    (1<<1)
+#define   CTRL_PLAYRESET	    (1<<0)
+
+#define CTRL_REG_CODEC_ADDR	    0x10
+#define   CTRL_CODEC_ADDR(a)	    (((a) & 0x7E)<<0)
+#define   CTRL_CODEC_READ 	    (1<<7)
+#define   CTRL_CODEC_WRITE	    (0<<7)
+
+#define CTRL_REG_CODEC_DATAREAD     0x14
+#define   CTRL_CODEC_DATAREAD(v)    ((v) & 0xFFFF)
+
+#define CTRL_REG_CODEC_DATAWRITE    0x18
+#define   CTRL_CODEC_DATAWRITE(v)   ((v) & 0xFFFF)
+
+#define CTRL_FIFO_SIZE		    32	/* words, each FIFO entry holds a left and a right word */
+
+
+/* words the play FIFO takes without an overflow */
+static inline int ctrl_fifo_play_room(u32 status)
+{
+	int room;
+
+	if (!(status & CTRL_LEVELS_VALID))
+		return (status & CTRL_PLAYFULL) ? 0 : 1;
+
+	/* one entry is kept free, that is what CTRL_PLAYFULL reports */
+	room = (((CTRL_FIFO_SIZE >> 1) - 1 - CTRL_PLAYLEVEL(status)) << 1) -
+	       ((status & CTRL_PLAYODD) ? 1 : 0);
+	return (room > 0) ? room : 0;
+}
+
+/* words the record FIFO holds */
+static inline int ctrl_fifo_rec_avail(u32 status)
+{
+	if (!(status & CTRL_LEVELS_VALID))
+		return (status & CTRL_RECEMPTY) ? 0 : 1;
+
+	return (CTRL_RECLEVEL(status) << 1) - ((status & CTRL_RECODD) ? 1 : 0);
+}
+
+/* copies up to words samples to the play FIFO, src == NULL fills in silence;
+ * *hw_ready tells whether the FIFO takes more words afterwards
+ */
+static inline size_t ctrl_fifo_play_copy(void CTRL_FIFO_IOMEM *port,
+					 const u16 *src, size_t words,
+					 int *hw_ready)
+{
+	size_t copied = 0;
+	size_t room, burst;
+	u32 status;
+
+	for (;;) {
+		status = CTRL_FIFO_RD(port, CTRL_REG_STATUS);
+		room = ctrl_fifo_play_room(status);
+		if (!room || (copied == words))
+			break;
+
+		burst = (room < words - copied) ? room : words - copied;
+		room -= burst;
+		for (; burst; burst--, copied++)
+			CTRL_FIFO_WR(port, CTRL_REG_PLAYFIFO,
+				     src ? CTRL_PLAYDATA(src[copied]) : 0);
+
+		/* all is copied and the level told there is space left */
+		if (room && (status & CTRL_LEVELS_VALID))
+			break;
+	}
+
+	*hw_ready = (room > 0);
+	return copied;
+}
+
+/* copies up to words samples from the record FIFO, dst == NULL drops them;
+ * *hw_ready tells whether the FIFO holds more words afterwards
+ */
+static inline size_t ctrl_fifo_rec_copy(void CTRL_FIFO_IOMEM *port,
+					u16 *dst, size_t words,
+					int *hw_ready)
+{
+	size_t copied = 0;
+	size_t avail, burst;
+	u32 status;
+
+	for (;;) {
+		status = CTRL_FIFO_RD(port, CTRL_REG_STATUS);
+		avail = ctrl_fifo_rec_avail(status);
+		if (!avail || (copied == words))
+			break;
+
+		burst = (avail < words - copied) ? avail : words - copied;
+		avail -= burst;
+		for (; burst; burst--, copied++) {
+			const u32 data = CTRL_FIFO_RD(port, CTRL_REG_RECFIFO);
+
+			if (dst)
+				dst[copied] = CTRL_RECDATA(data);
+		}
+
+		/* all is copied and the level told there are words left */
+		if (avail && (status & CTRL_LEVELS_VALID))
+			break;
+	}
+
+	*hw_ready = (avail > 0);
+	return copied;
+}
+
+#endif /* __REDPITAYA_AC97_FIFO_H */
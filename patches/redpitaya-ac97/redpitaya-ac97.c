@@ -79,6 +79,7 @@
 #include <linux/of_irq.h>
 
 #include "pcm-indirect2.h"
+#include "redpitaya-ac97-fifo.h"
 
 
 #define SND_REDPITAYA_AC97_DRIVER "redpitaya-ac97"
@@ -324,42 +325,9 @@ static void lm4550_regfile_write_values_after_init(struct snd_ac97 *ac97)
 }
 
 
-/* direct registers */
+/* direct registers, the others are found in redpitaya-ac97-fifo.h */
 #define CTRL_REG(redpitaya_ac97, x) (redpitaya_ac97->port + (CTRL_REG_##x))
 
-#define CTRL_REG_PLAYFIFO 	    0x00
-#define CTRL_PLAYDATA(a)	    ((a) & 0xFFFF)
-
-#define CTRL_REG_RECFIFO	    0x04
-#define CTRL_RECDATA(a) 	    ((a) & 0xFFFF)
-
-#define CTRL_REG_STATUS		    0x08
-#define   CTRL_RECOVER		    (1<<7)
-#define   CTRL_PLAYUNDER	    (1<<6)
-#define   CTRL_CODECREADY 	    (1<<5)
-#define   CTRL_RAF		    (1<<4)
-#define   CTRL_RECEMPTY		    (1<<3)
-#define   CTRL_RECFULL		    (1<<2)
-#define   CTRL_PLAYHALF		    (1<<1)
-#define   CTRL_PLAYFULL		    (1<<0)
-
-#define CTRL_REG_RESETFIFO	    0x0C
-#define   CTRL_RECRESET		    (1<<1)
-#define   CTRL_PLAYRESET	    (1<<0)
-
-#define CTRL_REG_CODEC_ADDR	    0x10
-#define   CTRL_CODEC_ADDR(a)	    (((a) & 0x7E)<<0)
-#define   CTRL_CODEC_READ 	    (1<<7)
-#define   CTRL_CODEC_WRITE	    (0<<7)
-
-#define CTRL_REG_CODEC_DATAREAD     0x14
-#define   CTRL_CODEC_DATAREAD(v)    ((v) & 0xFFFF)
-
-#define CTRL_REG_CODEC_DATAWRITE    0x18
-#define   CTRL_CODEC_DATAWRITE(v)   ((v) & 0xFFFF)
-
-#define CTRL_FIFO_SIZE		    32
-
 struct snd_redpitaya_ac97 {
 	/* lock for access to (controller) registers */
 	spinlock_t reg_lock;
@@ -436,21 +404,18 @@ snd_redpitaya_ac97_playback_ind2_zero(struct snd_pcm_substream *substream,
 				      struct snd_pcm_indirect2 *pcm)
 {
 	struct snd_redpitaya_ac97 *redpitaya_ac97;
-	int copied_words = 0;
-	u32 status = 0;
+	size_t copied_words;
+	int hw_ready;
 
 	redpitaya_ac97 = snd_pcm_substream_chip(substream);
 
 	spin_lock(&redpitaya_ac97->reg_lock);
-	while ((status = (ioread32(CTRL_REG(redpitaya_ac97, STATUS)) &
-				   CTRL_PLAYFULL)) != CTRL_PLAYFULL) {
-		iowrite32(0, CTRL_REG(redpitaya_ac97, PLAYFIFO));
-		copied_words++;
-	}
+	copied_words = ctrl_fifo_play_copy(redpitaya_ac97->port, NULL,
+					   CTRL_FIFO_SIZE, &hw_ready);
 	pcm->hw_ready = 0;
 	spin_unlock(&redpitaya_ac97->reg_lock);
 
-	return (size_t) (copied_words << 1);
+	return copied_words << 1;
 }
 
 static size_t
@@ -460,27 +425,22 @@ snd_redpitaya_ac97_playback_ind2_copy(struct snd_pcm_substream *substream,
 {
 	struct snd_redpitaya_ac97 *redpitaya_ac97;
 	u16 *src;
-	int copied_words = 0;
-	u32 status = 0;
+	size_t copied_words;
+	int hw_ready;
 
 	redpitaya_ac97 = snd_pcm_substream_chip(substream);
 	src = (u16 *)(substream->runtime->dma_area + pcm->sw_data);
 
-        PDEBUG(ISR_INFO, "ind2_copy(playback): copying %d bytes to the FPGA ...\n", bytes);
+        PDEBUG(ISR_INFO, "ind2_copy(playback): copying %zu bytes to the FPGA ...\n", bytes);
+	/* one status read tells how many words fit, they are written in a burst */
 	spin_lock(&redpitaya_ac97->reg_lock);
-	while (((status = (ioread32(CTRL_REG(redpitaya_ac97, STATUS)) &
-				    CTRL_PLAYFULL)) != CTRL_PLAYFULL) && (bytes > 1)) {
-		iowrite32(CTRL_PLAYDATA(src[copied_words++]), CTRL_REG(redpitaya_ac97, PLAYFIFO));
-		bytes -= 2;
-	}
-	if (status != CTRL_PLAYFULL)
-		pcm->hw_ready = 1;
-	else
-		pcm->hw_ready = 0;
+	copied_words = ctrl_fifo_play_copy(redpitaya_ac97->port, src,
+					   bytes >> 1, &hw_ready);
+	pcm->hw_ready = hw_ready;
 	spin_unlock(&redpitaya_ac97->reg_lock);
-        PDEBUG(ISR_INFO, "ind2_copy(playback): ... copied_words = %d, hw_ready = %d, done.\n", copied_words, pcm->hw_ready);
+        PDEBUG(ISR_INFO, "ind2_copy(playback): ... copied_words = %zu, hw_ready = %d, done.\n", copied_words, pcm->hw_ready);
 
-	return (size_t) (copied_words << 1);
+	return copied_words << 1;
 }
 
 static size_t
@@ -488,20 +448,18 @@ snd_redpitaya_ac97_capture_ind2_null(struct snd_pcm_substream *substream,
 				     struct snd_pcm_indirect2 *pcm)
 {
 	struct snd_redpitaya_ac97 *redpitaya_ac97;
-	int copied_words = 0;
+	size_t copied_words;
+	int hw_ready;
 
 	redpitaya_ac97 = snd_pcm_substream_chip(substream);
 
 	spin_lock(&redpitaya_ac97->reg_lock);
-	while ((ioread32(CTRL_REG(redpitaya_ac97, STATUS)) &
-			 CTRL_RECEMPTY) != CTRL_RECEMPTY) {
-		(void) ioread32(CTRL_REG(redpitaya_ac97, RECFIFO));
-		copied_words++;
-	}
+	copied_words = ctrl_fifo_rec_copy(redpitaya_ac97->port, NULL,
+					  CTRL_FIFO_SIZE, &hw_ready);
 	pcm->hw_ready = 1;
 	spin_unlock(&redpitaya_ac97->reg_lock);
 
-	return (size_t) (copied_words << 1);
+	return copied_words << 1;
 }
 
 static size_t
@@ -510,28 +468,22 @@ snd_redpitaya_ac97_capture_ind2_copy(struct snd_pcm_substream *substream,
 {
 	struct snd_redpitaya_ac97 *redpitaya_ac97;
 	u16 *dst;
-	int copied_words = 0;
-	u32 status = 0;
+	size_t copied_words;
+	int hw_ready;
 
 	redpitaya_ac97 = snd_pcm_substream_chip(substream);
 	dst = (u16 *)(substream->runtime->dma_area + pcm->sw_data);
 
-	PDEBUG(ISR_INFO, "ind2_copy(capture): copying %d bytes from the FPGA ...\n", bytes);
+	PDEBUG(ISR_INFO, "ind2_copy(capture): copying %zu bytes from the FPGA ...\n", bytes);
+	/* one status read tells how many words are waiting, they are read in a burst */
 	spin_lock(&redpitaya_ac97->reg_lock);
-	while (((status = (ioread32(CTRL_REG(redpitaya_ac97, STATUS)) &
-				    CTRL_RECEMPTY)) != CTRL_RECEMPTY) && (bytes > 1)) {
-		dst[copied_words++] = CTRL_RECDATA(ioread32(CTRL_REG(redpitaya_ac97,
-							    RECFIFO)));
-		bytes -= 2;
-	}
-	if (status != CTRL_RECEMPTY)
-		pcm->hw_ready = 1;
-	else
-		pcm->hw_ready = 0;
+	copied_words = ctrl_fifo_rec_copy(redpitaya_ac97->port, dst,
+					  bytes >> 1, &hw_ready);
+	pcm->hw_ready = hw_ready;
 	spin_unlock(&redpitaya_ac97->reg_lock);
         PDEBUG(ISR_INFO, "ind2_copy(capture): ... done. hw_ready = %d\n", pcm->hw_ready);
 
-	return (size_t) (copied_words << 1);
+	return copied_words << 1;
 }
 
 static snd_pcm_uframes_t
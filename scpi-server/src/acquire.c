@@ -18,6 +18,7 @@
 
 #include "acquire.h"
 #include "common.h"
+#include "output.h"
 
 #include "scpi/parser.h"
 #include "scpi/units.h"
@@ -78,6 +79,15 @@ const scpi_choice_def_t scpi_RpTrigStat[] = {
     SCPI_CHOICE_LIST_END
 };
 
+/* Data units are part of the client session, saved and restored per connection */
+rp_scpi_acq_unit_t RP_AcqGetScpiUnit() {
+    return unit;
+}
+
+void RP_AcqSetScpiUnit(rp_scpi_acq_unit_t value) {
+    unit = value;
+}
+
 scpi_result_t RP_AcqSetDataFormat(scpi_t *context) {
     const char * param;
     size_t param_len;
@@ -631,28 +641,31 @@ scpi_result_t RP_AcqDataPosQ(scpi_t *context) {
         return SCPI_RES_ERR;
     }
 
-    uint32_t size = end - start;
+    rp_scpi_output_t *out = RP_OutputGet(context);
+    if (out == NULL) {
+        return SCPI_RES_ERR;
+    }
+
+    uint32_t size = ADC_BUFFER_SIZE;
     if(unit == RP_SCPI_VOLTS){
-        float buffer[size];
-        result = rp_AcqGetDataPosV(channel, start, end, buffer, &size);
+        result = rp_AcqGetDataPosV(channel, start, end, out->samples.f, &size);
         
         if(result != RP_OK){
             RP_LOG(LOG_ERR, "*ACQ:SOUR#:DATA:STA:END? Failed to get data in volts: %s\n", rp_GetError(result));
             return SCPI_RES_ERR;
         }
         
-        SCPI_ResultBufferFloat(context, buffer, size);
+        RP_OutputResultBufferFloat(context, out->samples.f, size);
 
     }else{
-        int16_t buffer[size];
-        result = rp_AcqGetDataPosRaw(channel, start, end, buffer, &size);
+        result = rp_AcqGetDataPosRaw(channel, start, end, out->samples.i16, &size);
         
         if(result != RP_OK){
             RP_LOG(LOG_ERR, "*ACQ:SOUR#:DATA:STA:END? Failed to get raw data: %s\n", rp_GetError(result));
             return SCPI_RES_ERR;
         }
 
-        SCPI_ResultBufferInt16(context, buffer, size);
+        RP_OutputResultBufferInt16(context, out->samples.i16, size);
     }
 
     RP_LOG(LOG_INFO, "*ACQ:SOUR#:DATA:STA:END? Successfully returned data to client.\n");
@@ -682,29 +695,30 @@ scpi_result_t RP_AcqDataQ(scpi_t *context) {
         return SCPI_RES_ERR;
     }
 
-    uint32_t size_buff;
-    rp_AcqGetBufSize(&size_buff);
+    rp_scpi_output_t *out = RP_OutputGet(context);
+    if (out == NULL) {
+        return SCPI_RES_ERR;
+    }
+
     if(unit == RP_SCPI_VOLTS){
-        float buffer[size_buff - start];
-        result = rp_AcqGetDataV(channel, start, &size, buffer);
+        result = rp_AcqGetDataV(channel, start, &size, out->samples.f);
         if(result != RP_OK){
             RP_LOG(LOG_ERR, "*ACQ:SOUR<n>:DATA:STA:N? Failed to get "
             "data in volts: %s\n", rp_GetError(result));
             return SCPI_RES_ERR;
         }
 
-        SCPI_ResultBufferFloat(context, buffer, size);
+        RP_OutputResultBufferFloat(context, out->samples.f, size);
 
     }else{
-        int16_t buffer[size_buff - start];
-        result = rp_AcqGetDataRaw(channel, start, &size, buffer);
+        result = rp_AcqGetDataRaw(channel, start, &size, out->samples.i16);
 
         if(result != RP_OK){
             RP_LOG(LOG_ERR, "*ACQ:SOUR<n>:DATA:STA:N? Failed to get raw data: %s\n", rp_GetError(result));
             return SCPI_RES_ERR;
         }
 
-        SCPI_ResultBufferInt16(context, buffer, size);
+        RP_OutputResultBufferInt16(context, out->samples.i16, size);
     }
 
     RP_LOG(LOG_INFO, "*ACQ:SOUR<n>:DATA:STA:N? Successfully returned data.\n");
@@ -722,27 +736,30 @@ scpi_result_t RP_AcqDataOldestAllQ(scpi_t *context) {
         return SCPI_RES_ERR;
     }
     
+    rp_scpi_output_t *out = RP_OutputGet(context);
+    if (out == NULL) {
+        return SCPI_RES_ERR;
+    }
+
     rp_AcqGetBufSize(&size);
     if(unit == RP_SCPI_VOLTS){
-        float buffer[size];
-        result = rp_AcqGetOldestDataV(channel, &size, buffer);
+        result = rp_AcqGetOldestDataV(channel, &size, out->samples.f);
 
         if(result != RP_OK){
             RP_LOG(LOG_ERR, "*ACQ:SOUR#:DATA? Failed to get data in volt: %s\n", rp_GetError(result));
             return SCPI_RES_ERR;
         }
 
-        SCPI_ResultBufferFloat(context, buffer, size);
+        RP_OutputResultBufferFloat(context, out->samples.f, size);
 
     }else{
-        int16_t buffer[size];
-        result = rp_AcqGetOldestDataRaw(channel, &size, buffer);
+        result = rp_AcqGetOldestDataRaw(channel, &size, out->samples.i16);
         if(result != RP_OK){
             RP_LOG(LOG_ERR, "*ACQ:SOUR#:DATA? Failed to get raw data: %s\n", rp_GetError(result));
             return SCPI_RES_ERR;
         }
 
-        SCPI_ResultBufferInt16(context, buffer, size);
+        RP_OutputResultBufferInt16(context, out->samples.i16, size);
     }
 
     RP_LOG(LOG_INFO, "*ACQ:SOUR#:DATA? Successfully returned data.\n");
@@ -765,9 +782,13 @@ scpi_result_t RP_AcqOldestDataQ(scpi_t *context) {
         return SCPI_RES_ERR;
     }
 
+    rp_scpi_output_t *out = RP_OutputGet(context);
+    if (out == NULL) {
+        return SCPI_RES_ERR;
+    }
+
     if(unit == RP_SCPI_VOLTS){
-        float buffer[size];
-        result = rp_AcqGetOldestDataV(channel, &size, buffer);
+        result = rp_AcqGetOldestDataV(channel, &size, out->samples.f);
 
         if(result != RP_OK){
             RP_LOG(LOG_ERR, "*ACQ:SOUR#:DATA:OLD:N? Failed to get data in "
@@ -776,17 +797,16 @@ scpi_result_t RP_AcqOldestDataQ(scpi_t *context) {
             return SCPI_RES_ERR;
         }
 
-        SCPI_ResultBufferFloat(context, buffer, size);
+        RP_OutputResultBufferFloat(context, out->samples.f, size);
 
     }else{
-        int16_t buffer[size];
-        result = rp_AcqGetOldestDataRaw(channel, &size, buffer);
+        result = rp_AcqGetOldestDataRaw(channel, &size, out->samples.i16);
         if(result != RP_OK){
             RP_LOG(LOG_ERR, "*ACQ:SOUR#:DATA:OLD:N? Failed to get raw data: %s\n", rp_GetError(result));
             return SCPI_RES_ERR;
         }
 
-        SCPI_ResultBufferInt16(context, buffer, size);
+        RP_OutputResultBufferInt16(context, out->samples.i16, size);
     }
 
     RP_LOG(LOG_INFO, "*ACQ:SOUR#:DATA:OLD:N? Successfully returned data to client.");
@@ -809,9 +829,13 @@ scpi_result_t RP_AcqLatestDataQ(scpi_t *context) {
         return SCPI_RES_ERR;
     }
 
+    rp_scpi_output_t *out = RP_OutputGet(context);
+    if (out == NULL) {
+        return SCPI_RES_ERR;
+    }
+
     if(unit == RP_SCPI_VOLTS){
-        float buffer[size];
-        result = rp_AcqGetLatestDataV(channel, &size, buffer);
+        result = rp_AcqGetLatestDataV(channel, &size, out->samples.f);
 
         if(result != RP_OK){
             RP_LOG(LOG_INFO, "*ACQ:SOUR<n>:DATA:LAT:N? Failed to "
@@ -819,17 +843,17 @@ scpi_result_t RP_AcqLatestDataQ(scpi_t *context) {
             return SCPI_RES_ERR;
         }
 
-        SCPI_ResultBufferFloat(context, buffer, size);
+        RP_OutputResultBufferFloat(context, out->samples.f, size);
     }else{
-        int16_t buffer[size];
-        result = rp_AcqGetLatestDataRaw(channel, &size, buffer);
+        result = rp_AcqGetLatestDataRaw(channel, &size, out->samples.i16);
 
         if(result != RP_OK){
             RP_LOG(LOG_ERR, "*ACQ:SOUR<n>:DATA:LAT:N? Failed to "
                 "get raw data: %s\n", rp_GetError(result));
+            return SCPI_RES_ERR;
         }
 
-        SCPI_ResultBufferInt16(context, buffer, size);
+        RP_OutputResultBufferInt16(context, out->samples.i16, size);
     }
 
     RP_LOG(LOG_INFO, "*ACQ:SOUR<n>:DATA:LAT:N? Successfully returned data to client.\n");
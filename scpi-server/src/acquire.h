@@ -25,6 +25,8 @@ typedef enum {
 } rp_scpi_acq_unit_t;
 
 int RP_AcqSetDefaultValues();
+rp_scpi_acq_unit_t RP_AcqGetScpiUnit();
+void RP_AcqSetScpiUnit(rp_scpi_acq_unit_t value);
 scpi_result_t RP_AcqSetDataFormat(scpi_t *context);
 scpi_result_t RP_AcqStart(scpi_t * context);
 scpi_result_t RP_AcqStop(scpi_t *context);
@@ -16,6 +16,7 @@
 #define COMMON_H_
 
 #include <syslog.h>
+#include <pthread.h>
 
 #include "scpi/parser.h"
 #include "redpitaya/rp.h"
@@ -35,6 +36,9 @@ syslog(__VA_ARGS__);
 #define RP_LOG(...)
 #endif
 
+/* Serializes SCPI command execution, see scpi-server.c */
+extern pthread_mutex_t rp_scpi_lock;
+
 int RP_ParseChArgv(scpi_t *context, rp_channel_t *channel);
 
 #endif /* COMMON_H_ */
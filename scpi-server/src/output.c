@@ -0,0 +1,246 @@
+/**
+ * $Id: $
+ *
+ * @brief Red Pitaya Scpi server per-connection response buffer implementation
+ *
+ * Bulk sample queries are encoded straight into the response buffer, either
+ * as ASCII list "{v1,v2,...}" or, with binary_output enabled, as IEEE-488.2
+ * definite length block "#<n><len><data>" with big endian samples.
+ *
+ * @Author Red Pitaya
+ *
+ * (c) Red Pitaya  http://www.redpitaya.com
+ *
+ * This part of code is written in C programming language.
+ * Please visit http://en.wikipedia.org/wiki/C_(programming_language)
+ * for more details on the language used herein.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#include "output.h"
+#include "common.h"
+
+#include "scpi/parser.h"
+
+/* Worst case ASCII length of one "%g" float plus separator */
+#define OUTPUT_ASCII_FLOAT_LEN  16
+/* Worst case ASCII length of one int16 plus separator */
+#define OUTPUT_ASCII_INT16_LEN  7
+
+/* Response delimiter, as written by the parser after each query */
+#ifndef SCPI_LINE_ENDING
+#define SCPI_LINE_ENDING        "\r\n"
+#endif
+
+int RP_OutputInit(rp_scpi_output_t *out, int fd)
+{
+    out->fd = fd;
+    out->head = 0;
+    out->len = 0;
+    out->open = 0;
+    out->size = OUTPUT_INIT_SIZE;
+    out->data = malloc(out->size);
+    return out->data ? RP_OK : RP_EOOR;
+}
+
+void RP_OutputRelease(rp_scpi_output_t *out)
+{
+    free(out->data);
+    out->data = NULL;
+    out->head = out->len = out->size = 0;
+}
+
+rp_scpi_output_t *RP_OutputGet(scpi_t *context)
+{
+    return (rp_scpi_output_t *)context->user_context;
+}
+
+/**
+ * Returns a pointer where len more bytes can be written. Data becomes part of
+ * the response only after out->len is advanced by the caller.
+ */
+char *RP_OutputReserve(rp_scpi_output_t *out, size_t len)
+{
+    if (out->len + len > out->size) {
+        size_t size = out->size ? out->size : OUTPUT_INIT_SIZE;
+        while (out->len + len > size) {
+            size *= 2;
+        }
+        char *data = realloc(out->data, size);
+        if (data == NULL) {
+            return NULL;
+        }
+        out->data = data;
+        out->size = size;
+    }
+    return out->data + out->len;
+}
+
+size_t RP_OutputAppend(rp_scpi_output_t *out, const char *data, size_t len)
+{
+    char *p = RP_OutputReserve(out, len);
+    if (p == NULL) {
+        return 0;
+    }
+    memcpy(p, data, len);
+    out->len += len;
+    if (len > 0) {
+        out->open = (data[len - 1] != '\n');
+    }
+    return len;
+}
+
+/**
+ * Sends the collected response with a single send() and empties the buffer.
+ * On a non-blocking socket whatever the kernel does not take stays queued
+ * and 1 is returned; call again once the socket is writable.
+ * @return 0 when everything was sent, 1 when data is still pending, -1 on error.
+ */
+int RP_OutputFlush(rp_scpi_output_t *out)
+{
+    while (out->head < out->len) {
+        ssize_t n = send(out->fd, out->data + out->head, out->len - out->head, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return 1;
+            }
+            syslog(LOG_ERR,
+                "Failed to write into the socket. Should send %zu bytes. Could send only %zu bytes",
+                out->len, out->head);
+            out->head = out->len = 0;
+            out->open = 0;
+            return -1;
+        }
+        out->head += n;
+    }
+    out->head = out->len = 0;
+    return 0;
+}
+
+int RP_OutputPending(rp_scpi_output_t *out)
+{
+    return out->head < out->len;
+}
+
+/**
+ * Ends the response of the command just executed with the line ending, unless
+ * the parser already wrote it. Responses encoded by RP_OutputResultBuffer*()
+ * bypass the parser's write path, so clients reading up to "\n" would wait
+ * forever for them otherwise.
+ */
+void RP_OutputTerminate(rp_scpi_output_t *out)
+{
+    if (out->open) {
+        RP_OutputAppend(out, SCPI_LINE_ENDING, strlen(SCPI_LINE_ENDING));
+        out->open = 0;
+    }
+}
+
+/* Writes the "#<n><len>" block header, returns pointer to the payload */
+static char *reserveBlock(rp_scpi_output_t *out, size_t payload)
+{
+    char header[16];
+    int digits = snprintf(header + 2, sizeof(header) - 2, "%zu", payload);
+    header[0] = '#';
+    header[1] = '0' + digits;
+
+    char *p = RP_OutputReserve(out, digits + 2 + payload);
+    if (p == NULL) {
+        return NULL;
+    }
+    memcpy(p, header, digits + 2);
+    return p + digits + 2;
+}
+
+size_t RP_OutputResultBufferFloat(scpi_t *context, const float *data, uint32_t size)
+{
+    rp_scpi_output_t *out = RP_OutputGet(context);
+    size_t start;
+    uint32_t i;
+
+    if (out == NULL) {
+        return 0;
+    }
+    start = out->len;
+
+    if (context->binary_output) {
+        char *p = reserveBlock(out, (size_t)size * sizeof(float));
+        if (p == NULL) {
+            return 0;
+        }
+        for (i = 0; i < size; ++i) {
+            uint32_t w;
+            memcpy(&w, &data[i], sizeof(w));
+            w = htonl(w);
+            memcpy(p, &w, sizeof(w));
+            p += sizeof(w);
+        }
+        out->len = p - out->data;
+    }
+    else {
+        char *p = RP_OutputReserve(out, (size_t)size * OUTPUT_ASCII_FLOAT_LEN + 2);
+        if (p == NULL) {
+            return 0;
+        }
+        *p++ = '{';
+        for (i = 0; i < size; ++i) {
+            p += sprintf(p, i ? ",%g" : "%g", data[i]);
+        }
+        *p++ = '}';
+        out->len = p - out->data;
+    }
+
+    out->open = 1;
+    context->output_count++;
+    return out->len - start;
+}
+
+size_t RP_OutputResultBufferInt16(scpi_t *context, const int16_t *data, uint32_t size)
+{
+    rp_scpi_output_t *out = RP_OutputGet(context);
+    size_t start;
+    uint32_t i;
+
+    if (out == NULL) {
+        return 0;
+    }
+    start = out->len;
+
+    if (context->binary_output) {
+        char *p = reserveBlock(out, (size_t)size * sizeof(int16_t));
+        if (p == NULL) {
+            return 0;
+        }
+        for (i = 0; i < size; ++i) {
+            uint16_t w = htons((uint16_t)data[i]);
+            memcpy(p, &w, sizeof(w));
+            p += sizeof(w);
+        }
+        out->len = p - out->data;
+    }
+    else {
+        char *p = RP_OutputReserve(out, (size_t)size * OUTPUT_ASCII_INT16_LEN + 2);
+        if (p == NULL) {
+            return 0;
+        }
+        *p++ = '{';
+        for (i = 0; i < size; ++i) {
+            p += sprintf(p, i ? ",%d" : "%d", data[i]);
+        }
+        *p++ = '}';
+        out->len = p - out->data;
+    }
+
+    out->open = 1;
+    context->output_count++;
+    return out->len - start;
+}
@@ -0,0 +1,60 @@
+/**
+ * $Id: $
+ *
+ * @brief Red Pitaya Scpi server per-connection response buffer interface
+ *
+ * @Author Red Pitaya
+ *
+ * (c) Red Pitaya  http://www.redpitaya.com
+ *
+ * This part of code is written in C programming language.
+ * Please visit http://en.wikipedia.org/wiki/C_(programming_language)
+ * for more details on the language used herein.
+ */
+
+#ifndef OUTPUT_H_
+#define OUTPUT_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "scpi/types.h"
+#include "redpitaya/rp.h"
+
+/* Initial response buffer size, large enough for a 16k sample ASCII capture */
+#define OUTPUT_INIT_SIZE    (256 * 1024)
+
+/**
+ * Response buffer of one client connection. Everything the parser or the
+ * command callbacks write is collected here and sent with a single send()
+ * per query. The buffer only grows, so in steady state no allocation happens.
+ */
+typedef struct rp_scpi_output_s {
+    int     fd;
+    char   *data;
+    size_t  head;       // first byte not yet sent (non-blocking sockets)
+    size_t  len;
+    size_t  size;
+    int     open;       // response written without its line ending yet
+
+    /* Scratch sample buffer, filled by rp_AcqGetData* before encoding */
+    union {
+        float   f[ADC_BUFFER_SIZE];
+        int16_t i16[ADC_BUFFER_SIZE];
+    } samples;
+} rp_scpi_output_t;
+
+int RP_OutputInit(rp_scpi_output_t *out, int fd);
+void RP_OutputRelease(rp_scpi_output_t *out);
+rp_scpi_output_t *RP_OutputGet(scpi_t *context);
+
+char *RP_OutputReserve(rp_scpi_output_t *out, size_t len);
+size_t RP_OutputAppend(rp_scpi_output_t *out, const char *data, size_t len);
+int RP_OutputFlush(rp_scpi_output_t *out);
+int RP_OutputPending(rp_scpi_output_t *out);
+void RP_OutputTerminate(rp_scpi_output_t *out);
+
+size_t RP_OutputResultBufferFloat(scpi_t *context, const float *data, uint32_t size);
+size_t RP_OutputResultBufferInt16(scpi_t *context, const int16_t *data, uint32_t size);
+
+#endif /* OUTPUT_H_ */
@@ -23,6 +23,8 @@
 #include "apin.h"
 #include "acquire.h"
 #include "generate.h"
+#include "output.h"
+#include "stream.h"
 #include "scpi/error.h"
 #include "scpi/ieee488.h"
 #include "scpi/minimal.h"
@@ -36,28 +38,20 @@ bool RST_executed = FALSE;
  */
 size_t SCPI_Write(scpi_t * context, const char * data, size_t len) {
 
-    size_t total = 0;
-
-    if (context->user_context != NULL) {
-        int fd = *(int *)(context->user_context);
-        while (len > 0) {
-            size_t written =  write(fd, data, len);
-            if (written < 0) {
-                syslog(LOG_ERR,
-                    "Failed to write into the socket. Should send %zu bytes. Could send only %zu bytes",
-                    len, written);
-                return total;
-            }
-            len -= written;
-            data += written;
-            total += written;
-        }
+    rp_scpi_output_t *out = RP_OutputGet(context);
+    if (out == NULL) {
+        return 0;
     }
-    return total;
+    /* Collected into the connection response buffer, sent by SCPI_Flush */
+    return RP_OutputAppend(out, data, len);
 }
 
 scpi_result_t SCPI_Flush(scpi_t * context) {
-    return SCPI_RES_OK;
+    rp_scpi_output_t *out = RP_OutputGet(context);
+    if (out == NULL) {
+        return SCPI_RES_OK;
+    }
+    return RP_OutputFlush(out) < 0 ? SCPI_RES_ERR : SCPI_RES_OK;
 }
 
 int SCPI_Error(scpi_t * context, int_fast16_t err) {
@@ -188,6 +182,13 @@ static const scpi_command_t scpi_commands[] = {
     {.pattern = "ACQ:SOUR#:DATA?", .callback            = RP_AcqDataOldestAllQ,},
     {.pattern = "ACQ:SOUR#:DATA:LAT:N?", .callback      = RP_AcqLatestDataQ,},
     {.pattern = "ACQ:BUF:SIZE?", .callback              = RP_AcqBufferSizeQ,},
+    {.pattern = "ACQ:STR:PROT", .callback               = RP_AcqStreamProtocol,},
+    {.pattern = "ACQ:STR:PROT?", .callback              = RP_AcqStreamProtocolQ,},
+    {.pattern = "ACQ:STR:PORT", .callback               = RP_AcqStreamPort,},
+    {.pattern = "ACQ:STR:PORT?", .callback              = RP_AcqStreamPortQ,},
+    {.pattern = "ACQ:STR:START", .callback              = RP_AcqStreamStart,},
+    {.pattern = "ACQ:STR:STOP", .callback               = RP_AcqStreamStop,},
+    {.pattern = "ACQ:STR:STAT?", .callback              = RP_AcqStreamStatusQ,},
 
     /* Generate */
     {.pattern = "GEN:RST", .callback                    = RP_GenReset,},
@@ -18,15 +18,21 @@
 #include <string.h>
 
 #include <netinet/in.h>
-#include <sys/prctl.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
 #include <errno.h>
+#include <pthread.h>
 #include <arpa/inet.h>
 #include <signal.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <syslog.h>
 
 #include "scpi-commands.h"
 #include "common.h"
+#include "output.h"
+#include "acquire.h"
+#include "stream.h"
 
 #include "scpi/parser.h"
 #include "redpitaya/rp.h"
@@ -37,19 +43,44 @@
 #define LISTEN_BACKLOG 50
 #define LISTEN_PORT 5000
 #define MAX_BUFF_SIZE 1024
+#define MAX_EVENTS 16
 
 static bool app_exit = false;
 static char delimiter[] = "\r\n";
 
+/**
+ * Serializes command execution - and with it every access to the acquisition
+ * and generator registers - between clients and any background thread of
+ * the server. Held while one client command is dispatched.
+ */
+pthread_mutex_t rp_scpi_lock = PTHREAD_MUTEX_INITIALIZER;
 
-static void handleCloseChildEvents()
-{
-    struct sigaction sigchld_action = {
-            .sa_handler = SIG_DFL,
-            .sa_flags = SA_NOCLDWAIT
-    };
-    sigaction(SIGCHLD, &sigchld_action, NULL);
-}
+/**
+ * Client connection state. The SCPI parser context is shared, so per-client
+ * session settings are swapped in and out around every command: the response
+ * buffer, the status registers (*ESE, *SRE, *STB?, ...), the data format and
+ * the data units. The rest of the context is safe to share:
+ *  - input buffer, parameter list, output/input counts and cmd_error only live
+ *    for one command, as complete commands are handed to the parser;
+ *  - the error queue is a single static queue inside libscpi, SYST:ERR? reports
+ *    the errors of all clients, as it did with fork-per-client neither;
+ *  - all other settings configure the one instrument the clients share.
+ */
+typedef struct connection_s {
+    int                 fd;
+    struct in_addr      addr;
+
+    char               *message_buff;   // received, not yet parsed input
+    size_t              message_len;
+    size_t              msg_end;
+    bool                closing;        // client sent FIN, serve the rest and close
+
+    rp_scpi_output_t    out;
+
+    bool                binary_output;
+    rp_scpi_acq_unit_t  unit;
+    scpi_reg_val_t      registers[SCPI_REG_COUNT];
+} connection_t;
 
 
 static void termSignalHandler(int signum)
@@ -113,87 +144,237 @@ void LogMessage(char *m, size_t len) {
     RP_LOG(LOG_INFO, "Processing command: %s\n", buff);
 }
 
+static int setNonBlocking(int fd)
+{
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags == -1) {
+        return -1;
+    }
+    return fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+static connection_t *openConnection(int fd, struct in_addr addr)
+{
+    connection_t *conn = calloc(1, sizeof(connection_t));
+    if (conn == NULL) {
+        return NULL;
+    }
+
+    conn->fd = fd;
+    conn->addr = addr;
+    conn->message_len = MAX_BUFF_SIZE;
+    conn->message_buff = malloc(conn->message_len);
+    conn->binary_output = false;
+    conn->unit = RP_SCPI_VOLTS;
+
+    if (conn->message_buff == NULL || RP_OutputInit(&conn->out, fd) != RP_OK) {
+        free(conn->message_buff);
+        free(conn);
+        return NULL;
+    }
+    return conn;
+}
+
+static void closeConnection(int epfd, connection_t *conn)
+{
+    RP_LOG(LOG_INFO, "Closing connection with client ip %s.", inet_ntoa(conn->addr));
+
+    epoll_ctl(epfd, EPOLL_CTL_DEL, conn->fd, NULL);
+    close(conn->fd);
+    RP_OutputRelease(&conn->out);
+    free(conn->message_buff);
+    free(conn);
+}
+
 /**
- * This is main method of every child process. Here communication with client is handled.
- * @param connfd The communication port
- * @return
+ * Executes one command in the session of the client. The last input of a
+ * closing connection may lack the delimiter, it is parsed as it is.
  */
-static int handleConnection(int connfd) {
-    int read_size;
-
-    size_t message_len = MAX_BUFF_SIZE;
-    char *message_buff = malloc(message_len);
-    char buffer[MAX_BUFF_SIZE];
-    size_t msg_end = 0;
+static void executeCommand(connection_t *conn, char *m, size_t len, bool last)
+{
+    // Log out message
+    LogMessage(m, len);
+
+    pthread_mutex_lock(&rp_scpi_lock);
+
+    // Swap in the client session
+    scpi_reg_val_t *registers = scpi_context.registers;
+    scpi_context.user_context = &conn->out;
+    scpi_context.registers = conn->registers;
+    scpi_context.binary_output = conn->binary_output;
+    RP_AcqSetScpiUnit(conn->unit);
+
+    // A stream that failed meanwhile shows up in SYST:ERR?
+    RP_StreamReportError(&scpi_context);
+
+    //Parse the message and return response
+    if (last) {
+        SCPI_Parse(&scpi_context, m, len);
+    } else {
+        SCPI_Input(&scpi_context, m, len);
+    }
 
-    installTermSignalHandler();
+    RP_OutputTerminate(&conn->out);
 
-    prctl( 1, SIGTERM );
+    conn->binary_output = scpi_context.binary_output;
+    conn->unit = RP_AcqGetScpiUnit();
+    scpi_context.registers = registers;
+    scpi_context.user_context = NULL;
 
-    RP_LOG(LOG_INFO, "Waiting for first client request.");
+    pthread_mutex_unlock(&rp_scpi_lock);
 
-    //Receive a message from client
-    while( (read_size = recv(connfd , buffer , MAX_BUFF_SIZE , 0)) > 0 )
-    {
-        if (app_exit) {
-            break;
-        }
+    // Join the threads of a stream the command stopped
+    RP_StreamReap();
 
-        // First make sure that message buffer is large enough
-        while (msg_end + read_size >= message_len) {
-            message_len *= 2;
-            message_buff = realloc(message_buff, message_len);
-        }
+    RP_OutputFlush(&conn->out);
+}
 
-        // Copy read buffer into message buffer
-        memcpy(message_buff + msg_end, buffer, read_size);
-        msg_end += read_size;
+/**
+ * Parses and executes every complete command received so far. Stops early
+ * while the previous response is still queued, so a slow reader can not make
+ * the server buffer unbounded responses.
+ */
+static void processCommands(connection_t *conn)
+{
+    char *m = conn->message_buff;
+    size_t pos = -1;
 
-        // Now try to parse each command out
-        char *m = message_buff;
-        size_t pos = -1;
-        while ((pos = getNextCommand(m, msg_end)) != -1) {
+    while (!RP_OutputPending(&conn->out) && (pos = getNextCommand(m, conn->msg_end)) != -1) {
 
-            // Log out message
-            LogMessage(m, pos);
+        executeCommand(conn, m, pos, false);
 
-            //Parse the message and return response
-            SCPI_Input(&scpi_context, m, pos);
-            m += pos;
-            msg_end -= pos;
-        }
+        m += pos;
+        conn->msg_end -= pos;
+    }
 
-        // Move the rest of the message to the beginning of the buffer
-        if (message_buff != m && msg_end > 0) {
-            memmove(message_buff, m, msg_end);
-        }
+    // The client will not complete a trailing command any more
+    if (conn->closing && !RP_OutputPending(&conn->out) && conn->msg_end > 0) {
+        executeCommand(conn, m, conn->msg_end, true);
+        conn->msg_end = 0;
+    }
 
-        RP_LOG(LOG_INFO, "Waiting for next client request.\n");
+    // Move the rest of the message to the beginning of the buffer
+    if (conn->message_buff != m && conn->msg_end > 0) {
+        memmove(conn->message_buff, m, conn->msg_end);
     }
+}
+
+/**
+ * Reads everything available on the client socket. When the client has shut
+ * down its side, conn->closing is set; commands received up to then are still
+ * executed and answered.
+ * @return 0 unless the connection failed, otherwise -1.
+ */
+static int readConnection(connection_t *conn)
+{
+    char buffer[MAX_BUFF_SIZE];
+    ssize_t read_size;
 
-    free(message_buff);
+    while ((read_size = recv(conn->fd, buffer, MAX_BUFF_SIZE, 0)) > 0) {
 
-    RP_LOG(LOG_INFO, "Closing client connection...");
+        // First make sure that message buffer is large enough
+        while (conn->msg_end + read_size >= conn->message_len) {
+            char *buff = realloc(conn->message_buff, conn->message_len * 2);
+            if (buff == NULL) {
+                RP_LOG(LOG_ERR, "Failed to grow message buffer");
+                return -1;
+            }
+            conn->message_buff = buff;
+            conn->message_len *= 2;
+        }
 
-    if(read_size == 0)
-    {
+        // Copy read buffer into message buffer
+        memcpy(conn->message_buff + conn->msg_end, buffer, read_size);
+        conn->msg_end += read_size;
+    }
+
+    if (read_size == 0) {
         RP_LOG(LOG_INFO, "Client is disconnected");
+        conn->closing = true;
         return 0;
     }
-    else if(read_size == -1)
-    {
+    if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
         RP_LOG(LOG_ERR, "Receive message failed (%s)", strerror(errno));
-        perror("Receive message failed");
-        return 1;
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Handles one readiness event of a client connection.
+ * @return 0 while the connection stays open, otherwise -1.
+ */
+static int handleConnection(int epfd, connection_t *conn, uint32_t events)
+{
+    if (events & EPOLLERR) {
+        return -1;
+    }
+
+    if ((events & EPOLLOUT) && RP_OutputFlush(&conn->out) < 0) {
+        return -1;
+    }
+
+    if ((events & (EPOLLIN | EPOLLHUP)) && !conn->closing && readConnection(conn) < 0) {
+        return -1;
+    }
+
+    processCommands(conn);
+
+    // Everything the client sent before closing is answered
+    if (conn->closing && !RP_OutputPending(&conn->out)) {
+        return -1;
     }
+
+    // Wait for the socket to drain before reading further requests
+    struct epoll_event ev = {
+        .events = RP_OutputPending(&conn->out) ? EPOLLOUT : EPOLLIN,
+        .data.ptr = conn
+    };
+    epoll_ctl(epfd, EPOLL_CTL_MOD, conn->fd, &ev);
+
     return 0;
 }
 
+static void acceptConnections(int epfd, int listenfd)
+{
+    while (1) {
+        struct sockaddr_in cliaddr;
+        socklen_t clilen = sizeof(cliaddr);
+
+        int connfd = accept(listenfd, (struct sockaddr *)&cliaddr, &clilen);
+        if (connfd == -1) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                RP_LOG(LOG_ERR, "Failed to accept connection (%s)", strerror(errno));
+            }
+            return;
+        }
+
+        connection_t *conn = NULL;
+        if (setNonBlocking(connfd) == -1 || (conn = openConnection(connfd, cliaddr.sin_addr)) == NULL) {
+            RP_LOG(LOG_ERR, "Failed to set up connection (%s)", strerror(errno));
+            close(connfd);
+            continue;
+        }
+
+        struct epoll_event ev = { .events = EPOLLIN, .data.ptr = conn };
+        if (epoll_ctl(epfd, EPOLL_CTL_ADD, connfd, &ev) == -1) {
+            RP_LOG(LOG_ERR, "Failed to watch connection (%s)", strerror(errno));
+            close(connfd);
+            RP_OutputRelease(&conn->out);
+            free(conn->message_buff);
+            free(conn);
+            continue;
+        }
+
+        RP_LOG(LOG_INFO, "Connection with client ip %s established.", inet_ntoa(cliaddr.sin_addr));
+    }
+}
+
 
 /**
  * Main daemon entrance point. Opens a socket and listens for any incoming connection.
- * When client connects, if forks the conversation into a new socket and the daemon (parent process)
- * waits for another connection. It can handle multiple connections simultaneously.
+ * All clients are served from this single process: sockets are non-blocking and
+ * multiplexed with epoll, every connection has its own input and response buffer.
  * @param argc  not used
  * @param argv  not used
  * @return
@@ -209,12 +390,9 @@ int main(int argc, char *argv[])
 
     installTermSignalHandler();
 
-    int listenfd = 0, connfd = 0;
+    int listenfd = 0, epfd = 0;
     struct sockaddr_in serv_addr;
 
-    // Handle close child events
-    handleCloseChildEvents();
-
 
     int result = rp_Init();
     if (result != RP_OK) {
@@ -228,7 +406,7 @@ int main(int argc, char *argv[])
         return (EXIT_FAILURE);
     }
 
-    // user_context will be pointer to socket
+    // user_context will be pointer to the response buffer of the served connection
     scpi_context.user_context = NULL;
     scpi_context.binary_output = false;
     SCPI_Init(&scpi_context);
@@ -255,63 +433,59 @@ int main(int argc, char *argv[])
         return (EXIT_FAILURE);
     }
 
-    if (listen(listenfd, LISTEN_BACKLOG) == -1)
+    if (listen(listenfd, LISTEN_BACKLOG) == -1 || setNonBlocking(listenfd) == -1)
     {
         RP_LOG(LOG_ERR, "Failed to listen on the socket (%s)", strerror(errno));
         perror("Failed to listen on the socket");
         return (EXIT_FAILURE);
     }
 
-    RP_LOG(LOG_INFO, "Server is listening on port %d\n", LISTEN_PORT);
-
-    // Socket is opened and listening on port. Now we can accept connections
-    while(1)
+    epfd = epoll_create1(0);
+    struct epoll_event listen_ev = { .events = EPOLLIN, .data.ptr = NULL };
+    if (epfd == -1 || epoll_ctl(epfd, EPOLL_CTL_ADD, listenfd, &listen_ev) == -1)
     {
-        struct sockaddr_in cliaddr;
-        socklen_t clilen;
-        clilen = sizeof(cliaddr);
+        RP_LOG(LOG_ERR, "Failed to set up epoll (%s)", strerror(errno));
+        perror("Failed to set up epoll");
+        return (EXIT_FAILURE);
+    }
 
-        connfd = accept(listenfd, (struct sockaddr *)&cliaddr, &clilen);
+    RP_LOG(LOG_INFO, "Server is listening on port %d\n", LISTEN_PORT);
 
-        if (app_exit == true) {
-            break;
-        }
+    // Socket is opened and listening on port. Now we can serve connections
+    while (!app_exit)
+    {
+        struct epoll_event events[MAX_EVENTS];
 
-        if (connfd == -1) {
-            RP_LOG(LOG_ERR, "Failed to accept connection (%s)", strerror(errno));
-            perror("Failed to accept connection\n");
+        int n = epoll_wait(epfd, events, MAX_EVENTS, -1);
+        if (n == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            RP_LOG(LOG_ERR, "Failed to wait for events (%s)", strerror(errno));
+            perror("Failed to wait for events\n");
             return (EXIT_FAILURE);
         }
 
-        // Fork a child process, which will talk to the client
-        if (!fork()) {
-
-            RP_LOG(LOG_INFO, "Connection with client ip %s established.", inet_ntoa(cliaddr.sin_addr));
-
-            // this is the child process
-            close(listenfd); // child doesn't need the listener
-
-            scpi_context.user_context = &connfd;
+        for (int i = 0; i < n; i++) {
+            connection_t *conn = events[i].data.ptr;
 
-            result = handleConnection(connfd);
-
-            close(connfd);
-
-            RP_LOG(LOG_INFO, "Closing connection with client ip %s.", inet_ntoa(cliaddr.sin_addr));
-
-            if (result == 0) {
-                return(EXIT_SUCCESS);
+            if (conn == NULL) {
+                acceptConnections(epfd, listenfd);
             }
-            else {
-                return(EXIT_FAILURE);
+            else if (handleConnection(epfd, conn, events[i].events) != 0) {
+                closeConnection(epfd, conn);
             }
         }
-
-        close(connfd);
     }
 
+    close(epfd);
     close(listenfd);
 
+    pthread_mutex_lock(&rp_scpi_lock);
+    RP_StreamStop();
+    pthread_mutex_unlock(&rp_scpi_lock);
+    RP_StreamReap();
+
     result = rp_Release();
     if (result != RP_OK) {
         RP_LOG(LOG_ERR, "Failed to release RP App library: %s", rp_GetError(result));
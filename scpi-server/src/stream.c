@@ -0,0 +1,593 @@
+/**
+ * $Id: $
+ *
+ * @brief Red Pitaya Scpi server continuous acquisition streaming implementation
+ *
+ * The acquisition is armed with arm_keep set, so the FPGA keeps writing the
+ * ADC buffer after the trigger. A capture thread follows the write pointer and
+ * copies every completed chunk into a single producer / single consumer ring,
+ * a sender thread drains the ring to the network. A full ring never blocks the
+ * capture thread, the chunk is dropped and counted instead.
+ *
+ * The sender never blocks for long: connect() and send() time out, and a stop
+ * shuts the socket down. Stopping only signals the threads while rp_scpi_lock
+ * is held, RP_StreamReap() joins them afterwards outside of the lock. When the
+ * receiver fails, the sender stops the stream itself and keeps the error for
+ * the clients, see RP_StreamReportError().
+ *
+ * @Author Red Pitaya
+ *
+ * (c) Red Pitaya  http://www.redpitaya.com
+ *
+ * This part of code is written in C programming language.
+ * Please visit http://en.wikipedia.org/wiki/C_(programming_language)
+ * for more details on the language used herein.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <time.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+
+#include "stream.h"
+#include "common.h"
+#include "output.h"
+
+#include "scpi/parser.h"
+#include "scpi/error.h"
+
+#include "redpitaya/rp.h"
+
+#define STREAM_RING_MASK        (STREAM_RING_SLOTS - 1)
+
+#define STREAM_POLL_MIN_US      100
+#define STREAM_POLL_MAX_US      10000
+
+/* A receiver that does not accept the connection or stops reading ends the stream */
+#define STREAM_CONNECT_TIMEOUT_MS   3000
+#define STREAM_SEND_TIMEOUT_MS      1000
+/* Granularity the connect wait checks for a stop */
+#define STREAM_CONNECT_SLICE_MS     100
+
+const scpi_choice_def_t scpi_RpStreamProt[] = {
+    {"TCP", 0},
+    {"UDP", 1},
+    SCPI_CHOICE_LIST_END
+};
+
+static bool     stream_udp  = false;
+static uint16_t stream_port = 5001;
+
+/* Ring shared by the capture (producer) and the sender (consumer) thread */
+static rp_stream_packet_t stream_ring[STREAM_RING_SLOTS];
+static uint32_t ring_head = 0;          // written by the capture thread only
+static uint32_t ring_tail = 0;          // written by the sender thread only
+static sem_t    ring_sem;
+
+static pthread_t stream_capture_thread;
+static pthread_t stream_sender_thread;
+static bool      stream_threads = false;
+static volatile bool stream_running = false;
+/* Stopped threads not joined yet, accessed with rp_scpi_lock held */
+static bool      stream_reap = false;
+
+/* Start requested while the previous stream threads were not joined yet */
+static bool      stream_pending = false;
+static bool      stream_pending_udp;
+static struct sockaddr_in stream_pending_dest;
+
+static int stream_fd = -1;
+static struct sockaddr_in stream_dest;
+
+/* errno of the receiver failure that ended the last stream, 0: none */
+static int       stream_error = 0;
+/* The failure is still to be queued as SCPI error */
+static bool      stream_error_pending = false;
+
+/* Next ADC buffer position not yet read */
+static uint32_t stream_rd = 0;
+static rp_stream_stats_t stream_stats;
+
+
+static double stream_Now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint32_t stream_PollPeriod(float rate)
+{
+    // poll twice per chunk
+    double period = 0.5e6 * STREAM_CHUNK_SAMPLES / rate;
+    if (period < STREAM_POLL_MIN_US) {
+        return STREAM_POLL_MIN_US;
+    }
+    if (period > STREAM_POLL_MAX_US) {
+        return STREAM_POLL_MAX_US;
+    }
+    return (uint32_t)period;
+}
+
+/**
+ * Reserves the next ring slot and fills it with a chunk starting at stream_rd.
+ * Must be called with rp_scpi_lock held.
+ */
+static void stream_PushChunk(uint32_t sequence)
+{
+    uint32_t head = ring_head;
+    uint32_t tail = __atomic_load_n(&ring_tail, __ATOMIC_ACQUIRE);
+
+    if (head - tail >= STREAM_RING_SLOTS) {
+        __atomic_add_fetch(&stream_stats.ring_overruns, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    rp_stream_packet_t *pkt = &stream_ring[head & STREAM_RING_MASK];
+    uint32_t size = STREAM_CHUNK_SAMPLES;
+    rp_AcqGetDataRaw(RP_CH_1, stream_rd, &size, pkt->data[0]);
+    size = STREAM_CHUNK_SAMPLES;
+    rp_AcqGetDataRaw(RP_CH_2, stream_rd, &size, pkt->data[1]);
+
+    uint32_t overruns = __atomic_load_n(&stream_stats.ring_overruns, __ATOMIC_RELAXED)
+                      + __atomic_load_n(&stream_stats.adc_overruns, __ATOMIC_RELAXED);
+    pkt->header.magic    = htonl(STREAM_MAGIC);
+    pkt->header.sequence = htonl(sequence);
+    pkt->header.overruns = htonl(overruns);
+    pkt->header.channels = htons(2);
+    pkt->header.samples  = htons(STREAM_CHUNK_SAMPLES);
+
+    __atomic_store_n(&ring_head, head + 1, __ATOMIC_RELEASE);
+    sem_post(&ring_sem);
+}
+
+/**
+ * Follows the FPGA write pointer and slices the ADC buffer into chunks.
+ * The sequence number counts chunks, dropped ones included, so a receiver
+ * sees a gap wherever data was lost.
+ */
+static void* stream_Capture(void *arg)
+{
+    uint32_t sequence = 0;
+    uint32_t backlog = 0;
+    float rate = 0;
+    double last = stream_Now();
+
+    rp_AcqGetSamplingRateHz(&rate);
+
+    while (stream_running) {
+        usleep(stream_PollPeriod(rate));
+
+        // Never stall command dispatch, try again on the next poll
+        if (pthread_mutex_trylock(&rp_scpi_lock) != 0) {
+            continue;
+        }
+        // Stopped meanwhile, the acquisition is not ours any more
+        if (!stream_running) {
+            pthread_mutex_unlock(&rp_scpi_lock);
+            break;
+        }
+
+        uint32_t wp;
+        rp_AcqGetWritePointer(&wp);
+        rp_AcqGetSamplingRateHz(&rate);
+
+        double now = stream_Now();
+        double elapsed = (now - last) * rate;
+        last = now;
+
+        if (backlog + elapsed >= ADC_BUFFER_SIZE) {
+            // The oldest unread samples were overwritten, resynchronize
+            uint32_t lost = (uint32_t)((backlog + elapsed + STREAM_CHUNK_SAMPLES - 1) / STREAM_CHUNK_SAMPLES);
+            __atomic_add_fetch(&stream_stats.adc_overruns, lost, __ATOMIC_RELAXED);
+            sequence += lost;
+            stream_rd = (wp + 1) % ADC_BUFFER_SIZE;
+        }
+
+        uint32_t avail = (wp + 1 + ADC_BUFFER_SIZE - stream_rd) % ADC_BUFFER_SIZE;
+        while (avail >= STREAM_CHUNK_SAMPLES) {
+            stream_PushChunk(sequence++);
+            stream_rd = (stream_rd + STREAM_CHUNK_SAMPLES) % ADC_BUFFER_SIZE;
+            avail -= STREAM_CHUNK_SAMPLES;
+        }
+        backlog = avail;
+
+        pthread_mutex_unlock(&rp_scpi_lock);
+    }
+    return NULL;
+}
+
+static int stream_Send(const void *data, size_t len)
+{
+    const char *p = data;
+
+    while (len > 0) {
+        ssize_t n = send(stream_fd, p, len, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            // UDP receiver not listening (yet), the datagram is lost
+            if (stream_udp && errno == ECONNREFUSED) {
+                return 0;
+            }
+            // EAGAIN: the receiver did not read for STREAM_SEND_TIMEOUT_MS
+            return -1;
+        }
+        p += n;
+        len -= n;
+    }
+    return 0;
+}
+
+/**
+ * Connects to the receiver within STREAM_CONNECT_TIMEOUT_MS, giving up early
+ * on a stop. Sends on the connected socket time out after STREAM_SEND_TIMEOUT_MS.
+ */
+static int stream_Connect()
+{
+    int flags = fcntl(stream_fd, F_GETFL, 0);
+    int result;
+
+    if (flags == -1 || fcntl(stream_fd, F_SETFL, flags | O_NONBLOCK) == -1) {
+        return -1;
+    }
+
+    result = connect(stream_fd, (struct sockaddr *)&stream_dest, sizeof(stream_dest));
+    if (result == -1 && errno == EINPROGRESS) {
+        struct pollfd pfd = { .fd = stream_fd, .events = POLLOUT };
+        int waited = 0;
+
+        do {
+            result = poll(&pfd, 1, STREAM_CONNECT_SLICE_MS);
+            if (result == -1 && errno == EINTR) {
+                result = 0;
+                continue;
+            }
+            if (result == 0) {
+                waited += STREAM_CONNECT_SLICE_MS;
+            }
+        } while (result == 0 && stream_running && waited < STREAM_CONNECT_TIMEOUT_MS);
+
+        if (result > 0) {
+            int err = 0;
+            socklen_t len = sizeof(err);
+            getsockopt(stream_fd, SOL_SOCKET, SO_ERROR, &err, &len);
+            errno = err;
+            result = err ? -1 : 0;
+        }
+        else if (result == 0) {
+            errno = ETIMEDOUT;
+            result = -1;
+        }
+    }
+
+    fcntl(stream_fd, F_SETFL, flags);
+
+    struct timeval tv = {
+        .tv_sec  = STREAM_SEND_TIMEOUT_MS / 1000,
+        .tv_usec = (STREAM_SEND_TIMEOUT_MS % 1000) * 1000
+    };
+    setsockopt(stream_fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    return result;
+}
+
+/**
+ * Ends the stream from the sender thread after the receiver failed: the
+ * acquisition is disarmed as by a stop, and the next RP_StreamReap() joins
+ * the threads.
+ */
+static void stream_Fail(int err)
+{
+    pthread_mutex_lock(&rp_scpi_lock);
+    // Stopped meanwhile, the acquisition is not ours any more
+    if (stream_threads) {
+        stream_error = err;
+        stream_error_pending = true;
+        RP_StreamStop();
+    }
+    pthread_mutex_unlock(&rp_scpi_lock);
+}
+
+static void* stream_Sender(void *arg)
+{
+    bool connected = true;
+
+    if (stream_Connect() == -1) {
+        int err = errno;
+        RP_LOG(LOG_ERR, "Stream: failed to connect to %s:%d (%s)",
+                inet_ntoa(stream_dest.sin_addr), ntohs(stream_dest.sin_port), strerror(err));
+        stream_Fail(err);
+        return NULL;
+    }
+
+    while (1) {
+        while (sem_wait(&ring_sem) == -1 && errno == EINTR);
+
+        uint32_t tail = ring_tail;
+        uint32_t head = __atomic_load_n(&ring_head, __ATOMIC_ACQUIRE);
+        if (tail == head) {
+            if (!stream_running) {
+                break;
+            }
+            continue;
+        }
+
+        rp_stream_packet_t *pkt = &stream_ring[tail & STREAM_RING_MASK];
+        for (int ch = 0; ch < 2; ch++) {
+            for (int i = 0; i < STREAM_CHUNK_SAMPLES; i++) {
+                pkt->data[ch][i] = htons(pkt->data[ch][i]);
+            }
+        }
+
+        // The socket is shut down on a stop, the rest of the ring is dropped
+        if (!stream_running) {
+            connected = false;
+        }
+
+        if (connected && stream_Send(pkt, sizeof(*pkt)) != 0) {
+            int err = errno;
+            RP_LOG(LOG_ERR, "Stream: send failed (%s), stopping", strerror(err));
+            stream_Fail(err);
+            break;
+        }
+        else if (connected) {
+            __atomic_add_fetch(&stream_stats.packets, 1, __ATOMIC_RELAXED);
+        }
+
+        __atomic_store_n(&ring_tail, tail + 1, __ATOMIC_RELEASE);
+    }
+    return NULL;
+}
+
+
+static int stream_Begin(const struct sockaddr_in *dest, bool udp)
+{
+    int result;
+
+    stream_fd = socket(AF_INET, udp ? SOCK_DGRAM : SOCK_STREAM, 0);
+    if (stream_fd == -1) {
+        return RP_EOOR;
+    }
+    stream_dest = *dest;
+    stream_udp = udp;
+
+    ring_head = ring_tail = 0;
+    memset(&stream_stats, 0, sizeof(stream_stats));
+    stream_error = 0;
+    stream_error_pending = false;
+    sem_init(&ring_sem, 0, 0);
+
+    // Free running acquisition: trigger immediately and keep writing the buffer
+    if ((result = rp_AcqSetArmKeep(true)) != RP_OK ||
+        (result = rp_AcqStart()) != RP_OK ||
+        (result = rp_AcqSetTriggerSrc(RP_TRIG_SRC_NOW)) != RP_OK) {
+        close(stream_fd);
+        stream_fd = -1;
+        sem_destroy(&ring_sem);
+        return result;
+    }
+
+    uint32_t wp;
+    rp_AcqGetWritePointer(&wp);
+    stream_rd = (wp + 1) % ADC_BUFFER_SIZE;
+
+    stream_running = true;
+    stream_threads = true;
+    pthread_create(&stream_sender_thread, NULL, stream_Sender, NULL);
+    pthread_create(&stream_capture_thread, NULL, stream_Capture, NULL);
+    return RP_OK;
+}
+
+/**
+ * Starts streaming both channels to dest. Must be called with rp_scpi_lock held.
+ * A running stream is stopped first; while its threads are not joined yet the
+ * new stream is only recorded and started by RP_StreamReap().
+ */
+int RP_StreamStart(const struct sockaddr_in *dest, bool udp)
+{
+    int result = RP_StreamStop();
+    if (result != RP_OK) {
+        return result;
+    }
+
+    if (stream_reap) {
+        stream_pending = true;
+        stream_pending_dest = *dest;
+        stream_pending_udp = udp;
+        return RP_OK;
+    }
+    return stream_Begin(dest, udp);
+}
+
+/**
+ * Stops the stream. Must be called with rp_scpi_lock held, the threads are
+ * only told to end: the socket is shut down so a blocked send() returns at
+ * once. RP_StreamReap() joins them.
+ */
+int RP_StreamStop()
+{
+    stream_pending = false;
+
+    if (!stream_threads) {
+        return RP_OK;
+    }
+
+    stream_running = false;
+    shutdown(stream_fd, SHUT_RDWR);
+    sem_post(&ring_sem);
+    stream_threads = false;
+    stream_reap = true;
+
+    rp_AcqSetArmKeep(false);
+    return rp_AcqStop();
+}
+
+/**
+ * Joins the threads of a stopped stream and starts a stream requested
+ * meanwhile. Must be called without rp_scpi_lock held.
+ */
+void RP_StreamReap()
+{
+    pthread_mutex_lock(&rp_scpi_lock);
+    bool reap = stream_reap;
+    pthread_mutex_unlock(&rp_scpi_lock);
+
+    if (!reap) {
+        return;
+    }
+
+    pthread_join(stream_capture_thread, NULL);
+    pthread_join(stream_sender_thread, NULL);
+
+    pthread_mutex_lock(&rp_scpi_lock);
+    stream_reap = false;
+    sem_destroy(&ring_sem);
+    close(stream_fd);
+    stream_fd = -1;
+
+    if (stream_pending) {
+        stream_pending = false;
+        int result = stream_Begin(&stream_pending_dest, stream_pending_udp);
+        if (result != RP_OK) {
+            RP_LOG(LOG_ERR, "Stream: failed to restart stream: %s\n", rp_GetError(result));
+        }
+    }
+    pthread_mutex_unlock(&rp_scpi_lock);
+}
+
+bool RP_StreamRunning()
+{
+    return stream_running;
+}
+
+/**
+ * Queues the failure of a stream that ended on its own as SCPI execution
+ * error, once, so SYST:ERR? tells the clients. Must be called with
+ * rp_scpi_lock held.
+ */
+void RP_StreamReportError(scpi_t *context)
+{
+    if (stream_error_pending) {
+        stream_error_pending = false;
+        SCPI_ErrorPush(context, SCPI_ERROR_EXECUTION_ERROR);
+    }
+}
+
+void RP_StreamGetStats(rp_stream_stats_t *stats)
+{
+    stats->packets       = __atomic_load_n(&stream_stats.packets, __ATOMIC_RELAXED);
+    stats->ring_overruns = __atomic_load_n(&stream_stats.ring_overruns, __ATOMIC_RELAXED);
+    stats->adc_overruns  = __atomic_load_n(&stream_stats.adc_overruns, __ATOMIC_RELAXED);
+}
+
+
+scpi_result_t RP_AcqStreamProtocol(scpi_t *context) {
+    int32_t choice;
+
+    if (!SCPI_ParamChoice(context, scpi_RpStreamProt, &choice, true)) {
+        RP_LOG(LOG_ERR, "*ACQ:STR:PROT is missing first parameter.\n");
+        return SCPI_RES_ERR;
+    }
+
+    stream_udp = (choice == 1);
+
+    RP_LOG(LOG_INFO, "*ACQ:STR:PROT Successfully set stream protocol.\n");
+    return SCPI_RES_OK;
+}
+
+scpi_result_t RP_AcqStreamProtocolQ(scpi_t *context) {
+    const char *prot;
+
+    if (!SCPI_ChoiceToName(scpi_RpStreamProt, stream_udp ? 1 : 0, &prot)) {
+        RP_LOG(LOG_ERR, "*ACQ:STR:PROT? Failed to convert result to string.\n");
+        return SCPI_RES_ERR;
+    }
+
+    SCPI_ResultString(context, prot);
+
+    RP_LOG(LOG_INFO, "*ACQ:STR:PROT? Successfully returned stream protocol.\n");
+    return SCPI_RES_OK;
+}
+
+scpi_result_t RP_AcqStreamPort(scpi_t *context) {
+    uint32_t value;
+
+    if (!SCPI_ParamUInt32(context, &value, true) || value == 0 || value > 0xFFFF) {
+        RP_LOG(LOG_ERR, "*ACQ:STR:PORT is missing or has an invalid first parameter.\n");
+        return SCPI_RES_ERR;
+    }
+
+    stream_port = value;
+
+    RP_LOG(LOG_INFO, "*ACQ:STR:PORT Successfully set stream port to %d.\n", stream_port);
+    return SCPI_RES_OK;
+}
+
+scpi_result_t RP_AcqStreamPortQ(scpi_t *context) {
+    SCPI_ResultUInt32Base(context, stream_port, 10);
+
+    RP_LOG(LOG_INFO, "*ACQ:STR:PORT? Successfully returned stream port.\n");
+    return SCPI_RES_OK;
+}
+
+/* Streams to the configured port on the host this command came from */
+scpi_result_t RP_AcqStreamStart(scpi_t *context) {
+    rp_scpi_output_t *out = RP_OutputGet(context);
+    struct sockaddr_in dest;
+    socklen_t len = sizeof(dest);
+
+    if (out == NULL || getpeername(out->fd, (struct sockaddr *)&dest, &len) == -1) {
+        RP_LOG(LOG_ERR, "*ACQ:STR:START Failed to get client address.\n");
+        return SCPI_RES_ERR;
+    }
+    dest.sin_port = htons(stream_port);
+
+    int result = RP_StreamStart(&dest, stream_udp);
+    if (RP_OK != result) {
+        RP_LOG(LOG_ERR, "*ACQ:STR:START Failed to start stream: %s\n", rp_GetError(result));
+        return SCPI_RES_ERR;
+    }
+
+    RP_LOG(LOG_INFO, "*ACQ:STR:START Successfully started stream.\n");
+    return SCPI_RES_OK;
+}
+
+scpi_result_t RP_AcqStreamStop(scpi_t *context) {
+    int result = RP_StreamStop();
+
+    if (RP_OK != result) {
+        RP_LOG(LOG_ERR, "*ACQ:STR:STOP Failed to stop stream: %s\n", rp_GetError(result));
+        return SCPI_RES_ERR;
+    }
+
+    RP_LOG(LOG_INFO, "*ACQ:STR:STOP Successfully stopped stream.\n");
+    return SCPI_RES_OK;
+}
+
+/*
+ * Returns running state, packets sent, chunks dropped in the ring and in the ADC
+ * buffer, and the errno of the receiver failure that ended the stream, 0: none
+ */
+scpi_result_t RP_AcqStreamStatusQ(scpi_t *context) {
+    rp_stream_stats_t stats;
+    RP_StreamGetStats(&stats);
+
+    SCPI_ResultString(context, RP_StreamRunning() ? "ON" : "OFF");
+    SCPI_ResultUInt32Base(context, stats.packets, 10);
+    SCPI_ResultUInt32Base(context, stats.ring_overruns, 10);
+    SCPI_ResultUInt32Base(context, stats.adc_overruns, 10);
+    SCPI_ResultInt32(context, stream_error);
+
+    RP_LOG(LOG_INFO, "*ACQ:STR:STAT? Successfully returned stream status.\n");
+    return SCPI_RES_OK;
+}
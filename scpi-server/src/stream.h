@@ -0,0 +1,73 @@
+/**
+ * $Id: $
+ *
+ * @brief Red Pitaya Scpi server continuous acquisition streaming interface
+ *
+ * @Author Red Pitaya
+ *
+ * (c) Red Pitaya  http://www.redpitaya.com
+ *
+ * This part of code is written in C programming language.
+ * Please visit http://en.wikipedia.org/wiki/C_(programming_language)
+ * for more details on the language used herein.
+ */
+
+
+#ifndef STREAM_H_
+#define STREAM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <netinet/in.h>
+
+#include "scpi/types.h"
+
+/* Samples per channel carried by one stream packet */
+#define STREAM_CHUNK_SAMPLES    1024
+
+/* Packets buffered between the capture and the sender thread, power of two */
+#define STREAM_RING_SLOTS       64
+
+/* Stream packet magic, "RPST" */
+#define STREAM_MAGIC            0x52505354
+
+/**
+ * Header in front of every stream packet, all fields in network byte order.
+ * It is followed by 'samples' raw ADC counts of channel 1 and then of
+ * channel 2, each as big-endian int16.
+ */
+typedef struct rp_stream_header_s {
+    uint32_t magic;
+    uint32_t sequence;      // packet counter, starts at 0
+    uint32_t overruns;      // chunks lost so far: ring full or ADC buffer overwritten
+    uint16_t channels;
+    uint16_t samples;       // samples per channel
+} __attribute__((packed)) rp_stream_header_t;
+
+typedef struct rp_stream_packet_s {
+    rp_stream_header_t header;
+    int16_t            data[2][STREAM_CHUNK_SAMPLES];
+} rp_stream_packet_t;
+
+typedef struct rp_stream_stats_s {
+    uint32_t packets;       // packets sent
+    uint32_t ring_overruns; // chunks dropped because the sender fell behind
+    uint32_t adc_overruns;  // chunks overwritten in the ADC buffer before readout
+} rp_stream_stats_t;
+
+int RP_StreamStart(const struct sockaddr_in *dest, bool udp);
+int RP_StreamStop();
+void RP_StreamReap();
+bool RP_StreamRunning();
+void RP_StreamReportError(scpi_t *context);
+void RP_StreamGetStats(rp_stream_stats_t *stats);
+
+scpi_result_t RP_AcqStreamProtocol(scpi_t *context);
+scpi_result_t RP_AcqStreamProtocolQ(scpi_t *context);
+scpi_result_t RP_AcqStreamPort(scpi_t *context);
+scpi_result_t RP_AcqStreamPortQ(scpi_t *context);
+scpi_result_t RP_AcqStreamStart(scpi_t *context);
+scpi_result_t RP_AcqStreamStop(scpi_t *context);
+scpi_result_t RP_AcqStreamStatusQ(scpi_t *context);
+
+#endif /* STREAM_H_ */